@@ -25,7 +25,6 @@
 using namespace AGS::Common;
 
 Bitmap *backups[5];
-int _acroom_bpp = 1;  // bytes per pixel of currently loading room
 
 void sprstruc::ReadFromFile(Common::Stream *in)
 {
@@ -162,14 +161,12 @@ void room_file_header::WriteFromFile(Common::Stream *out)
     out->WriteInt16(version);
 }
 
-int usesmisccond = 0;
-
-void load_main_block(roomstruct *rstruc, const char *files, Stream *in, room_file_header rfh) {
+bool load_main_block(roomstruct *rstruc, const char *files, Stream *in, room_file_header rfh,
+                     RoomLoadPollCallback poll, String &error) {
   int   f, gsmod, NUMREAD;
   char  buffre[3000];
   long  tesl;
 
-  usesmisccond = 0;
   rstruc->width = 320;
   rstruc->height = 200;
   rstruc->resolution = 1;
@@ -196,18 +193,19 @@ void load_main_block(roomstruct *rstruc, const char *files, Stream *in, room_fil
   memset(&rstruc->objcond[0], 0, sizeof(EventBlock) * MAX_INIT_SPR);
   memset(&rstruc->misccond, 0, sizeof(EventBlock));*/
 
+  int bpp = 1;
   if (rfh.version >= kRoomVersion_208)
-    _acroom_bpp = in->ReadInt32();
-  else
-    _acroom_bpp = 1;
+    bpp = in->ReadInt32();
 
-  if (_acroom_bpp < 1)
-    _acroom_bpp = 1;
+  if (bpp < 1)
+    bpp = 1;
 
-  rstruc->bytes_per_pixel = _acroom_bpp;
+  rstruc->bytes_per_pixel = bpp;
   rstruc->numobj = in->ReadInt16();
-  if (rstruc->numobj > MAX_OBJ)
-    quit("!room newer than this version - too many walk-behinds");
+  if (rstruc->numobj > MAX_OBJ) {
+    error = "!room newer than this version - too many walk-behinds";
+    return false;
+  }
 
   NUMREAD = NUM_CONDIT;
   in->ReadArrayOfInt16(&rstruc->objyval[0], rstruc->numobj);
@@ -217,8 +215,10 @@ void load_main_block(roomstruct *rstruc, const char *files, Stream *in, room_fil
   rstruc->numhotspots = in->ReadInt32();
   if (rstruc->numhotspots == 0)
     rstruc->numhotspots = 20;
-	if (rstruc->numhotspots > MAX_HOTSPOTS)
-		quit("room has too many hotspots: need newer version of AGS?");
+	if (rstruc->numhotspots > MAX_HOTSPOTS) {
+		error = "room has too many hotspots: need newer version of AGS?";
+		return false;
+	}
 
     // Points are a pair of shorts
     // [IKM] TODO: read/write member for _Point?
@@ -251,7 +251,8 @@ void load_main_block(roomstruct *rstruc, const char *files, Stream *in, room_fil
       rstruc->wallpoints[iteratorCount].ReadFromFile(in);
   }
   
-  update_polled_stuff_if_runtime();
+  if (!poll())
+    return false;
 
   rstruc->top = in->ReadInt16();
   rstruc->bottom = in->ReadInt16();
@@ -279,8 +280,10 @@ void load_main_block(roomstruct *rstruc, const char *files, Stream *in, room_fil
   rstruc->numRegions = 0;
 
   if (rfh.version >= kRoomVersion_241) {
-    if ((rstruc->numhotspots > MAX_HOTSPOTS) || (rstruc->numsprs > MAX_INIT_SPR))
-      quit("load_room: room file created with newer version (too many hotspots/objects)");
+    if ((rstruc->numhotspots > MAX_HOTSPOTS) || (rstruc->numsprs > MAX_INIT_SPR)) {
+      error = "load_room: room file created with newer version (too many hotspots/objects)";
+      return false;
+    }
 
     // free all of the old interactions
     for (f = 0; f < MAX_HOTSPOTS; f++) {
@@ -292,7 +295,7 @@ void load_main_block(roomstruct *rstruc, const char *files, Stream *in, room_fil
 	  if (rfh.version < kRoomVersion_300a) 
 	  {
 		  if (f < rstruc->numhotspots)
-			rstruc->intrHotspot[f] = Interaction::CreateFromStream(in);
+			rstruc->intrHotspot[f] = Interaction::CreateFromStream(in, error);
 		  else
 			rstruc->intrHotspot[f] = new Interaction();
 	  }
@@ -307,7 +310,7 @@ void load_main_block(roomstruct *rstruc, const char *files, Stream *in, room_fil
 	  if (rfh.version < kRoomVersion_300a) 
 	  {
 		  if (f < rstruc->numsprs)
-			rstruc->intrObject[f] = Interaction::CreateFromStream(in);
+			rstruc->intrObject[f] = Interaction::CreateFromStream(in, error);
 		  else
 			rstruc->intrObject[f] = new Interaction();
 	  }
@@ -316,7 +319,8 @@ void load_main_block(roomstruct *rstruc, const char *files, Stream *in, room_fil
 	if (rfh.version < kRoomVersion_300a) 
 	{
 	    delete rstruc->intrRoom;
-		rstruc->intrRoom = Interaction::CreateFromStream(in);
+		rstruc->intrRoom = NULL;
+		rstruc->intrRoom = Interaction::CreateFromStream(in, error);
 	}
 
     for (f = 0; f < MAX_REGIONS; f++) {
@@ -327,36 +331,41 @@ void load_main_block(roomstruct *rstruc, const char *files, Stream *in, room_fil
 
     if (rfh.version >= kRoomVersion_255b) {
       rstruc->numRegions = in->ReadInt32();
-      if (rstruc->numRegions > MAX_REGIONS)
-        quit("load_room: needs newer version of AGS - too many regions");
+      if (rstruc->numRegions > MAX_REGIONS) {
+        error = "load_room: needs newer version of AGS - too many regions";
+        return false;
+      }
 
   	  if (rfh.version < kRoomVersion_300a) 
 	  {
         for (f = 0; f < rstruc->numRegions; f++) {
           delete rstruc->intrRegion[f];
-          rstruc->intrRegion[f] = Interaction::CreateFromStream(in);
+          rstruc->intrRegion[f] = NULL;
+          rstruc->intrRegion[f] = Interaction::CreateFromStream(in, error);
 		}
       }
     }
 
 	if (rfh.version >= kRoomVersion_300a)
 	{
-	  rstruc->hotspotScripts = new InteractionScripts*[rstruc->numhotspots];
-	  rstruc->objectScripts = new InteractionScripts*[rstruc->numsprs];
-      rstruc->regionScripts = new InteractionScripts*[rstruc->numRegions];
-      rstruc->roomScripts = InteractionScripts::CreateFromStream(in);
+	  rstruc->hotspotScripts = new InteractionScripts*[rstruc->numhotspots]();
+	  rstruc->objectScripts = new InteractionScripts*[rstruc->numsprs]();
+      rstruc->regionScripts = new InteractionScripts*[rstruc->numRegions]();
+      rstruc->roomScripts = InteractionScripts::CreateFromStream(in, error);
 	  int bb;
       for (bb = 0; bb < rstruc->numhotspots; bb++) {
-        rstruc->hotspotScripts[bb] = InteractionScripts::CreateFromStream(in);
+        rstruc->hotspotScripts[bb] = InteractionScripts::CreateFromStream(in, error);
       }
       for (bb = 0; bb < rstruc->numsprs; bb++) {
-        rstruc->objectScripts[bb] = InteractionScripts::CreateFromStream(in);
+        rstruc->objectScripts[bb] = InteractionScripts::CreateFromStream(in, error);
       }
 	  for (bb = 0; bb < rstruc->numRegions; bb++) {
-        rstruc->regionScripts[bb] = InteractionScripts::CreateFromStream(in);
+        rstruc->regionScripts[bb] = InteractionScripts::CreateFromStream(in, error);
       }
 
 	}
+    if (!error.IsEmpty())
+      return false;
   }
 
   if (rfh.version >= kRoomVersion_200_alpha) {
@@ -375,8 +384,10 @@ void load_main_block(roomstruct *rstruc, const char *files, Stream *in, room_fil
   if (rfh.version >= kRoomVersion_240)
     num_walk_areas = in->ReadInt32();
     
-  if (num_walk_areas > MAX_WALK_AREAS + 1)
-    quit("load_room: Too many walkable areas, need newer version");
+  if (num_walk_areas > MAX_WALK_AREAS + 1) {
+    error = "load_room: Too many walkable areas, need newer version";
+    return false;
+  }
 
   if (rfh.version >= kRoomVersion_200_alpha7)
     in->ReadArrayOfInt16(&rstruc->walk_area_zoom[0], num_walk_areas);
@@ -416,8 +427,17 @@ void load_main_block(roomstruct *rstruc, const char *files, Stream *in, room_fil
     memset(&rstruc->msgi[0], 0, sizeof(MessageInfo) * MAXMESS);
 
   for (f = 0;f < rstruc->nummes; f++) {
-    if (rfh.version >= kRoomVersion_261)
-      read_string_decrypt(in, buffre);
+    if (rfh.version >= kRoomVersion_261) {
+      // same as read_string_decrypt, but the length is checked against the buffer
+      int len = in->ReadInt32();
+      if ((len < 0) || (len >= (int)sizeof(buffre))) {
+        error = "ReadString: file is corrupt";
+        return false;
+      }
+      in->Read(buffre, len);
+      buffre[len] = 0;
+      decrypt_text(buffre);
+    }
     else
       fgetstring_limit(buffre, in, 2999);
 
@@ -475,36 +495,47 @@ void load_main_block(roomstruct *rstruc, const char *files, Stream *in, room_fil
     }
   }
 
-  update_polled_stuff_if_runtime();
+  if (!poll())
+    return false;
 
   if (rfh.version >= kRoomVersion_pre114_5) {
-    tesl = load_lzw(in, rstruc->ebscene[0], rstruc->pal);
-    rstruc->ebscene[0] = recalced;
+    tesl = load_lzw(in, &rstruc->ebscene[0], bpp, rstruc->pal);
   }
   else
     tesl = loadcompressed_allegro(in, &rstruc->ebscene[0], rstruc->pal, in->GetPosition());
+  if (tesl < 0) {
+    error = "Read error decompressing image - file is corrupt";
+    return false;
+  }
 
   if ((rstruc->ebscene[0]->GetWidth() > 320) & (rfh.version < kRoomVersion_200_final))
     rstruc->resolution = 2;
 
-  update_polled_stuff_if_runtime();
-  if (rfh.version >= kRoomVersion_255b)
-    tesl = loadcompressed_allegro(in, &rstruc->regions, rstruc->pal, tesl);
-  else if (rfh.version >= kRoomVersion_114) {
+  if (!poll())
+    return false;
+  if (rfh.version >= kRoomVersion_114) {
     tesl = loadcompressed_allegro(in, &rstruc->regions, rstruc->pal, tesl);
-    // an old version - ->Clear the 'shadow' area into a blank regions bmp
-    delete rstruc->regions;
-    rstruc->regions = NULL;
+    if (rfh.version < kRoomVersion_255b) {
+      // an old version - ->Clear the 'shadow' area into a blank regions bmp
+      delete rstruc->regions;
+      rstruc->regions = NULL;
+    }
   }
 
-  update_polled_stuff_if_runtime();
-  tesl = loadcompressed_allegro(in, &rstruc->walls, rstruc->pal, tesl);
-
-  update_polled_stuff_if_runtime();
-  tesl = loadcompressed_allegro(in, &rstruc->object, rstruc->pal, tesl);
-
-  update_polled_stuff_if_runtime();
-  tesl = loadcompressed_allegro(in, &rstruc->lookat, rstruc->pal, tesl);
+  // the masks follow one another, so after a corrupt one the rest can't
+  // be found either
+  if ((tesl >= 0) && poll())
+    tesl = loadcompressed_allegro(in, &rstruc->walls, rstruc->pal, tesl);
+  if ((tesl >= 0) && poll())
+    tesl = loadcompressed_allegro(in, &rstruc->object, rstruc->pal, tesl);
+  if ((tesl >= 0) && poll())
+    tesl = loadcompressed_allegro(in, &rstruc->lookat, rstruc->pal, tesl);
+  if (tesl < 0) {
+    error = "!load_room: mask data is corrupt";
+    return false;
+  }
+  if (!poll())
+    return false;
 
   if (rfh.version < kRoomVersion_255b) {
     // Old version - copy walkable areas to Regions
@@ -526,12 +557,60 @@ void load_main_block(roomstruct *rstruc, const char *files, Stream *in, room_fil
     for (f = 0; f < 11; f++)
       rstruc->password[f] += passwencstring[f];
   }
+  return true;
 }
 
 extern bool load_room_is_version_bad(roomstruct *rstruc);
 
+// Keeps the program responsive while the room is loaded on the main thread
+static bool poll_room_loading() {
+  update_polled_stuff_if_runtime();
+  return true;
+}
+
+static bool load_room_impl(Stream *opty, const char *files, roomstruct *rstruc, bool gameIsHighRes,
+                    RoomLoadPollCallback poll, long *script_pos, String &error);
+
 void load_room(const char *files, roomstruct *rstruc, bool gameIsHighRes) {
-  Common::Stream *opty; // CHECKME why "opty"??
+  Common::Stream *opty = Common::AssetManager::OpenAsset(files);
+  if (opty == NULL) {
+    char errbuffr[500];
+    sprintf(errbuffr,"Load_room: Unable to load the room file '%s'\n"
+      "Make sure that you saved the room to the correct folder (it should be\n"
+      "in your game's sub-folder of the AGS directory).\n"
+      "Also check that the player character's starting room is set correctly.\n",files);
+    quit(errbuffr);
+  }
+  load_room(opty, files, rstruc, gameIsHighRes);
+  delete opty;
+}
+
+void load_room(Common::Stream *opty, const char *files, roomstruct *rstruc, bool gameIsHighRes) {
+  String error;
+  if (!load_room_impl(opty, files, rstruc, gameIsHighRes, poll_room_loading, NULL, error))
+    quit(error);
+}
+
+bool load_room_data(Common::Stream *in, const char *files, roomstruct *rstruc, bool gameIsHighRes,
+                    RoomLoadPollCallback poll, long &script_pos, String &error) {
+  script_pos = -1;
+  return load_room_impl(in, files, rstruc, gameIsHighRes, poll, &script_pos, error);
+}
+
+bool load_room_script(Common::Stream *in, long script_pos, roomstruct *rstruc, String &error) {
+  if (script_pos < 0)
+    return true;
+  in->Seek(script_pos, kSeekBegin);
+  rstruc->compiled_script.reset(ccScript::CreateFromStream(in));
+  if (rstruc->compiled_script == NULL) {
+    error = "Load_room: Script load failed; need newer version?";
+    return false;
+  }
+  return true;
+}
+
+static bool load_room_impl(Stream *opty, const char *files, roomstruct *rstruc, bool gameIsHighRes,
+                    RoomLoadPollCallback poll, long *script_pos, String &error) {
   room_file_header  rfh;
   int i;
 
@@ -545,7 +624,8 @@ void load_room(const char *files, roomstruct *rstruc, bool gameIsHighRes) {
       delete rstruc->ebscene[ff];
       rstruc->ebscene[ff] = NULL;
     }
-    update_polled_stuff_if_runtime();
+    if (!poll())
+      return false;
   }
 
   rstruc->num_bscenes = 1;
@@ -577,18 +657,8 @@ void load_room(const char *files, roomstruct *rstruc, bool gameIsHighRes) {
 
   memset(&rstruc->ebpalShared[0], 0, MAX_BSCENE);
 
-  update_polled_stuff_if_runtime();
-
-  opty = Common::AssetManager::OpenAsset(files);
-  if (opty == NULL) {
-    char errbuffr[500];
-    sprintf(errbuffr,"Load_room: Unable to load the room file '%s'\n"
-      "Make sure that you saved the room to the correct folder (it should be\n"
-      "in your game's sub-folder of the AGS directory).\n"
-      "Also check that the player character's starting room is set correctly.\n",files);
-    quit(errbuffr);
-  }
-  update_polled_stuff_if_runtime();  // it can take a while to load the file sometimes
+  if (!poll())  // it can take a while to load the file sometimes
+    return false;
 
   rfh.ReadFromFile(opty);
   //fclose(opty);
@@ -596,16 +666,17 @@ void load_room(const char *files, roomstruct *rstruc, bool gameIsHighRes) {
 
   if (load_room_is_version_bad(rstruc))
   {
-    delete opty;
-    quit("Load_Room: Bad packed file. Either the file requires a newer or older version of\n"
-      "this program or the file is corrupt.\n");
+    error = "Load_Room: Bad packed file. Either the file requires a newer or older version of\n"
+      "this program or the file is corrupt.\n";
+    return false;
   }
 
   int   thisblock = 0;
   int   bloklen;
 
   while (thisblock != BLOCKTYPE_EOF) {
-    update_polled_stuff_if_runtime();
+    if (!poll())
+      return false;
     thisblock = opty->ReadByte();
 
     if (thisblock == BLOCKTYPE_EOF)
@@ -614,8 +685,10 @@ void load_room(const char *files, roomstruct *rstruc, bool gameIsHighRes) {
     bloklen = opty->ReadInt32();
     bloklen += opty->GetPosition();  // make it the new position for after block read
 
-    if (thisblock == BLOCKTYPE_MAIN)
-      load_main_block(rstruc, files, opty, rfh);
+    if (thisblock == BLOCKTYPE_MAIN) {
+      if (!load_main_block(rstruc, files, opty, rfh, poll, error))
+        return false;
+    }
     else if (thisblock == BLOCKTYPE_SCRIPT) {
       int   lee;
       int   hh;
@@ -630,19 +703,28 @@ void load_room(const char *files, roomstruct *rstruc, bool gameIsHighRes) {
         rstruc->scripts[hh] += passwencstring[hh % 11];
     }
     else if (thisblock == BLOCKTYPE_COMPSCRIPT3) {
-      rstruc->compiled_script.reset(ccScript::CreateFromStream(opty));
-      if (rstruc->compiled_script == NULL)
-        quit("Load_room: Script load failed; need newer version?");
+      if (script_pos) {
+        // the script is read later by the caller
+        *script_pos = opty->GetPosition();
+        opty->Seek(bloklen, kSeekBegin);
+      }
+      else if (!load_room_script(opty, opty->GetPosition(), rstruc, error))
+        return false;
     }
     else if ((thisblock == BLOCKTYPE_COMPSCRIPT) || (thisblock == BLOCKTYPE_COMPSCRIPT2))
 #ifdef LOADROOM_ALLOWOLD
       rstruc->compiled_script = NULL;
 #else
-      quit("Load_room: old room format. Please upgrade the room.");
+    {
+      error = "Load_room: old room format. Please upgrade the room.";
+      return false;
+    }
 #endif
     else if (thisblock == BLOCKTYPE_OBJECTNAMES) {
-      if (opty->ReadByte() != rstruc->numsprs)
-        quit("Load_room: inconsistent blocks for object names");
+      if (opty->ReadByte() != rstruc->numsprs) {
+        error = "Load_room: inconsistent blocks for object names";
+        return false;
+      }
 
       for (int i = 0; i < rstruc->numsprs; ++i)
       {
@@ -653,8 +735,10 @@ void load_room(const char *files, roomstruct *rstruc, bool gameIsHighRes) {
       }
     }
     else if (thisblock == BLOCKTYPE_OBJECTSCRIPTNAMES) {
-      if (opty->ReadByte() != rstruc->numsprs)
-        quit("Load_room: inconsistent blocks for object script names");
+      if (opty->ReadByte() != rstruc->numsprs) {
+        error = "Load_room: inconsistent blocks for object script names";
+        return false;
+      }
 
       for (int i = 0; i < rstruc->numsprs; ++i)
       {
@@ -680,51 +764,61 @@ void load_room(const char *files, roomstruct *rstruc, bool gameIsHighRes) {
 //        fclose(opty);
 
       for (ct = 1; ct < rstruc->num_bscenes; ct++) {
-        update_polled_stuff_if_runtime();
+        if (!poll())
+          return false;
 //          fpos = load_lzw(files,rstruc->ebscene[ct],rstruc->pal,fpos);
-        fpos = load_lzw(opty, rstruc->ebscene[ct], rstruc->bpalettes[ct]);
-        rstruc->ebscene[ct] = recalced;
+        fpos = load_lzw(opty, &rstruc->ebscene[ct], rstruc->bytes_per_pixel, rstruc->bpalettes[ct]);
+        if (fpos < 0) {
+          error = "Read error decompressing image - file is corrupt";
+          return false;
+        }
       }
 //        opty = Common::AssetManager::OpenAsset(files, "rb");
 //        Seek(opty, fpos, SEEK_SET);
     }
     else if (thisblock == BLOCKTYPE_PROPERTIES) {
       // Read custom properties
-      if (opty->ReadInt32() != 1)
-        quit("LoadRoom: unknown Custom Properties block encountered");
+      if (opty->ReadInt32() != 1) {
+        error = "LoadRoom: unknown Custom Properties block encountered";
+        return false;
+      }
 
       int errors = 0, gg;
 
-      if (Properties::ReadValues(rstruc->roomProps, opty))
-        quit("LoadRoom: error reading custom properties block");
+      if (Properties::ReadValues(rstruc->roomProps, opty)) {
+        error = "LoadRoom: error reading custom properties block";
+        return false;
+      }
 
       for (gg = 0; gg < rstruc->numhotspots; gg++)
         errors += Properties::ReadValues(rstruc->hsProps[gg], opty);
       for (gg = 0; gg < rstruc->numsprs; gg++)
         errors += Properties::ReadValues(rstruc->objProps[gg], opty);
 
-      if (errors > 0)
-        quit("LoadRoom: errors encountered reading custom props");
+      if (errors > 0) {
+        error = "LoadRoom: errors encountered reading custom props";
+        return false;
+      }
     }
     else if (thisblock == -1)
     {
-      delete opty;
-      quit("LoadRoom: unexpected end of file while loading room");
-      return;
+      error = "LoadRoom: unexpected end of file while loading room";
+      return false;
     }
     else {
-      quitprintf("LoadRoom: unknown block type %d encountered in '%s'", thisblock, files);
+      error.Format("LoadRoom: unknown block type %d encountered in '%s'", thisblock, files);
+      return false;
     }
 
-    if (opty->GetPosition() != bloklen)
-      quitprintf("LoadRoom: unexpected end of block %d in in '%s'", thisblock, files);
+    if (opty->GetPosition() != bloklen) {
+      error.Format("LoadRoom: unexpected end of block %d in in '%s'", thisblock, files);
+      return false;
+    }
   }
 
   // sync bpalettes[0] with room.pal
   memcpy (&rstruc->bpalettes[0][0], &rstruc->pal[0], sizeof(color) * 256);
 
-  delete opty;
-
   if ((rfh.version < kRoomVersion_303b) && (gameIsHighRes))
   {
 	  // Pre-3.0.3, multiply up co-ordinates
@@ -759,5 +853,5 @@ void load_room(const char *files, roomstruct *rstruc, bool gameIsHighRes) {
 	  rstruc->width *= 2;
 	  rstruc->height *= 2;
   }
-
+  return true;
 }
@@ -231,9 +231,23 @@ struct room_file_header {
     void WriteFromFile(Common::Stream *out);
 };
 
-extern int _acroom_bpp;  // bytes per pixel of currently loading room
+// Called by the room loader as it goes; returning false interrupts the loading
+typedef bool (*RoomLoadPollCallback)();
 
 extern void load_room(const char *files, roomstruct *rstruc, bool gameIsHighRes);
+// Loads the room from the stream opened by the caller, who also deletes it;
+// the file name is only used in error messages
+extern void load_room(Common::Stream *in, const char *files, roomstruct *rstruc, bool gameIsHighRes);
+// Loads the room without quitting on errors and without touching any global
+// state, so that it may run on another thread. Returns false on failure, with
+// the error set, or left empty if the poll callback interrupted the loading.
+// The compiled script is not read: its position in the stream is returned in
+// script_pos instead, or -1 if the room has none, to be read with
+// load_room_script on the main thread.
+extern bool load_room_data(Common::Stream *in, const char *files, roomstruct *rstruc, bool gameIsHighRes,
+                           RoomLoadPollCallback poll, long &script_pos, AGS::Common::String &error);
+// Reads the room's compiled script found at the given stream position
+extern bool load_room_script(Common::Stream *in, long script_pos, roomstruct *rstruc, AGS::Common::String &error);
 
 
 // Those are, in fact, are project-dependent and are implemented in runtime and AGS.Native
@@ -22,6 +22,7 @@
 #pragma warning (disable: 4996 4312)  // disable deprecation warnings
 #endif
 
+#include <vector>
 #include "ac/common.h"
 #include "ac/spritecache.h"
 #include "core/assetmanager.h"
@@ -39,41 +40,48 @@ extern void pre_save_sprite(int);
 extern void get_new_size_for_sprite(int, int, int, int &, int &);
 extern int spritewidth[], spriteheight[];
 
-#define SPRITE_LOCKED -1
-#define START_OF_LIST -1
 #define END_OF_LIST   -1
 
 const char *spindexid = "SPRINDEX";
 const char *spindexfilename = "sprindex.dat";
 
 
+SpriteCacheEntry::SpriteCacheEntry()
+  : Offset(0)
+  , Image(NULL)
+  , Size(0)
+  , Newer(END_OF_LIST)
+  , Older(END_OF_LIST)
+  , CatNewer(END_OF_LIST)
+  , CatOlder(END_OF_LIST)
+  , PinCount(0)
+  , Flags(0)
+  , Category(kSprCat_General)
+{
+}
+
+
 SpriteCache::SpriteCache(int32_t maxElements)
 {
   elements = maxElements;
   cache_stream = NULL;
-  offsets = NULL;
   sprite0InitialOffset = 0;
   spritesAreCompressed = false;
+  prefetcher = NULL;
+  for (int i = 0; i < kNumSpriteCategories; i++)
+    catBudget[i] = 0;
   init();
 }
 
 void SpriteCache::changeMaxSize(int32_t maxElements) {
   elements = maxElements;
-  if (offsets) {
-    free(offsets);
-    free(images);
-    free(mrulist);
-    free(mrubacklink);
-    free(sizes);
-    free(flags);
-  }
-  offsets = (int32_t *)calloc(elements, sizeof(int32_t));
-  memset(offsets, 0, elements*sizeof(int32_t));
-  images = (Bitmap **) calloc(elements, sizeof(Bitmap *));
-  mrulist = (int *)calloc(elements, sizeof(int));
-  mrubacklink = (int *)calloc(elements, sizeof(int));
-  sizes = (int *)calloc(elements, sizeof(int));
-  flags = (unsigned char *)calloc(elements, sizeof(unsigned char));
+  // swap with the new table, to release the memory of the old one
+  std::vector<SpriteCacheEntry>(elements).swap(entries);
+  mru = SpriteList();
+  for (int i = 0; i < kNumSpriteCategories; i++) {
+    catMru[i] = SpriteList();
+    catSize[i] = 0;
+  }
 }
 
 void SpriteCache::init()
@@ -83,51 +91,58 @@ void SpriteCache::init()
   changeMaxSize(elements);
   cachesize = 0;
   lockedSize = 0;
-  liststart = -1;
-  listend = -1;
   lastLoad = -2;
   maxCacheSize = DEFAULTCACHESIZE;
+  stats = SpriteCacheStats();
 }
 
 void SpriteCache::reset()
 {
-  int ii;
-  for (ii = 0; ii < elements; ii++) {
-    if (images[ii] != NULL) {
-      delete images[ii];
-      images[ii] = NULL;
-    }
+  for (int i = 0; i < elements; i++) {
+    delete entries[i].Image;
+    entries[i].Image = NULL;
   }
-
-  free(offsets);
-  free(images);
-  free(mrulist);
-  free(mrubacklink);
-  free(sizes);
-  free(flags);
-  offsets = NULL;
-
   init();
 }
 
 void SpriteCache::set(int index, Bitmap *sprite)
 {
-  images[index] = sprite;
+  SpriteCacheEntry &entry = entries[index];
+  if ((sprite == NULL) && (entry.Size > 0) && ((entry.Flags & SPRCACHEFLAG_LOCKED) == 0)) {
+    // image was taken away from the cache, so stop counting it
+    unlinkSprite(index);
+    cachesize -= entry.Size;
+    catSize[entry.Category] -= entry.Size;
+    entry.Size = 0;
+  }
+  entry.Image = sprite;
 }
 
 void SpriteCache::setNonDiscardable(int index, Bitmap *sprite)
 {
-  images[index] = sprite;
-  offsets[index] = SPRITE_LOCKED;
+  entries[index].Image = sprite;
+  lockSprite(index);
 }
 
 void SpriteCache::removeSprite(int index, bool freeMemory)
 {
-  if ((images[index] != NULL) && (freeMemory))
-    delete images[index];
-
-  images[index] = NULL;
-  offsets[index] = 0;
+  SpriteCacheEntry &entry = entries[index];
+  unlinkSprite(index);
+  if ((entry.Image != NULL) && (freeMemory))
+    delete entry.Image;
+
+  if (entry.Size > 0) {
+    cachesize -= entry.Size;
+    catSize[entry.Category] -= entry.Size;
+    if (entry.Flags & SPRCACHEFLAG_LOCKED) {
+      lockedSize -= entry.Size;
+      maxCacheSize -= entry.Size;
+    }
+  }
+  entry.Image = NULL;
+  entry.Offset = 0;
+  entry.Size = 0;
+  entry.Flags &= ~SPRCACHEFLAG_LOCKED;
 }
 
 int SpriteCache::enlargeTo(int32_t newsize) {
@@ -136,22 +151,9 @@ int SpriteCache::enlargeTo(int32_t newsize) {
 
   int elementsWas = elements;
   elements = newsize;
-  offsets = (int32_t *)realloc(offsets, elements * sizeof(int32_t));
-  images = (Bitmap **)realloc(images, elements * sizeof(Bitmap *));
-  mrulist = (int *)realloc(mrulist, elements * sizeof(int));
-  mrubacklink = (int *)realloc(mrubacklink, elements * sizeof(int));
-  sizes = (int *)realloc(sizes, elements * sizeof(int));
-  flags = (unsigned char*)realloc(flags, elements * sizeof(unsigned char));
-
-  for (int i = elementsWas; i < elements; i++) {
-    offsets[i] = 0;
-    images[i] = 0;
-    mrulist[i] = 0;
-    mrubacklink[i] = 0;
-    sizes[i] = 0;
-    flags[i] = SPRCACHEFLAG_DOESNOTEXIST;
-  }
-
+  entries.resize(elements);
+  for (int i = elementsWas; i < elements; i++)
+    entries[i].Flags = SPRCACHEFLAG_DOESNOTEXIST;
   return elementsWas;
 }
 
@@ -160,7 +162,9 @@ int SpriteCache::findFreeSlot()
   int i;
   for (i = 1; i < elements; i++) {
     // slot empty
-    if ((images[i] == NULL) && ((offsets[i] == 0) || (offsets[i] == sprite0InitialOffset)))
+    const SpriteCacheEntry &entry = entries[i];
+    if ((entry.Image == NULL) && ((entry.Flags & SPRCACHEFLAG_LOCKED) == 0) &&
+        ((entry.Offset == 0) || (entry.Offset == sprite0InitialOffset)))
       return i;
   }
   // no free slot found yet
@@ -173,13 +177,13 @@ int SpriteCache::findFreeSlot()
 }
 
 int SpriteCache::doesSpriteExist(int index) {
-  if (images[index] != NULL)
+  if (entries[index].Image != NULL)
     return 1;
   
-  if (flags[index] & SPRCACHEFLAG_DOESNOTEXIST)
+  if (entries[index].Flags & SPRCACHEFLAG_DOESNOTEXIST)
     return 0;
 
-  if (offsets[index] > 0)
+  if (entries[index].Offset > 0)
     return 1;
 
   return 0;
@@ -191,121 +195,52 @@ Bitmap *SpriteCache::operator [] (int index)
   if ((index < 0) || (index >= elements))
     return NULL;
 
+  SpriteCacheEntry &entry = entries[index];
   // Dynamically added sprite, don't put it on the sprite list
-  if ((images[index] != NULL) && 
-      ((offsets[index] == 0) || ((flags[index] & SPRCACHEFLAG_DOESNOTEXIST) != 0)))
-    return images[index];
-
-  // if sprite exists in file but is not in mem, load it
-  if ((images[index] == NULL) && (offsets[index] > 0))
-    loadSprite(index);
-
-  // Locked sprite, eg. mouse cursor, that shouldn't be discarded
-  if (offsets[index] == SPRITE_LOCKED)
-    return images[index];
-
-  if (liststart < 0) {
-    liststart = index;
-    listend = index;
-    mrulist[index] = END_OF_LIST;
-    mrubacklink[index] = START_OF_LIST;
-  } 
-  else if (listend != index) {
-    // this is the oldest element being bumped to newest, so update start link
-    if (index == liststart) {
-      liststart = mrulist[index];
-      mrubacklink[liststart] = START_OF_LIST;
+  if ((entry.Image != NULL) && 
+      ((entry.Offset == 0) || ((entry.Flags & SPRCACHEFLAG_DOESNOTEXIST) != 0)))
+    return entry.Image;
+
+  if (entry.Image == NULL) {
+    // if sprite exists in file but is not in mem, load it
+    if ((entry.Offset > 0) && ((entry.Flags & SPRCACHEFLAG_LOCKED) == 0)) {
+      // see if it was loaded in the background first
+      Bitmap *image = prefetcher ? prefetcher->TakeSprite(index) : NULL;
+      if (image)
+      {
+        installSprite(index, image);
+        stats.PrefetchHits++;
+      }
+      else
+      {
+        loadSprite(index);
+        stats.Misses++;
+      }
     }
-    // already in list, link previous to next
-    else if (mrulist[index] > 0) {
-      mrulist[mrubacklink[index]] = mrulist[index];
-      mrubacklink[mrulist[index]] = mrubacklink[index];
+  }
+  else {
+    stats.Hits++;
+    // make it the most recently used one
+    if ((entry.Flags & SPRCACHEFLAG_LISTED) && (mru.Newest != index)) {
+      unlinkSprite(index);
+      linkSprite(index);
     }
-
-    // set this as the newest element in the list
-    mrulist[index] = END_OF_LIST;
-    mrulist[listend] = index;
-    mrubacklink[index] = listend;
-    listend = index;
   }
-
-  return images[index];
+  return entries[index].Image;
 }
 
 // Remove the oldest cache element
 void SpriteCache::removeOldest()
 {
-
-  if (liststart < 0)
-    return;
-
-  int sprnum = liststart;
-
-  if ((images[sprnum] != NULL) && (offsets[sprnum] != SPRITE_LOCKED)) {
-    // Free the memory
-    if (flags[sprnum] & SPRCACHEFLAG_DOESNOTEXIST)
-    {
-      char msgg[150];
-      sprintf(msgg, "SpriteCache::removeOldest: Attempted to remove sprite %d that does not exist", sprnum);
-      quit(msgg);
-    }
-    cachesize -= sizes[sprnum];
-
-    delete images[sprnum];
-    images[sprnum] = NULL;
-  }
-
-  if (liststart == listend)
-  {
-    // there was one huge sprite, removing it has now emptied the cache completely
-    if (cachesize > 0)
-    {
-      Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Error, "SPRITE CACHE ERROR: Sprite cache should be empty, but still has %d bytes", cachesize);
-    }
-    mrulist[liststart] = 0;
-    liststart = -1;
-    listend = -1;
-  }
-  else
-  {
-    int oldstart = liststart;
-    liststart = mrulist[liststart];
-    mrulist[oldstart] = 0;
-    mrubacklink[liststart] = START_OF_LIST;
-    if (oldstart == liststart) {
-      // Somehow, we have got a recursive link to itself, so we
-      // the game will freeze (since it is not actually freeing any
-      // memory)
-      // There must be a bug somewhere causing this, but for now
-      // let's just reset the cache
-      Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Error, "RUNTIME CACHE ERROR: CACHE INCONSISTENT: RESETTING\n\tAt size %d (of %d), start %d end %d  fwdlink=%d",
-                    cachesize, maxCacheSize, oldstart, listend, liststart);
-      removeAll();
-    }
-  }
-
-#ifdef DEBUG_SPRITECACHE
-  Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Debug, "Removed %d, size now %d KB", sprnum, cachesize / 1024);
-#endif
+  if (mru.Oldest != END_OF_LIST)
+    freeSprite(mru.Oldest);
 }
 
 void SpriteCache::removeAll()
 {
-  int ii;
-
-  liststart = -1;
-  listend = -1;
-  for (ii = 0; ii < elements; ii++) {
-    if ((offsets[ii] != SPRITE_LOCKED) && (images[ii] != NULL) &&
-        ((flags[ii] & SPRCACHEFLAG_DOESNOTEXIST) == 0)) 
-    {
-      delete images[ii];
-      images[ii] = NULL;
-    }
-    mrulist[ii] = 0;
-    mrubacklink[ii] = 0;
-  }
-  cachesize = lockedSize;
+  // locked and pinned sprites stay
+  while (mru.Oldest != END_OF_LIST)
+    freeSprite(mru.Oldest);
 }
 
 void SpriteCache::precache(int index)
@@ -315,123 +250,270 @@ void SpriteCache::precache(int index)
 
   int sprSize = 0;
 
-  if (images[index] == NULL) {
+  if (entries[index].Image == NULL) {
     sprSize = loadSprite(index);
   }
-  else if (offsets[index] != SPRITE_LOCKED) {
-    sprSize = sizes[index];
+  else if ((entries[index].Flags & SPRCACHEFLAG_LOCKED) == 0) {
+    sprSize = entries[index].Size;
   }
 
   // make sure locked sprites can't fill the cache
   maxCacheSize += sprSize;
   lockedSize += sprSize;
 
-  offsets[index] = SPRITE_LOCKED;
+  lockSprite(index);
 
 #ifdef DEBUG_SPRITECACHE
   Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Debug, "Precached %d", index);
 #endif
 }
 
-void SpriteCache::seekToSprite(int index) {
-  if (index - 1 != lastLoad)
-      cache_stream->Seek(offsets[index], kSeekBegin);
+void SpriteCache::pinSprite(int index)
+{
+  if ((index < 0) || (index >= elements))
+    return;
+  entries[index].PinCount++;
+  unlinkSprite(index);
 }
 
-int SpriteCache::loadSprite(int index)
+void SpriteCache::unpinSprite(int index)
 {
-  int hh = 0;
+  if ((index < 0) || (index >= elements) || (entries[index].PinCount == 0))
+    return;
+  entries[index].PinCount--;
+  if (isRemovable(index) && ((entries[index].Flags & SPRCACHEFLAG_LISTED) == 0))
+    linkSprite(index);
+}
 
-  while (cachesize > maxCacheSize) {
-    removeOldest();
-    hh++;
-    if (hh > 1000) {
-      Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Error, "RUNTIME CACHE ERROR: STUCK IN FREE_UP_MEM; RESETTING CACHE");
-      removeAll();
-    }
+void SpriteCache::pinSprites(const std::vector<int> &sprites)
+{
+  for (size_t i = 0; i < sprites.size(); i++)
+    pinSprite(sprites[i]);
+}
+
+void SpriteCache::unpinSprites(const std::vector<int> &sprites)
+{
+  for (size_t i = 0; i < sprites.size(); i++)
+    unpinSprite(sprites[i]);
+}
+
+void SpriteCache::setCategory(int index, SpriteCategory category)
+{
+  if ((index < 0) || (index >= elements) || (entries[index].Category == category))
+    return;
+  SpriteCacheEntry &entry = entries[index];
+  bool listed = (entry.Flags & SPRCACHEFLAG_LISTED) != 0;
+  unlinkSprite(index);
+  catSize[entry.Category] -= entry.Size;
+  entry.Category = category;
+  catSize[entry.Category] += entry.Size;
+  if (listed)
+    linkSprite(index);
+}
+
+void SpriteCache::setCategoryBudget(SpriteCategory category, int32_t budget)
+{
+  catBudget[category] = budget;
+}
 
+bool SpriteCache::isLoaded(int index) const
+{
+  return (index >= 0) && (index < elements) && (entries[index].Image != NULL);
+}
+
+int32_t SpriteCache::getFileOffset(int index) const
+{
+  if ((index < 0) || (index >= elements) || (entries[index].Flags & SPRCACHEFLAG_DOESNOTEXIST))
+    return 0;
+  return entries[index].Offset;
+}
+
+void SpriteCache::freeUpMemory(int category, int32_t size)
+{
+  // keep the category within its own budget, if there's one
+  if (catBudget[category] > 0) {
+    while ((catSize[category] + size > catBudget[category]) && (catMru[category].Oldest != END_OF_LIST))
+      freeSprite(catMru[category].Oldest);
   }
+  while ((cachesize + size > maxCacheSize) && (mru.Oldest != END_OF_LIST))
+    freeSprite(mru.Oldest);
+}
+
+void SpriteCache::freeSprite(int index)
+{
+  SpriteCacheEntry &entry = entries[index];
+  unlinkSprite(index);
+  delete entry.Image;
+  entry.Image = NULL;
+  cachesize -= entry.Size;
+  catSize[entry.Category] -= entry.Size;
+  entry.Size = 0;
+
+#ifdef DEBUG_SPRITECACHE
+  Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Debug, "Removed %d, size now %d KB", index, cachesize / 1024);
+#endif
+}
+
+void SpriteCache::lockSprite(int index)
+{
+  unlinkSprite(index);
+  entries[index].Flags |= SPRCACHEFLAG_LOCKED;
+}
+
+bool SpriteCache::isRemovable(int index) const
+{
+  const SpriteCacheEntry &entry = entries[index];
+  return (entry.Image != NULL) && (entry.Offset > 0) && (entry.PinCount == 0) &&
+    ((entry.Flags & (SPRCACHEFLAG_DOESNOTEXIST | SPRCACHEFLAG_LOCKED)) == 0);
+}
+
+void SpriteCache::linkSprite(int index)
+{
+  SpriteCacheEntry &entry = entries[index];
+  listPushNewest(mru, index, &SpriteCacheEntry::Newer, &SpriteCacheEntry::Older);
+  listPushNewest(catMru[entry.Category], index, &SpriteCacheEntry::CatNewer, &SpriteCacheEntry::CatOlder);
+  entry.Flags |= SPRCACHEFLAG_LISTED;
+}
+
+void SpriteCache::unlinkSprite(int index)
+{
+  SpriteCacheEntry &entry = entries[index];
+  if ((entry.Flags & SPRCACHEFLAG_LISTED) == 0)
+    return;
+  listRemove(mru, index, &SpriteCacheEntry::Newer, &SpriteCacheEntry::Older);
+  listRemove(catMru[entry.Category], index, &SpriteCacheEntry::CatNewer, &SpriteCacheEntry::CatOlder);
+  entry.Flags &= ~SPRCACHEFLAG_LISTED;
+}
+
+void SpriteCache::listPushNewest(SpriteList &list, int index, ListLink newer, ListLink older)
+{
+  SpriteCacheEntry &entry = entries[index];
+  entry.*newer = END_OF_LIST;
+  entry.*older = list.Newest;
+  if (list.Newest != END_OF_LIST)
+    entries[list.Newest].*newer = index;
+  else
+    list.Oldest = index;
+  list.Newest = index;
+}
 
+void SpriteCache::listRemove(SpriteList &list, int index, ListLink newer, ListLink older)
+{
+  SpriteCacheEntry &entry = entries[index];
+  if (entry.*newer != END_OF_LIST)
+    entries[entry.*newer].*older = entry.*older;
+  else
+    list.Newest = entry.*older;
+  if (entry.*older != END_OF_LIST)
+    entries[entry.*older].*newer = entry.*newer;
+  else
+    list.Oldest = entry.*newer;
+  entry.*newer = END_OF_LIST;
+  entry.*older = END_OF_LIST;
+}
+
+void SpriteCache::seekToSprite(int index) {
+  if (index - 1 != lastLoad)
+      cache_stream->Seek(entries[index].Offset, kSeekBegin);
+}
+
+int SpriteCache::loadSprite(int index)
+{
   if ((index < 0) || (index >= elements))
     quit("sprite cache array index out of bounds");
 
   // If we didn't just load the previous sprite, seek to it
   seekToSprite(index);
-
-  int coldep = cache_stream->ReadInt16();
-
-  if (coldep == 0) {
-    lastLoad = index;
+  bool corrupt;
+  Bitmap *image = readSprite(cache_stream, spritesAreCompressed, corrupt);
+  if (corrupt)
+    Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Error, "Sprite %d: compressed data is corrupt", index);
+  // if failed, the stream position is not known for certain now
+  lastLoad = image ? index : -2;
+
+  if (image == NULL) {
+    entries[index].Offset = 0;
     return 0;
   }
+  return installSprite(index, image);
+}
 
-  int wdd = cache_stream->ReadInt16();
-  int htt = cache_stream->ReadInt16();
-  // update the stored width/height
-  spritewidth[index] = wdd;
-  spriteheight[index] = htt;
+Bitmap *SpriteCache::readSprite(Stream *in, bool compressed, bool &corrupt)
+{
+  corrupt = false;
+  int coldep = in->ReadInt16();
+  if (coldep == 0)
+    return NULL;
 
-  images[index] = BitmapHelper::CreateBitmap(wdd, htt, coldep * 8);
-  if (images[index] == NULL) {
-    offsets[index] = 0;
-    return 0;
-  }
+  int wdd = in->ReadInt16();
+  int htt = in->ReadInt16();
+  Bitmap *image = BitmapHelper::CreateBitmap(wdd, htt, coldep * 8);
+  if (image == NULL)
+    return NULL;
 
-  if (this->spritesAreCompressed) 
+  if (compressed)
   {
-    cache_stream->ReadInt32(); // skip data size
-    if (coldep == 1) {
-      for (hh = 0; hh < htt; hh++)
-        cunpackbitl(&images[index]->GetScanLineForWriting(hh)[0], wdd, cache_stream);
-    }
-    else if (coldep == 2) {
-      for (hh = 0; hh < htt; hh++)
-        cunpackbitl16((unsigned short*)&images[index]->GetScanLine(hh)[0], wdd, cache_stream);
-    }
-    else {
-      for (hh = 0; hh < htt; hh++)
-        cunpackbitl32((unsigned int*)&images[index]->GetScanLine(hh)[0], wdd, cache_stream);
+    // read all the compressed data at once, and decode it in memory
+    int data_size = in->ReadInt32();
+    if (data_size > 0)
+    {
+      std::vector<unsigned char> data(data_size);
+      data_size = in->Read(&data.front(), data_size);
+      corrupt = cunpackbitmap(image, &data.front(), data_size) < 0;
     }
   }
   else {
+    int hh;
     if (coldep == 1)
     {
       for (hh = 0; hh < htt; hh++)
-        cache_stream->ReadArray(&images[index]->GetScanLineForWriting(hh)[0], coldep, wdd);
+        in->ReadArray(&image->GetScanLineForWriting(hh)[0], coldep, wdd);
     }
     else if (coldep == 2)
     {
       for (hh = 0; hh < htt; hh++)
-        cache_stream->ReadArrayOfInt16((int16_t*)&images[index]->GetScanLineForWriting(hh)[0], wdd);
+        in->ReadArrayOfInt16((int16_t*)&image->GetScanLineForWriting(hh)[0], wdd);
     }
     else
     {
       for (hh = 0; hh < htt; hh++)
-        cache_stream->ReadArrayOfInt32((int32_t*)&images[index]->GetScanLineForWriting(hh)[0], wdd);
+        in->ReadArrayOfInt32((int32_t*)&image->GetScanLineForWriting(hh)[0], wdd);
     }
   }
+  return image;
+}
 
-  lastLoad = index;
+int SpriteCache::installSprite(int index, Bitmap *image)
+{
+  int coldep = image->GetColorDepth() / 8;
+  freeUpMemory(entries[index].Category, image->GetWidth() * image->GetHeight() * coldep);
 
-  // Stop it adding the sprite to the used list just because it's loaded
-  int32_t offs = offsets[index];
-  offsets[index] = SPRITE_LOCKED;
+  SpriteCacheEntry &entry = entries[index];
+  entry.Image = image;
+  // update the stored width/height
+  spritewidth[index] = image->GetWidth();
+  spriteheight[index] = image->GetHeight();
 
+  // the sprite is not put to the used list until it's initialized, because
+  // the engine may replace the image while doing that
   initialize_sprite(index);
 
-  if (index != 0)  // leave sprite 0 locked
-    offsets[index] = offs;
+  if (index == 0)  // leave sprite 0 locked
+    entry.Flags |= SPRCACHEFLAG_LOCKED;
 
   // we need to store this because the main program might
   // alter spritewidth/height if it resizes stuff
-  sizes[index] = spritewidth[index] * spriteheight[index] * coldep;
-  cachesize += sizes[index];
+  entry.Size = spritewidth[index] * spriteheight[index] * coldep;
+  cachesize += entry.Size;
+  catSize[entry.Category] += entry.Size;
+  if (isRemovable(index))
+    linkSprite(index);
 
 #ifdef DEBUG_SPRITECACHE
   Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Debug, "Loaded %d, size now %d KB", index, cachesize / 1024);
 #endif
 
-  return sizes[index];
+  return entry.Size;
 }
 
 const char *spriteFileSig = " Sprite File ";
@@ -485,7 +567,7 @@ int SpriteCache::saveToFile(const char *filnam, int lastElement, bool compressOu
 
   for (i = 1; i < lastElement; i++) {
     // slot empty
-    if ((images[i] != NULL) || ((offsets[i] != 0) && (offsets[i] != sprite0InitialOffset)))
+    if ((entries[i].Image != NULL) || ((entries[i].Offset != 0) && (entries[i].Offset != sprite0InitialOffset)))
       lastslot = i;
   }
 
@@ -505,15 +587,15 @@ int SpriteCache::saveToFile(const char *filnam, int lastElement, bool compressOu
     spriteoffs[i] = output->GetPosition();
 
     // if compressing uncompressed sprites, load the sprite into memory
-    if ((images[i] == NULL) && (this->spritesAreCompressed != compressOutput))
+    if ((entries[i].Image == NULL) && (this->spritesAreCompressed != compressOutput))
       (*this)[i];
 
-    if (images[i] != NULL) {
+    if (entries[i].Image != NULL) {
       // image in memory -- write it out
       pre_save_sprite(i);
-      int bpss = images[i]->GetColorDepth() / 8;
-      spritewidths[i] = images[i]->GetWidth();
-      spriteheights[i] = images[i]->GetHeight();
+      int bpss = entries[i].Image->GetColorDepth() / 8;
+      spritewidths[i] = entries[i].Image->GetWidth();
+      spriteheights[i] = entries[i].Image->GetHeight();
       output->WriteInt16(bpss);
       output->WriteInt16(spritewidths[i]);
       output->WriteInt16(spriteheights[i]);
@@ -523,7 +605,7 @@ int SpriteCache::saveToFile(const char *filnam, int lastElement, bool compressOu
         // write some space for the length data
         output->WriteInt32(0);
 
-        compressSprite(images[i], output);
+        compressSprite(entries[i].Image, output);
 
         size_t fileSizeSoFar = output->GetPosition();
         // write the length of the compressed data
@@ -532,12 +614,12 @@ int SpriteCache::saveToFile(const char *filnam, int lastElement, bool compressOu
         output->Seek(0, kSeekEnd);
       }
       else
-        output->WriteArray(images[i]->GetDataForWriting(), spritewidths[i] * bpss, spriteheights[i]);
+        output->WriteArray(entries[i].Image->GetDataForWriting(), spritewidths[i] * bpss, spriteheights[i]);
 
       continue;
     }
 
-    if ((offsets[i] == 0) || ((offsets[i] == sprite0InitialOffset) && (i > 0))) {
+    if ((entries[i].Offset == 0) || ((entries[i].Offset == sprite0InitialOffset) && (i > 0))) {
       // sprite doesn't exist
       output->WriteInt16(0);
       spritewidths[i] = 0;
@@ -630,8 +712,8 @@ int SpriteCache::initFile(const char *filnam)
   int spriteFileID = 0;
 
   for (vv = 0; vv < elements; vv++) {
-    images[vv] = NULL;
-    offsets[vv] = 0;
+    entries[vv].Image = NULL;
+    entries[vv].Offset = 0;
   }
 
   cache_stream = Common::AssetManager::OpenAsset((char *)filnam);
@@ -694,14 +776,14 @@ int SpriteCache::initFile(const char *filnam)
 
   for (vv = 0; vv <= numspri; vv++) {
 
-    offsets[vv] = cache_stream->GetPosition();
-    flags[vv] = 0;
+    entries[vv].Offset = cache_stream->GetPosition();
+    entries[vv].Flags = 0;
 
     int coldep = cache_stream->ReadInt16();
 
     if (coldep == 0) {
-      offsets[vv] = 0;
-      images[vv] = NULL;
+      entries[vv].Offset = 0;
+      entries[vv].Image = NULL;
 
       initFile_initNullSpriteParams(vv);
 
@@ -717,7 +799,7 @@ int SpriteCache::initFile(const char *filnam)
     if (vv >= elements)
       break;
 
-    images[vv] = NULL;
+    entries[vv].Image = NULL;
 
     wdd = cache_stream->ReadInt16();
     htt = cache_stream->ReadInt16();
@@ -742,7 +824,7 @@ int SpriteCache::initFile(const char *filnam)
     cache_stream->Seek(spriteDataSize);
   }
 
-  sprite0InitialOffset = offsets[0];
+  sprite0InitialOffset = entries[0].Offset;
   return 0;
 }
 
@@ -797,12 +879,14 @@ bool SpriteCache::loadSpriteIndexFile(int expectedFileID, int32_t spr_initial_of
 
   fidx->ReadArrayOfInt16(&rspritewidths[0], numsprits);
   fidx->ReadArrayOfInt16(&rspriteheights[0], numsprits);
-  fidx->ReadArrayOfInt32(&offsets[0], numsprits);
+  std::vector<int32_t> roffsets(numsprits);
+  fidx->ReadArrayOfInt32(&roffsets[0], numsprits);
 
   for (vv = 0; vv <= numspri; vv++) {
-    flags[vv] = 0;
-    if (offsets[vv] != 0) {
-      offsets[vv] += spr_initial_offs;
+    entries[vv].Flags = 0;
+    entries[vv].Offset = roffsets[vv];
+    if (entries[vv].Offset != 0) {
+      entries[vv].Offset += spr_initial_offs;
       get_new_size_for_sprite(vv, rspritewidths[vv], rspriteheights[vv], spritewidth[vv], spriteheight[vv]);
     }
     else if (vv > 0) {
@@ -810,7 +894,7 @@ bool SpriteCache::loadSpriteIndexFile(int expectedFileID, int32_t spr_initial_of
     }
   }
 
-  sprite0InitialOffset = offsets[0];
+  sprite0InitialOffset = entries[0].Offset;
   free(rspritewidths);
   free(rspriteheights);
 
@@ -831,3 +915,7 @@ int SpriteCache::attachFile(const char *filename) {
   return 0;
 }
 
+void SpriteCache::setPrefetcher(SpritePrefetcher *pf) {
+  prefetcher = pf;
+}
+
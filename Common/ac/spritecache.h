@@ -19,15 +19,20 @@
 #ifndef __SPRCACHE_H
 #define __SPRCACHE_H
 
+#include <vector>
 #include "core/types.h"
 
 namespace AGS { namespace Common { class Stream; class Bitmap; } }
 using namespace AGS; // FIXME later
 
-// We can't rely on offsets[slot]==0 because when the engine is running
+// We can't rely on the entry's Offset==0 because when the engine is running
 // this is changed to reference the Bluecup sprite. Therefore we need
 // a definite way of knowing whether the sprite existed in the sprite file.
 #define SPRCACHEFLAG_DOESNOTEXIST 1
+// Sprite is locked in memory and is never removed by the cache
+#define SPRCACHEFLAG_LOCKED       2
+// Sprite is in the lists of the removable sprites
+#define SPRCACHEFLAG_LISTED       4
 
 // Max size of the sprite cache, in bytes
 #if defined (PSP_VERSION)
@@ -39,6 +44,53 @@ using namespace AGS; // FIXME later
 #define DEFAULTCACHESIZE 128 * 1024 * 1024
 #endif
 
+// Source of sprite images loaded ahead of time, e.g. on a background thread
+class SpritePrefetcher
+{
+public:
+  virtual ~SpritePrefetcher() {}
+  // Hands over the prefetched image of the given sprite, or returns NULL
+  // if that sprite is not ready
+  virtual Common::Bitmap *TakeSprite(int index) = 0;
+};
+
+// Counters of the sprite requests from the file
+struct SpriteCacheStats
+{
+  int32_t Hits;         // sprite was already in memory
+  int32_t PrefetchHits; // sprite was taken from the prefetcher
+  int32_t Misses;       // sprite had to be loaded from the file right away
+
+  SpriteCacheStats() : Hits(0), PrefetchHits(0), Misses(0) {}
+};
+
+// Groups of sprites, which may be given their own share of the cache
+enum SpriteCategory
+{
+  kSprCat_General,
+  kSprCat_Room,         // room objects
+  kSprCat_Character,    // character views
+  kSprCat_GUI,          // GUI backgrounds and controls
+  kNumSpriteCategories
+};
+
+// Sprite table entry
+struct SpriteCacheEntry
+{
+  int32_t Offset;         // position in the sprite file, 0 if not from file
+  Common::Bitmap *Image;
+  int32_t Size;           // size in bytes of the loaded image
+  // Links in the list of all removable sprites, and in the list of
+  // the sprite's category; lists go from the newest to the oldest used
+  int32_t Newer, Older;
+  int32_t CatNewer, CatOlder;
+  uint16_t PinCount;
+  uint8_t Flags;
+  uint8_t Category;
+
+  SpriteCacheEntry();
+};
+
 class SpriteCache
 {
 public:
@@ -48,6 +100,16 @@ public:
   int  loadSprite(int);
   void seekToSprite(int index);
   void precache(int);           // preloads and locks in memory
+  // Pinned sprites are not removed from the cache while they have pins;
+  // each pinSprite call must be matched with unpinSprite
+  void pinSprite(int index);
+  void unpinSprite(int index);
+  void pinSprites(const std::vector<int> &sprites);
+  void unpinSprites(const std::vector<int> &sprites);
+  void setCategory(int index, SpriteCategory category);
+  // Sets the max size of the category's sprites in cache, in bytes;
+  // 0 means no limit other than the total cache size
+  void setCategoryBudget(SpriteCategory category, int32_t budget);
   void set(int, Common::Bitmap *);
   void setNonDiscardable(int, Common::Bitmap *);
   void removeSprite(int, bool);
@@ -62,25 +124,60 @@ public:
   int  doesSpriteExist(int index);
   void detachFile();
   int  attachFile(const char *);
+  void setPrefetcher(SpritePrefetcher *);
+  // Tells if the sprite image is in memory
+  bool isLoaded(int index) const;
+  // Returns sprite's position in the sprite file, or 0 if it's not there
+  int32_t getFileOffset(int index) const;
+
+  // Reads sprite image at the current stream position; returns NULL if
+  // there's no image or it could not be created; tells whether the
+  // compressed data was corrupt. Does not access the cache nor write to
+  // the log, so may be used on any thread with a separate stream.
+  static Common::Bitmap *readSprite(Common::Stream *in, bool compressed, bool &corrupt);
 
   Common::Bitmap *operator[] (int index);
 
-  int32_t *offsets;
   int32_t sprite0InitialOffset;
-  int32_t elements;                // size of offsets/images arrays
-  Common::Bitmap **images;
-  int *sizes;
-  unsigned char *flags;
+  int32_t elements;                // size of the sprite table
   Common::Stream *cache_stream;
   bool spritesAreCompressed;
   int32_t cachesize;               // size in bytes of currently cached images
-  int *mrulist, *mrubacklink;
-  int liststart, listend;
   int lastLoad;
   int32_t maxCacheSize;
   int32_t lockedSize;              // size in bytes of currently locked images
+  SpriteCacheStats stats;
 
 private:
+  // Ends of the list of removable sprites
+  struct SpriteList
+  {
+    int32_t Newest, Oldest;
+    SpriteList() : Newest(-1), Oldest(-1) {}
+  };
+
+  std::vector<SpriteCacheEntry> entries;
+  SpriteList mru;
+  SpriteList catMru[kNumSpriteCategories];
+  int32_t catSize[kNumSpriteCategories];
+  int32_t catBudget[kNumSpriteCategories];
+
+  SpritePrefetcher *prefetcher;
+
+  // Puts the loaded image into the cache, freeing older sprites if necessary
+  int  installSprite(int index, Common::Bitmap *image);
+  // Frees memory for the new sprite of the given category and size
+  void freeUpMemory(int category, int32_t size);
+  // Removes sprite image from memory
+  void freeSprite(int index);
+  void lockSprite(int index);
+  // Tells if sprite may be put in the lists of removable sprites
+  bool isRemovable(int index) const;
+  void linkSprite(int index);
+  void unlinkSprite(int index);
+  typedef int32_t SpriteCacheEntry::*ListLink;
+  void listPushNewest(SpriteList &list, int index, ListLink newer, ListLink older);
+  void listRemove(SpriteList &list, int index, ListLink newer, ListLink older);
     void compressSprite(Common::Bitmap *sprite, Common::Stream *out);
   bool loadSpriteIndexFile(int expectedFileID, int32_t spr_initial_offs, short numspri);
 
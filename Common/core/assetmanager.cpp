@@ -303,6 +303,7 @@ AssetError AssetManager::RegisterAssetLib(const String &data_file, const String
     if (mfl_err != MFLUtil::kMFLNoError)
     {
         _assetLib.Unload();
+        BuildAssetIndex();
         return kAssetErrLibParse;
     }
 
@@ -326,17 +327,35 @@ AssetError AssetManager::RegisterAssetLib(const String &data_file, const String
     // make a backup of the original file name
     _assetLib.BaseFileName = _assetLib.LibFileNames[0];
     _assetLib.BaseFileName.MakeLower();
+    BuildAssetIndex();
     return kAssetNoError;
 }
 
-AssetInfo *AssetManager::FindAssetByFileName(const String &asset_name)
+void AssetManager::BuildAssetIndex()
 {
+    _assetLookup.clear();
     for (size_t i = 0; i < _assetLib.AssetInfos.size(); ++i)
     {
-        if (_assetLib.AssetInfos[i].FileName.CompareNoCase(asset_name) == 0)
-        {
-            return &_assetLib.AssetInfos[i];
-        }
+        // if the name is repeated, the first asset wins, same as with the plain search
+        _assetLookup.insert(std::make_pair(_assetLib.AssetInfos[i].FileName, i));
+    }
+
+    // library parts do not move while the game runs, so find them once;
+    // those that are missing now are looked for again when requested
+    _libFilePaths.resize(_assetLib.LibFileNames.size());
+    for (size_t i = 0; i < _assetLib.LibFileNames.size(); ++i)
+    {
+        _libFilePaths[i] = free_char_to_string(ci_find_file(NULL,
+            String::FromFormat("%s/%s", _basePath.GetCStr(), _assetLib.LibFileNames[i].GetCStr())));
+    }
+}
+
+AssetInfo *AssetManager::FindAssetByFileName(const String &asset_name)
+{
+    AssetLookup::const_iterator it = _assetLookup.find(asset_name);
+    if (it != _assetLookup.end())
+    {
+        return &_assetLib.AssetInfos[it->second];
     }
     return NULL;
 }
@@ -347,6 +366,16 @@ String AssetManager::MakeLibraryFileNameForAsset(const AssetInfo *asset)
     return String::FromFormat("%s/%s",_basePath.GetCStr(), _assetLib.LibFileNames[asset->LibUid].GetCStr());
 }
 
+String AssetManager::FindLibraryFileForAsset(const AssetInfo *asset)
+{
+    if (asset->LibUid >= 0 && (size_t)asset->LibUid < _libFilePaths.size() &&
+        !_libFilePaths[asset->LibUid].IsEmpty())
+    {
+        return _libFilePaths[asset->LibUid];
+    }
+    return free_char_to_string( ci_find_file(NULL, MakeLibraryFileNameForAsset(asset)) );
+}
+
 bool AssetManager::GetAssetFromLib(const String &asset_name, AssetLocation &loc, FileOpenMode open_mode, FileWorkMode work_mode)
 {
     if (open_mode != Common::kFile_Open || work_mode != Common::kFile_Read)
@@ -356,7 +385,7 @@ bool AssetManager::GetAssetFromLib(const String &asset_name, AssetLocation &loc,
     if (!asset)
         return NULL; // asset not found
 
-    String libfile = free_char_to_string( ci_find_file(NULL, MakeLibraryFileNameForAsset(asset)) );
+    String libfile = FindLibraryFileForAsset(asset);
     if (libfile.IsEmpty())
         return false;
     loc.FileName = libfile;
@@ -37,6 +37,7 @@
 #define __AGS_CN_CORE__ASSETMANAGER_H
 
 #include "util/file.h"
+#include "util/string_types.h"
 
 namespace AGS
 {
@@ -132,8 +133,12 @@ private:
 
     bool        _DoesAssetExist(const String &asset_name);
 
+    // Fills the asset lookup table and resolves library part paths
+    void        BuildAssetIndex();
     AssetInfo   *FindAssetByFileName(const String &asset_name);
     String      MakeLibraryFileNameForAsset(const AssetInfo *asset);
+    // Returns actual path to the library part containing the asset
+    String      FindLibraryFileForAsset(const AssetInfo *asset);
 
     bool        GetAssetFromLib(const String &asset_name, AssetLocation &loc, Common::FileOpenMode open_mode, Common::FileWorkMode work_mode);
     bool        GetAssetFromDir(const String &asset_name, AssetLocation &loc, Common::FileOpenMode open_mode, Common::FileWorkMode work_mode);
@@ -146,6 +151,10 @@ private:
     AssetLibInfo            &_assetLib;
     String                  _basePath;          // library's parent path (directory)
     long                    _lastAssetSize;     // size of asset that was opened last time
+    // Asset name to index in the library TOC, case-insensitive
+    typedef stdtr1compat::unordered_map<String, size_t, HashStrNoCase, StrCmpNoCase> AssetLookup;
+    AssetLookup             _assetLookup;
+    StringV                 _libFilePaths;      // found paths to library parts, per LibUid
 };
 
 } // namespace Common
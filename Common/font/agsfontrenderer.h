@@ -45,6 +45,9 @@ class IAGSFontRenderer2
 public:
   // Load font, applying extended font rendering parameters
   virtual bool LoadFromDiskEx(int fontNumber, int fontSize, const FontRenderParams *params) = 0;
+  // Tells if the character always adds its own width to the width of text,
+  // regardless of the characters around it
+  virtual bool IsCharWidthAdditive(int fontNumber, unsigned char ch) = 0;
 };
 
 #endif // __AC_AGSFONTRENDERER_H
@@ -17,6 +17,7 @@
 #endif
 
 #include <stdio.h>
+#include <vector>
 #include "alfont.h"
 
 #include "ac/common.h"
@@ -32,6 +33,8 @@ using namespace AGS::Common;
 
 int wtext_multiply = 1;
 
+extern bool ShouldAntiAliasText();
+
 namespace AGS
 {
 namespace Common
@@ -42,6 +45,9 @@ struct Font
     IAGSFontRenderer   *Renderer;
     IAGSFontRenderer2  *Renderer2;
     FontInfo            Info;
+    // Cached character widths, and the text multiplier they were made with
+    std::vector<int>    CharWidths;
+    int                 CharWidthsMultiply;
 
     Font();
 };
@@ -49,6 +55,7 @@ struct Font
 Font::Font()
     : Renderer(NULL)
     , Renderer2(NULL)
+    , CharWidthsMultiply(0)
 {}
 
 } // Common
@@ -98,6 +105,7 @@ IAGSFontRenderer* font_replace_renderer(int fontNumber, IAGSFontRenderer* render
   IAGSFontRenderer* oldRender = fonts[fontNumber].Renderer;
   fonts[fontNumber].Renderer = renderer;
   fonts[fontNumber].Renderer2 = NULL;
+  fonts[fontNumber].CharWidths.clear();
   return oldRender;
 }
 
@@ -106,6 +114,15 @@ bool font_supports_extended_characters(int fontNumber)
   return fonts[fontNumber].Renderer->SupportsExtendedCharacters(fontNumber);
 }
 
+bool font_renders_solid_pixels(int fontNumber, int color_depth)
+{
+  // plugin renderers may draw text in any way
+  if (fonts[fontNumber].Renderer == NULL || fonts[fontNumber].Renderer2 == NULL)
+    return false;
+  // anti-aliased text is blended with the background
+  return fonts[fontNumber].Renderer != &ttfRenderer || !ShouldAntiAliasText() || color_depth <= 8;
+}
+
 void ensure_text_valid_for_font(char *text, int fontnum)
 {
   fonts[fontnum].Renderer->EnsureTextValidForFont(text, fontnum);
@@ -116,6 +133,27 @@ int wgettextwidth(const char *texx, int fontNumber)
   return fonts[fontNumber].Renderer->GetTextWidth(texx, fontNumber);
 }
 
+const int *get_font_char_widths(int fontNumber)
+{
+  Font &font = fonts[fontNumber];
+  if (font.Renderer == NULL || font.Renderer2 == NULL)
+    return NULL;
+  if (font.CharWidths.empty() || font.CharWidthsMultiply != wtext_multiply)
+  {
+    font.CharWidths.resize(256);
+    font.CharWidths[0] = 0;
+    char text[2] = { 0, 0 };
+    for (int ch = 1; ch < 256; ++ch)
+    {
+      text[0] = (char)ch;
+      font.CharWidths[ch] = font.Renderer2->IsCharWidthAdditive(fontNumber, (unsigned char)ch) ?
+        font.Renderer->GetTextWidth(text, fontNumber) : -1;
+    }
+    font.CharWidthsMultiply = wtext_multiply;
+  }
+  return &font.CharWidths.front();
+}
+
 int wgettextheight(const char *text, int fontNumber)
 {
   return fonts[fontNumber].Renderer->GetTextHeight(text, fontNumber);
@@ -126,6 +164,11 @@ int get_font_outline(int font_number)
     return fonts[font_number].Info.Outline;
 }
 
+int get_font_yoffset(int font_number)
+{
+    return fonts[font_number].Info.YOffset;
+}
+
 void set_font_outline(int font_number, int outline_type)
 {
     fonts[font_number].Info.Outline = FONT_OUTLINE_AUTO;
@@ -169,6 +212,7 @@ void wouttextxy(Common::Bitmap *ds, int xxx, int yyy, int fontNumber, color_t te
 // Loads a font from disk
 bool wloadfont_size(int fontNumber, const FontInfo &font_info, const FontRenderParams *params)
 {
+  fonts[fontNumber].CharWidths.clear();
   if (ttfRenderer.LoadFromDiskEx(fontNumber, font_info.SizePt, params))
   {
     fonts[fontNumber].Renderer  = &ttfRenderer;
@@ -205,4 +249,6 @@ void wfreefont(int fontNumber)
     fonts[fontNumber].Renderer->FreeMemory(fontNumber);
 
   fonts[fontNumber].Renderer = NULL;
+  fonts[fontNumber].Renderer2 = NULL;
+  fonts[fontNumber].CharWidths.clear();
 }
@@ -56,6 +56,9 @@ void adjust_y_coordinate_for_text(int* ypos, int fontnum);
 IAGSFontRenderer* font_replace_renderer(int fontNumber, IAGSFontRenderer* renderer);
 bool font_first_renderer_loaded();
 bool font_supports_extended_characters(int fontNumber);
+// Tells if the font is known to draw text with plain pixels of the text
+// color, which do not depend on what was under them
+bool font_renders_solid_pixels(int fontNumber, int color_depth);
 // TODO: with changes to WFN font renderer that implemented safe rendering of
 // strings containing invalid chars (since 3.3.1) this function is not
 // important, except for (maybe) few particular cases.
@@ -64,6 +67,11 @@ bool font_supports_extended_characters(int fontNumber);
 // Need to check whether it is safe to completely remove it.
 void ensure_text_valid_for_font(char *text, int fontnum);
 int wgettextwidth(const char *texx, int fontNumber);
+// Gets the font's character widths indexed by character code, or NULL if the
+// font does not tell how it measures text; characters which have negative
+// width here may change their width depending on the neighbouring characters.
+// Width of any text made of the rest of characters equals to their sum.
+const int *get_font_char_widths(int fontNumber);
 // Calculates actual height of a line of text
 int wgettextheight(const char *text, int fontNumber);
 // Get font's height (maximal height of any line of text printed with this font)
@@ -73,6 +81,8 @@ int getfontlinespacing(int fontNumber);
 // Get is font is meant to use default line spacing
 bool use_default_linespacing(int fontNumber);
 int  get_font_outline(int font_number);
+// Get font's custom vertical render offset
+int  get_font_yoffset(int font_number);
 void set_font_outline(int font_number, int outline_type);
 // Outputs a single line of text on the defined position on bitmap, using defined font, color and parameters
 int getfontlinespacing(int fontNumber);
@@ -36,6 +36,8 @@ public:
 
   // IAGSFontRenderer2 implementation
   virtual bool LoadFromDiskEx(int fontNumber, int fontSize, const FontRenderParams *params);
+  // alfont does not apply kerning, but may decode non-ASCII text as multibyte
+  virtual bool IsCharWidthAdditive(int fontNumber, unsigned char ch) { return ch < 0x80; }
 
 private:
     struct FontData
@@ -32,6 +32,7 @@ public:
   virtual void EnsureTextValidForFont(char *text, int fontNumber);
 
   virtual bool LoadFromDiskEx(int fontNumber, int fontSize, const FontRenderParams *params);
+  virtual bool IsCharWidthAdditive(int fontNumber, unsigned char ch) { return true; }
 
 private:
   struct FontData
@@ -262,13 +262,25 @@ void Interaction::Reset()
 }
 
 Interaction *Interaction::CreateFromStream(Stream *in)
+{
+    String error;
+    Interaction *inter = CreateFromStream(in, error);
+    if (!error.IsEmpty())
+        quit(error);
+    return inter;
+}
+
+Interaction *Interaction::CreateFromStream(Stream *in, String &error)
 {
     if (in->ReadInt32() != kInteractionVersion_Initial)
         return NULL; // unsupported format
 
     const size_t evt_count = in->ReadInt32();
     if (evt_count > MAX_NEWINTERACTION_EVENTS)
-        quit("Can't deserialize interaction: too many events");
+    {
+        error = "Can't deserialize interaction: too many events";
+        return NULL;
+    }
 
     int types[MAX_NEWINTERACTION_EVENTS];
     int load_response[MAX_NEWINTERACTION_EVENTS];
@@ -406,11 +418,20 @@ void InteractionVariable::Write(Common::Stream *out) const
 //-----------------------------------------------------------------------------
 
 InteractionScripts *InteractionScripts::CreateFromStream(Stream *in)
+{
+    String error;
+    InteractionScripts *scripts = CreateFromStream(in, error);
+    if (!error.IsEmpty())
+        quit(error);
+    return scripts;
+}
+
+InteractionScripts *InteractionScripts::CreateFromStream(Stream *in, String &error)
 {
     const size_t evt_count = in->ReadInt32();
     if (evt_count > MAX_NEWINTERACTION_EVENTS)
     {
-        quit("Can't deserialize interaction scripts: too many events");
+        error = "Can't deserialize interaction scripts: too many events";
         return NULL;
     }
 
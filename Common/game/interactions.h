@@ -159,6 +159,9 @@ struct Interaction
 
     // Game static data (de)serialization
     static Interaction *CreateFromStream(Stream *in);
+    // Same as above, but returns NULL and sets the error instead of quitting
+    // the program if the data can't be read
+    static Interaction *CreateFromStream(Stream *in, String &error);
     void                Write(Stream *out) const;
 
     // Reading and writing runtime data from/to savedgame;
@@ -194,6 +197,9 @@ struct InteractionScripts
     StringV ScriptFuncNames;
 
     static InteractionScripts *CreateFromStream(Stream *in);
+    // Same as above, but returns NULL and sets the error instead of quitting
+    // the program if the data can't be read
+    static InteractionScripts *CreateFromStream(Stream *in, String &error);
 };
 
 } // namespace Common
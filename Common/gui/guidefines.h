@@ -147,6 +147,7 @@ enum GUITextBoxFlags
 } // namespace Common
 } // namespace AGS
 
+// Requests redraw of all guis; changes to single gui should use GUIMain::MarkChanged
 extern int guis_need_update;
 
 #endif // __AC_GUIDEFINES_H
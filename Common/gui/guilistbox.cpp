@@ -65,7 +65,7 @@ bool GUIListBox::IsInRightMargin(int x) const
 
 int GUIListBox::AddItem(const String &text)
 {
-    guis_need_update = 1;
+    NotifyParentChanged();
     Items.push_back(text);
     SavedGameIndex.push_back(-1);
     ItemCount++;
@@ -79,7 +79,7 @@ void GUIListBox::Clear()
     ItemCount = 0;
     SelectedItem = 0;
     TopItem = 0;
-    guis_need_update = 1;
+    NotifyParentChanged();
 }
 
 void GUIListBox::Draw(Common::Bitmap *ds)
@@ -172,7 +172,7 @@ int GUIListBox::InsertItem(int index, const String &text)
         SelectedItem++;
 
     ItemCount++;
-    guis_need_update = 1;
+    NotifyParentChanged();
     return ItemCount - 1;
 }
 
@@ -189,7 +189,7 @@ void GUIListBox::RemoveItem(int index)
         SelectedItem--;
     if (SelectedItem >= ItemCount)
         SelectedItem = -1;
-    guis_need_update = 1;
+    NotifyParentChanged();
 }
 
 void GUIListBox::SetFont(int Font)
@@ -203,7 +203,7 @@ void GUIListBox::SetItemText(int index, const String &text)
 {
     if (index >= 0 && index < ItemCount)
     {
-        guis_need_update = 1;
+        NotifyParentChanged();
         Items[index] = text;
     }
 }
@@ -76,6 +76,7 @@ void GUIMain::Init()
     ZOrder        = -1;
 
     _visibility   = kGUIVisibility_On;
+    _hasChanged   = true;
     FocusCtrl     = 0;
     HighlightCtrl = -1;
     MouseOverCtrl = -1;
@@ -249,6 +250,16 @@ void GUIMain::DrawBlob(Bitmap *ds, int x, int y, color_t draw_color)
     ds->FillRect(Rect(x, y, x + get_fixed_pixel_size(1), y + get_fixed_pixel_size(1)), draw_color);
 }
 
+void GUIMain::MarkChanged()
+{
+    _hasChanged = true;
+}
+
+void GUIMain::ClearChanged()
+{
+    _hasChanged = false;
+}
+
 void GUIMain::Poll()
 {
     int mxwas = mousex, mywas = mousey;
@@ -282,7 +293,7 @@ void GUIMain::Poll()
                     Controls[MouseOverCtrl]->OnMouseMove(mousex, mousey);
                 }
             }
-            guis_need_update = 1;
+            MarkChanged();
         } 
         else if (MouseOverCtrl >= 0)
             Controls[MouseOverCtrl]->OnMouseMove(mousex, mousey);
@@ -412,7 +423,7 @@ void GUIMain::OnMouseButtonDown()
     if (Controls[MouseOverCtrl]->OnMouseDown())
         MouseOverCtrl = MOVER_MOUSEDOWNLOCKED;
     Controls[MouseDownCtrl]->OnMouseMove(mousex - X, mousey - Y);
-    guis_need_update = 1;
+    MarkChanged();
 }
 
 void GUIMain::OnMouseButtonUp()
@@ -430,7 +441,7 @@ void GUIMain::OnMouseButtonUp()
 
     Controls[MouseDownCtrl]->OnMouseUp();
     MouseDownCtrl = -1;
-    guis_need_update = 1;
+    MarkChanged();
 }
 
 void GUIMain::ReadFromFile(Stream *in, GuiVersion gui_version)
@@ -83,6 +83,12 @@ public:
     bool    BringControlToFront(int index);
     void    Draw(Bitmap *ds);
     void    DrawAt(Bitmap *ds, int x, int y);
+    // Marks gui as requiring its image to be redrawn
+    void    MarkChanged();
+    // Tells if gui was changed since its image was last redrawn
+    inline bool HasChanged() const { return _hasChanged; }
+    // Resets changed state after the gui image was redrawn
+    void    ClearChanged();
     void    Poll();
     void    RebuildArray();
     void    ResortZOrder();
@@ -142,6 +148,7 @@ public:
 
 private:
     GUIVisibilityState _visibility;
+    bool               _hasChanged; // gui image must be redrawn
 };
 
 
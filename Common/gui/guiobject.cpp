@@ -80,6 +80,12 @@ void GUIObject::Hide()
     Flags |= kGUICtrl_Invisible;
 }
 
+void GUIObject::NotifyParentChanged()
+{
+    if (ParentId >= 0 && (size_t)ParentId < guis.size())
+        guis[ParentId].MarkChanged();
+}
+
 void GUIObject::SetClickable(bool clickable)
 {
     if (clickable)
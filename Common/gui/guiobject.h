@@ -64,6 +64,8 @@ public:
     virtual void    Draw(Bitmap *ds) { }
     void            Enable();
     void            Hide();
+    // Marks parent gui as requiring its image to be redrawn
+    void            NotifyParentChanged();
     void            SetClickable(bool clickable);
     void            Show();
 
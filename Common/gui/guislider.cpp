@@ -196,7 +196,7 @@ void GUISlider::OnMouseMove(int x, int y)
         Value = (int)(((float)(((Y + Height) - y) - 2) / (float)(Height - 4)) * (float)(MaxValue - MinValue)) + MinValue;
 
     Value = Math::Clamp(MinValue, MaxValue, Value);
-    guis_need_update = 1;
+    NotifyParentChanged();
     IsActivated = true;
 }
 
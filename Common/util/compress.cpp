@@ -14,7 +14,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include "ac/common.h"	// quit()
+#include <string.h>
+#include <vector>
 #include "ac/roomstruct.h"
 #include "util/compress.h"
 #include "util/lzw.h"
@@ -26,6 +27,7 @@
 #pragma unmanaged
 #endif
 
+#include "util/memory.h"
 #include "util/misc.h"
 #include "util/stream.h"
 #include "util/filestream.h"
@@ -318,6 +320,121 @@ int cunpackbitl32(unsigned int *line, int size, Stream *in)
   return ferror(((Common::FileStream*)in)->GetHandle());
 }
 
+//-----------------------------------------------------------------------------
+// Decoding RLE data from the memory buffer
+//-----------------------------------------------------------------------------
+
+inline void GetPixelLE(const unsigned char *src, unsigned char &px)
+{
+  px = *src;
+}
+
+inline void GetPixelLE(const unsigned char *src, unsigned short &px)
+{
+  px = Memory::ReadInt16LE(src);
+}
+
+inline void GetPixelLE(const unsigned char *src, unsigned int &px)
+{
+  px = Memory::ReadInt32LE(src);
+}
+
+template <typename T>
+inline void CopyPixelsLE(T *dst, const unsigned char *src, int count)
+{
+#if defined (BITBYTE_BIG_ENDIAN)
+  for (int i = 0; i < count; ++i, src += sizeof(T))
+    GetPixelLE(src, dst[i]);
+#else
+  memcpy(dst, src, count * sizeof(T));
+#endif
+}
+
+template <typename T>
+inline void FillPixels(T *dst, T px, int count)
+{
+  for (T *dst_end = dst + count; dst != dst_end; ++dst)
+    *dst = px;
+}
+
+inline void FillPixels(unsigned char *dst, unsigned char px, int count)
+{
+  memset(dst, px, count);
+}
+
+template <typename T>
+int UnpackBitsLine(T *line, int size, const unsigned char *data, int data_size)
+{
+  const unsigned char *src = data;
+  const unsigned char *src_end = data + data_size;
+  int n = 0;                    // number of pixels decoded
+
+  while (n < size) {
+    if (src == src_end)
+      return -1;
+    signed char cx = (signed char)*src++;
+    if (cx == -128)
+      cx = 0;
+
+    if (cx < 0) {                //.............run
+      int count = 1 - cx;
+      if ((n + count > size) || (src_end - src < (int)sizeof(T)))
+        return -1;
+      T px;
+      GetPixelLE(src, px);
+      src += sizeof(T);
+      FillPixels(line + n, px, count);
+      n += count;
+    } else {                     //.....................seq
+      int count = cx + 1;
+      if ((n + count > size) || (src_end - src < count * (int)sizeof(T)))
+        return -1;
+      CopyPixelsLE(line + n, src, count);
+      src += count * sizeof(T);
+      n += count;
+    }
+  }
+  return src - data;
+}
+
+int cunpackbitl(unsigned char *line, int size, const unsigned char *data, int data_size)
+{
+  return UnpackBitsLine(line, size, data, data_size);
+}
+
+int cunpackbitl16(unsigned short *line, int size, const unsigned char *data, int data_size)
+{
+  return UnpackBitsLine(line, size, data, data_size);
+}
+
+int cunpackbitl32(unsigned int *line, int size, const unsigned char *data, int data_size)
+{
+  return UnpackBitsLine(line, size, data, data_size);
+}
+
+int cunpackbitmap(Bitmap *bmp, const unsigned char *data, int data_size)
+{
+  const int bpp = bmp->GetBPP();
+  const int width = bmp->GetWidth();
+  const int height = bmp->GetHeight();
+  int done = 0;
+  for (int y = 0; y < height; ++y)
+  {
+    unsigned char *line = bmp->GetScanLineForWriting(y);
+    int res;
+    if (bpp == 1)
+      res = cunpackbitl(line, width, data + done, data_size - done);
+    else if (bpp == 2)
+      res = cunpackbitl16((unsigned short*)line, width, data + done, data_size - done);
+    else
+      res = cunpackbitl32((unsigned int*)line, width, data + done, data_size - done);
+    if (res < 0)
+      return -1;
+    done += res;
+  }
+  return done;
+}
+
 //=============================================================================
 
 char *lztempfnm = "~aclzw.tmp";
@@ -369,88 +486,66 @@ long save_lzw(char *fnn, Bitmap *bmpp, color *pall, long offe) {
   FILE*iii=clibfopen(fnn,"rb");
   Seek(iii,ooff,SEEK_SET);*/
 
-long load_lzw(Stream *in, Common::Bitmap *bmm, color *pall) {
-  int          uncompsiz, *loptr;
-  unsigned char *membuffer;
-  int           arin;
-
-  recalced = bmm;
-  // MACPORT FIX (HACK REALLY)
-  in->Read(&pall[0], sizeof(color)*256);
-  maxsize = in->ReadInt32();
-  uncompsiz = in->ReadInt32();
-
-  uncompsiz += in->GetPosition();
-  outbytes = 0; putbytes = 0;
-
-  update_polled_stuff_if_runtime();
-  membuffer = lzwexpand_to_mem(in);
-  update_polled_stuff_if_runtime();
-
-  loptr = (int *)&membuffer[0];
-  membuffer += 8;
+Bitmap *decode_lzw_bitmap(const unsigned char *data, size_t data_size, int bpp) {
+  LzwDecoder decoder(data, data_size);
+  // the image starts with its line length in bytes and height
+  int32_t header[2];
+  if (decoder.Expand((unsigned char*)header, sizeof(header)) < sizeof(header))
+    return NULL;
 #if defined(AGS_BIG_ENDIAN)
-  loptr[0] = AGS::Common::BBOp::SwapBytesInt32(loptr[0]);
-  loptr[1] = AGS::Common::BBOp::SwapBytesInt32(loptr[1]);
-  int bitmapNumPixels = loptr[0]*loptr[1]/_acroom_bpp;
-  switch (_acroom_bpp) // bytes per pixel!
-  {
-    case 1:
-    {
-      // all done
-      break;
+  header[0] = AGS::Common::BBOp::SwapBytesInt32(header[0]);
+  header[1] = AGS::Common::BBOp::SwapBytesInt32(header[1]);
+#endif
+  const int line_length = header[0];
+  const int height = header[1];
+  if (line_length <= 0 || height <= 0 || line_length % bpp != 0)
+    return NULL;
+
+  Bitmap *bmp = BitmapHelper::CreateBitmap(line_length / bpp, height, bpp * 8);
+  if (bmp == NULL)
+    return NULL;
+  for (int y = 0; y < height; ++y) {
+    unsigned char *line = bmp->GetScanLineForWriting(y);
+    if (decoder.Expand(line, line_length) < (size_t)line_length) {
+      delete bmp;
+      return NULL;
     }
-    case 2:
-    {
-      short *sp = (short *)membuffer;
-      for (int i = 0; i < bitmapNumPixels; ++i)
-      {
-        sp[i] = AGS::Common::BBOp::SwapBytesInt16(sp[i]);
-      }
-      // all done
-      break;
+#if defined(AGS_BIG_ENDIAN)
+    if (bpp == 2) {
+      short *sp = (short *)line;
+      for (int x = 0; x < line_length / 2; ++x)
+        sp[x] = AGS::Common::BBOp::SwapBytesInt16(sp[x]);
     }
-    case 4:
-    {
-      int *ip = (int *)membuffer;
-      for (int i = 0; i < bitmapNumPixels; ++i)
-      {
-        ip[i] = AGS::Common::BBOp::SwapBytesInt32(ip[i]);
-      }
-      // all done
-      break;
+    else if (bpp == 4) {
+      int *ip = (int *)line;
+      for (int x = 0; x < line_length / 4; ++x)
+        ip[x] = AGS::Common::BBOp::SwapBytesInt32(ip[x]);
     }
-  }
 #endif // defined(AGS_BIG_ENDIAN)
+  }
+  return bmp;
+}
 
-  delete bmm;
-
-  update_polled_stuff_if_runtime();
-
-  bmm = BitmapHelper::CreateBitmap((loptr[0] / _acroom_bpp), loptr[1], _acroom_bpp * 8);
-  if (bmm == NULL)
-    quit("!load_room: not enough memory to load room background");
-
-  update_polled_stuff_if_runtime();
-
-  bmm->Acquire ();
-  recalced = bmm;
-
-  for (arin = 0; arin < loptr[1]; arin++)
-    memcpy(&bmm->GetScanLineForWriting(arin)[0], &membuffer[arin * loptr[0]], loptr[0]);
-
-  bmm->Release ();
-
-  update_polled_stuff_if_runtime();
+long load_lzw(Stream *in, Common::Bitmap **bmm, int bpp, color *pall) {
+  // MACPORT FIX (HACK REALLY)
+  in->Read(&pall[0], sizeof(color)*256);
+  in->ReadInt32(); // uncompressed size
+  const int compsiz = in->ReadInt32();
+  const long block_end = in->GetPosition() + compsiz;
 
-  free(membuffer-8);
+  std::vector<unsigned char> data(compsiz > 0 ? compsiz : 0);
+  if (!data.empty())
+    data.resize(in->Read(&data.front(), data.size()));
 
-  if (in->GetPosition() != uncompsiz)
-    in->Seek(uncompsiz, kSeekBegin);
+  delete *bmm;
+  *bmm = data.empty() ? NULL : decode_lzw_bitmap(&data.front(), data.size(), bpp);
+  if (*bmm == NULL)
+    return -1;
 
-  update_polled_stuff_if_runtime();
+  if (in->GetPosition() != block_end)
+    in->Seek(block_end, kSeekBegin);
 
-  return uncompsiz;
+  return block_end;
 }
 
 long savecompressed_allegro(char *fnn, Common::Bitmap *bmpp, color *pall, long write_at) {
@@ -474,19 +569,31 @@ long loadcompressed_allegro(Stream *in, Common::Bitmap **bimpp, color *pall, lon
 
   Bitmap *bim = *bimpp;
   delete bim;
+  *bimpp = NULL;
 
   widd = in->ReadInt16();
   hitt = in->ReadInt16();
   bim = BitmapHelper::CreateBitmap(widd, hitt, 8);
   if (bim == NULL)
-    quit("!load_room: not enough memory to decompress masks");
+    return -1;
   *bimpp = bim;
 
+  // The size of compressed data is not known beforehand: read as much as
+  // the worst case would require, then return to where the data has ended
+  size_t max_size = widd * 2 * hitt;
+  size_t avail_size = in->GetLength() - in->GetPosition();
+  std::vector<unsigned char> buffer(max_size < avail_size ? max_size : avail_size);
+  int read_size = buffer.empty() ? 0 : in->Read(&buffer.front(), buffer.size());
+  int done = 0;
   for (ii = 0; ii < hitt; ii++) {
-    cunpackbitl(&bim->GetScanLineForWriting(ii)[0], widd, in);
-    if (ii % 20 == 0)
-      update_polled_stuff_if_runtime();
+    int res = cunpackbitl(&bim->GetScanLineForWriting(ii)[0], widd,
+                          buffer.empty() ? NULL : &buffer.front() + done, read_size - done);
+    // the rest of the mask, and where the next one starts, can't be known
+    if (res < 0)
+      return -1;
+    done += res;
   }
+  in->Seek(done - read_size, kSeekCurrent);
 
   in->Seek(768);  // skip palette
 
@@ -35,14 +35,29 @@ void cpackbitl32(unsigned int *line, int size, Common::Stream *out);
 int  cunpackbitl(unsigned char *line, int size, Common::Stream *in);
 int  cunpackbitl16(unsigned short *line, int size, Common::Stream *in);
 int  cunpackbitl32(unsigned int *line, int size, Common::Stream *in);
+// Decode RLE data from the memory buffer; return the number of bytes used,
+// or -1 if the data is corrupt
+int  cunpackbitl(unsigned char *line, int size, const unsigned char *data, int data_size);
+int  cunpackbitl16(unsigned short *line, int size, const unsigned char *data, int data_size);
+int  cunpackbitl32(unsigned int *line, int size, const unsigned char *data, int data_size);
+// Decode whole bitmap, line by line, choosing the decoder by its color depth
+int  cunpackbitmap(Common::Bitmap *bmp, const unsigned char *data, int data_size);
 
 //=============================================================================
 
 long save_lzw(char *fnn, Common::Bitmap *bmpp, color *pall, long offe);
 
 /*long load_lzw(char*fnn,Common::Bitmap*bmm,color*pall,long ooff);*/
-long load_lzw(Common::Stream *in, Common::Bitmap *bmm, color *pall);
+// Loads the room background made of bytes per pixel into *bmm, replacing
+// the image it held; returns -1 if the data is corrupt
+long load_lzw(Common::Stream *in, Common::Bitmap **bmm, int bpp, color *pall);
+// Decodes the LZW compressed room background, made of bytes per pixel;
+// returns NULL if the data is corrupt. Does not touch any global state, so
+// may be run for several images at once on different threads.
+Common::Bitmap *decode_lzw_bitmap(const unsigned char *data, size_t data_size, int bpp);
 long savecompressed_allegro(char *fnn, Common::Bitmap *bmpp, color *pall, long write_at);
+// Loads the room mask into *bimpp, replacing the image it held; returns -1
+// if the image could not be created or its data is corrupt
 long loadcompressed_allegro(Common::Stream *in, Common::Bitmap **bimpp, color *pall, long read_at);
 
 //extern char *lztempfnm;
@@ -14,6 +14,9 @@
 
 #if defined(WINDOWS_VERSION)
 #include <io.h>
+#include <windows.h>
+#undef CreateFile  // undef the declarations from winbase.h
+#undef DeleteFile
 #else
 #include <unistd.h> // for unlink()
 #endif
@@ -88,6 +91,15 @@ bool File::DeleteFile(const String &filename)
     return true;
 }
 
+bool File::RenameFile(const String &old_name, const String &new_name)
+{
+#if defined(WINDOWS_VERSION)
+    return MoveFileExA(old_name, new_name, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return rename(old_name, new_name) == 0;
+#endif
+}
+
 bool File::GetFileModesFromCMode(const String &cmode, FileOpenMode &open_mode, FileWorkMode &work_mode)
 {
     // We do not test for 'b' and 't' here, because text mode reading/writing should be done with
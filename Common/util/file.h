@@ -54,6 +54,10 @@ namespace File
     bool        TestCreateFile(const String &filename);
     // Deletes existing file; returns TRUE if was able to delete one
     bool        DeleteFile(const String &filename);
+    // Renames the file, replacing the existing file of the new name if there
+    // is one; where the system allows, the old file stays in place until the
+    // new one replaces it at once
+    bool        RenameFile(const String &old_name, const String &new_name);
 
     // Sets FileOpenMode and FileWorkMode values corresponding to C-style file open mode string
     bool        GetFileModesFromCMode(const String &cmode, FileOpenMode &open_mode, FileWorkMode &work_mode);
@@ -12,6 +12,9 @@
 //
 //=============================================================================
 #include "util/geometry.h"
+#include "util/math.h"
+
+namespace Math = AGS::Common::Math;
 
 //namespace AGS
 //{
@@ -68,6 +71,24 @@ Rect OffsetRect(const Rect &r, const Point off)
     return Rect(r.Left + off.X, r.Top + off.Y, r.Right + off.X, r.Bottom + off.Y);
 }
 
+bool AreRectsIntersecting(const Rect &r1, const Rect &r2)
+{
+    return r1.Left <= r2.Right && r1.Right >= r2.Left &&
+        r1.Top <= r2.Bottom && r1.Bottom >= r2.Top;
+}
+
+Rect IntersectRects(const Rect &r1, const Rect &r2)
+{
+    return Rect(Math::Max(r1.Left, r2.Left), Math::Max(r1.Top, r2.Top),
+        Math::Min(r1.Right, r2.Right), Math::Min(r1.Bottom, r2.Bottom));
+}
+
+Rect UnionRects(const Rect &r1, const Rect &r2)
+{
+    return Rect(Math::Min(r1.Left, r2.Left), Math::Min(r1.Top, r2.Top),
+        Math::Max(r1.Right, r2.Right), Math::Max(r1.Bottom, r2.Bottom));
+}
+
 Rect CenterInRect(const Rect &place, const Rect &item)
 {
     return RectWH((place.GetWidth() >> 1) - (item.GetWidth() >> 1),
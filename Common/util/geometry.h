@@ -350,6 +350,12 @@ Size ProportionalStretch(int dest_w, int dest_h, int item_w, int item_h);
 Size ProportionalStretch(const Size &dest, const Size &item);
 
 Rect OffsetRect(const Rect &r, const Point off);
+// Tells if two rectangles have at least one common point
+bool AreRectsIntersecting(const Rect &r1, const Rect &r2);
+// Returns the common part of two rectangles; result is empty if they don't intersect
+Rect IntersectRects(const Rect &r1, const Rect &r2);
+// Returns the smallest rectangle containing both given ones
+Rect UnionRects(const Rect &r1, const Rect &r2);
 Rect CenterInRect(const Rect &place, const Rect &item);
 Rect PlaceInRect(const Rect &place, const Rect &item, const RectPlacement &placement);
 //} // namespace Common
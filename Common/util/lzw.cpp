@@ -20,7 +20,9 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "ac/common.h"
+#include "util/lzw.h"
 #include "util/stream.h"
 
 using AGS::Common::Stream;
@@ -52,7 +54,7 @@ void _delete(int);
 char *lzbuffer;
 int *node;
 int pos;
-long outbytes = 0, maxsize = 0, putbytes = 0;
+long outbytes = 0;
 
 int insert(int i, int run)
 {
@@ -200,80 +202,58 @@ void lzwcompress(Common::Stream *lzw_in, Common::Stream *out)
   free(lzbuffer);
 }
 
-int expand_to_mem = 0;
-unsigned char *membfptr = NULL;
-void myputc(int ccc, Stream *out)
+LzwDecoder::LzwDecoder(const unsigned char *data, size_t data_size)
+  : _data(data)
+  , _dataEnd(data + data_size)
+  , _pos(N - F)
+  , _matchPos(0)
+  , _matchLen(0)
+  , _flags(0)
+  , _flagMask(0x100)
 {
-  if (maxsize > 0) {
-    putbytes++;
-    if (putbytes > maxsize)
-      return;
-  }
-
-  outbytes++;
-  if (expand_to_mem) {
-    membfptr[0] = ccc;
-    membfptr++;
-  } else
-    out->WriteInt8(ccc);
+  memset(_window, 0, sizeof(_window));
 }
 
-void lzwexpand(Stream *lzw_in, Stream *out)
+size_t LzwDecoder::Expand(unsigned char *out, size_t out_size)
 {
-  int bits, ch, i, j, len, mask;
-  char *lzbuffer;
-//  printf(" UnShrinking: %s ",filena);
-  putbytes = 0;
-
-  lzbuffer = (char *)malloc(N);
-  if (lzbuffer == NULL) {
-    quit("compress.cpp: unable to decompress: insufficient memory");
-  }
-  i = N - F;
-
-  // this end condition just checks for EOF, which is no good to us
-  while ((bits = lzw_in->ReadByte()) != -1) {
-    for (mask = 0x01; mask & 0xFF; mask <<= 1) {
-      if (bits & mask) {
-        // MACPORT FIX: read to short and expand
-        short jshort = 0;
-        jshort = lzw_in->ReadInt16();
-        j = jshort;
-
-        len = ((j >> 12) & 15) + 3;
-        j = (i - j - 1) & (N - 1);
-
-        while (len--) {
-          myputc(lzbuffer[i] = lzbuffer[j], out);
-          j = (j + 1) & (N - 1);
-          i = (i + 1) & (N - 1);
-        }
-      } else {
-        ch = lzw_in->ReadByte();
-        myputc(lzbuffer[i] = ch, out);
-        i = (i + 1) & (N - 1);
+  size_t done = 0;
+  while (done < out_size) {
+    // finish copying the last match first, it may not have fit into the
+    // previous output buffer
+    if (_matchLen > 0) {
+      for (; _matchLen > 0 && done < out_size; _matchLen--) {
+        out[done++] = _window[_pos] = _window[_matchPos];
+        _matchPos = (_matchPos + 1) & (N - 1);
+        _pos = (_pos + 1) & (N - 1);
       }
+      continue;
+    }
 
-      if ((putbytes >= maxsize) && (maxsize > 0))
+    // every group of 8 items is preceded by their flags
+    if (_flagMask & 0x100) {
+      if (_data == _dataEnd)
         break;
+      _flags = *_data++;
+      _flagMask = 0x01;
+    }
 
-      if ((lzw_in->EOS()) && (maxsize > 0))
-        quit("Read error decompressing image - file is corrupt");
-    }                           // end for mask
-
-    if ((putbytes >= maxsize) && (maxsize > 0))
-      break;
+    if (_flags & _flagMask) {
+      // 12-bit offset back in the window, and the match length in the high bits
+      if (_dataEnd - _data < 2) {
+        _data = _dataEnd;
+        break;
+      }
+      const int code = _data[0] | (_data[1] << 8);
+      _data += 2;
+      _matchLen = ((code >> 12) & 15) + 3;
+      _matchPos = (_pos - code - 1) & (N - 1);
+    } else {
+      if (_data == _dataEnd)
+        break;
+      out[done++] = _window[_pos] = *_data++;
+      _pos = (_pos + 1) & (N - 1);
+    }
+    _flagMask <<= 1;
   }
-
-  free(lzbuffer);
-  expand_to_mem = 0;
-}
-
-unsigned char *lzwexpand_to_mem(Common::Stream *in)
-{
-  unsigned char *membuff = (unsigned char *)malloc(maxsize + 10);
-  expand_to_mem = 1;
-  membfptr = membuff;
-  lzwexpand(in, NULL);
-  return membuff;
+  return done;
 }
@@ -18,12 +18,40 @@
 #ifndef __AGS_CN_UTIL__LZW_H
 #define __AGS_CN_UTIL__LZW_H
 
+#include <stddef.h>
+
 namespace AGS { namespace Common { class Stream; } }
 using namespace AGS; // FIXME later
 
 void lzwcompress(Common::Stream *lzw_in, Common::Stream *out);
-unsigned char *lzwexpand_to_mem(Common::Stream *in);
 
-extern long outbytes, maxsize, putbytes;
+// LZW decoder over the compressed data in memory. Every decoder keeps its
+// own state, so that several blocks may be decoded at the same time on
+// different threads; the output may be requested in parts, e.g. line by
+// line right into a bitmap.
+class LzwDecoder
+{
+public:
+    LzwDecoder(const unsigned char *data, size_t data_size);
+
+    // Decodes up to the given number of bytes into the buffer, continuing
+    // where the last call stopped; returns the number of bytes written,
+    // which is less than requested only if the compressed data ended
+    size_t Expand(unsigned char *out, size_t out_size);
+
+private:
+    static const int WindowSize = 4096;
+
+    const unsigned char *_data;
+    const unsigned char *_dataEnd;
+    unsigned char _window[WindowSize];
+    int  _pos;      // where the next output byte goes in the window
+    int  _matchPos; // where the repeated bytes are copied from
+    int  _matchLen; // number of bytes left to copy
+    int  _flags;    // current group's flags telling matches from literals
+    int  _flagMask; // flag of the next item in the group
+};
+
+extern long outbytes;
 
 #endif // __AGS_CN_UTIL__LZW_H
@@ -0,0 +1,146 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <string.h>
+#include "util/memorystream.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+MemoryStream::MemoryStream(std::vector<char> &buffer, DataEndianess stream_endianess)
+    : DataStream(stream_endianess)
+    , _buffer(&buffer)
+    , _pos(0)
+{
+}
+
+MemoryStream::~MemoryStream()
+{
+    Close();
+}
+
+void MemoryStream::Close()
+{
+    _buffer = NULL;
+    _pos = 0;
+}
+
+bool MemoryStream::Flush()
+{
+    return IsValid();
+}
+
+bool MemoryStream::IsValid() const
+{
+    return _buffer != NULL;
+}
+
+bool MemoryStream::EOS() const
+{
+    return !IsValid() || _pos >= _buffer->size();
+}
+
+size_t MemoryStream::GetLength() const
+{
+    return IsValid() ? _buffer->size() : 0;
+}
+
+size_t MemoryStream::GetPosition() const
+{
+    return IsValid() ? _pos : -1;
+}
+
+bool MemoryStream::CanRead() const
+{
+    return IsValid();
+}
+
+bool MemoryStream::CanWrite() const
+{
+    return IsValid();
+}
+
+bool MemoryStream::CanSeek() const
+{
+    return IsValid();
+}
+
+size_t MemoryStream::Read(void *buffer, size_t size)
+{
+    if (EOS() || !buffer)
+        return 0;
+    if (size > _buffer->size() - _pos)
+        size = _buffer->size() - _pos;
+    memcpy(buffer, &(*_buffer)[_pos], size);
+    _pos += size;
+    return size;
+}
+
+int32_t MemoryStream::ReadByte()
+{
+    if (EOS())
+        return -1;
+    return (uint8_t)(*_buffer)[_pos++];
+}
+
+size_t MemoryStream::Write(const void *buffer, size_t size)
+{
+    if (!IsValid() || !buffer)
+        return 0;
+    if (size == 0)
+        return 0;
+    if (_pos + size > _buffer->size())
+        _buffer->resize(_pos + size);
+    memcpy(&(*_buffer)[_pos], buffer, size);
+    _pos += size;
+    return size;
+}
+
+int32_t MemoryStream::WriteByte(uint8_t val)
+{
+    if (!IsValid())
+        return -1;
+    if (_pos >= _buffer->size())
+        _buffer->resize(_pos + 1);
+    (*_buffer)[_pos++] = val;
+    return val;
+}
+
+size_t MemoryStream::Seek(int offset, StreamSeek origin)
+{
+    if (!IsValid())
+        return -1;
+
+    size_t base;
+    switch (origin)
+    {
+    case kSeekBegin:    base = 0; break;
+    case kSeekCurrent:  base = _pos; break;
+    case kSeekEnd:      base = _buffer->size(); break;
+    default:
+        return -1;
+    }
+    // like a file, the stream may not be positioned before its start,
+    // in which case the position stays, but may be positioned past its
+    // end, which is filled with zeroes on the next write
+    if (offset < 0 && (size_t)-offset > base)
+        return _pos;
+    _pos = base + offset;
+    return _pos;
+}
+
+} // namespace Common
+} // namespace AGS
@@ -14,6 +14,7 @@
 
 #include <errno.h>
 #include <stdlib.h>
+#include "font/fonts.h"
 #include "gui/guidefines.h"
 #include "util/math.h"
 #include "util/string_utils.h"
@@ -50,6 +51,16 @@ int  numlines;
 // Project-dependent implementation
 extern int wgettextwidth_compensate(const char *tex, int font);
 
+// Measures the line up to and including the given character
+static int get_line_prefix_width(char *theline, int last, int fonnt) {
+    // temporarily terminate the line here and test its width
+    const char nextCharWas = theline[last + 1];
+    theline[last + 1] = 0;
+    const int width = wgettextwidth_compensate(theline, fonnt);
+    theline[last + 1] = nextCharWas;
+    return width;
+}
+
 // Break up the text into lines
 void split_lines(const char *todis, int wii, int fonnt) {
     // v2.56.636: rewrote this function because the old version
@@ -65,6 +76,18 @@ void split_lines(const char *todis, int wii, int fonnt) {
     theline = textCopyBuffer;
     unescape(theline);
 
+    // If the font measures all of these characters separately, the line
+    // width is summed up as we go; otherwise every longer part of the line
+    // has to be measured anew.
+    const int *char_widths = get_font_char_widths(fonnt);
+    for (const char *p = theline; char_widths && *p; ++p) {
+        if (char_widths[(unsigned char)*p] < 0)
+            char_widths = NULL;
+    }
+    // the outline compensation is added once per line
+    const int emptyLineWidth = char_widths ? wgettextwidth_compensate("", fonnt) : 0;
+    int lineWidth = emptyLineWidth;
+
     while (1) {
         splitAt = -1;
 
@@ -77,15 +100,14 @@ void split_lines(const char *todis, int wii, int fonnt) {
             break;
         }
 
-        // temporarily terminate the line here and test its width
-        nextCharWas = theline[i + 1];
-        theline[i + 1] = 0;
+        if (char_widths)
+            lineWidth += char_widths[(unsigned char)theline[i]];
 
         // force end of line with the \n character
         if (theline[i] == '\n')
             splitAt = i;
         // otherwise, see if we are too wide
-        else if (wgettextwidth_compensate(theline, fonnt) >= wii) {
+        else if ((char_widths ? lineWidth : get_line_prefix_width(theline, i, fonnt)) >= wii) {
             int endline = i;
             while ((theline[endline] != ' ') && (endline > 0))
                 endline--;
@@ -97,9 +119,6 @@ void split_lines(const char *todis, int wii, int fonnt) {
             splitAt = endline;
         }
 
-        // restore the character that was there before
-        theline[i + 1] = nextCharWas;
-
         if (splitAt >= 0) {
             // add this line
             nextCharWas = theline[splitAt];
@@ -117,6 +136,7 @@ void split_lines(const char *todis, int wii, int fonnt) {
             if ((theline[0] == ' ') || (theline[0] == '\n'))
                 theline++;
             i = -1;
+            lineWidth = emptyLineWidth;
         }
 
         i++;
@@ -624,6 +624,10 @@ import void DisplayMessageBar(int y, int textColor, int backColor, const string
 import void ResetRoom(int roomNumber);
 /// Checks whether the player has been in the specified room yet.
 import int  HasPlayerBeenInRoom(int roomNumber);
+#ifdef SCRIPT_API_v341
+/// Loads the specified room in the background, so that changing to it later takes less time.
+import void PreloadRoom(int roomNumber);
+#endif
 #ifndef STRICT_IN_v340
 /// Performs default processing of a mouse click at the specified co-ordinates.
 import void ProcessClick(int x, int y, CursorMode);
@@ -1432,7 +1436,14 @@ enum EventType {
   eEventGUIMouseUp = 6,
   eEventAddInventory = 7,
   eEventLoseInventory = 8,
+#ifdef SCRIPT_API_v341
+  eEventRestoreGame = 9,
+  eEventSaveGame = 10,
+  eEventSaveGameFailed = 11
+#endif
+#ifndef SCRIPT_API_v341
   eEventRestoreGame = 9
+#endif
 };
 
 // forward-declare these so that they can be returned by GUIControl class
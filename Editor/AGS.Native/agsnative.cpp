@@ -246,9 +246,7 @@ int find_free_sprite_slot() {
   if (rr < 0) {
     return -1;
   }
-  spriteset.images[rr] = NULL;
-  spriteset.offsets[rr] = 0;
-  spriteset.sizes[rr] = 0;
+  spriteset.removeSprite(rr, false);
   return rr;
 }
 
@@ -32,5 +32,5 @@ void SpriteCache::initFile_initNullSpriteParams(int vv)
   // no sprite ... blank it out
   spritewidth[vv] = 0;
   spriteheight[vv] = 0;
-  offsets[vv] = 0;
+  entries[vv].Offset = 0;
 }
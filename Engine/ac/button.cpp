@@ -85,7 +85,7 @@ void Button_SetText(GUIButton *butt, const char *newtx) {
     if (strlen(newtx) > 49) quit("!SetButtonText: text too long, button has 50 chars max");
 
     if (strcmp(butt->GetText(), newtx)) {
-        guis_need_update = 1;
+        butt->NotifyParentChanged();
         butt->SetText(newtx);
     }
 }
@@ -96,7 +96,7 @@ void Button_SetFont(GUIButton *butt, int newFont) {
 
     if (butt->Font != newFont) {
         butt->Font = newFont;
-        guis_need_update = 1;
+        butt->NotifyParentChanged();
     }
 }
 
@@ -115,7 +115,7 @@ void Button_SetClipImage(GUIButton *butt, int newval) {
     if (newval)
         butt->Flags |= kGUICtrl_Clip;
 
-    guis_need_update = 1;
+    butt->NotifyParentChanged();
 }
 
 int Button_GetGraphic(GUIButton *butt) {
@@ -136,7 +136,7 @@ void Button_SetMouseOverGraphic(GUIButton *guil, int slotn) {
         guil->CurrentImage = slotn;
     guil->MouseOverImage = slotn;
 
-    guis_need_update = 1;
+    guil->NotifyParentChanged();
     FindAndRemoveButtonAnimation(guil->ParentId, guil->Id);
 }
 
@@ -154,7 +154,7 @@ void Button_SetNormalGraphic(GUIButton *guil, int slotn) {
     guil->Width = spritewidth[slotn];
     guil->Height = spriteheight[slotn];
 
-    guis_need_update = 1;
+    guil->NotifyParentChanged();
     FindAndRemoveButtonAnimation(guil->ParentId, guil->Id);
 }
 
@@ -169,7 +169,7 @@ void Button_SetPushedGraphic(GUIButton *guil, int slotn) {
         guil->CurrentImage = slotn;
     guil->PushedImage = slotn;
 
-    guis_need_update = 1;
+    guil->NotifyParentChanged();
     FindAndRemoveButtonAnimation(guil->ParentId, guil->Id);
 }
 
@@ -180,7 +180,7 @@ int Button_GetTextColor(GUIButton *butt) {
 void Button_SetTextColor(GUIButton *butt, int newcol) {
     if (butt->TextColor != newcol) {
         butt->TextColor = newcol;
-        guis_need_update = 1;
+        butt->NotifyParentChanged();
     }
 }
 
@@ -224,7 +224,7 @@ int UpdateAnimatingButton(int bu) {
     guibuts[animbuts[bu].buttonid].CurrentImage = guibuts[animbuts[bu].buttonid].Image;
     guibuts[animbuts[bu].buttonid].PushedImage = 0;
     guibuts[animbuts[bu].buttonid].MouseOverImage = 0;
-    guis_need_update = 1;
+    guibuts[animbuts[bu].buttonid].NotifyParentChanged();
 
     animbuts[bu].wait = animbuts[bu].speed + tview->loops[animbuts[bu].loop].frames[animbuts[bu].frame].speed;
     return 0;
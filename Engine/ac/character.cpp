@@ -17,6 +17,7 @@
 //=============================================================================
 
 #include "ac/character.h"
+#include "ac/characterindex.h"
 #include "ac/common.h"
 #include "ac/gamesetupstruct.h"
 #include "ac/roomstruct.h"
@@ -51,6 +52,7 @@
 #include "main/game_run.h"
 #include "main/update.h"
 #include "ac/spritecache.h"
+#include "ac/spriteprefetch.h"
 #include "util/string_utils.h"
 #include <math.h>
 #include "gfx/graphicsdriver.h"
@@ -250,6 +252,7 @@ void Character_ChangeRoomSetLoop(CharacterInfo *chaa, int room, int x, int y, in
         }
         chaa->prevroom = chaa->room;
         chaa->room = room;
+        charindex_update(chaa->index_id);
 
 		debug_script_log("%s moved to room %d, location %d,%d, loop %d",
 			chaa->scrname, room, chaa->x, chaa->y, chaa->loop);
@@ -811,7 +814,10 @@ void Character_SetAsPlayer(CharacterInfo *chaa) {
     // the current room for 2.x. Following script calls to NewRoom() will
     // make sure this still works as intended.
     if ((loaded_game_file_version <= kGameVersion_272) && (playerchar->room < 0))
+    {
         playerchar->room = displayed_room;
+        charindex_update(game.playercharacter);
+    }
 
     if (displayed_room != playerchar->room)
         NewRoom(playerchar->room);
@@ -1846,9 +1852,10 @@ int has_hit_another_character(int sourceChar) {
     if (game.chars[sourceChar].flags & CHF_NOBLOCKING)
         return -1;
 
-    for (int ww = 0; ww < game.numcharacters; ww++) {
+    const std::vector<int> &room_chars = charindex_get_room(displayed_room);
+    for (size_t i = 0; i < room_chars.size(); i++) {
+        int ww = room_chars[i];
         if (game.chars[ww].on != 1) continue;
-        if (game.chars[ww].room != displayed_room) continue;
         if (ww == sourceChar) continue;
         if (game.chars[ww].flags & CHF_NOBLOCKING) continue;
 
@@ -2135,6 +2142,7 @@ void animate_character(CharacterInfo *chap, int loopn,int sppd,int rept, int noi
 
     chap->wait = sppd + views[chap->view].loops[loopn].frames[chap->frame].speed;
     CheckViewFrameForCharacter(chap);
+    spriteprefetch_queue_loop(chap->view, loopn);
 }
 
 void CheckViewFrameForCharacter(CharacterInfo *chi) {
@@ -2186,8 +2194,9 @@ extern int char_lowest_yp, obj_lowest_yp;
 
 int is_pos_on_character(int xx,int yy) {
     int cc,sppic,lowestyp=0,lowestwas=-1;
-    for (cc=0;cc<game.numcharacters;cc++) {
-        if (game.chars[cc].room!=displayed_room) continue;
+    const std::vector<int> &room_chars = charindex_get_room(displayed_room);
+    for (size_t i = 0; i < room_chars.size(); i++) {
+        cc = room_chars[i];
         if (game.chars[cc].on==0) continue;
         if (game.chars[cc].flags & CHF_NOINTERACT) continue;
         if (game.chars[cc].view < 0) continue;
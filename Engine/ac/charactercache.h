@@ -30,6 +30,9 @@ struct CharacterCache {
     short tintredwas, tintgrnwas, tintbluwas, tintamntwas;
     short lightlevwas, tintlightwas;
     // no mirroredWas is required, since the code inverts the sprite number
+    // The following are used to determine if the walk-behinds drawn over
+    // the character have to be updated
+    int xwas, ywas, baselinewas, nowalkbehindswas;
 };
 
 #endif // __AGS_EE_AC__CHARACTERCACHE_H
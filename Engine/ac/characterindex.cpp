@@ -0,0 +1,85 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <algorithm>
+#include "ac/characterindex.h"
+#include "ac/gamesetupstruct.h"
+
+extern GameSetupStruct game;
+
+typedef std::vector<int> CharList;
+
+// Character lists indexed by room number
+static std::vector<CharList> RoomChars;
+// The room each character is listed in, or -1
+static std::vector<int> CharRooms;
+static bool IndexValid = false;
+static const CharList NoChars;
+
+static void add_to_room(int charid, int room)
+{
+    CharRooms[charid] = room;
+    if (room < 0)
+        return;
+    if ((size_t)room >= RoomChars.size())
+        RoomChars.resize(room + 1);
+    CharList &list = RoomChars[room];
+    list.insert(std::lower_bound(list.begin(), list.end(), charid), charid);
+}
+
+static void remove_from_room(int charid)
+{
+    int room = CharRooms[charid];
+    CharRooms[charid] = -1;
+    if (room < 0 || (size_t)room >= RoomChars.size())
+        return;
+    CharList &list = RoomChars[room];
+    CharList::iterator it = std::lower_bound(list.begin(), list.end(), charid);
+    if (it != list.end() && *it == charid)
+        list.erase(it);
+}
+
+static void rebuild_index()
+{
+    for (size_t i = 0; i < RoomChars.size(); ++i)
+        RoomChars[i].clear();
+    CharRooms.assign(game.numcharacters, -1);
+    for (int i = 0; i < game.numcharacters; ++i)
+        add_to_room(i, game.chars[i].room);
+    IndexValid = true;
+}
+
+void charindex_invalidate()
+{
+    IndexValid = false;
+}
+
+void charindex_update(int charid)
+{
+    if (!IndexValid || charid < 0 || charid >= game.numcharacters)
+        return;
+    if (CharRooms[charid] == game.chars[charid].room)
+        return;
+    remove_from_room(charid);
+    add_to_room(charid, game.chars[charid].room);
+}
+
+const std::vector<int> &charindex_get_room(int room)
+{
+    if (!IndexValid)
+        rebuild_index();
+    if (room < 0 || (size_t)room >= RoomChars.size())
+        return NoChars;
+    return RoomChars[room];
+}
@@ -0,0 +1,37 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Per-room character index. Keeps lists of the characters in each room, so
+// that the code working with the current room does not have to go through
+// every character in the game.
+//
+// The index must be told whenever a character's room changes; if the
+// character data may have been changed behind the engine's back, the index
+// is invalidated and rebuilt on the next request.
+//
+//=============================================================================
+
+#ifndef __AGS_EE_AC__CHARACTERINDEX_H
+#define __AGS_EE_AC__CHARACTERINDEX_H
+
+#include <vector>
+
+// Marks the whole index outdated; it is rebuilt when next requested
+void charindex_invalidate();
+// Moves the character to the list of its current room
+void charindex_update(int charid);
+// Gets indexes of the characters in the given room, in ascending order
+const std::vector<int> &charindex_get_room(int room);
+
+#endif // __AGS_EE_AC__CHARACTERINDEX_H
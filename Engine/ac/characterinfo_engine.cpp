@@ -18,6 +18,7 @@
 #include "ac/roomstruct.h"
 #include "media/audio/audiodefines.h"
 #include "ac/character.h"
+#include "ac/characterindex.h"
 #include "ac/characterextras.h"
 #include "ac/gamestate.h"
 #include "ac/global_character.h"
@@ -90,6 +91,8 @@ void CharacterInfo::UpdateMoveAndAnim(int &char_index, CharacterExtras *chex, in
 	}
 
 	update_character_follower(char_index, numSheep, followingAsSheep, doing_nothing);
+	// followers may have changed room
+	charindex_update(index_id);
 
 	update_character_idle(chex, doing_nothing);
 
@@ -103,6 +106,7 @@ void CharacterInfo::UpdateFollowingExactlyCharacter()
     z = game.chars[following].z;
     room = game.chars[following].room;
     prevroom = game.chars[following].prevroom;
+    charindex_update(index_id);
 
     int usebase = game.chars[following].get_baseline();
 
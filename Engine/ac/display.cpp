@@ -31,6 +31,7 @@
 #include "ac/speech.h"
 #include "ac/string.h"
 #include "ac/system.h"
+#include "ac/textruncache.h"
 #include "ac/topbarsettings.h"
 #include "debug/debug_log.h"
 #include "gui/guibutton.h"
@@ -40,10 +41,12 @@
 #include "platform/base/agsplatformdriver.h"
 #include "ac/spritecache.h"
 #include "gfx/gfx_util.h"
+#include "util/math.h"
 #include "util/string_utils.h"
 
 using AGS::Common::Bitmap;
 namespace BitmapHelper = AGS::Common::BitmapHelper;
+namespace Math = AGS::Common::Math;
 
 extern GameState play;
 extern GameSetupStruct game;
@@ -429,9 +432,9 @@ bool ShouldAntiAliasText() {
     return (game.options[OPT_ANTIALIASFONTS] != 0);
 }
 
-void wouttext_outline(Common::Bitmap *ds, int xxp, int yyp, int usingfont, color_t text_color, const char *texx) {
-    
-    color_t outline_color = ds->GetCompatibleColor(play.speech_text_shadow);
+// Draws the text and its outline right onto the bitmap
+static void draw_text_outlined(Bitmap *ds, int xxp, int yyp, int usingfont, color_t text_color, color_t outline_color, const char *texx) {
+
     if (get_font_outline(usingfont) >= 0) {
         // MACPORT FIX 9/6/5: cast
         wouttextxy(ds, xxp, yyp, (int)get_font_outline(usingfont), outline_color, texx);
@@ -461,6 +464,66 @@ void wouttext_outline(Common::Bitmap *ds, int xxp, int yyp, int usingfont, color
     wouttextxy(ds, xxp, yyp, usingfont, text_color, texx);
 }
 
+// Tells if the text drawn on this bitmap would look the same when blitted
+// from the cached image
+static bool can_use_text_cache(Bitmap *ds, int yyp, int usingfont, color_t text_color, color_t outline_color, const char *texx) {
+    if (!textcache_is_enabled() || texx[0] == 0)
+        return false;
+    // the image is blitted skipping the mask color pixels
+    const int depth = ds->GetColorDepth();
+    const color_t mask_color = ds->GetMaskColor();
+    if (!font_renders_solid_pixels(usingfont, depth) || text_color == mask_color)
+        return false;
+    int text_bottom = yyp + get_font_yoffset(usingfont);
+    const int outline_font = get_font_outline(usingfont);
+    if (outline_font >= 0) {
+        if (!font_renders_solid_pixels(outline_font, depth) || outline_color == mask_color)
+            return false;
+        text_bottom = Math::Max(text_bottom, yyp + get_font_yoffset(outline_font));
+    }
+    else if (outline_font == FONT_OUTLINE_AUTO) {
+        if (outline_color == mask_color)
+            return false;
+        text_bottom += get_outline_adjustment(usingfont);
+    }
+    // wouttextxy skips the text starting below the clipping rectangle, even
+    // though a part of it could have been drawn there
+    return text_bottom <= ds->GetClip().Bottom;
+}
+
+// Gets the margin around the text in its cached image, which is wide enough
+// for any glyph parts that stick out of the text's box
+static int get_text_run_margin(int usingfont) {
+    int margin = getfontheight(usingfont) + abs(get_font_yoffset(usingfont));
+    const int outline_font = get_font_outline(usingfont);
+    if (outline_font >= 0)
+        margin = Math::Max(margin, getfontheight(outline_font) + abs(get_font_yoffset(outline_font)));
+    return margin + get_outline_adjustment(usingfont);
+}
+
+void wouttext_outline(Common::Bitmap *ds, int xxp, int yyp, int usingfont, color_t text_color, const char *texx) {
+
+    color_t outline_color = ds->GetCompatibleColor(play.speech_text_shadow);
+    if (!can_use_text_cache(ds, yyp, usingfont, text_color, outline_color, texx)) {
+        draw_text_outlined(ds, xxp, yyp, usingfont, text_color, outline_color, texx);
+        return;
+    }
+
+    const int depth = ds->GetColorDepth();
+    const int margin = get_text_run_margin(usingfont);
+    Bitmap *run = textcache_get(usingfont, text_color, outline_color, depth, texx);
+    bool cached = run != NULL;
+    if (!run) {
+        run = BitmapHelper::CreateTransparentBitmap(wgettextwidth_compensate(texx, usingfont) + margin * 2,
+            getfontheight_outlined(usingfont) + margin * 2, depth);
+        draw_text_outlined(run, margin, margin, usingfont, text_color, outline_color, texx);
+        cached = textcache_put(usingfont, text_color, outline_color, depth, texx, run);
+    }
+    ds->Blit(run, 0, 0, xxp - margin, yyp - margin, run->GetWidth(), run->GetHeight(), Common::kBitmap_Transparency);
+    if (!cached)
+        delete run;
+}
+
 void wouttext_aligned (Bitmap *ds, int usexp, int yy, int oriwid, int usingfont, color_t text_color, const char *text, int align) {
 
     if (align == SCALIGN_CENTRE)
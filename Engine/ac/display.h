@@ -30,6 +30,8 @@ void wouttext_outline(Common::Bitmap *ds, int xxp, int yyp, int usingfont, color
 void wouttext_aligned (Common::Bitmap *ds, int usexp, int yy, int oriwid, int usingfont, color_t text_color, const char *text, int align);
 // TODO: GUI classes located in Common library do not make use of outlining,
 // need to find a way to make all code use same functions.
+// Get the extra height that automatic outline adds to the font
+int get_outline_adjustment(int font);
 // Get the maximal height of the given font, with possible outlining in mind
 int getfontheight_outlined(int font);
 // Get line spacing for the given font, with possible outlining in mind
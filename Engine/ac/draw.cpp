@@ -18,6 +18,7 @@
 #include "util/compress.h"
 #include "ac/view.h"
 #include "ac/charactercache.h"
+#include "ac/characterindex.h"
 #include "ac/characterextras.h"
 #include "ac/characterinfo.h"
 #include "ac/display.h"
@@ -49,8 +50,10 @@
 #include "ac/dynobj/scriptsystem.h"
 #include "debug/debugger.h"
 #include "debug/debug_log.h"
+#include "debug/profiler.h"
 #include "font/fonts.h"
 #include "gui/guimain.h"
+#include "main/replay_bench.h"
 #include "media/audio/audio.h"
 #include "media/audio/soundclip.h"
 #include "platform/base/agsplatformdriver.h"
@@ -61,6 +64,8 @@
 #include "gfx/graphicsdriver.h"
 #include "gfx/ali3dexception.h"
 #include "gfx/blender.h"
+#include "gfx/blend_kernels.h"
+#include "util/math.h"
 
 using namespace AGS::Common;
 using namespace AGS::Engine;
@@ -811,6 +816,7 @@ void render_to_screen(Bitmap *toRender, int atx, int aty) {
     // in a window
     gfxDriver->EnableVsyncBeforeRender((scsystem.vsync > 0) && (!scsystem.windowed));
 
+    ReplayBench::Phase last_phase = ReplayBench::SetPhase(ReplayBench::kPhase_Render);
     bool succeeded = false;
     while (!succeeded)
     {
@@ -833,6 +839,7 @@ void render_to_screen(Bitmap *toRender, int atx, int aty) {
             platform->Delay(500);
         }
     }
+    ReplayBench::SetPhase(last_phase);
 }
 
 
@@ -1794,11 +1801,20 @@ void tint_image (Bitmap *ds, Bitmap *srcimg, int red, int grn, int blu, int ligh
         set_blender_mode (_myblender_color15, _myblender_color16, _myblender_color32, red, grn, blu, 0);
     else
         set_blender_mode (_myblender_color15_light, _myblender_color16_light, _myblender_color32_light, red, grn, blu, 0);
+    // same blender for the row kernels
+    const int depth = srcimg->GetColorDepth();
+    BLENDER_FUNC tint_blender;
+    if (luminance >= 250)
+        tint_blender = depth == 15 ? _myblender_color15 : (depth == 16 ? _myblender_color16 : _myblender_color32);
+    else
+        tint_blender = depth == 15 ? _myblender_color15_light : (depth == 16 ? _myblender_color16_light : _myblender_color32_light);
+    const int tint_color = makecol_depth(depth, red, grn, blu);
 
     if (light_level >= 100) {
         // fully colourised
         ds->FillTransparent();
-        ds->LitBlendBlt(srcimg, 0, 0, luminance);
+        if (!BlendKernels::LitBlendBlt(ds, srcimg, 0, 0, tint_blender, tint_color, luminance))
+            ds->LitBlendBlt(srcimg, 0, 0, luminance);
     }
     else {
         // light_level is between -100 and 100 normally; 0-100 in
@@ -1810,11 +1826,17 @@ void tint_image (Bitmap *ds, Bitmap *srcimg, int red, int grn, int blu, int ligh
         // Render the colourised image to a temporary bitmap,
         // then transparently draw it over the original image
         Bitmap *finaltarget = BitmapHelper::CreateTransparentBitmap(srcimg->GetWidth(), srcimg->GetHeight(), srcimg->GetColorDepth());
-        finaltarget->LitBlendBlt(srcimg, 0, 0, luminance);
+        if (!BlendKernels::LitBlendBlt(finaltarget, srcimg, 0, 0, tint_blender, tint_color, luminance))
+            finaltarget->LitBlendBlt(srcimg, 0, 0, luminance);
 
         // customized trans blender to preserve alpha channel
-        set_my_trans_blender (0, 0, 0, light_level);
-        ds->TransBlendBlt (finaltarget, 0, 0);
+        const BlendKernels::BlendOp blend_op = depth == 32 ? BlendKernels::kBlendOp_TransKeepAlpha32 :
+            (depth == 16 ? BlendKernels::kBlendOp_Trans16 : BlendKernels::kBlendOp_Trans15);
+        if (!BlendKernels::BlendBlt(ds, finaltarget, 0, 0, blend_op, light_level))
+        {
+            set_my_trans_blender (0, 0, 0, light_level);
+            ds->TransBlendBlt (finaltarget, 0, 0);
+        }
         delete finaltarget;
     }
 }
@@ -1826,12 +1848,14 @@ void prepare_characters_for_drawing() {
     int zoom_level,newwidth,newheight,onarea,sppic,atxp,atyp,useindx;
     int light_level,coldept,aa;
     int tint_red, tint_green, tint_blue, tint_amount, tint_light = 255;
+    Profiler::Zone zone("prepare_characters_for_drawing");
 
     our_eip=33;
     // draw characters
-    for (aa=0;aa<game.numcharacters;aa++) {
+    const std::vector<int> &room_chars = charindex_get_room(displayed_room);
+    for (size_t i = 0; i < room_chars.size(); i++) {
+        aa = room_chars[i];
         if (game.chars[aa].on==0) continue;
-        if (game.chars[aa].room!=displayed_room) continue;
         eip_guinum = aa;
         useindx = aa + MAX_INIT_SPR;
 
@@ -1901,6 +1925,7 @@ void prepare_characters_for_drawing() {
         our_eip = 3330;
         int isMirrored = 0, specialpic = sppic;
         bool usingCachedImage = false;
+        bool cachedUnderWalkBehinds = false;
 
         coldept = spriteset[sppic]->GetColorDepth();
 
@@ -1927,8 +1952,9 @@ void prepare_characters_for_drawing() {
         {
             if (walkBehindMethod == DrawOverCharSprite)
             {
-                actsps[useindx] = recycle_bitmap(actsps[useindx], charcache[aa].image->GetColorDepth(), charcache[aa].image->GetWidth(), charcache[aa].image->GetHeight());
-                actsps[useindx]->Blit (charcache[aa].image, 0, 0, 0, 0, actsps[useindx]->GetWidth(), actsps[useindx]->GetHeight());
+                // walk-behinds are drawn over the copy of the cached image,
+                // which is only made once the character's position is known
+                cachedUnderWalkBehinds = true;
             }
             else 
             {
@@ -2032,8 +2058,33 @@ void prepare_characters_for_drawing() {
 
         int bgX = atxp + offsetx + chin->pic_xoffs;
         int bgY = atyp + offsety + chin->pic_yoffs;
+        int noWalkBehinds = (chin->flags & CHF_NOWALKBEHINDS) != 0;
 
-        if (chin->flags & CHF_NOWALKBEHINDS) {
+        if (cachedUnderWalkBehinds)
+        {
+            // if the character has not moved, the image made last time,
+            // walk-behinds included, is still valid
+            if ((charcache[aa].xwas == bgX) &&
+                (charcache[aa].ywas == bgY) &&
+                (charcache[aa].baselinewas == usebasel) &&
+                (charcache[aa].nowalkbehindswas == noWalkBehinds) &&
+                (actsps[useindx] != NULL) &&
+                (walk_behind_baselines_changed == 0))
+            {
+                usingCachedImage = true;
+            }
+            else
+            {
+                actsps[useindx] = recycle_bitmap(actsps[useindx], charcache[aa].image->GetColorDepth(), charcache[aa].image->GetWidth(), charcache[aa].image->GetHeight());
+                actsps[useindx]->Blit (charcache[aa].image, 0, 0, 0, 0, actsps[useindx]->GetWidth(), actsps[useindx]->GetHeight());
+            }
+        }
+        charcache[aa].xwas = bgX;
+        charcache[aa].ywas = bgY;
+        charcache[aa].baselinewas = usebasel;
+        charcache[aa].nowalkbehindswas = noWalkBehinds;
+
+        if (noWalkBehinds) {
             // ignore walk-behinds, do nothing
             if (walkBehindMethod == DrawAsSeparateSprite)
             {
@@ -2044,7 +2095,7 @@ void prepare_characters_for_drawing() {
         {
             sort_out_char_sprite_walk_behind(useindx, bgX, bgY, usebasel, charextra[aa].zoom, newwidth, newheight);
         }
-        else if (walkBehindMethod == DrawOverCharSprite)
+        else if ((!usingCachedImage) && (walkBehindMethod == DrawOverCharSprite))
         {
             sort_out_walk_behinds(actsps[useindx], bgX, bgY, usebasel);
         }
@@ -2127,7 +2178,7 @@ void draw_screen_background(Bitmap *ds) {
     if (play.screen_tint >= 0)
         invalidate_screen();
 
-    if (gfxDriver->RequiresFullRedrawEachFrame())
+    if (gfxDriver->RequiresFullRedrawEachFrame() || gfxDriver->UsesDirtyRects())
     {
         if (roomBackgroundBmp == NULL) 
         {
@@ -2213,10 +2264,60 @@ void draw_fps()
     draw_and_invalidate_text(ds, get_fixed_pixel_size(250), yp, FONT_SPEECH, text_color, tbuffer);
 }
 
+// Draws the frame profiler's zone times in the upper left corner
+void draw_profiler()
+{
+    static IDriverDependantBitmap* ddb = NULL;
+    static Bitmap *profDisplay = NULL;
+    static std::vector<Profiler::ZoneStat> stats;
+
+    const int max_lines = 16;
+    float frame_ms = Profiler::GetZoneStats(stats);
+    if (stats.size() > (size_t)(max_lines - 1))
+        stats.resize(max_lines - 1);
+
+    char lines[max_lines][100];
+    int line_count = 0;
+    sprintf(lines[line_count++], "Frame: %.2f ms", frame_ms);
+    for (size_t i = 0; i < stats.size(); ++i)
+        sprintf(lines[line_count++], "%*s%s: %.2f ms", (stats[i].Depth + 1) * 2, "", stats[i].Name, stats[i].AverageMs);
+
+    const int font = FONT_SPEECH;
+    const int line_height = getfontheight_outlined(font) + get_fixed_pixel_size(1);
+    int width = 0;
+    for (int i = 0; i < line_count; ++i)
+        width = Math::Max(width, wgettextwidth_compensate(lines[i], font));
+    width += get_fixed_pixel_size(2);
+    const int height = line_count * line_height + get_fixed_pixel_size(2);
+
+    if (profDisplay == NULL || profDisplay->GetWidth() != width || profDisplay->GetHeight() != height)
+    {
+        if (ddb)
+            gfxDriver->DestroyDDB(ddb);
+        ddb = NULL;
+        delete profDisplay;
+        profDisplay = BitmapHelper::CreateBitmap(width, height, System_GetColorDepth());
+        profDisplay = ReplaceBitmapWithSupportedFormat(profDisplay);
+    }
+    profDisplay->ClearTransparent();
+    color_t text_color = profDisplay->GetCompatibleColor(14);
+    for (int i = 0; i < line_count; ++i)
+        wouttext_outline(profDisplay, 1, 1 + i * line_height, font, text_color, lines[i]);
+
+    if (ddb == NULL)
+        ddb = gfxDriver->CreateDDBFromBitmap(profDisplay, false);
+    else
+        gfxDriver->UpdateDDBFromBitmap(ddb, profDisplay, false);
+
+    gfxDriver->DrawSprite(0, 0, ddb);
+    invalidate_sprite(0, 0, ddb);
+}
+
 // draw_screen_overlay: draws any stuff currently on top of the background,
 // like a message box or popup interface
 void draw_screen_overlay() {
     int gg;
+    Profiler::Zone zone("draw_screen_overlay");
 
     add_thing_to_draw(NULL, AGSE_PREGUIDRAW, 0, TRANS_RUN_PLUGIN, false);
 
@@ -2251,45 +2352,49 @@ void draw_screen_overlay() {
         }*/
         our_eip = 37;
         if (guis_need_update) {
-            //Bitmap *abufwas = ds;
+            // global request, redraw all guis
             guis_need_update = 0;
-            for (aa=0;aa<game.numgui;aa++) {
-                if (!guis[aa].IsVisible()) continue;
-
-                if (guibg[aa] == NULL)
-                    recreate_guibg_image(&guis[aa]);
-
-                eip_guinum = aa;
-                our_eip = 370;
-                guibg[aa]->ClearTransparent();
-                //ds = guibg[aa];
-                our_eip = 372;
-                guis[aa].DrawAt(guibg[aa], 0,0);
-                our_eip = 373;
-
-                bool isAlpha = false;
-                if (guis[aa].HasAlphaChannel()) 
-                {
-                    isAlpha = true;
+            for (aa=0;aa<game.numgui;aa++)
+                guis[aa].MarkChanged();
+        }
+        for (aa=0;aa<game.numgui;aa++) {
+            if (!guis[aa].IsVisible()) continue;
 
-                    if ((game.options[OPT_NEWGUIALPHA] == kGuiAlphaRender_Classic) && (guis[aa].BgImage > 0))
-                    {
-                        // old-style (pre-3.0.2) GUI alpha rendering
-                        repair_alpha_channel(guibg[aa], spriteset[guis[aa].BgImage]);
-                    }
-                }
+            if (guibg[aa] == NULL)
+                recreate_guibg_image(&guis[aa]);
+            // hidden guis keep their changed state until shown
+            if (!guis[aa].HasChanged()) continue;
+            guis[aa].ClearChanged();
+
+            eip_guinum = aa;
+            our_eip = 370;
+            guibg[aa]->ClearTransparent();
+            //ds = guibg[aa];
+            our_eip = 372;
+            guis[aa].DrawAt(guibg[aa], 0,0);
+            our_eip = 373;
+
+            bool isAlpha = false;
+            if (guis[aa].HasAlphaChannel()) 
+            {
+                isAlpha = true;
 
-                if (guibgbmp[aa] != NULL) 
-                {
-                    gfxDriver->UpdateDDBFromBitmap(guibgbmp[aa], guibg[aa], isAlpha);
-                }
-                else
+                if ((game.options[OPT_NEWGUIALPHA] == kGuiAlphaRender_Classic) && (guis[aa].BgImage > 0))
                 {
-                    guibgbmp[aa] = gfxDriver->CreateDDBFromBitmap(guibg[aa], isAlpha);
+                    // old-style (pre-3.0.2) GUI alpha rendering
+                    repair_alpha_channel(guibg[aa], spriteset[guis[aa].BgImage]);
                 }
-                our_eip = 374;
             }
-            //ds = abufwas;
+
+            if (guibgbmp[aa] != NULL) 
+            {
+                gfxDriver->UpdateDDBFromBitmap(guibgbmp[aa], guibg[aa], isAlpha);
+            }
+            else
+            {
+                guibgbmp[aa] = gfxDriver->CreateDDBFromBitmap(guibg[aa], isAlpha);
+            }
+            our_eip = 374;
         }
         our_eip = 38;
         // Draw the GUIs
@@ -2375,6 +2480,10 @@ void draw_misc_info()
     {
         draw_fps();
     }
+    if (Profiler::IsOverlayShown())
+    {
+        draw_profiler();
+    }
 
     Bitmap *ds = GetVirtualScreen();
 
@@ -2557,6 +2666,17 @@ void update_screen() {
 extern volatile int psp_audio_multithreaded; // in ac_audio
 
 
+// Tells if the renderer may be left to find out which parts of the screen
+// have to be redrawn; this is only possible if the room is drawn as sprites
+// and nothing is drawn right onto the virtual screen: neither on-screen debug
+// info, nor plugins.
+bool can_use_dirty_rects()
+{
+    return usetup.dirty_rects && displayed_room >= 0 &&
+        !display_fps && !play.recording && !play.playback &&
+        !pl_any_want_hook(AGSE_PRESCREENDRAW | AGSE_PREGUIDRAW | AGSE_POSTSCREENDRAW | AGSE_FINALSCREENDRAW);
+}
+
 void construct_virtual_screen(bool fullRedraw) 
 {
     gfxDriver->ClearDrawList();
@@ -2564,6 +2684,8 @@ void construct_virtual_screen(bool fullRedraw)
     if (play.fast_forward)
         return;
 
+    gfxDriver->UseDirtyRects(can_use_dirty_rects());
+
     our_eip=3;
 
     Bitmap *ds = GetVirtualScreen();
@@ -88,12 +88,8 @@ void DrawingSurface_Release(ScriptDrawingSurface* sds)
             }
             for (tt = 0; tt < game.numgui; tt++) 
             {
-                if ((guis[tt].BgImage == sds->dynamicSpriteNumber) &&
-                    (guis[tt].IsVisible()))
-                {
-                    guis_need_update = 1;
-                    break;
-                }
+                if (guis[tt].BgImage == sds->dynamicSpriteNumber)
+                    guis[tt].MarkChanged();
             }
         }
 
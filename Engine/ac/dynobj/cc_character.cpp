@@ -13,6 +13,7 @@
 //=============================================================================
 
 #include "ac/dynobj/cc_character.h"
+#include "ac/characterindex.h"
 #include "ac/characterinfo.h"
 #include "ac/global_character.h"
 #include "ac/gamesetupstruct.h"
@@ -40,6 +41,17 @@ void CCCharacter::Unserialize(int index, const char *serializedData, int dataSiz
     ccRegisterUnserializedObject(index, &game.chars[num], this);
 }
 
+void CCCharacter::WriteInt32(const char *address, intptr_t offset, int32_t val)
+{
+    *(int32_t*)(address + offset) = val;
+
+    // Old-style scripts may move the character to another room by assigning
+    // the field directly
+    const int roomoffset = 12;
+    if (offset == roomoffset)
+        charindex_update(((CharacterInfo*)address)->index_id);
+}
+
 void CCCharacter::WriteInt16(const char *address, intptr_t offset, int16_t val)
 {
     *(int16_t*)(address + offset) = val;
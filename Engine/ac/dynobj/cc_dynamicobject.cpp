@@ -56,6 +56,15 @@ int32_t ccRegisterManagedObject(const void *object, ICCDynamicObject *callback,
     return handl;
 }
 
+int32_t ccRegisterPersistentObject(const void *object, ICCDynamicObject *callback) {
+    int32_t handl = pool.AddObject((const char*)object, callback, false, -1, false);
+
+    ManagedObjectLog("Register persistent object type '%s' handle=%d addr=%08X",
+        ((callback == NULL) ? "(unknown)" : callback->GetType()), handl, object);
+
+    return handl;
+}
+
 // register a de-serialized object
 int32_t ccRegisterUnserializedObject(int index, const void *object, ICCDynamicObject *callback, bool plugin_object) {
     return pool.AddObject((const char*)object, callback, plugin_object, index);
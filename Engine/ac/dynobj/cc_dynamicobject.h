@@ -65,6 +65,9 @@ extern void  ccSetStringClassImpl(ICCStringClass *theClass);
 // register a memory handle for the object and allow script
 // pointers to point to it
 extern int32_t ccRegisterManagedObject(const void *object, ICCDynamicObject *, bool plugin_object = false);
+// register the object which is never disposed by its manager, such as
+// the game's characters or GUIs; it is not checked for garbage when created
+extern int32_t ccRegisterPersistentObject(const void *object, ICCDynamicObject *);
 // register a de-serialized object
 extern int32_t ccRegisterUnserializedObject(int index, const void *object, ICCDynamicObject *, bool plugin_object = false);
 // unregister a particular object
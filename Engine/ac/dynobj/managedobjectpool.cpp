@@ -22,8 +22,10 @@
 #include "script/cc_error.h"
 #include "script/script_common.h"
 #include "util/stream.h"
+#include "util/clock.h"
 
 using namespace AGS::Common;
+using namespace AGS::Engine;
 
 void ManagedObjectPool::ManagedObject::init(int32_t theHandle, const char *theAddress,
                                             ICCDynamicObject *theCallback, ScriptValueType objType) {
@@ -55,21 +57,6 @@ int ManagedObjectPool::ManagedObject::AddRef() {
     return ++refCount;
 }
 
-int ManagedObjectPool::ManagedObject::CheckDispose() {
-    if ((refCount < 1) && (callback != NULL)) {
-        if (remove(false))
-            return 1;
-    }
-    return 0;
-}
-
-int ManagedObjectPool::ManagedObject::SubRef() {
-    refCount--;
-    ManagedObjectLog("Line %d SubRef: handle=%d new refcount=%d", currentline, handle, refCount);
-
-    return CheckDispose();
-}
-
 void ManagedObjectPool::ManagedObject::SubRefNoDispose() {
     refCount--;
     ManagedObjectLog("Line %d SubRefNoDispose: handle=%d new refcount=%d", currentline, handle, refCount);
@@ -80,32 +67,127 @@ int32_t ManagedObjectPool::AddRef(int32_t handle) {
 }
 
 int ManagedObjectPool::CheckDispose(int32_t handle) {
-    return objects[handle].CheckDispose();
+    if ((objects[handle].refCount < 1) && (objects[handle].callback != NULL))
+        return Remove(handle, false);
+    return 0;
 }
 
 int32_t ManagedObjectPool::SubRef(int32_t handle) {
-    if ((disableDisposeForObject != NULL) && 
-        (objects[handle].addr == disableDisposeForObject))
-        objects[handle].SubRefNoDispose();
-    else
-        objects[handle].SubRef();
+    objects[handle].SubRefNoDispose();
+    if ((disableDisposeForObject == NULL) ||
+        (objects[handle].addr != disableDisposeForObject))
+        CheckDispose(handle);
+    else if (objects[handle].refCount < 1)
+        QueueForCollection(handle);
     return objects[handle].refCount;
 }
 
+// Hash of the object address; the lowest bits are mostly zero due to alignment
+static inline size_t AddressHash(const char *addr) {
+    size_t key = (size_t)addr;
+    return (key >> 3) ^ (key >> 11) ^ (key >> 19);
+}
+
 int32_t ManagedObjectPool::AddressToHandle(const char *addr) {
-    // this function is only called when a pointer is set
-    // SLOW LOOP ALERT, improve at some point
-    // [IKM] 2013-01-01: search in reverse order, as suggested by rofl0r:
-    // it appears that, statistically, the given address is more often
-    // located closer to the end of the managed array.
-    for (size_t i = numObjects - 1; i >= 1; --i)
+    // this function is called whenever a pointer is set
+    if (addr == NULL)
+        return 0;
+    const size_t mask = addrIndexSize - 1;
+    for (size_t i = AddressHash(addr) & mask; addrIndex[i] != 0; i = (i + 1) & mask)
     {
-        if (objects[i].addr == addr)
+        if (addrIndex[i] > 0 && objects[addrIndex[i]].addr == addr)
+            return addrIndex[i];
+    }
+    return 0;
+}
+
+void ManagedObjectPool::IndexAdd(int32_t handle) {
+    const char *addr = objects[handle].addr;
+    if (addr == NULL)
+        return;
+    // keep load factor (including deleted entries) under 3/4
+    if ((addrIndexUsed + 1) * 4 > addrIndexSize * 3)
+        IndexRebuild((addrIndexCount + 1) * 2 > addrIndexSize / 2 ? addrIndexSize * 2 : addrIndexSize);
+
+    const size_t mask = addrIndexSize - 1;
+    int deleted_slot = -1;
+    size_t i = AddressHash(addr) & mask;
+    for (; addrIndex[i] != 0; i = (i + 1) & mask)
+    {
+        if (addrIndex[i] < 0)
+        {
+            if (deleted_slot < 0)
+                deleted_slot = i;
+        }
+        else if (objects[addrIndex[i]].addr == addr)
         {
-            return objects[i].handle;
+            // same address registered again: the latest handle wins
+            addrIndex[i] = handle;
+            return;
         }
     }
-    return 0;
+    if (deleted_slot >= 0)
+    {
+        addrIndex[deleted_slot] = handle;
+    }
+    else
+    {
+        addrIndex[i] = handle;
+        addrIndexUsed++;
+    }
+    addrIndexCount++;
+}
+
+void ManagedObjectPool::IndexRemove(const char *addr, int32_t handle) {
+    if (addr == NULL)
+        return;
+    const size_t mask = addrIndexSize - 1;
+    for (size_t i = AddressHash(addr) & mask; addrIndex[i] != 0; i = (i + 1) & mask)
+    {
+        if (addrIndex[i] == handle)
+        {
+            addrIndex[i] = -1;
+            addrIndexCount--;
+            return;
+        }
+    }
+}
+
+void ManagedObjectPool::IndexRebuild(int new_size) {
+    free(addrIndex);
+    addrIndexSize = new_size;
+    addrIndex = (int32_t*)calloc(sizeof(int32_t), addrIndexSize);
+    addrIndexCount = 0;
+    addrIndexUsed = 0;
+    for (int i = 1; i < numObjects; i++)
+    {
+        if (objects[i].handle)
+            IndexAdd(i);
+    }
+}
+
+void ManagedObjectPool::IndexClear() {
+    memset(addrIndex, 0, sizeof(int32_t) * addrIndexSize);
+    addrIndexCount = 0;
+    addrIndexUsed = 0;
+}
+
+static void PushHandle(int32_t *&arr, int &count, int &alloc, int32_t handle) {
+    if (count == alloc)
+    {
+        alloc += ARRAY_INCREMENT_SIZE;
+        arr = (int32_t*)realloc(arr, sizeof(int32_t) * alloc);
+    }
+    arr[count++] = handle;
+}
+
+void ManagedObjectPool::QueueForCollection(int32_t handle) {
+    // the flag stays set when the object is removed, so that the slot is
+    // queued only once even if it is reused before its entry is processed
+    if (objects[handle].gcQueued)
+        return;
+    objects[handle].gcQueued = true;
+    PushHandle(gcQueue, gcQueueCount, gcQueueAlloc, handle);
 }
 
 const char* ManagedObjectPool::HandleToAddress(int32_t handle) {
@@ -135,7 +217,17 @@ int ManagedObjectPool::RemoveObject(const char *address) {
     if (handl == 0)
         return 0;
 
-    objects[handl].remove(true);
+    Remove(handl, true);
+    return 1;
+}
+
+int ManagedObjectPool::Remove(int32_t handle, bool force) {
+    const char *addr = objects[handle].addr;
+    if (!objects[handle].remove(force))
+        return 0;
+    IndexRemove(addr, handle);
+    PushHandle(freeHandles, numFreeHandles, freeHandlesAlloc, handle);
+    numAlive--;
     return 1;
 }
 
@@ -148,20 +240,76 @@ void ManagedObjectPool::RunGarbageCollectionIfAppropriate()
     }
 }
 
+void ManagedObjectPool::RunGarbageCollectionStep()
+{
+    if (gcQueueCount == 0)
+    {
+        gcStats.LastSwept = 0;
+        gcStats.LastDisposed = 0;
+        gcStats.LastTime = 0;
+        return;
+    }
+
+    int64_t start_time = GetClockMicroseconds();
+    // make sure the queue does not grow faster than it's processed
+    int budget = gcQueueCount / 4 > GARBAGE_COLLECTION_STEP_BUDGET ? gcQueueCount / 4 : GARBAGE_COLLECTION_STEP_BUDGET;
+    int swept = 0;
+    int disposed = 0;
+    // objects which refuse to be disposed are dropped from the queue; they
+    // are queued again when their reference count drops to zero once more,
+    // and are checked by the full collection meanwhile
+    for (; swept < budget && gcQueueCount > 0; swept++)
+    {
+        int32_t handle = gcQueue[--gcQueueCount];
+        objects[handle].gcQueued = false;
+        if (objects[handle].handle == 0)
+            continue;
+        if (CheckDispose(handle))
+            disposed++;
+    }
+
+    gcStats.LastSwept = swept;
+    gcStats.LastDisposed = disposed;
+    gcStats.LastTime = GetClockMicroseconds() - start_time;
+    gcStats.TotalDisposed += disposed;
+    gcStats.TotalTime += gcStats.LastTime;
+}
+
 void ManagedObjectPool::RunGarbageCollection()
 {
     ManagedObjectLog("Running garbage collection");
 
+    // all the queued objects are going to be checked now
+    for (int i = 0; i < gcQueueCount; i++)
+        objects[gcQueue[i]].gcQueued = false;
+    gcQueueCount = 0;
+
     for (int i = 1; i < numObjects; i++) 
     {
         if ((objects[i].refCount < 1) && (objects[i].callback != NULL)) 
         {
-            objects[i].remove(false);
+            Remove(i, false);
         }
     }
 }
 
-int ManagedObjectPool::AddObject(const char *address, ICCDynamicObject *callback, bool plugin_object, int useSlot) {
+const ManagedObjectPool::GCStats &ManagedObjectPool::GetGCStats()
+{
+    gcStats.ObjectsAlive = numAlive;
+    gcStats.QueueLength = gcQueueCount;
+    return gcStats;
+}
+
+void ManagedObjectPool::InitObject(int32_t handle, const char *address, ICCDynamicObject *callback, bool plugin_object, bool collectable) {
+    objects[handle].init(handle, address, callback, plugin_object ? kScValPluginObject : kScValDynamicObject);
+    IndexAdd(handle);
+    numAlive++;
+    // new objects are not referenced by anything yet
+    if (collectable)
+        QueueForCollection(handle);
+}
+
+int ManagedObjectPool::AddObject(const char *address, ICCDynamicObject *callback, bool plugin_object, int useSlot, bool collectable) {
     if (useSlot == -1)
         useSlot = numObjects;
 
@@ -169,7 +317,7 @@ int ManagedObjectPool::AddObject(const char *address, ICCDynamicObject *callback
 
     if (useSlot < arrayAllocLimit) {
         // still space in the array, so use it
-        objects[useSlot].init(useSlot, address, callback, plugin_object ? kScValPluginObject : kScValDynamicObject);
+        InitObject(useSlot, address, callback, plugin_object, collectable);
         if (useSlot == numObjects)
             numObjects++;
         return useSlot;
@@ -177,23 +325,25 @@ int ManagedObjectPool::AddObject(const char *address, ICCDynamicObject *callback
     else {
         // array has been used up
         if (useSlot == numObjects) {
-            // if adding new (not un-serializing) check for empty slot
-            // check backwards, since newer objects don't tend to last
-            // long
-            for (int i = arrayAllocLimit - 1; i >= 1; i--) {
+            // if adding new (not un-serializing) reuse the recently released
+            // slot, since newer objects don't tend to last long
+            while (numFreeHandles > 0) {
+                int32_t i = freeHandles[--numFreeHandles];
+                // the slot might have been taken by the un-serialized object
                 if (objects[i].handle == 0) {
-                    objects[i].init(i, address, callback, plugin_object ? kScValPluginObject : kScValDynamicObject);
+                    InitObject(i, address, callback, plugin_object, collectable);
                     return i;
                 }
             }
         }
         // no empty slots, expand array
+        int oldAllocLimit = arrayAllocLimit;
         while (useSlot >= arrayAllocLimit)
             arrayAllocLimit += ARRAY_INCREMENT_SIZE;
 
         objects = (ManagedObject*)realloc(objects, sizeof(ManagedObject) * arrayAllocLimit);
-        memset(&objects[useSlot], 0, sizeof(ManagedObject) * ARRAY_INCREMENT_SIZE);
-        objects[useSlot].init(useSlot, address, callback, plugin_object ? kScValPluginObject : kScValDynamicObject);
+        memset(&objects[oldAllocLimit], 0, sizeof(ManagedObject) * (arrayAllocLimit - oldAllocLimit));
+        InitObject(useSlot, address, callback, plugin_object, collectable);
         if (useSlot == numObjects)
             numObjects++;
         return useSlot;
@@ -284,6 +434,13 @@ int ManagedObjectPool::ReadFromDisk(Stream *in, ICCObjectReader *reader) {
         }
     }
 
+    // gather the slots which were left empty
+    numFreeHandles = 0;
+    for (int i = 1; i < numObjs; i++) {
+        if (objects[i].handle == 0)
+            PushHandle(freeHandles, numFreeHandles, freeHandlesAlloc, i);
+    }
+
     free(serializeBuffer);
     return 0;
 }
@@ -296,12 +453,28 @@ void ManagedObjectPool::reset() {
     }
     memset(&objects[0], 0, sizeof(ManagedObject) * arrayAllocLimit);
     numObjects = 1;
+    IndexClear();
+    numFreeHandles = 0;
+    gcQueueCount = 0;
+    numAlive = 0;
 }
 
 ManagedObjectPool::ManagedObjectPool() {
     numObjects = 1;
     arrayAllocLimit = 10;
     objects = (ManagedObject*)calloc(sizeof(ManagedObject), arrayAllocLimit);
+    addrIndexSize = 64;
+    addrIndex = (int32_t*)calloc(sizeof(int32_t), addrIndexSize);
+    addrIndexCount = 0;
+    addrIndexUsed = 0;
+    freeHandles = NULL;
+    numFreeHandles = 0;
+    freeHandlesAlloc = 0;
+    gcQueue = NULL;
+    gcQueueCount = 0;
+    gcQueueAlloc = 0;
+    numAlive = 0;
+    memset(&gcStats, 0, sizeof(gcStats));
     disableDisposeForObject = NULL;
 }
 
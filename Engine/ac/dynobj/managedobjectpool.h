@@ -24,21 +24,33 @@ using namespace AGS; // FIXME later
 #define SERIALIZE_BUFFER_SIZE 10240
 const int ARRAY_INCREMENT_SIZE = 100;
 const int GARBAGE_COLLECTION_INTERVAL = 100;
+// Minimal number of queued objects checked by the incremental collection step
+const int GARBAGE_COLLECTION_STEP_BUDGET = 200;
 
 struct ManagedObjectPool {
+    // Garbage collection statistics
+    struct GCStats {
+        int     ObjectsAlive;   // number of registered objects
+        int     QueueLength;    // number of objects waiting to be checked
+        int     LastSwept;      // objects checked by the last collection step
+        int     LastDisposed;   // objects disposed by the last collection step
+        int64_t LastTime;       // time spent in the last step, in microseconds
+        int64_t TotalDisposed;
+        int64_t TotalTime;
+    };
+
     struct ManagedObject {
         ScriptValueType obj_type;
         int32_t handle;
         const char *addr;
         ICCDynamicObject * callback;
         int  refCount;
+        bool gcQueued; // is in the garbage collection queue
 
         void init(int32_t theHandle, const char *theAddress,
             ICCDynamicObject *theCallback, ScriptValueType objType);
         int remove(bool force);
         int AddRef();
-        int CheckDispose();
-        int SubRef();
         void SubRefNoDispose();
     };
 private:
@@ -48,6 +60,36 @@ private:
     int numObjects;  // not actually numObjects, but the highest index used
     int objectCreationCounter;  // used to do garbage collection every so often
 
+    // Reverse lookup of handles by object address: open-addressed hash table
+    // with linear probing; the size is always a power of two.
+    // Slot values: 0 - empty, -1 - deleted entry, otherwise object handle.
+    int32_t *addrIndex;
+    int addrIndexSize;
+    int addrIndexCount;  // number of valid entries
+    int addrIndexUsed;   // number of valid and deleted entries
+    // Released handles, available for reuse when the object array is full
+    int32_t *freeHandles;
+    int numFreeHandles;
+    int freeHandlesAlloc;
+    // Garbage collection queue: objects that were created, or had their reference
+    // count dropped to zero, but were not disposed yet. Young objects are checked
+    // first, as they are the most likely ones to be garbage. Objects that refuse
+    // to be disposed are not kept in the queue.
+    int32_t *gcQueue;
+    int gcQueueCount;
+    int gcQueueAlloc;
+    int numAlive;
+    GCStats gcStats;
+
+    // Disposes the object and releases its handle
+    int  Remove(int32_t handle, bool force);
+    void InitObject(int32_t handle, const char *address, ICCDynamicObject *callback, bool plugin_object, bool collectable);
+    void IndexAdd(int32_t handle);
+    void IndexRemove(const char *addr, int32_t handle);
+    void IndexRebuild(int new_size);
+    void IndexClear();
+    void QueueForCollection(int32_t handle);
+
 public:
 
     int32_t AddRef(int32_t handle);
@@ -58,8 +100,17 @@ public:
     ScriptValueType HandleToAddressAndManager(int32_t handle, void *&object, ICCDynamicObject *&manager);
     int RemoveObject(const char *address);
     void RunGarbageCollectionIfAppropriate();
+    // Checks a limited number of objects from the collection queue, disposing
+    // unreferenced ones; meant to be called once per game tick, when no script
+    // is running, because running scripts may use objects without references
+    void RunGarbageCollectionStep();
+    // Checks all objects; also run every GARBAGE_COLLECTION_INTERVAL created
+    // objects, in case scripts keep running for long
     void RunGarbageCollection();
-    int AddObject(const char *address, ICCDynamicObject *callback, bool plugin_object, int useSlot = -1);
+    const GCStats &GetGCStats();
+    // Registers the object; collectable objects are queued for the garbage
+    // collection, the others are the ones their manager never disposes
+    int AddObject(const char *address, ICCDynamicObject *callback, bool plugin_object, int useSlot = -1, bool collectable = true);
     void WriteToDisk(Common::Stream *out);
     int ReadFromDisk(Common::Stream *in, ICCObjectReader *reader);
     void reset();
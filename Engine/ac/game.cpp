@@ -53,6 +53,7 @@
 #include "ac/spritecache.h"
 #include "ac/string.h"
 #include "ac/system.h"
+#include "ac/textruncache.h"
 #include "ac/timer.h"
 #include "ac/translation.h"
 #include "ac/dynobj/all_dynamicclasses.h"
@@ -65,6 +66,7 @@
 #include "font/fonts.h"
 #include "game/savegame.h"
 #include "game/savegame_internal.h"
+#include "game/savegame_writer.h"
 #include "gui/animatingguibutton.h"
 #include "gfx/graphicsdriver.h"
 #include "gfx/gfxfilter.h"
@@ -82,6 +84,7 @@
 #include "util/alignedstream.h"
 #include "util/directory.h"
 #include "util/filestream.h"
+#include "util/memorystream.h"
 #include "util/path.h"
 #include "util/string_utils.h"
 
@@ -421,6 +424,8 @@ bool SetSaveGameDirectoryPath(const char *newFolder, bool explicit_path)
     String newSaveGameDir = explicit_path ? String(newFolder) : MakeSaveGameDir(newFolder);
     if (newSaveGameDir.IsEmpty())
         return false;
+    // pending saves must go to the old directory
+    WaitForSavegameWrites();
 
     if (!Directory::CreateDirectory(newSaveGameDir))
         return false;
@@ -600,14 +605,22 @@ void unload_game_file() {
     moduleInstFork.resize(0);
     moduleInst.resize(0);
     scriptModules.resize(0);
-    repExecAlways.moduleHasFunction.resize(0);
-    lateRepExecAlways.moduleHasFunction.resize(0);
-    getDialogOptionsDimensionsFunc.moduleHasFunction.resize(0);
-    renderDialogOptionsFunc.moduleHasFunction.resize(0);
-    getDialogOptionUnderCursorFunc.moduleHasFunction.resize(0);
-    runDialogOptionMouseClickHandlerFunc.moduleHasFunction.resize(0);
-    runDialogOptionKeyPressHandlerFunc.moduleHasFunction.resize(0);
-    runDialogOptionRepExecFunc.moduleHasFunction.resize(0);
+    repExecAlways.moduleFuncAddr.resize(0);
+    lateRepExecAlways.moduleFuncAddr.resize(0);
+    getDialogOptionsDimensionsFunc.moduleFuncAddr.resize(0);
+    renderDialogOptionsFunc.moduleFuncAddr.resize(0);
+    getDialogOptionUnderCursorFunc.moduleFuncAddr.resize(0);
+    runDialogOptionMouseClickHandlerFunc.moduleFuncAddr.resize(0);
+    runDialogOptionKeyPressHandlerFunc.moduleFuncAddr.resize(0);
+    runDialogOptionRepExecFunc.moduleFuncAddr.resize(0);
+    repExecAlways.globalScriptFuncAddr = kScFuncAddr_Unresolved;
+    lateRepExecAlways.globalScriptFuncAddr = kScFuncAddr_Unresolved;
+    getDialogOptionsDimensionsFunc.globalScriptFuncAddr = kScFuncAddr_Unresolved;
+    renderDialogOptionsFunc.globalScriptFuncAddr = kScFuncAddr_Unresolved;
+    getDialogOptionUnderCursorFunc.globalScriptFuncAddr = kScFuncAddr_Unresolved;
+    runDialogOptionMouseClickHandlerFunc.globalScriptFuncAddr = kScFuncAddr_Unresolved;
+    runDialogOptionKeyPressHandlerFunc.globalScriptFuncAddr = kScFuncAddr_Unresolved;
+    runDialogOptionRepExecFunc.globalScriptFuncAddr = kScFuncAddr_Unresolved;
     numScriptModules = 0;
 
     if (game.audioClipCount > 0)
@@ -682,6 +695,7 @@ void unload_game_file() {
     ccRemoveAllSymbols();
     ccUnregisterAllObjects();
 
+    textcache_clear();
     for (ee=0;ee<game.numfonts;ee++)
         wfreefont(ee);
 
@@ -1168,9 +1182,34 @@ void save_game(int slotn, const char*descript) {
     // Screenshot
     create_savegame_screenshot(screenShot);
 
+    // plugins which save their own data expect a real file to write into,
+    // so the game is only saved in the background without them
+    if (usetup.save_in_background && IsSavegameWriterRunning() &&
+        !pl_any_want_hook(AGSE_SAVEGAME))
+    {
+        // collect the game data in memory, and let the writing thread
+        // do the file work
+        std::vector<char> data;
+        Common::PStream mem_out(new Common::MemoryStream(data));
+        StartSavegame(mem_out.get(), descript, screenShot);
+        SaveGameState(mem_out);
+        mem_out.reset();
+        QueueSavegameWrite(slotn, nametouse, data, screenShot);
+        return;
+    }
+
+    // the previous save to this file may still be pending
+    WaitForSavegameWrites();
     Common::PStream out = StartSavegame(nametouse, descript, screenShot);
     if (out == NULL)
-        quit("save_game: unable to open savegame file for writing");
+    {
+        delete screenShot;
+        // games made with the older script API have no event for this
+        if (game.options[OPT_BASESCRIPTAPI] < kScriptAPI_v341)
+            quit("save_game: unable to open savegame file for writing");
+        PushWrittenSavegame(slotn, nametouse, false);
+        return;
+    }
 
     update_polled_stuff_if_runtime();
 
@@ -1185,14 +1224,18 @@ void save_game(int slotn, const char*descript) {
         update_polled_stuff_if_runtime();
 
         out.reset(Common::File::OpenFile(nametouse, Common::kFile_Open, Common::kFile_ReadWrite));
-        out->Seek(12, kSeekBegin);
-        out->WriteInt32(screenShotOffset);
-        out->Seek(4);
-        out->WriteInt32(screenShotSize);
+        if (out != NULL)
+        {
+            out->Seek(12, kSeekBegin);
+            out->WriteInt32(screenShotOffset);
+            out->Seek(4);
+            out->WriteInt32(screenShotSize);
+        }
     }
 
     if (screenShot != NULL)
         delete screenShot;
+    PushWrittenSavegame(slotn, nametouse, out != NULL);
 }
 
 char rbuffer[200];
@@ -33,6 +33,16 @@ GameSetup::GameSetup()
     mouse_control = kMouseCtrl_Fullscreen;
     mouse_speed_def = kMouseSpeed_CurrentDisplay;
     RenderAtScreenRes = false;
+    sprite_prefetch = true;
+    text_cache_size = 1024;
+    room_preload = 2;
+    room_preload_size = 65536;
+    save_in_background = false;
+    dirty_rects = true;
+    render_threads = -1;
+    compose_threads = -1;
+    headless = false;
+    dump_frames = 0;
 
     Screen.DisplayMode.ScreenSize.MatchDeviceRatio = true;
     Screen.DisplayMode.ScreenSize.SizeDef = kScreenDef_MaxDisplay;
@@ -61,6 +61,18 @@ struct GameSetup {
     MouseControl mouse_control;
     MouseSpeedDef mouse_speed_def;
     bool  RenderAtScreenRes; // render sprites at screen resolution, as opposed to native one
+    bool  sprite_prefetch; // load sprites on a background thread ahead of time
+    int   text_cache_size; // memory limit of the rendered text cache, in KB
+    int   room_preload; // max number of rooms loaded ahead of time, 0 to disable
+    int   room_preload_size; // memory limit of the rooms loaded ahead, in KB
+    bool  save_in_background; // write savegame files on a separate thread
+    bool  dirty_rects; // let renderer redraw only the changed parts of the screen
+    int   render_threads; // number of helper threads for software rendering, negative for auto
+    int   compose_threads; // max threads to composite sprites with, negative for all
+    bool  headless; // run with the null renderer and without sound
+    int   dump_frames; // null renderer: save every Nth frame to a file, 0 to disable
+    AGS::Common::String dump_frames_dir; // directory to save frames to
+    AGS::Common::String replay_bench_file; // replay to play back as a benchmark
 
     ScreenSetup Screen;
 
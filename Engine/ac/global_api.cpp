@@ -1227,6 +1227,12 @@ RuntimeScriptValue Sc_scrPlayVideo(const RuntimeScriptValue *params, int32_t par
     API_SCALL_VOID_POBJ_PINT2(scrPlayVideo, const char);
 }
 
+// void (int nrnum)
+RuntimeScriptValue Sc_PreloadRoom(const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_SCALL_VOID_PINT(PreloadRoom);
+}
+
 // void (int dialog)
 RuntimeScriptValue Sc_QuitGame(const RuntimeScriptValue *params, int32_t param_count)
 {
@@ -2470,6 +2476,7 @@ void RegisterGlobalAPI()
 	ccAddExternalStaticFunction("PlaySoundEx",              Sc_PlaySoundEx);
 	ccAddExternalStaticFunction("PlaySpeech",               Sc_scr_play_speech);
 	ccAddExternalStaticFunction("PlayVideo",                Sc_scrPlayVideo);
+	ccAddExternalStaticFunction("PreloadRoom",              Sc_PreloadRoom);
 	ccAddExternalStaticFunction("QuitGame",                 Sc_QuitGame);
 	ccAddExternalStaticFunction("Random",                   Sc_Rand);
 	ccAddExternalStaticFunction("RawClearScreen",           Sc_RawClear);
@@ -2837,6 +2844,7 @@ void RegisterGlobalAPI()
     ccAddExternalFunctionForPlugin("PlaySoundEx",              (void*)PlaySoundEx);
     ccAddExternalFunctionForPlugin("PlaySpeech",               (void*)__scr_play_speech);
     ccAddExternalFunctionForPlugin("PlayVideo",                (void*)scrPlayVideo);
+    ccAddExternalFunctionForPlugin("PreloadRoom",              (void*)PreloadRoom);
     ccAddExternalFunctionForPlugin("ProcessClick",             (void*)ProcessClick);
     ccAddExternalFunctionForPlugin("QuitGame",                 (void*)QuitGame);
     ccAddExternalFunctionForPlugin("Random",                   (void*)__Rand);
@@ -38,12 +38,14 @@
 #include "ac/path_helper.h"
 #include "ac/record.h"
 #include "ac/room.h"
+#include "ac/roompreload.h"
 #include "ac/roomstatus.h"
 #include "ac/roomstruct.h"
 #include "ac/string.h"
 #include "ac/system.h"
 #include "debug/debugger.h"
 #include "debug/debug_log.h"
+#include "game/savegame_writer.h"
 #include "gui/guidialog.h"
 #include "main/engine.h"
 #include "main/game_start.h"
@@ -53,12 +55,14 @@
 #include "script/script.h"
 #include "script/script_runtime.h"
 #include "ac/spritecache.h"
+#include "ac/spriteprefetch.h"
 #include "gfx/graphicsdriver.h"
 #include "core/assetmanager.h"
 #include "main/game_file.h"
 #include "util/string_utils.h"
 
 using namespace AGS::Common;
+using namespace AGS::Engine;
 
 #define ALLEGRO_KEYBOARD_HANDLER
 
@@ -123,6 +127,7 @@ void RestoreGameSlot(int slnum) {
 }
 
 void DeleteSaveSlot (int slnum) {
+    WaitForSavegameWrites();
     String nametouse;
     nametouse = get_save_game_path(slnum);
     unlink (nametouse);
@@ -266,6 +271,7 @@ int RunAGSGame (const char *newgame, unsigned int mode, int data) {
     unload_old_room();
     displayed_room = -10;
 
+    roompreload_clear();
     unload_game_file();
 
     if (Common::AssetManager::SetDataFile(game_file_name) != Common::kAssetNoError)
@@ -279,9 +285,12 @@ int RunAGSGame (const char *newgame, unsigned int mode, int data) {
     if (!load_game_file(err_str))
         quitprintf("!RunAGSGame: error loading new game file:\n%s", err_str.GetCStr());
 
+    spriteprefetch_stop();
     spriteset.reset();
     if (spriteset.initFile ("acsprset.spr"))
         quit("!RunAGSGame: error loading new sprites");
+    if (usetup.sprite_prefetch)
+        spriteprefetch_start("acsprset.spr");
 
     if ((mode & RAGMODE_PRESERVEGLOBALINT) == 0) {
         // reset GlobalInts
@@ -62,7 +62,7 @@ void InterfaceOn(int ifn) {
     debug_script_log("GUIOn(%d) ignored (already on)", ifn);
     return;
   }
-  guis_need_update = 1;
+  guis[ifn].MarkChanged();
   guis[ifn].SetVisibility(kGUIVisibility_On);
   debug_script_log("GUI %d turned on", ifn);
   // modal interface
@@ -87,7 +87,7 @@ void InterfaceOff(int ifn) {
     guis[ifn].MouseOverCtrl = -1;
   }
   guis[ifn].OnControlPositionChanged();
-  guis_need_update = 1;
+  guis[ifn].MarkChanged();
   // modal interface
   if (guis[ifn].PopupStyle==kGUIPopupModal) UnPauseGame();
   else if (guis[ifn].PopupStyle==kGUIPopupMouseY) guis[ifn].SetVisibility(kGUIVisibility_Concealed);
@@ -35,6 +35,7 @@
 #include "main/game_run.h"
 #include "script/script.h"
 #include "ac/spritecache.h"
+#include "ac/spriteprefetch.h"
 #include "gfx/graphicsdriver.h"
 #include "gfx/bitmap.h"
 #include "gfx/gfx_def.h"
@@ -234,6 +235,7 @@ void AnimateObjectEx(int obn,int loopn,int spdd,int rept, int direction, int blo
     objs[obn].wait = spdd+views[objs[obn].view].loops[loopn].frames[objs[obn].frame].speed;
     objs[obn].num = views[objs[obn].view].loops[loopn].frames[objs[obn].frame].pic;
     CheckViewFrame (objs[obn].view, loopn, objs[obn].frame);
+    spriteprefetch_queue_loop(objs[obn].view, loopn);
 
     if (blocking)
         GameLoopUntilEvent(UNTIL_CHARIS0,(long)&objs[obn].cycling);
@@ -15,6 +15,7 @@
 #include "ac/global_room.h"
 #include "ac/common.h"
 #include "ac/character.h"
+#include "ac/characterindex.h"
 #include "ac/characterinfo.h"
 #include "ac/draw.h"
 #include "ac/event.h"
@@ -25,6 +26,7 @@
 #include "ac/movelist.h"
 #include "ac/properties.h"
 #include "ac/room.h"
+#include "ac/roompreload.h"
 #include "ac/roomstatus.h"
 #include "debug/debug_log.h"
 #include "debug/debugger.h"
@@ -79,6 +81,7 @@ void NewRoom(int nrnum) {
     if (displayed_room < 0) {
         // called from game_start; change the room where the game will start
         playerchar->room = nrnum;
+        charindex_update(game.playercharacter);
         return;
     }
 
@@ -172,6 +175,15 @@ int HasPlayerBeenInRoom(int roomnum) {
         return 0;
 }
 
+void PreloadRoom(int nrnum) {
+    if ((nrnum < 0) || (nrnum >= MAX_ROOMS))
+        quit("!PreloadRoom: invalid room number");
+    if (nrnum == displayed_room)
+        return;
+
+    roompreload_queue(nrnum);
+}
+
 void CallRoomScript (int value) {
     can_run_delayed_command();
 
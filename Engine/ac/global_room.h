@@ -25,6 +25,8 @@ void NewRoomEx(int nrnum,int newx,int newy);
 void NewRoomNPC(int charid, int nrnum, int newx, int newy);
 void ResetRoom(int nrnum);
 int  HasPlayerBeenInRoom(int roomnum);
+// Asks for the room to be loaded in the background, ahead of entering it
+void PreloadRoom(int nrnum);
 void CallRoomScript (int value);
 int  HasBeenToRoom (int roomnum);
 void GetRoomPropertyText (const char *property, char *bufer);
@@ -131,7 +131,7 @@ void GUI_SetSize(ScriptGUI *sgui, int widd, int hitt) {
   
   recreate_guibg_image(tehgui);
 
-  guis_need_update = 1;
+  tehgui->MarkChanged();
 }
 
 int GUI_GetWidth(ScriptGUI *sgui) {
@@ -210,7 +210,7 @@ void GUI_Centre(ScriptGUI *sgui) {
 void GUI_SetBackgroundGraphic(ScriptGUI *tehgui, int slotn) {
   if (guis[tehgui->id].BgImage != slotn) {
     guis[tehgui->id].BgImage = slotn;
-    guis_need_update = 1;
+    guis[tehgui->id].MarkChanged();
   }
 }
 
@@ -264,7 +264,7 @@ void remove_popup_interface(int ifacenum) {
         set_default_cursor();
 
     if (ifacenum==mouse_on_iface) mouse_on_iface=-1;
-    guis_need_update = 1;
+    guis[ifacenum].MarkChanged();
 }
 
 void process_interface_click(int ifce, int btn, int mbut) {
@@ -401,7 +401,7 @@ void export_gui_controls(int ee) {
         if (!guis[ee].Controls[ff]->Name.IsEmpty())
             ccAddExternalDynamicObject(guis[ee].Controls[ff]->Name, guis[ee].Controls[ff], &ccDynamicGUIObject);
 
-        ccRegisterManagedObject(guis[ee].Controls[ff], &ccDynamicGUIObject);
+        ccRegisterPersistentObject(guis[ee].Controls[ff], &ccDynamicGUIObject);
     }
 }
 
@@ -515,6 +515,7 @@ void recreate_guibg_image(GUIMain *tehgui)
     gfxDriver->DestroyDDB(guibgbmp[ifn]);
     guibgbmp[ifn] = NULL;
   }
+  tehgui->MarkChanged();
 }
 
 extern int is_complete_overlay;
@@ -549,7 +550,7 @@ int gui_on_mouse_move()
 
             if (mousey < guis[guin].PopupAtMouseY) {
                 set_mouse_cursor(CURS_ARROW);
-                guis[guin].SetVisibility(kGUIVisibility_On); guis_need_update = 1;
+                guis[guin].SetVisibility(kGUIVisibility_On); guis[guin].MarkChanged();
                 ifacepopped=guin; PauseGame();
                 break;
             }
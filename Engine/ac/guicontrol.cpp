@@ -68,7 +68,7 @@ void GUIControl_SetVisible(GUIObject *guio, int visible)
       guio->Hide();
 
     guis[guio->ParentId].OnControlPositionChanged();
-    guis_need_update = 1;
+    guio->NotifyParentChanged();
   }
 }
 
@@ -85,7 +85,7 @@ void GUIControl_SetClickable(GUIObject *guio, int enabled) {
     guio->SetClickable(false);
 
   guis[guio->ParentId].OnControlPositionChanged();
-  guis_need_update = 1;
+  guio->NotifyParentChanged();
 }
 
 int GUIControl_GetEnabled(GUIObject *guio) {
@@ -99,7 +99,7 @@ void GUIControl_SetEnabled(GUIObject *guio, int enabled) {
     guio->Disable();
 
   guis[guio->ParentId].OnControlPositionChanged();
-  guis_need_update = 1;
+  guio->NotifyParentChanged();
 }
 
 
@@ -160,7 +160,7 @@ int GUIControl_GetX(GUIObject *guio) {
 void GUIControl_SetX(GUIObject *guio, int xx) {
   guio->X = multiply_up_coordinate(xx);
   guis[guio->ParentId].OnControlPositionChanged();
-  guis_need_update = 1;
+  guio->NotifyParentChanged();
 }
 
 int GUIControl_GetY(GUIObject *guio) {
@@ -170,7 +170,7 @@ int GUIControl_GetY(GUIObject *guio) {
 void GUIControl_SetY(GUIObject *guio, int yy) {
   guio->Y = multiply_up_coordinate(yy);
   guis[guio->ParentId].OnControlPositionChanged();
-  guis_need_update = 1;
+  guio->NotifyParentChanged();
 }
 
 int GUIControl_GetZOrder(GUIObject *guio)
@@ -181,7 +181,7 @@ int GUIControl_GetZOrder(GUIObject *guio)
 void GUIControl_SetZOrder(GUIObject *guio, int zorder)
 {
     if (guis[guio->ParentId].SetControlZOrder(guio->Id, zorder))
-        guis_need_update = 1;
+        guio->NotifyParentChanged();
 }
 
 void GUIControl_SetPosition(GUIObject *guio, int xx, int yy) {
@@ -198,7 +198,7 @@ void GUIControl_SetWidth(GUIObject *guio, int newwid) {
   guio->Width = multiply_up_coordinate(newwid);
   guio->OnResized();
   guis[guio->ParentId].OnControlPositionChanged();
-  guis_need_update = 1;
+  guio->NotifyParentChanged();
 }
 
 int GUIControl_GetHeight(GUIObject *guio) {
@@ -209,7 +209,7 @@ void GUIControl_SetHeight(GUIObject *guio, int newhit) {
   guio->Height = multiply_up_coordinate(newhit);
   guio->OnResized();
   guis[guio->ParentId].OnControlPositionChanged();
-  guis_need_update = 1;
+  guio->NotifyParentChanged();
 }
 
 void GUIControl_SetSize(GUIObject *guio, int newwid, int newhit) {
@@ -223,12 +223,12 @@ void GUIControl_SetSize(GUIObject *guio, int newwid, int newhit) {
 
 void GUIControl_SendToBack(GUIObject *guio) {
   if (guis[guio->ParentId].SendControlToBack(guio->Id))
-    guis_need_update = 1;
+    guio->NotifyParentChanged();
 }
 
 void GUIControl_BringToFront(GUIObject *guio) {
   if (guis[guio->ParentId].BringControlToFront(guio->Id))
-    guis_need_update = 1;
+    guio->NotifyParentChanged();
 }
 
 //=============================================================================
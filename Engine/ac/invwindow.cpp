@@ -65,7 +65,7 @@ void InvWindow_SetCharacterToUse(GUIInvWindow *guii, CharacterInfo *chaa) {
   // reset to top of list
   guii->TopItem = 0;
 
-  guis_need_update = 1;
+  guii->NotifyParentChanged();
 }
 
 CharacterInfo* InvWindow_GetCharacterToUse(GUIInvWindow *guii) {
@@ -96,7 +96,7 @@ int InvWindow_GetItemHeight(GUIInvWindow *guii) {
 void InvWindow_SetTopItem(GUIInvWindow *guii, int topitem) {
   if (guii->TopItem != topitem) {
     guii->TopItem = topitem;
-    guis_need_update = 1;
+    guii->NotifyParentChanged();
   }
 }
 
@@ -120,7 +120,7 @@ void InvWindow_ScrollDown(GUIInvWindow *guii) {
   if ((charextra[guii->GetCharacterId()].invorder_count) >
       (guii->TopItem + (guii->ColCount * guii->RowCount))) { 
     guii->TopItem += guii->ColCount;
-    guis_need_update = 1;
+    guii->NotifyParentChanged();
   }
 }
 
@@ -130,7 +130,7 @@ void InvWindow_ScrollUp(GUIInvWindow *guii) {
     if (guii->TopItem < 0)
       guii->TopItem = 0;
 
-    guis_need_update = 1;
+    guii->NotifyParentChanged();
   }
 }
 
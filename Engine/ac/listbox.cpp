@@ -21,9 +21,11 @@
 #include "ac/global_game.h"
 #include "ac/path_helper.h"
 #include "ac/string.h"
+#include "game/savegame_writer.h"
 #include "gui/guimain.h"
 
 using namespace AGS::Common;
+using namespace AGS::Engine;
 
 extern char saveGameDirectory[260];
 extern GameState play;
@@ -35,7 +37,7 @@ int ListBox_AddItem(GUIListBox *lbb, const char *text) {
   if (lbb->AddItem(text) < 0)
     return 0;
 
-  guis_need_update = 1;
+  lbb->NotifyParentChanged();
   return 1;
 }
 
@@ -43,13 +45,13 @@ int ListBox_InsertItemAt(GUIListBox *lbb, int index, const char *text) {
   if (lbb->InsertItem(index, text) < 0)
     return 0;
 
-  guis_need_update = 1;
+  lbb->NotifyParentChanged();
   return 1;
 }
 
 void ListBox_Clear(GUIListBox *listbox) {
   listbox->Clear();
-  guis_need_update = 1;
+  listbox->NotifyParentChanged();
 }
 
 void FillDirList(std::set<String> &files, const String &path)
@@ -65,7 +67,7 @@ void FillDirList(std::set<String> &files, const String &path)
 
 void ListBox_FillDirList(GUIListBox *listbox, const char *filemask) {
   listbox->Clear();
-  guis_need_update = 1;
+  listbox->NotifyParentChanged();
 
   String path, alt_path;
   if (!ResolveScriptPath(filemask, true, path, alt_path))
@@ -98,6 +100,7 @@ int ListBox_FillSaveGameList(GUIListBox *listbox) {
   long filedates[MAXSAVEGAMES];
   char buff[200];
 
+  WaitForSavegameWrites();
   char searchPath[260];
   sprintf(searchPath, "%s""agssave.*", saveGameDirectory);
 
@@ -144,7 +147,7 @@ int ListBox_FillSaveGameList(GUIListBox *listbox) {
     play.filenumbers[nn] = listbox->SavedGameIndex[nn];
   }
 
-  guis_need_update = 1;
+  listbox->NotifyParentChanged();
   listbox->ListBoxFlags |= kListBox_SvgIndex;
 
   if (numsaves >= MAXSAVEGAMES)
@@ -188,7 +191,7 @@ void ListBox_SetItemText(GUIListBox *listbox, int index, const char *newtext) {
 
   if (strcmp(listbox->Items[index], newtext)) {
     listbox->SetItemText(index, newtext);
-    guis_need_update = 1;
+    listbox->NotifyParentChanged();
   }
 }
 
@@ -198,7 +201,7 @@ void ListBox_RemoveItem(GUIListBox *listbox, int itemIndex) {
     quit("!ListBoxRemove: invalid listindex specified");
 
   listbox->RemoveItem(itemIndex);
-  guis_need_update = 1;
+  listbox->NotifyParentChanged();
 }
 
 int ListBox_GetItemCount(GUIListBox *listbox) {
@@ -216,7 +219,7 @@ void ListBox_SetFont(GUIListBox *listbox, int newfont) {
 
   if (newfont != listbox->Font) {
     listbox->SetFont(newfont);
-    guis_need_update = 1;
+    listbox->NotifyParentChanged();
   }
 
 }
@@ -229,7 +232,7 @@ void ListBox_SetHideBorder(GUIListBox *listbox, int newValue) {
   listbox->ListBoxFlags &= ~kListBox_NoBorder;
   if (newValue)
     listbox->ListBoxFlags |= kListBox_NoBorder;
-  guis_need_update = 1;
+  listbox->NotifyParentChanged();
 }
 
 int ListBox_GetHideScrollArrows(GUIListBox *listbox) {
@@ -240,7 +243,7 @@ void ListBox_SetHideScrollArrows(GUIListBox *listbox, int newValue) {
   listbox->ListBoxFlags &= ~kListBox_NoArrows;
   if (newValue)
     listbox->ListBoxFlags |= kListBox_NoArrows;
-  guis_need_update = 1;
+  listbox->NotifyParentChanged();
 }
 
 int ListBox_GetSelectedIndex(GUIListBox *listbox) {
@@ -262,7 +265,7 @@ void ListBox_SetSelectedIndex(GUIListBox *guisl, int newsel) {
       if (newsel >= guisl->TopItem + guisl->VisibleItemCount)
         guisl->TopItem = (newsel - guisl->VisibleItemCount) + 1;
     }
-    guis_need_update = 1;
+    guisl->NotifyParentChanged();
   }
 
 }
@@ -278,7 +281,7 @@ void ListBox_SetTopItem(GUIListBox *guisl, int item) {
     quit("!ListBoxSetTopItem: tried to set top to beyond top or bottom of list");
 
   guisl->TopItem = item;
-  guis_need_update = 1;
+  guisl->NotifyParentChanged();
 }
 
 int ListBox_GetRowCount(GUIListBox *listbox) {
@@ -288,14 +291,14 @@ int ListBox_GetRowCount(GUIListBox *listbox) {
 void ListBox_ScrollDown(GUIListBox *listbox) {
   if (listbox->TopItem + listbox->VisibleItemCount < listbox->ItemCount) {
     listbox->TopItem++;
-    guis_need_update = 1;
+    listbox->NotifyParentChanged();
   }
 }
 
 void ListBox_ScrollUp(GUIListBox *listbox) {
   if (listbox->TopItem > 0) {
     listbox->TopItem--;
-    guis_need_update = 1;
+    listbox->NotifyParentChanged();
   }
 }
 
@@ -305,7 +308,7 @@ GUIListBox* is_valid_listbox (int guin, int objn) {
   if ((objn<0) | (objn>=guis[guin].ControlCount)) quit("!ListBox: invalid object number");
   if (guis[guin].GetControlType(objn)!=kGUIListBox)
     quit("!ListBox: specified control is not a list box");
-  guis_need_update = 1;
+  guis[guin].MarkChanged();
   return (GUIListBox*)guis[guin].Controls[objn];
 }
 
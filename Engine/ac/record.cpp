@@ -16,6 +16,7 @@
 #include "ac/common.h"
 #include "media/audio/audiodefines.h"
 #include "ac/game.h"
+#include "ac/gamesetup.h"
 #include "ac/gamesetupstruct.h"
 #include "ac/gamestate.h"
 #include "ac/global_display.h"
@@ -23,6 +24,7 @@
 #include "ac/keycode.h"
 #include "ac/mouse.h"
 #include "ac/record.h"
+#include "debug/out.h"
 #include "game/savegame.h"
 #include "main/main.h"
 #include "media/audio/soundclip.h"
@@ -34,6 +36,7 @@
 using namespace AGS::Common;
 using namespace AGS::Engine;
 
+extern GameSetup usetup;
 extern GameSetupStruct game;
 extern GameState play;
 extern int disable_mgetgraphpos;
@@ -416,7 +419,12 @@ void start_playback()
             if (requested_engine_version < AGS::Engine::Version(2, 55, 553))
                 quit("!Replay file was recorded with an older incompatible version");
 
-            if (requested_engine_version != EngineVersion) {
+            if (requested_engine_version != EngineVersion && !usetup.replay_bench_file.IsEmpty()) {
+                // Do not stop unattended benchmark runs for user confirmation
+                Debug::Printf(kDbgMsg_Warn, "WARNING: replay is from a different version of AGS (%s) - it may not work properly.",
+                    version_string.GetCStr());
+            }
+            else if (requested_engine_version != EngineVersion) {
                 // Disable text as speech while displaying the warning message
                 // This happens if the user's graphics card does BGR order 16-bit colour
                 int oldalways = game.options[OPT_ALWAYSSPCH];
@@ -17,6 +17,7 @@
 #include "ac/common.h"
 #include "media/audio/audiodefines.h"
 #include "ac/charactercache.h"
+#include "ac/characterindex.h"
 #include "ac/characterextras.h"
 #include "ac/draw.h"
 #include "ac/event.h"
@@ -37,10 +38,12 @@
 #include "ac/record.h"
 #include "ac/room.h"
 #include "ac/roomobject.h"
+#include "ac/roompreload.h"
 #include "ac/roomstatus.h"
 #include "ac/screen.h"
 #include "ac/string.h"
 #include "ac/system.h"
+#include "ac/view.h"
 #include "ac/viewport.h"
 #include "ac/walkablearea.h"
 #include "ac/walkbehind.h"
@@ -59,6 +62,7 @@
 #include "script/script.h"
 #include "script/script_runtime.h"
 #include "ac/spritecache.h"
+#include "ac/spriteprefetch.h"
 #include "util/stream.h"
 #include "gfx/graphicsdriver.h"
 #include "core/assetmanager.h"
@@ -83,6 +87,7 @@ extern RoomStatus*croom;
 extern RoomStatus troom;    // used for non-saveable rooms, eg. intro
 extern int displayed_room;
 extern RoomObject*objs;
+extern ViewStruct*views;
 extern ccInstance *roominst;
 extern AGSPlatformDriver *platform;
 extern int numevents;
@@ -113,6 +118,9 @@ extern Bitmap **actspswb;
 extern IDriverDependantBitmap* *actspswbbmp;
 extern CachedActSpsData* actspswbcache;
 extern color palette[256];
+
+// Sprites of the room objects, kept in the sprite cache while in the room
+std::vector<int> room_pinned_sprites;
 extern Bitmap *virtual_screen;
 extern Bitmap *_old_screen;
 extern Bitmap *_sub_screen;
@@ -251,6 +259,48 @@ void save_room_data_segment () {
 
 }
 
+void unpin_room_sprites() {
+    spriteset.unpinSprites(room_pinned_sprites);
+    room_pinned_sprites.clear();
+}
+
+// Adds the frames of the view's loop to the pinned sprites
+static void add_room_pinned_loop(int view, int loop, bool room_sprites) {
+    if (view < 0 || view >= game.numviews || loop < 0 || loop >= views[view].numLoops)
+        return;
+    const ViewLoopNew &vloop = views[view].loops[loop];
+    for (int i = 0; i < vloop.numFrames; i++) {
+        if (room_sprites)
+            spriteset.setCategory(vloop.frames[i].pic, kSprCat_Room);
+        room_pinned_sprites.push_back(vloop.frames[i].pic);
+    }
+}
+
+// Adds the frames of all the view's loops to the pinned sprites
+static void add_room_pinned_view(int view) {
+    if (view < 0 || view >= game.numviews)
+        return;
+    for (int i = 0; i < views[view].numLoops; i++)
+        add_room_pinned_loop(view, i, false);
+}
+
+// Pins the sprites which the room's objects and characters are drawn with:
+// the same ones that are prefetched on entering the room
+void pin_room_sprites() {
+    unpin_room_sprites();
+    for (int i = 0; i < croom->numobj; i++) {
+        spriteset.setCategory(objs[i].num, kSprCat_Room);
+        room_pinned_sprites.push_back(objs[i].num);
+        if (objs[i].view >= 0)
+            add_room_pinned_loop(objs[i].view, objs[i].loop, true);
+    }
+    for (int i = 0; i < game.numcharacters; i++) {
+        if (game.chars[i].room == displayed_room && game.chars[i].on)
+            add_room_pinned_view(game.chars[i].view);
+    }
+    spriteset.pinSprites(room_pinned_sprites);
+}
+
 void unload_old_room() {
     int ff;
 
@@ -258,6 +308,8 @@ void unload_old_room() {
     if (displayed_room < 0)
         return;
 
+    unpin_room_sprites();
+
     debug_script_log("Unloading room %d", displayed_room);
 
     current_fade_out_effect();
@@ -403,19 +455,8 @@ void convert_room_coordinates_to_low_res(roomstruct *rstruc)
 
 extern int convert_16bit_bgr;
 
-#define NO_GAME_ID_IN_ROOM_FILE 16325
-// forchar = playerchar on NewRoom, or NULL if restore saved game
-void load_new_room(int newnum, CharacterInfo*forchar) {
-
-    debug_script_log("Loading room %d", newnum);
-
+String get_room_filename(int newnum) {
     String room_filename;
-    int cc;
-    done_es_error = 0;
-    play.room_changes ++;
-    set_color_depth(8);
-    displayed_room=newnum;
-
     room_filename.Format("room%d.crm", newnum);
     if (newnum == 0) {
         // support both room0.crm and intro.crm
@@ -426,6 +467,22 @@ void load_new_room(int newnum, CharacterInfo*forchar) {
             room_filename = "intro.crm";
         }
     }
+    return room_filename;
+}
+
+// forchar = playerchar on NewRoom, or NULL if restore saved game
+void load_new_room(int newnum, CharacterInfo*forchar) {
+
+    debug_script_log("Loading room %d", newnum);
+
+    int cc;
+    done_es_error = 0;
+    play.room_changes ++;
+    set_color_depth(8);
+    displayed_room=newnum;
+
+    String room_filename = get_room_filename(newnum);
+
     // reset these back, because they might have been changed.
     delete thisroom.object;
     thisroom.object=BitmapHelper::CreateBitmap(320,200);
@@ -438,7 +495,10 @@ void load_new_room(int newnum, CharacterInfo*forchar) {
     // load the room from disk
     our_eip=200;
     thisroom.gameId = NO_GAME_ID_IN_ROOM_FILE;
-    load_room(room_filename, &thisroom, game.IsHiRes());
+    if (roompreload_take(newnum, thisroom))
+        debug_script_log("Room %d was loaded in advance", newnum);
+    else
+        load_room(room_filename, &thisroom, game.IsHiRes());
 
     if ((thisroom.gameId != NO_GAME_ID_IN_ROOM_FILE) &&
         (thisroom.gameId != game.uniqueid)) {
@@ -779,6 +839,7 @@ void load_new_room(int newnum, CharacterInfo*forchar) {
                     game.chars[ff].room = newnum;
                 else
                     game.chars[ff].room = game.chars[game.chars[ff].following].room;
+                charindex_update(ff);
             }
         }
 
@@ -786,6 +847,7 @@ void load_new_room(int newnum, CharacterInfo*forchar) {
         offsety=0;
         forchar->prevroom=forchar->room;
         forchar->room=newnum;
+        charindex_update(forchar->index_id);
         // only stop moving if it's a new room, not a restore game
         for (cc=0;cc<game.numcharacters;cc++)
             StopMoving(cc);
@@ -950,6 +1012,12 @@ void load_new_room(int newnum, CharacterInfo*forchar) {
     if (game.color_depth > 1)
         setpal();
 
+    // start loading sprites of the new room's characters and objects;
+    // the ones left from the previous room are no longer needed
+    spriteprefetch_clear();
+    spriteprefetch_queue_room();
+    pin_room_sprites();
+
     our_eip=220;
     update_polled_stuff_if_runtime();
     debug_script_log("Now in room %d", displayed_room);
@@ -1073,9 +1141,15 @@ void compile_room_script() {
     if (roominstFork == NULL)
         quitprintf("Unable to create forked room instance: %s", ccErrorString);
 
-    repExecAlways.roomHasFunction = true;
-    lateRepExecAlways.roomHasFunction = true;
-    getDialogOptionsDimensionsFunc.roomHasFunction = true;
+    // function addresses are cached per script, so have to be looked up again
+    repExecAlways.roomFuncAddr = kScFuncAddr_Unresolved;
+    lateRepExecAlways.roomFuncAddr = kScFuncAddr_Unresolved;
+    getDialogOptionsDimensionsFunc.roomFuncAddr = kScFuncAddr_Unresolved;
+    renderDialogOptionsFunc.roomFuncAddr = kScFuncAddr_Unresolved;
+    getDialogOptionUnderCursorFunc.roomFuncAddr = kScFuncAddr_Unresolved;
+    runDialogOptionMouseClickHandlerFunc.roomFuncAddr = kScFuncAddr_Unresolved;
+    runDialogOptionKeyPressHandlerFunc.roomFuncAddr = kScFuncAddr_Unresolved;
+    runDialogOptionRepExecFunc.roomFuncAddr = kScFuncAddr_Unresolved;
 }
 
 int bg_just_changed = 0;
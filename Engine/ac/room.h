@@ -39,10 +39,15 @@ RuntimeScriptValue Sc_Room_GetProperty(const RuntimeScriptValue *params, int32_t
 
 //=============================================================================
 
+// Value given to roomstruct::gameId before loading, to tell if the file has set it
+#define NO_GAME_ID_IN_ROOM_FILE 16325
+
 Common::Bitmap *fix_bitmap_size(Common::Bitmap *todubl);
 void  save_room_data_segment ();
 void  unload_old_room();
 void  convert_room_coordinates_to_low_res(roomstruct *rstruc);
+// Returns the name of the room's file in the game package
+AGS::Common::String get_room_filename(int newnum);
 void  load_new_room(int newnum,CharacterInfo*forchar);
 void  new_room(int newnum,CharacterInfo*forchar);
 int   find_highest_room_entered();
@@ -0,0 +1,459 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// The loading thread reads the room with load_room_data, into a room struct
+// of its own; this does not touch any global state, and returns errors
+// instead of quitting. The loader polls the queue as it goes, and stops if
+// the request was cancelled. If the file has an error, the room is left
+// unloaded, and the main thread will report the error when it loads the
+// room itself. Room files are opened on the main thread, when the request is
+// made, and kept open until the room is taken: the room's compiled script is
+// read from it then, on the main thread, as the script reader uses globals.
+// The loading thread does not write to the log, its warnings are passed to
+// the main thread and logged next time it calls the queue.
+//
+//=============================================================================
+
+#include <deque>
+#include <vector>
+#include "ac/common.h"
+#include "ac/gamesetupstruct.h"
+#include "ac/room.h"
+#include "ac/roompreload.h"
+#include "ac/roomstruct.h"
+#include "core/assetmanager.h"
+#include "debug/out.h"
+#include "gfx/bitmap.h"
+#include "platform/base/agsplatformdriver.h"
+#include "util/mutex.h"
+#include "util/mutex_lock.h"
+#include "util/stream.h"
+#include "util/thread.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+extern GameSetupStruct game;
+
+namespace
+{
+
+// Time the loading thread sleeps when it has nothing to do, in milliseconds
+const int PreloadIdleDelay = 10;
+// Time the main thread sleeps while waiting for the room to load
+const int PreloadWaitDelay = 1;
+
+struct PreloadRequest
+{
+    int     Room;
+    String  FileName;
+    Stream *In;
+    bool    HiRes;
+    int     Generation;
+};
+
+struct StagedRoom
+{
+    int         Room;
+    roomstruct *Data;
+    size_t      Size;
+    Stream     *In;        // room file, to read the script from
+    long        ScriptPos; // position of the compiled script in the file
+};
+
+roomstruct *create_room_data()
+{
+    roomstruct *data = new roomstruct();
+    // the constructor does not initialize the extra backgrounds, which
+    // are deleted by the room loader, nor the messages; these must be
+    // valid for freeing a room which failed to load
+    for (int i = 0; i < MAX_BSCENE; ++i)
+        data->ebscene[i] = NULL;
+    for (int i = 0; i < MAXMESS; ++i)
+        data->message[i] = NULL;
+    data->gameId = NO_GAME_ID_IN_ROOM_FILE;
+    return data;
+}
+
+// Frees everything the room data owns, except for the members which
+// free themselves
+void free_room_data(roomstruct &data)
+{
+    data.freemessage();
+    data.freescripts();
+    for (int i = 0; i < data.num_bscenes; ++i)
+        delete data.ebscene[i];
+    delete data.walls;
+    delete data.object;
+    delete data.lookat;
+    delete data.regions;
+    for (int i = 0; i < MAX_HOTSPOTS; ++i)
+        delete data.intrHotspot[i];
+    for (int i = 0; i < MAX_INIT_SPR; ++i)
+        delete data.intrObject[i];
+    for (int i = 0; i < MAX_REGIONS; ++i)
+        delete data.intrRegion[i];
+    delete data.intrRoom;
+    free(data.localvars);
+}
+
+size_t get_bitmap_size(Bitmap *image)
+{
+    return image ? image->GetLineLength() * image->GetHeight() : 0;
+}
+
+// Returns memory taken by the room's images
+size_t get_room_data_size(const roomstruct &data)
+{
+    size_t size = 0;
+    for (int i = 0; i < data.num_bscenes; ++i)
+        size += get_bitmap_size(data.ebscene[i]);
+    size += get_bitmap_size(data.walls);
+    size += get_bitmap_size(data.object);
+    size += get_bitmap_size(data.lookat);
+    size += get_bitmap_size(data.regions);
+    return size;
+}
+
+class RoomPreloadQueue
+{
+public:
+    RoomPreloadQueue();
+
+    bool Start(int max_rooms, size_t max_size);
+    void Stop();
+    void Clear();
+    void Queue(int room);
+    bool Take(int room, roomstruct &room_data);
+
+    // Thread entry point
+    static void Run();
+    // Tells the room loader to stop if the load was cancelled
+    static bool PollLoading();
+
+private:
+    void RunStep();
+    // Cancels the requests, and moves the staged rooms to the given list
+    void ClearImpl(std::deque<StagedRoom> &freed);
+    void FreeRooms(std::deque<StagedRoom> &rooms);
+    bool IsRequested(int room) const;
+    // Writes the loading thread's warnings to the log
+    void ReportWarnings();
+
+    Thread      _thread;
+    bool        _started;
+    Mutex       _mutex;
+    // Following are protected by the mutex
+    std::deque<PreloadRequest> _requests;
+    std::deque<StagedRoom> _staged; // oldest first
+    size_t      _stagedSize;
+    size_t      _maxSize;
+    size_t      _maxRooms;
+    int         _loadingRoom; // room being loaded now, or -1
+    bool        _cancel;      // tells the loading thread to drop the room
+    int         _generation;  // increased on clearing the queue
+    std::vector<String> _warnings;
+};
+
+RoomPreloadQueue::RoomPreloadQueue()
+    : _started(false)
+    , _stagedSize(0)
+    , _maxSize(0)
+    , _maxRooms(0)
+    , _loadingRoom(-1)
+    , _cancel(false)
+    , _generation(0)
+{
+}
+
+RoomPreloadQueue PreloadQueue;
+
+void RoomPreloadQueue::Run()
+{
+    PreloadQueue.RunStep();
+}
+
+bool RoomPreloadQueue::Start(int max_rooms, size_t max_size)
+{
+    Stop();
+    if (max_rooms <= 0)
+        return false;
+    _maxRooms = max_rooms;
+    _maxSize = max_size;
+    _started = _thread.CreateAndStart(RoomPreloadQueue::Run, true);
+    return _started;
+}
+
+void RoomPreloadQueue::Stop()
+{
+    std::deque<StagedRoom> freed;
+    MutexLock lock(_mutex);
+    ClearImpl(freed);
+    lock.Release();
+    _thread.Stop();
+    _started = false;
+    FreeRooms(freed);
+    ReportWarnings();
+}
+
+void RoomPreloadQueue::Clear()
+{
+    ReportWarnings();
+    std::deque<StagedRoom> freed;
+    MutexLock lock(_mutex);
+    ClearImpl(freed);
+    lock.Release();
+    FreeRooms(freed);
+}
+
+void RoomPreloadQueue::ClearImpl(std::deque<StagedRoom> &freed)
+{
+    for (size_t i = 0; i < _requests.size(); ++i)
+        delete _requests[i].In;
+    _requests.clear();
+    freed.insert(freed.end(), _staged.begin(), _staged.end());
+    _staged.clear();
+    _stagedSize = 0;
+    if (_loadingRoom >= 0)
+        _cancel = true;
+    _generation++;
+}
+
+void RoomPreloadQueue::FreeRooms(std::deque<StagedRoom> &rooms)
+{
+    for (size_t i = 0; i < rooms.size(); ++i)
+    {
+        free_room_data(*rooms[i].Data);
+        delete rooms[i].Data;
+        delete rooms[i].In;
+    }
+    rooms.clear();
+}
+
+bool RoomPreloadQueue::IsRequested(int room) const
+{
+    if (_loadingRoom == room)
+        return true;
+    for (size_t i = 0; i < _requests.size(); ++i)
+        if (_requests[i].Room == room)
+            return true;
+    return false;
+}
+
+void RoomPreloadQueue::Queue(int room)
+{
+    if (!_started)
+        return;
+
+    ReportWarnings();
+    MutexLock lock(_mutex);
+    if (IsRequested(room))
+        return;
+    for (std::deque<StagedRoom>::iterator it = _staged.begin(); it != _staged.end(); ++it)
+    {
+        if (it->Room == room)
+        {
+            // asked again, so make it the last one to be freed
+            StagedRoom staged = *it;
+            _staged.erase(it);
+            _staged.push_back(staged);
+            return;
+        }
+    }
+    lock.Release();
+
+    // the asset manager is only used on main thread
+    PreloadRequest req;
+    req.Room = room;
+    req.FileName = get_room_filename(room);
+    req.In = AssetManager::OpenAsset(req.FileName);
+    if (!req.In)
+        return; // let the usual room loading report this
+    req.HiRes = game.IsHiRes();
+
+    lock.Acquire(_mutex);
+    req.Generation = _generation;
+    // there is no use in loading more rooms than may be kept
+    if (_requests.size() >= _maxRooms)
+    {
+        delete _requests.front().In;
+        _requests.pop_front();
+    }
+    _requests.push_back(req);
+}
+
+bool RoomPreloadQueue::Take(int room, roomstruct &room_data)
+{
+    if (!_started)
+        return false;
+
+    ReportWarnings();
+    MutexLock lock(_mutex);
+    // the room is being changed, so the other pending rooms were asked for
+    // by the previous one; also the loading thread should stay idle, not to
+    // slow down the room loaded on the main thread
+    for (size_t i = 0; i < _requests.size(); ++i)
+        delete _requests[i].In;
+    _requests.clear();
+    if (_loadingRoom >= 0 && _loadingRoom != room)
+        _cancel = true;
+    while (_loadingRoom >= 0)
+    {
+        lock.Release();
+        update_polled_stuff_if_runtime();
+        platform->Delay(PreloadWaitDelay);
+        lock.Acquire(_mutex);
+    }
+
+    StagedRoom staged;
+    staged.Data = NULL;
+    for (std::deque<StagedRoom>::iterator it = _staged.begin(); it != _staged.end(); ++it)
+    {
+        if (it->Room == room)
+        {
+            staged = *it;
+            _staged.erase(it);
+            _stagedSize -= staged.Size;
+            break;
+        }
+    }
+    lock.Release();
+    if (!staged.Data)
+        return false;
+
+    String error;
+    bool script_loaded = load_room_script(staged.In, staged.ScriptPos, staged.Data, error);
+    delete staged.In;
+    if (!script_loaded)
+    {
+        // let the usual room loading report this
+        free_room_data(*staged.Data);
+        delete staged.Data;
+        return false;
+    }
+    free_room_data(room_data);
+    room_data = *staged.Data;
+    delete staged.Data;
+    return true;
+}
+
+void RoomPreloadQueue::ReportWarnings()
+{
+    std::vector<String> warnings;
+    MutexLock lock(_mutex);
+    warnings.swap(_warnings);
+    lock.Release();
+    for (size_t i = 0; i < warnings.size(); ++i)
+        Debug::Printf(kDbgMsg_Warn, "%s", warnings[i].GetCStr());
+}
+
+bool RoomPreloadQueue::PollLoading()
+{
+    MutexLock lock(PreloadQueue._mutex);
+    return !PreloadQueue._cancel;
+}
+
+void RoomPreloadQueue::RunStep()
+{
+    MutexLock lock(_mutex);
+    if (_requests.empty())
+    {
+        lock.Release();
+        platform->Delay(PreloadIdleDelay);
+        return;
+    }
+    PreloadRequest req = _requests.front();
+    _requests.pop_front();
+    _loadingRoom = req.Room;
+    _cancel = false;
+    lock.Release();
+
+    roomstruct *data = create_room_data();
+    long script_pos;
+    String error;
+    bool loaded = load_room_data(req.In, req.FileName, data, req.HiRes,
+        RoomPreloadQueue::PollLoading, script_pos, error);
+
+    std::deque<StagedRoom> freed;
+    lock.Acquire(_mutex);
+    _loadingRoom = -1;
+    if (!error.IsEmpty())
+        _warnings.push_back(String::FromFormat("Failed to preload room %d: %s", req.Room, error.GetCStr()));
+    if (!loaded || _cancel || req.Generation != _generation)
+    {
+        _cancel = false;
+        lock.Release();
+        // the room loader keeps the struct valid for freeing even if
+        // the load was interrupted
+        free_room_data(*data);
+        delete data;
+        delete req.In;
+        return;
+    }
+
+    StagedRoom staged;
+    staged.Room = req.Room;
+    staged.Data = data;
+    staged.Size = get_room_data_size(*data);
+    staged.In = req.In;
+    staged.ScriptPos = script_pos;
+    // make room for the new one by freeing the oldest
+    while (!_staged.empty() &&
+        (_staged.size() >= _maxRooms || _stagedSize + staged.Size > _maxSize))
+    {
+        _stagedSize -= _staged.front().Size;
+        freed.push_back(_staged.front());
+        _staged.pop_front();
+    }
+    if (staged.Size <= _maxSize)
+    {
+        _staged.push_back(staged);
+        _stagedSize += staged.Size;
+    }
+    else
+    {
+        _warnings.push_back(String::FromFormat("Room %d is too big to be preloaded (%u KB)", req.Room, (unsigned)(staged.Size / 1024)));
+        freed.push_back(staged);
+    }
+    lock.Release();
+    FreeRooms(freed);
+}
+
+} // namespace
+
+
+bool roompreload_start(int max_rooms, size_t max_size)
+{
+    return PreloadQueue.Start(max_rooms, max_size);
+}
+
+void roompreload_stop()
+{
+    PreloadQueue.Stop();
+}
+
+void roompreload_clear()
+{
+    PreloadQueue.Clear();
+}
+
+void roompreload_queue(int room)
+{
+    PreloadQueue.Queue(room);
+}
+
+bool roompreload_take(int room, roomstruct &room_data)
+{
+    return PreloadQueue.Take(room, room_data);
+}
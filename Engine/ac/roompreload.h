@@ -0,0 +1,44 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Background room loading. Rooms which the game expects the player to enter
+// next are read from their files on a separate thread and kept aside, so
+// that the room change only has to put the loaded data in place.
+//
+//=============================================================================
+
+#ifndef __AGS_EE_AC__ROOMPRELOAD_H
+#define __AGS_EE_AC__ROOMPRELOAD_H
+
+#include <stddef.h>
+
+struct roomstruct;
+
+// Starts the loading thread; max_rooms is the number of loaded rooms kept
+// aside, and max_size is the memory their images may take, in bytes
+bool roompreload_start(int max_rooms, size_t max_size);
+// Stops the loading thread and frees the rooms that were not taken
+void roompreload_stop();
+// Discards pending requests and the rooms that were not taken yet
+void roompreload_clear();
+// Requests the room to be loaded in the background
+void roompreload_queue(int room);
+// Moves the loaded room into the given struct, freeing the room it held
+// before; waits if the room is being loaded right now. Returns false if the
+// room was not loaded ahead, and has to be loaded as usual. Must be called
+// before loading a room on the main thread, so that the loading thread does
+// not compete with it.
+bool roompreload_take(int room, roomstruct &room_data);
+
+#endif // __AGS_EE_AC__ROOMPRELOAD_H
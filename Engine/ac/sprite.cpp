@@ -17,17 +17,22 @@
 #include "ac/gamesetupstruct.h"
 #include "ac/sprite.h"
 #include "ac/system.h"
+#include "ac/view.h"
 #include "platform/base/agsplatformdriver.h"
 #include "plugin/agsplugin.h"
 #include "plugin/plugin_engine.h"
 #include "ac/spritecache.h"
 #include "gfx/bitmap.h"
 #include "gfx/graphicsdriver.h"
+#include "gui/guibutton.h"
+#include "gui/guimain.h"
+#include "gui/guislider.h"
 
 using namespace AGS::Common;
 using namespace AGS::Engine;
 
 extern GameSetupStruct game;
+extern ViewStruct*views;
 extern int current_screen_resolution_multiplier;
 extern int spritewidth[MAX_SPRITES],spriteheight[MAX_SPRITES];
 extern SpriteCache spriteset;
@@ -209,3 +214,41 @@ void initialize_sprite (int ee) {
         our_eip = oldeip;
     }
 }
+
+static void set_view_sprite_category(int view, SpriteCategory category)
+{
+    if (view < 0 || view >= game.numviews)
+        return;
+    for (int i = 0; i < views[view].numLoops; ++i)
+    {
+        for (int j = 0; j < views[view].loops[i].numFrames; ++j)
+            spriteset.setCategory(views[view].loops[i].frames[j].pic, category);
+    }
+}
+
+void init_sprite_categories()
+{
+    for (int i = 0; i < game.numcharacters; ++i)
+    {
+        const CharacterInfo &chinfo = game.chars[i];
+        set_view_sprite_category(chinfo.defview, kSprCat_Character);
+        set_view_sprite_category(chinfo.talkview, kSprCat_Character);
+        set_view_sprite_category(chinfo.idleview, kSprCat_Character);
+        set_view_sprite_category(chinfo.thinkview, kSprCat_Character);
+        set_view_sprite_category(chinfo.blinkview, kSprCat_Character);
+    }
+
+    for (int i = 0; i < game.numgui; ++i)
+        spriteset.setCategory(guis[i].BgImage, kSprCat_GUI);
+    for (int i = 0; i < numguibuts; ++i)
+    {
+        spriteset.setCategory(guibuts[i].Image, kSprCat_GUI);
+        spriteset.setCategory(guibuts[i].MouseOverImage, kSprCat_GUI);
+        spriteset.setCategory(guibuts[i].PushedImage, kSprCat_GUI);
+    }
+    for (int i = 0; i < numguislider; ++i)
+    {
+        spriteset.setCategory(guislider[i].BgImage, kSprCat_GUI);
+        spriteset.setCategory(guislider[i].HandleImage, kSprCat_GUI);
+    }
+}
@@ -26,5 +26,7 @@ void set_rgb_mask_using_alpha_channel(Common::Bitmap *image);
 Common::Bitmap *remove_alpha_channel(Common::Bitmap *from);
 void pre_save_sprite(int ee);
 void initialize_sprite (int ee);
+// Assigns sprite cache categories to the character views and GUI images
+void init_sprite_categories();
 
 #endif // __AGS_EE_AC__SPRITE_H
@@ -46,6 +46,6 @@ void SpriteCache::initFile_initNullSpriteParams(int vv)
   // make it a blue cup, to avoid crashes
   spritewidth[vv] = spritewidth[0];
   spriteheight[vv] = spriteheight[0];
-  offsets[vv] = offsets[0];
-  flags[vv] = SPRCACHEFLAG_DOESNOTEXIST;
+  entries[vv].Offset = entries[0].Offset;
+  entries[vv].Flags = SPRCACHEFLAG_DOESNOTEXIST;
 }
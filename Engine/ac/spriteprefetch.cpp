@@ -0,0 +1,317 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// The loading thread only works with its own sprite file stream and the
+// request queue; it never touches the sprite cache. Requests carry the file
+// offset of a sprite, so that the cache arrays are only read on main thread.
+// The thread does not write to the log either; the sprites it failed to
+// load are reported by the main thread, next time it uses the queue.
+//
+//=============================================================================
+
+#include <deque>
+#include <map>
+#include <set>
+#include <vector>
+#include "ac/characterinfo.h"
+#include "ac/gamesetupstruct.h"
+#include "ac/roomobject.h"
+#include "ac/roomstatus.h"
+#include "ac/spritecache.h"
+#include "ac/spriteprefetch.h"
+#include "ac/view.h"
+#include "core/assetmanager.h"
+#include "debug/out.h"
+#include "gfx/bitmap.h"
+#include "platform/base/agsplatformdriver.h"
+#include "util/mutex.h"
+#include "util/mutex_lock.h"
+#include "util/stream.h"
+#include "util/thread.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+extern GameSetupStruct game;
+extern ViewStruct*views;
+extern RoomStatus*croom;
+extern RoomObject*objs;
+extern int displayed_room;
+
+namespace
+{
+
+// Time the loading thread sleeps when it has nothing to do, in milliseconds
+const int PrefetchIdleDelay = 10;
+
+struct PrefetchRequest
+{
+    int     Index;
+    int32_t Offset;
+    int     Generation;
+};
+
+struct PrefetchFailure
+{
+    int     Index;
+    bool    Corrupt; // the image was loaded, but its data was corrupt
+};
+
+typedef std::map<int, Bitmap*> StagedSprites;
+
+class SpritePrefetchQueue : public SpritePrefetcher
+{
+public:
+    SpritePrefetchQueue();
+
+    bool Start(const char *sprite_file);
+    void Stop();
+    void Clear();
+    void Queue(int index);
+
+    virtual Bitmap *TakeSprite(int index);
+
+    // Thread entry point
+    static void Run();
+
+private:
+    void RunStep();
+    void ClearImpl();
+    // Writes the failures of the loading thread to the log
+    void ReportFailures();
+
+    Thread      _thread;
+    Mutex       _mutex;
+    Stream     *_in;        // sprite file, used by the loading thread
+    bool        _compressed;
+    // Following are protected by the mutex
+    std::deque<PrefetchRequest> _requests;
+    std::set<int>   _pending;   // sprites that are either queued or staged
+    StagedSprites   _staged;
+    std::vector<PrefetchFailure> _failures;
+    size_t          _stagedSize;
+    size_t          _stageLimit;
+    int             _generation; // increased on clearing the queue
+};
+
+SpritePrefetchQueue::SpritePrefetchQueue()
+    : _in(NULL)
+    , _compressed(false)
+    , _stagedSize(0)
+    , _stageLimit(0)
+    , _generation(0)
+{
+}
+
+SpritePrefetchQueue PrefetchQueue;
+
+void SpritePrefetchQueue::Run()
+{
+    PrefetchQueue.RunStep();
+}
+
+bool SpritePrefetchQueue::Start(const char *sprite_file)
+{
+    Stop();
+    _in = AssetManager::OpenAsset(sprite_file);
+    if (!_in)
+        return false;
+    _compressed = spriteset.spritesAreCompressed;
+    if (!_thread.CreateAndStart(SpritePrefetchQueue::Run, true))
+    {
+        delete _in;
+        _in = NULL;
+        return false;
+    }
+    spriteset.setPrefetcher(this);
+    return true;
+}
+
+void SpritePrefetchQueue::Stop()
+{
+    spriteset.setPrefetcher(NULL);
+    _thread.Stop();
+    ClearImpl();
+    delete _in;
+    _in = NULL;
+}
+
+void SpritePrefetchQueue::Clear()
+{
+    MutexLock lock(_mutex);
+    ClearImpl();
+}
+
+void SpritePrefetchQueue::ClearImpl()
+{
+    for (StagedSprites::iterator it = _staged.begin(); it != _staged.end(); ++it)
+        delete it->second;
+    _staged.clear();
+    _requests.clear();
+    _pending.clear();
+    _failures.clear();
+    _stagedSize = 0;
+    _generation++;
+}
+
+void SpritePrefetchQueue::Queue(int index)
+{
+    if (!_in || index <= 0 || index >= spriteset.elements)
+        return;
+    // only the sprites which are in the file and not in memory
+    const int32_t offset = spriteset.getFileOffset(index);
+    if (offset <= 0 || spriteset.isLoaded(index))
+        return;
+
+    ReportFailures();
+    MutexLock lock(_mutex);
+    if (!_pending.insert(index).second)
+        return;
+    // don't let the staged sprites take more than a half of what the cache
+    // may hold besides locked sprites, or they would be pushing each other out
+    // when put to cache
+    int32_t cache_free = spriteset.maxCacheSize - spriteset.lockedSize;
+    _stageLimit = cache_free > 0 ? cache_free / 2 : 0;
+    PrefetchRequest req;
+    req.Index = index;
+    req.Offset = offset;
+    req.Generation = _generation;
+    _requests.push_back(req);
+}
+
+Bitmap *SpritePrefetchQueue::TakeSprite(int index)
+{
+    ReportFailures();
+    MutexLock lock(_mutex);
+    StagedSprites::iterator it = _staged.find(index);
+    if (it == _staged.end())
+        return NULL;
+    Bitmap *image = it->second;
+    _stagedSize -= image->GetLineLength() * image->GetHeight();
+    _staged.erase(it);
+    _pending.erase(index);
+    return image;
+}
+
+void SpritePrefetchQueue::ReportFailures()
+{
+    std::vector<PrefetchFailure> failures;
+    MutexLock lock(_mutex);
+    failures.swap(_failures);
+    lock.Release();
+    for (size_t i = 0; i < failures.size(); ++i)
+    {
+        if (failures[i].Corrupt)
+            Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Error, "Sprite %d: compressed data is corrupt", failures[i].Index);
+        else
+            Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Warn, "Failed to prefetch sprite %d", failures[i].Index);
+    }
+}
+
+void SpritePrefetchQueue::RunStep()
+{
+    MutexLock lock(_mutex);
+    if (_requests.empty() || _stagedSize >= _stageLimit)
+    {
+        lock.Release();
+        platform->Delay(PrefetchIdleDelay);
+        return;
+    }
+    PrefetchRequest req = _requests.front();
+    _requests.pop_front();
+    lock.Release();
+
+    _in->Seek(req.Offset, kSeekBegin);
+    bool corrupt;
+    Bitmap *image = SpriteCache::readSprite(_in, _compressed, corrupt);
+
+    lock.Acquire(_mutex);
+    if (req.Generation != _generation)
+    {
+        // the queue was cleared while we were loading this one
+        delete image;
+        return;
+    }
+    if (!image || corrupt)
+    {
+        PrefetchFailure failure;
+        failure.Index = req.Index;
+        failure.Corrupt = corrupt;
+        _failures.push_back(failure);
+    }
+    if (!image)
+    {
+        _pending.erase(req.Index);
+        return;
+    }
+    _staged[req.Index] = image;
+    _stagedSize += image->GetLineLength() * image->GetHeight();
+}
+
+} // namespace
+
+
+bool spriteprefetch_start(const char *sprite_file)
+{
+    return PrefetchQueue.Start(sprite_file);
+}
+
+void spriteprefetch_stop()
+{
+    PrefetchQueue.Stop();
+}
+
+void spriteprefetch_clear()
+{
+    PrefetchQueue.Clear();
+}
+
+void spriteprefetch_queue(int sprite)
+{
+    PrefetchQueue.Queue(sprite);
+}
+
+void spriteprefetch_queue_loop(int view, int loop)
+{
+    if (view < 0 || view >= game.numviews || loop < 0 || loop >= views[view].numLoops)
+        return;
+    const ViewLoopNew &vloop = views[view].loops[loop];
+    for (int i = 0; i < vloop.numFrames; ++i)
+        PrefetchQueue.Queue(vloop.frames[i].pic);
+}
+
+void spriteprefetch_queue_view(int view)
+{
+    if (view < 0 || view >= game.numviews)
+        return;
+    for (int i = 0; i < views[view].numLoops; ++i)
+        spriteprefetch_queue_loop(view, i);
+}
+
+void spriteprefetch_queue_room()
+{
+    for (int i = 0; i < croom->numobj; ++i)
+    {
+        if (!objs[i].on)
+            continue;
+        PrefetchQueue.Queue(objs[i].num);
+        if (objs[i].view >= 0)
+            spriteprefetch_queue_loop(objs[i].view, objs[i].loop);
+    }
+    for (int i = 0; i < game.numcharacters; ++i)
+    {
+        if (game.chars[i].room == displayed_room && game.chars[i].on)
+            spriteprefetch_queue_view(game.chars[i].view);
+    }
+}
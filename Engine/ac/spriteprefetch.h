@@ -0,0 +1,40 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Background sprite loading. Requested sprites are read and decoded on
+// a separate thread, and kept aside until the sprite cache asks for them;
+// only then they are put into the cache, on the main thread.
+//
+//=============================================================================
+
+#ifndef __AGS_EE_AC__SPRITEPREFETCH_H
+#define __AGS_EE_AC__SPRITEPREFETCH_H
+
+// Starts the loading thread, reading from the given sprite file
+bool spriteprefetch_start(const char *sprite_file);
+// Stops the loading thread and frees any sprites that were not taken
+void spriteprefetch_stop();
+// Discards pending requests and the sprites that were not taken yet
+void spriteprefetch_clear();
+// Requests a sprite to be loaded in the background, unless it is
+// already in the cache
+void spriteprefetch_queue(int sprite);
+// Requests all frames of the view's loop
+void spriteprefetch_queue_loop(int view, int loop);
+// Requests all frames of the view
+void spriteprefetch_queue_view(int view);
+// Requests sprites of the characters and objects in the current room
+void spriteprefetch_queue_room();
+
+#endif // __AGS_EE_AC__SPRITEPREFETCH_H
@@ -37,7 +37,7 @@ void TextBox_SetText(GUITextBox *texbox, const char *newtex) {
 
     if (strcmp(texbox->Text, newtex)) {
         texbox->Text = newtex;
-        guis_need_update = 1;
+        texbox->NotifyParentChanged();
     }
 }
 
@@ -50,7 +50,7 @@ void TextBox_SetTextColor(GUITextBox *guit, int colr)
     if (guit->TextColor != colr) 
     {
         guit->TextColor = colr;
-        guis_need_update = 1;
+        guit->NotifyParentChanged();
     }
 }
 
@@ -64,7 +64,7 @@ void TextBox_SetFont(GUITextBox *guit, int fontnum) {
 
     if (guit->Font != fontnum) {
         guit->Font = fontnum;
-        guis_need_update = 1;
+        guit->NotifyParentChanged();
     }
 }
 
@@ -0,0 +1,140 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <list>
+#include <map>
+#include "ac/textruncache.h"
+#include "gfx/bitmap.h"
+#include "util/string.h"
+
+using namespace AGS::Common;
+
+struct TextRunKey
+{
+    int     Font;
+    color_t TextColor;
+    color_t OutlineColor;
+    int     ColorDepth;
+    String  Text;
+
+    bool operator <(const TextRunKey &other) const
+    {
+        if (Font != other.Font)
+            return Font < other.Font;
+        if (TextColor != other.TextColor)
+            return TextColor < other.TextColor;
+        if (OutlineColor != other.OutlineColor)
+            return OutlineColor < other.OutlineColor;
+        if (ColorDepth != other.ColorDepth)
+            return ColorDepth < other.ColorDepth;
+        return Text.Compare(other.Text.GetCStr()) < 0;
+    }
+};
+
+struct TextRun
+{
+    TextRunKey Key;
+    Bitmap    *Image;
+    size_t     Size;
+};
+
+typedef std::list<TextRun> TextRunList;
+typedef std::map<TextRunKey, TextRunList::iterator> TextRunMap;
+
+// A single run may take no more than this part of the cache, so that
+// a long text does not push out everything else
+const size_t MaxRunSizeDivisor = 4;
+
+// Cached runs, most recently used first
+static TextRunList Runs;
+static TextRunMap RunIndex;
+static TextRunCacheStats Stats;
+
+static TextRunKey make_key(int font, color_t text_color, color_t outline_color, int color_depth, const char *text)
+{
+    TextRunKey key;
+    key.Font = font;
+    key.TextColor = text_color;
+    key.OutlineColor = outline_color;
+    key.ColorDepth = color_depth;
+    key.Text = text;
+    return key;
+}
+
+static void remove_last_run()
+{
+    TextRun &run = Runs.back();
+    RunIndex.erase(run.Key);
+    Stats.Size -= run.Size;
+    delete run.Image;
+    Runs.pop_back();
+}
+
+void textcache_set_max_size(size_t max_size)
+{
+    Stats.MaxSize = max_size;
+    while (!Runs.empty() && Stats.Size > Stats.MaxSize)
+        remove_last_run();
+}
+
+bool textcache_is_enabled()
+{
+    return Stats.MaxSize > 0;
+}
+
+void textcache_clear()
+{
+    while (!Runs.empty())
+        remove_last_run();
+}
+
+Bitmap *textcache_get(int font, color_t text_color, color_t outline_color, int color_depth, const char *text)
+{
+    TextRunMap::iterator it = RunIndex.find(make_key(font, text_color, outline_color, color_depth, text));
+    if (it == RunIndex.end())
+    {
+        Stats.Misses++;
+        return NULL;
+    }
+    Runs.splice(Runs.begin(), Runs, it->second);
+    Stats.Hits++;
+    return it->second->Image;
+}
+
+bool textcache_put(int font, color_t text_color, color_t outline_color, int color_depth, const char *text,
+                   Bitmap *image)
+{
+    const size_t size = image->GetLineLength() * image->GetHeight();
+    if (size > Stats.MaxSize / MaxRunSizeDivisor)
+        return false;
+    TextRunKey key = make_key(font, text_color, outline_color, color_depth, text);
+    if (RunIndex.find(key) != RunIndex.end())
+        return false;
+
+    while (!Runs.empty() && Stats.Size + size > Stats.MaxSize)
+        remove_last_run();
+    TextRun run;
+    run.Key = key;
+    run.Image = image;
+    run.Size = size;
+    Runs.push_front(run);
+    RunIndex.insert(std::make_pair(key, Runs.begin()));
+    Stats.Size += size;
+    return true;
+}
+
+const TextRunCacheStats &textcache_get_stats()
+{
+    return Stats;
+}
@@ -0,0 +1,58 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Rendered text run cache. Keeps the images of recently drawn lines of text,
+// along with their outline, so that the same text may be blitted instead of
+// being rasterised again. Least recently used runs are removed when the
+// cache is over its memory limit.
+//
+// The images are only valid as long as the fonts do not change; the cache
+// must be cleared whenever fonts are loaded, freed or replaced.
+//
+//=============================================================================
+
+#ifndef __AGS_EE_AC__TEXTRUNCACHE_H
+#define __AGS_EE_AC__TEXTRUNCACHE_H
+
+#include "core/types.h"
+
+namespace AGS { namespace Common { class Bitmap; } }
+using namespace AGS; // FIXME later
+
+struct TextRunCacheStats
+{
+    int32_t Hits;    // text was drawn from the cache
+    int32_t Misses;  // text was not found in the cache
+    size_t  Size;    // memory taken by the cached images, in bytes
+    size_t  MaxSize; // memory limit, in bytes
+
+    TextRunCacheStats() : Hits(0), Misses(0), Size(0), MaxSize(0) {}
+};
+
+// Sets the cache memory limit in bytes, removing runs that no longer fit;
+// zero limit disables the cache
+void textcache_set_max_size(size_t max_size);
+bool textcache_is_enabled();
+// Removes all the cached runs
+void textcache_clear();
+// Finds the image of the text drawn with the given parameters; returns NULL
+// if there's none
+Common::Bitmap *textcache_get(int font, color_t text_color, color_t outline_color, int color_depth, const char *text);
+// Puts the text image into the cache, which takes its ownership; returns
+// false and leaves the image to the caller if it would not fit
+bool textcache_put(int font, color_t text_color, color_t outline_color, int color_depth, const char *text,
+                   Common::Bitmap *image);
+const TextRunCacheStats &textcache_get_stats();
+
+#endif // __AGS_EE_AC__TEXTRUNCACHE_H
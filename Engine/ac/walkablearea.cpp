@@ -16,6 +16,7 @@
 #include "ac/object.h"
 #include "ac/roomstruct.h"
 #include "ac/character.h"
+#include "ac/characterindex.h"
 #include "ac/draw.h"
 #include "ac/gamestate.h"
 #include "ac/gamesetupstruct.h"
@@ -151,9 +152,10 @@ Bitmap *prepare_walkable_areas (int sourceChar) {
     int ww;
     // for each character in the current room, make the area under
     // them unwalkable
-    for (ww = 0; ww < game.numcharacters; ww++) {
+    const std::vector<int> &room_chars = charindex_get_room(displayed_room);
+    for (size_t i = 0; i < room_chars.size(); i++) {
+        ww = room_chars[i];
         if (game.chars[ww].on != 1) continue;
-        if (game.chars[ww].room != displayed_room) continue;
         if (ww == sourceChar) continue;
         if (game.chars[ww].flags & CHF_NOBLOCKING) continue;
         if (convert_to_low_res(game.chars[ww].y) >= walkable_areas_temp->GetHeight()) continue;
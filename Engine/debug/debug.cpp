@@ -25,6 +25,7 @@
 #include "debug/consoleoutputtarget.h"
 #include "debug/logfile.h"
 #include "debug/messagebuffer.h"
+#include "debug/profiler.h"
 #include "main/config.h"
 #include "media/audio/audio.h"
 #include "media/audio/soundclip.h"
@@ -75,6 +76,9 @@ IAGSEditorDebugger *GetEditorDebugger(const char *instanceToken)
 int debug_flags=0;
 bool enable_log_file = false;
 bool disable_log_file = false;
+bool enable_profiler = false;
+String profiler_trace_file;
+bool show_engine_stats = false;
 
 String debug_line[DEBUG_CONSOLE_NUMLINES];
 int first_debug_line = 0, last_debug_line = 0, display_console = 0;
@@ -153,10 +157,20 @@ void apply_debug_config(const ConfigTree &cfg)
     }
     DbgMgr.UnregisterOutput(OutputMsgBufID);
     DebugMsgBuff.reset();
+
+    // Frame profiler
+    int show_profiler = INIreadint(cfg, "debug", "profiler", 0);
+    String trace_file = INIreadstring(cfg, "debug", "profiler_trace");
+    if (show_profiler != 0 || !trace_file.IsEmpty())
+        Profiler::Init(show_profiler != 0, trace_file);
+
+    show_engine_stats = INIreadint(cfg, "debug", "stats", 0) != 0;
 }
 
 void shutdown_debug()
 {
+    Profiler::Shutdown();
+
     // Shutdown output subsystem
     DbgMgr.UnregisterAll();
 
@@ -490,8 +504,17 @@ void scriptDebugHook (ccInstance *ccinst, int linenum) {
 }
 
 int scrlockWasDown = 0;
+int profilerKeyWasDown = 0;
 
 void check_debug_keys() {
+    if (Profiler::IsEnabled()) {
+        // Ctrl+Alt+P toggles the profiler overlay
+        int keys_down = (key[KEY_LCONTROL] || key[KEY_RCONTROL]) && (key[KEY_ALT] || key[KEY_ALTGR]) && key[KEY_P];
+        if (keys_down && !profilerKeyWasDown)
+            Profiler::ToggleOverlay();
+        profilerKeyWasDown = keys_down;
+    }
+
     if (play.debug_mode) {
         // do the run-time script debugging
 
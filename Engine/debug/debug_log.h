@@ -45,6 +45,11 @@ extern AGS::Common::String debug_line[DEBUG_CONSOLE_NUMLINES];
 extern int first_debug_line, last_debug_line, display_console;
 extern bool enable_log_file;
 extern bool disable_log_file;
+// frame profiler options from the command line
+extern bool enable_profiler;
+extern AGS::Common::String profiler_trace_file;
+// print the engine's cache and renderer statistics to the log every second
+extern bool show_engine_stats;
 
 
 extern AGSPlatformDriver *platform;
@@ -0,0 +1,275 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <stdio.h>
+#include <string.h>
+#include "debug/out.h"
+#include "debug/profiler.h"
+#include "util/clock.h"
+#include "util/file.h"
+#include "util/stream.h"
+
+using namespace AGS::Common;
+
+namespace AGS
+{
+namespace Engine
+{
+
+namespace Profiler
+{
+
+// Number of recent frames kept for the overlay
+const int FrameHistory    = 60;
+// Max zones recorded per frame, the rest are dropped
+const int MaxFrameEvents  = 256;
+// Max zone nesting level, deeper zones are not recorded
+const int MaxDepth        = 16;
+
+struct ZoneEvent
+{
+    const char *Name;
+    int64_t     Start;
+    int32_t     Duration;
+    int16_t     Depth;
+    bool        Nested; // inside the zone of the same name
+};
+
+struct FrameRecord
+{
+    int64_t     Start;
+    int32_t     Duration;
+    int         EventCount;
+    ZoneEvent   Events[MaxFrameEvents];
+};
+
+struct OpenZone
+{
+    const char *Name;
+    int64_t     Start;
+    int         Event; // index of the record in the current frame, or -1
+};
+
+static bool     IsRunning = false;
+static bool     ShowOverlay = false;
+static int64_t  StartTime;
+static std::vector<FrameRecord> Frames;
+static int      CurFrame;
+static int      FramesDone;
+static bool     InFrame;
+static OpenZone ZoneStack[MaxDepth];
+static int      StackDepth;
+static Stream  *TraceOut = NULL;
+static bool     TraceHasEvents;
+
+static void WriteTraceEvent(const char *name, int64_t start, int64_t duration)
+{
+    char buf[256];
+    int len = snprintf(buf, sizeof(buf),
+        "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":1,\"tid\":1}",
+        TraceHasEvents ? ",\n" : "", name, (long long)(start - StartTime), (long long)duration);
+    if (len > 0)
+        TraceOut->Write(buf, len < (int)sizeof(buf) ? len : (int)sizeof(buf) - 1);
+    TraceHasEvents = true;
+}
+
+// Reserves a record for the zone at the given stack level, so that the
+// frame's records are kept in the order zones were opened
+static void OpenEvent(int depth, int64_t start)
+{
+    OpenZone &zone = ZoneStack[depth];
+    zone.Start = start;
+    zone.Event = -1;
+    FrameRecord &frame = Frames[CurFrame];
+    if (!InFrame || frame.EventCount == MaxFrameEvents)
+        return;
+    zone.Event = frame.EventCount++;
+    ZoneEvent &evt = frame.Events[zone.Event];
+    evt.Name = zone.Name;
+    evt.Start = start;
+    evt.Duration = 0;
+    evt.Depth = depth;
+    evt.Nested = false;
+    for (int i = 0; i < depth && !evt.Nested; ++i)
+        evt.Nested = strcmp(ZoneStack[i].Name, evt.Name) == 0;
+}
+
+static void CloseEvent(int depth, int64_t end)
+{
+    OpenZone &zone = ZoneStack[depth];
+    if (zone.Event < 0)
+        return;
+    ZoneEvent &evt = Frames[CurFrame].Events[zone.Event];
+    evt.Duration = (int32_t)(end - zone.Start);
+    if (TraceOut)
+        WriteTraceEvent(evt.Name, zone.Start, evt.Duration);
+}
+
+static void EndFrame(int64_t now)
+{
+    // zones which span over the frame boundary are closed here and
+    // reopened when the next frame begins
+    const int depth = StackDepth < MaxDepth ? StackDepth : MaxDepth;
+    for (int i = depth - 1; i >= 0; --i)
+    {
+        CloseEvent(i, now);
+        ZoneStack[i].Event = -1;
+    }
+    FrameRecord &frame = Frames[CurFrame];
+    frame.Duration = (int32_t)(now - frame.Start);
+    if (TraceOut)
+        WriteTraceEvent("frame", frame.Start, frame.Duration);
+    CurFrame = (CurFrame + 1) % FrameHistory;
+    FramesDone++;
+    InFrame = false;
+}
+
+void Init(bool show_overlay, const String &trace_file)
+{
+    Shutdown();
+    Frames.resize(FrameHistory);
+    CurFrame = 0;
+    FramesDone = 0;
+    InFrame = false;
+    StackDepth = 0;
+    StartTime = GetClockMicroseconds();
+    ShowOverlay = show_overlay;
+    if (!trace_file.IsEmpty())
+    {
+        TraceOut = File::CreateFile(trace_file);
+        if (TraceOut)
+        {
+            const char *header = "{\"traceEvents\":[\n";
+            TraceOut->Write(header, strlen(header));
+            TraceHasEvents = false;
+        }
+        else
+        {
+            Debug::Printf(kDbgMsg_Warn, "WARNING: unable to create profiler trace file %s", trace_file.GetCStr());
+        }
+    }
+    IsRunning = true;
+}
+
+void Shutdown()
+{
+    if (TraceOut)
+    {
+        if (InFrame)
+            EndFrame(GetClockMicroseconds());
+        const char *footer = "\n]}\n";
+        TraceOut->Write(footer, strlen(footer));
+        delete TraceOut;
+        TraceOut = NULL;
+    }
+    IsRunning = false;
+    ShowOverlay = false;
+    std::vector<FrameRecord>().swap(Frames);
+}
+
+bool IsEnabled()
+{
+    return IsRunning;
+}
+
+bool IsOverlayShown()
+{
+    return ShowOverlay;
+}
+
+void ToggleOverlay()
+{
+    if (IsRunning)
+        ShowOverlay = !ShowOverlay;
+}
+
+void BeginFrame()
+{
+    if (!IsRunning)
+        return;
+    int64_t now = GetClockMicroseconds();
+    if (InFrame)
+        EndFrame(now);
+    FrameRecord &frame = Frames[CurFrame];
+    frame.Start = now;
+    frame.Duration = 0;
+    frame.EventCount = 0;
+    InFrame = true;
+    const int depth = StackDepth < MaxDepth ? StackDepth : MaxDepth;
+    for (int i = 0; i < depth; ++i)
+        OpenEvent(i, now);
+}
+
+void BeginZone(const char *name)
+{
+    if (!IsRunning)
+        return;
+    if (StackDepth < MaxDepth)
+    {
+        ZoneStack[StackDepth].Name = name;
+        OpenEvent(StackDepth, GetClockMicroseconds());
+    }
+    StackDepth++;
+}
+
+void EndZone()
+{
+    if (!IsRunning || StackDepth == 0)
+        return;
+    StackDepth--;
+    if (StackDepth < MaxDepth)
+        CloseEvent(StackDepth, GetClockMicroseconds());
+}
+
+float GetZoneStats(std::vector<ZoneStat> &stats)
+{
+    stats.clear();
+    if (!IsRunning || FramesDone == 0)
+        return 0.f;
+    const int frame_count = FramesDone < FrameHistory ? FramesDone : FrameHistory;
+    std::vector<int64_t> totals;
+    int64_t frame_total = 0;
+    // walk from the last completed frame back in time
+    for (int f = 1; f <= frame_count; ++f)
+    {
+        const FrameRecord &frame = Frames[(CurFrame + FrameHistory - f) % FrameHistory];
+        frame_total += frame.Duration;
+        for (int e = 0; e < frame.EventCount; ++e)
+        {
+            const ZoneEvent &evt = frame.Events[e];
+            if (evt.Nested)
+                continue;
+            size_t i = 0;
+            for (; i < stats.size() && strcmp(stats[i].Name, evt.Name) != 0; ++i);
+            if (i == stats.size())
+            {
+                ZoneStat stat;
+                stat.Name = evt.Name;
+                stat.Depth = evt.Depth;
+                stat.AverageMs = 0.f;
+                stats.push_back(stat);
+                totals.push_back(0);
+            }
+            totals[i] += evt.Duration;
+        }
+    }
+    for (size_t i = 0; i < stats.size(); ++i)
+        stats[i].AverageMs = totals[i] / (1000.f * frame_count);
+    return frame_total / (1000.f * frame_count);
+}
+
+} // namespace Profiler
+
+} // namespace Engine
+} // namespace AGS
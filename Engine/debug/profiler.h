@@ -0,0 +1,84 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Frame profiler: measures time spent in the named zones of the engine code.
+// Zones recorded during the last frames are kept in a ring buffer and may
+// be summarized for the on-screen overlay; they may also be written to the
+// trace file which can be opened with Chrome's trace viewer
+// (chrome://tracing).
+//
+// Zones are only collected by the main thread; when the profiler is not
+// enabled they cost a single flag test.
+//
+//=============================================================================
+#ifndef __AGS_EE_DEBUG__PROFILER_H
+#define __AGS_EE_DEBUG__PROFILER_H
+
+#include <vector>
+#include "util/string.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+namespace Profiler
+{
+
+using AGS::Common::String;
+
+// Time spent in the zone, averaged over recent frames
+struct ZoneStat
+{
+    const char *Name;
+    int         Depth;      // nesting level of the zone's first occurrence
+    float       AverageMs;  // average time per frame
+};
+
+// Enables the profiler; if trace file name is not empty, all the zones
+// will be written to that file
+void Init(bool show_overlay, const String &trace_file);
+// Disables the profiler and closes the trace file
+void Shutdown();
+bool IsEnabled();
+
+bool IsOverlayShown();
+void ToggleOverlay();
+
+// Marks the beginning of the next game frame; zones that are still open
+// are split at the frame boundary
+void BeginFrame();
+// Opens named zone; name must be a string constant
+void BeginZone(const char *name);
+// Closes the last opened zone
+void EndZone();
+
+// Gets zone times averaged over the recorded frames, in the order of their
+// appearance in the last frame; returns average frame time in milliseconds
+float GetZoneStats(std::vector<ZoneStat> &stats);
+
+// Measures the time until the end of the enclosing scope
+class Zone
+{
+public:
+    explicit Zone(const char *name) { BeginZone(name); }
+    ~Zone() { EndZone(); }
+};
+
+} // namespace Profiler
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_DEBUG__PROFILER_H
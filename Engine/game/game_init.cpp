@@ -14,6 +14,7 @@
 
 #include "ac/character.h"
 #include "ac/charactercache.h"
+#include "ac/characterindex.h"
 #include "ac/dialog.h"
 #include "ac/draw.h"
 #include "ac/file.h"
@@ -23,6 +24,7 @@
 #include "ac/gamestate.h"
 #include "ac/gui.h"
 #include "ac/movelist.h"
+#include "ac/textruncache.h"
 #include "ac/dynobj/all_dynamicclasses.h"
 #include "ac/dynobj/all_scriptclasses.h"
 #include "ac/statobj/agsstaticobject.h"
@@ -133,13 +135,13 @@ void InitAndRegisterAudioObjects()
     for (int i = 0; i <= MAX_SOUND_CHANNELS; ++i) 
     {
         scrAudioChannel[i].id = i;
-        ccRegisterManagedObject(&scrAudioChannel[i], &ccDynamicAudio);
+        ccRegisterPersistentObject(&scrAudioChannel[i], &ccDynamicAudio);
     }
 
     for (int i = 0; i < game.audioClipCount; ++i)
     {
         game.audioClips[i].id = i;
-        ccRegisterManagedObject(&game.audioClips[i], &ccDynamicAudioClip);
+        ccRegisterPersistentObject(&game.audioClips[i], &ccDynamicAudioClip);
         ccAddExternalDynamicObject(game.audioClips[i].scriptName, &game.audioClips[i], &ccDynamicAudioClip);
     }
 }
@@ -163,12 +165,13 @@ void InitAndRegisterCharacters()
         game.chars[i].loop = 0;
         game.chars[i].frame = 0;
         game.chars[i].walkwait = -1;
-        ccRegisterManagedObject(&game.chars[i], &ccDynamicCharacter);
+        ccRegisterPersistentObject(&game.chars[i], &ccDynamicCharacter);
 
         // export the character's script object
         characterScriptObjNames[i] = game.chars[i].scrname;
         ccAddExternalDynamicObject(characterScriptObjNames[i], &game.chars[i], &ccDynamicCharacter);
     }
+    charindex_invalidate();
 }
 
 // Initializes dialog and registers them in the script system
@@ -179,7 +182,7 @@ void InitAndRegisterDialogs()
     {
         scrDialog[i].id = i;
         scrDialog[i].reserved = 0;
-        ccRegisterManagedObject(&scrDialog[i], &ccDynamicDialog);
+        ccRegisterPersistentObject(&scrDialog[i], &ccDynamicDialog);
 
         if (!game.dialogScriptNames[i].IsEmpty())
             ccAddExternalDynamicObject(game.dialogScriptNames[i], &scrDialog[i], &ccDynamicDialog);
@@ -189,7 +192,7 @@ void InitAndRegisterDialogs()
 // Initializes dialog options rendering objects and registers them in the script system
 void InitAndRegisterDialogOptions()
 {
-    ccRegisterManagedObject(&ccDialogOptionsRendering, &ccDialogOptionsRendering);
+    ccRegisterPersistentObject(&ccDialogOptionsRendering, &ccDialogOptionsRendering);
 
     dialogOptionsRenderingSurface = new ScriptDrawingSurface();
     dialogOptionsRenderingSurface->isLinkedBitmapOnly = true;
@@ -222,7 +225,7 @@ void InitAndRegisterGUI()
         guiScriptObjNames[i] = guis[i].Name;
         scrGui[i].id = i;
         ccAddExternalDynamicObject(guiScriptObjNames[i], &scrGui[i], &ccDynamicGUI);
-        ccRegisterManagedObject(&scrGui[i], &ccDynamicGUI);
+        ccRegisterPersistentObject(&scrGui[i], &ccDynamicGUI);
     }
 }
 
@@ -233,7 +236,7 @@ void InitAndRegisterInvItems()
     {
         scrInv[i].id = i;
         scrInv[i].reserved = 0;
-        ccRegisterManagedObject(&scrInv[i], &ccDynamicInv);
+        ccRegisterPersistentObject(&scrInv[i], &ccDynamicInv);
 
         if (!game.invScriptNames[i].IsEmpty())
             ccAddExternalDynamicObject(game.invScriptNames[i], &scrInv[i], &ccDynamicInv);
@@ -247,7 +250,7 @@ void InitAndRegisterHotspots()
     {
         scrHotspot[i].id = i;
         scrHotspot[i].reserved = 0;
-        ccRegisterManagedObject(&scrHotspot[i], &ccDynamicHotspot);
+        ccRegisterPersistentObject(&scrHotspot[i], &ccDynamicHotspot);
     }
 }
 
@@ -256,7 +259,7 @@ void InitAndRegisterRoomObjects()
 {
     for (int i = 0; i < MAX_INIT_SPR; ++i)
     {
-        ccRegisterManagedObject(&scrObj[i], &ccDynamicObject);
+        ccRegisterPersistentObject(&scrObj[i], &ccDynamicObject);
     }
 }
 
@@ -267,7 +270,7 @@ void InitAndRegisterRegions()
     {
         scrRegion[i].id = i;
         scrRegion[i].reserved = 0;
-        ccRegisterManagedObject(&scrRegion[i], &ccDynamicRegion);
+        ccRegisterPersistentObject(&scrRegion[i], &ccDynamicRegion);
     }
 }
 
@@ -333,6 +336,7 @@ void LoadFonts()
         if (!wloadfont_size(i, finfo, NULL))
             quitprintf("Unable to load font %d, no renderer could load a matching file", i);
     }
+    textcache_clear();
 }
 
 void AllocScriptModules()
@@ -340,14 +344,22 @@ void AllocScriptModules()
     moduleInst.resize(numScriptModules, NULL);
     moduleInstFork.resize(numScriptModules, NULL);
     moduleRepExecAddr.resize(numScriptModules);
-    repExecAlways.moduleHasFunction.resize(numScriptModules, true);
-    lateRepExecAlways.moduleHasFunction.resize(numScriptModules, true);
-    getDialogOptionsDimensionsFunc.moduleHasFunction.resize(numScriptModules, true);
-    renderDialogOptionsFunc.moduleHasFunction.resize(numScriptModules, true);
-    getDialogOptionUnderCursorFunc.moduleHasFunction.resize(numScriptModules, true);
-    runDialogOptionMouseClickHandlerFunc.moduleHasFunction.resize(numScriptModules, true);
-    runDialogOptionKeyPressHandlerFunc.moduleHasFunction.resize(numScriptModules, true);
-    runDialogOptionRepExecFunc.moduleHasFunction.resize(numScriptModules, true);
+    repExecAlways.moduleFuncAddr.resize(numScriptModules, kScFuncAddr_Unresolved);
+    lateRepExecAlways.moduleFuncAddr.resize(numScriptModules, kScFuncAddr_Unresolved);
+    getDialogOptionsDimensionsFunc.moduleFuncAddr.resize(numScriptModules, kScFuncAddr_Unresolved);
+    renderDialogOptionsFunc.moduleFuncAddr.resize(numScriptModules, kScFuncAddr_Unresolved);
+    getDialogOptionUnderCursorFunc.moduleFuncAddr.resize(numScriptModules, kScFuncAddr_Unresolved);
+    runDialogOptionMouseClickHandlerFunc.moduleFuncAddr.resize(numScriptModules, kScFuncAddr_Unresolved);
+    runDialogOptionKeyPressHandlerFunc.moduleFuncAddr.resize(numScriptModules, kScFuncAddr_Unresolved);
+    runDialogOptionRepExecFunc.moduleFuncAddr.resize(numScriptModules, kScFuncAddr_Unresolved);
+    repExecAlways.globalScriptFuncAddr = kScFuncAddr_Unresolved;
+    lateRepExecAlways.globalScriptFuncAddr = kScFuncAddr_Unresolved;
+    getDialogOptionsDimensionsFunc.globalScriptFuncAddr = kScFuncAddr_Unresolved;
+    renderDialogOptionsFunc.globalScriptFuncAddr = kScFuncAddr_Unresolved;
+    getDialogOptionUnderCursorFunc.globalScriptFuncAddr = kScFuncAddr_Unresolved;
+    runDialogOptionMouseClickHandlerFunc.globalScriptFuncAddr = kScFuncAddr_Unresolved;
+    runDialogOptionKeyPressHandlerFunc.globalScriptFuncAddr = kScFuncAddr_Unresolved;
+    runDialogOptionRepExecFunc.globalScriptFuncAddr = kScFuncAddr_Unresolved;
     for (int i = 0; i < numScriptModules; ++i)
     {
         moduleRepExecAddr[i].Invalidate();
@@ -13,6 +13,7 @@
 //=============================================================================
 
 #include "ac/character.h"
+#include "ac/characterindex.h"
 #include "ac/common.h"
 #include "ac/draw.h"
 #include "ac/dynamicsprite.h"
@@ -40,6 +41,7 @@
 #include "game/savegame.h"
 #include "game/savegame_components.h"
 #include "game/savegame_internal.h"
+#include "game/savegame_writer.h"
 #include "main/main.h"
 #include "media/audio/audio.h"
 #include "media/audio/soundclip.h"
@@ -259,6 +261,8 @@ SavegameError ReadDescription_v321(Stream *in, SavegameVersion &svg_ver, Savegam
 
 SavegameError OpenSavegameBase(const String &filename, SavegameSource *src, SavegameDescription *desc, SavegameDescElem elems)
 {
+    // the file may still be written in the background
+    WaitForSavegameWrites();
     AStream in(File::OpenFileRead(filename));
     if (!in.get())
         return kSvgErr_FileNotFound;
@@ -412,6 +416,9 @@ void DoBeforeRestore(PreservedParams &pp)
 // Final processing after successfully restoring from save
 SavegameError DoAfterRestore(const PreservedParams &pp, const RestoredData &r_data)
 {
+    // characters were read anew, with their rooms
+    charindex_invalidate();
+
     // Use a yellow dialog highlight for older game versions
     // CHECKME: it is dubious that this should be right here
     if(loaded_game_file_version < kGameVersion_331)
@@ -673,7 +680,12 @@ PStream StartSavegame(const String &filename, const String &user_text, const Bit
     Stream *out = Common::File::CreateFile(filename);
     if (!out)
         return PStream();
+    StartSavegame(out, user_text, user_image);
+    return PStream(out);
+}
 
+void StartSavegame(Stream *out, const String &user_text, const Bitmap *user_image)
+{
     // Initialize and write Vista header
     RICH_GAME_MEDIA_HEADER vistaHeader;
     memset(&vistaHeader, 0, sizeof(RICH_GAME_MEDIA_HEADER));
@@ -699,7 +711,6 @@ PStream StartSavegame(const String &filename, const String &user_text, const Bit
 
     // Write descrition block
     WriteDescription(out, user_text, user_image);
-    return PStream(out);
 }
 
 void DoBeforeSave()
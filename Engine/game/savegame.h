@@ -146,6 +146,8 @@ SavegameError  RestoreGameState(PStream in, SavegameVersion svg_version);
 
 // Opens savegame for writing and puts in savegame description
 PStream        StartSavegame(const String &filename, const String &user_text, const Bitmap *user_image);
+// Puts savegame description into the given stream
+void           StartSavegame(Stream *out, const String &user_text, const Bitmap *user_image);
 
 // Prepares game for saving state and writes game data into the save stream
 void           SaveGameState(PStream out);
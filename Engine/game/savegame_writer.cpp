@@ -0,0 +1,319 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// The writing thread only deals with files and with the bitmaps handed over
+// to it; it does not touch any game state. Saves are written one at a time,
+// in the order they were made. The screenshot bitmaps are not deleted on the
+// writing thread, but passed back with the results; failures are logged when
+// the main thread takes the results, too.
+//
+//=============================================================================
+
+#include <deque>
+#include <string.h>
+#include "ac/richgamemedia.h"
+#include "debug/out.h"
+#include "game/savegame_writer.h"
+#include "gfx/bitmap.h"
+#include "platform/base/agsplatformdriver.h"
+#include "util/file.h"
+#include "util/memorystream.h"
+#include "util/mutex.h"
+#include "util/mutex_lock.h"
+#include "util/stream.h"
+#include "util/thread.h"
+#include "util/wgt2allg.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+extern char saveGameDirectory[260];
+extern color palette[256];
+
+namespace
+{
+
+// Time the writing thread sleeps when it has nothing to do, in milliseconds
+const int WriterIdleDelay = 10;
+// Time the main thread sleeps while waiting for the saves to be written
+const int WriterWaitDelay = 1;
+
+struct SaveJob
+{
+    int               Slot;
+    String            FileName;
+    String            TempFileName;
+    String            ImageFileName;
+    std::vector<char> Data;
+    Bitmap           *Screenshot;
+    color             Palette[256];
+};
+
+struct SaveResult
+{
+    int     Slot;
+    String  FileName;
+    bool    Success;
+    Bitmap *Screenshot;
+};
+
+// Reads the whole file into the buffer
+bool read_file_data(const String &filename, std::vector<char> &data)
+{
+    Stream *in = File::OpenFileRead(filename);
+    if (!in)
+        return false;
+    data.resize(in->GetLength());
+    size_t read = data.empty() ? 0 : in->Read(&data[0], data.size());
+    delete in;
+    return read == data.size();
+}
+
+bool write_savegame(SaveJob &job)
+{
+    std::vector<char> image;
+    if (job.Screenshot)
+    {
+        // the screenshot is put after the game data, and the rich media
+        // header is told where to find it
+        job.Screenshot->SaveToFile(job.ImageFileName, job.Palette);
+        if (File::TestReadFile(job.ImageFileName))
+        {
+            read_file_data(job.ImageFileName, image);
+            File::DeleteFile(job.ImageFileName);
+        }
+        MemoryStream header(job.Data);
+        header.Seek(12, kSeekBegin);
+        header.WriteInt32(job.Data.size() - sizeof(RICH_GAME_MEDIA_HEADER));
+        header.Seek(4, kSeekCurrent);
+        header.WriteInt32(image.size());
+    }
+
+    Stream *out = File::CreateFile(job.TempFileName);
+    if (!out)
+        return false;
+    bool written = out->Write(&job.Data[0], job.Data.size()) == job.Data.size();
+    if (written && !image.empty())
+        written = out->Write(&image[0], image.size()) == image.size();
+    written = written && out->Flush();
+    delete out;
+
+    if (!written || !File::RenameFile(job.TempFileName, job.FileName))
+    {
+        File::DeleteFile(job.TempFileName);
+        return false;
+    }
+    return true;
+}
+
+class SavegameWriter
+{
+public:
+    SavegameWriter();
+
+    bool Start();
+    void Stop();
+    bool IsRunning() const;
+    void Queue(int slot, const String &filename, std::vector<char> &data, Bitmap *screenshot);
+    void Wait();
+    void AddResult(int slot, const String &filename, bool success);
+    bool GetResult(int &slot, bool &success);
+
+    // Thread entry point
+    static void Run();
+
+private:
+    void RunStep();
+    void FreeResults();
+
+    Thread      _thread;
+    bool        _started;
+    Mutex       _mutex;
+    // Following are protected by the mutex; the job being written stays
+    // in front of the queue until it is done
+    std::deque<SaveJob*>   _jobs;
+    std::deque<SaveResult> _results;
+};
+
+SavegameWriter::SavegameWriter()
+    : _started(false)
+{
+}
+
+SavegameWriter Writer;
+
+void SavegameWriter::Run()
+{
+    Writer.RunStep();
+}
+
+bool SavegameWriter::Start()
+{
+    Stop();
+    _started = _thread.CreateAndStart(SavegameWriter::Run, true);
+    return _started;
+}
+
+void SavegameWriter::Stop()
+{
+    if (!_started)
+        return;
+    // losing a save the player was told about is worse than a slow exit
+    Wait();
+    _thread.Stop();
+    _started = false;
+    FreeResults();
+}
+
+bool SavegameWriter::IsRunning() const
+{
+    return _started;
+}
+
+void SavegameWriter::Queue(int slot, const String &filename, std::vector<char> &data, Bitmap *screenshot)
+{
+    SaveJob *job = new SaveJob();
+    job->Slot = slot;
+    job->FileName = filename;
+    job->TempFileName = String::FromFormat("%s""_tmpsave.tmp", saveGameDirectory);
+    job->ImageFileName = String::FromFormat("%s""_tmpscht.bmp", saveGameDirectory);
+    job->Data.swap(data);
+    job->Screenshot = screenshot;
+    memcpy(job->Palette, palette, sizeof(job->Palette));
+
+    MutexLock lock(_mutex);
+    _jobs.push_back(job);
+}
+
+void SavegameWriter::Wait()
+{
+    if (!_started)
+        return;
+
+    MutexLock lock(_mutex);
+    while (!_jobs.empty())
+    {
+        lock.Release();
+        platform->Delay(WriterWaitDelay);
+        lock.Acquire(_mutex);
+    }
+}
+
+void SavegameWriter::AddResult(int slot, const String &filename, bool success)
+{
+    SaveResult result;
+    result.Slot = slot;
+    result.FileName = filename;
+    result.Success = success;
+    result.Screenshot = NULL;
+
+    MutexLock lock(_mutex);
+    _results.push_back(result);
+}
+
+bool SavegameWriter::GetResult(int &slot, bool &success)
+{
+    MutexLock lock(_mutex);
+    if (_results.empty())
+        return false;
+    SaveResult result = _results.front();
+    _results.pop_front();
+    lock.Release();
+
+    if (!result.Success)
+        Debug::Printf(kDbgMsg_Error, "Failed to write savegame: %s", result.FileName.GetCStr());
+    delete result.Screenshot;
+    slot = result.Slot;
+    success = result.Success;
+    return true;
+}
+
+void SavegameWriter::FreeResults()
+{
+    MutexLock lock(_mutex);
+    for (size_t i = 0; i < _results.size(); ++i)
+        delete _results[i].Screenshot;
+    _results.clear();
+}
+
+void SavegameWriter::RunStep()
+{
+    MutexLock lock(_mutex);
+    if (_jobs.empty())
+    {
+        lock.Release();
+        platform->Delay(WriterIdleDelay);
+        return;
+    }
+    SaveJob *job = _jobs.front();
+    lock.Release();
+
+    SaveResult result;
+    result.Slot = job->Slot;
+    result.FileName = job->FileName;
+    result.Success = write_savegame(*job);
+    result.Screenshot = job->Screenshot;
+
+    lock.Acquire(_mutex);
+    _jobs.pop_front();
+    _results.push_back(result);
+    lock.Release();
+    delete job;
+}
+
+} // namespace
+
+
+namespace AGS
+{
+namespace Engine
+{
+
+bool StartSavegameWriter()
+{
+    return Writer.Start();
+}
+
+void StopSavegameWriter()
+{
+    Writer.Stop();
+}
+
+bool IsSavegameWriterRunning()
+{
+    return Writer.IsRunning();
+}
+
+void QueueSavegameWrite(int slot, const String &filename, std::vector<char> &data, Bitmap *screenshot)
+{
+    Writer.Queue(slot, filename, data, screenshot);
+}
+
+void WaitForSavegameWrites()
+{
+    Writer.Wait();
+}
+
+void PushWrittenSavegame(int slot, const String &filename, bool success)
+{
+    Writer.AddResult(slot, filename, success);
+}
+
+bool GetWrittenSavegame(int &slot, bool &success)
+{
+    return Writer.GetResult(slot, success);
+}
+
+} // namespace Engine
+} // namespace AGS
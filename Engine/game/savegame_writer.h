@@ -0,0 +1,61 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Background savegame writing. The game state is serialized into memory on
+// the main thread, and the file is written on a separate thread. Each save
+// is first written under a temporary name and then renamed over the slot's
+// file, so that an interrupted save does not destroy the previous one.
+//
+//=============================================================================
+#ifndef __AGS_EE_GAME__SAVEGAMEWRITER_H
+#define __AGS_EE_GAME__SAVEGAMEWRITER_H
+
+#include <vector>
+#include "util/string.h"
+
+namespace AGS
+{
+namespace Common { class Bitmap; }
+
+namespace Engine
+{
+
+using Common::Bitmap;
+using Common::String;
+
+// Starts the writing thread
+bool StartSavegameWriter();
+// Finishes all the pending saves and stops the writing thread
+void StopSavegameWriter();
+// Tells if the saves may be written in the background
+bool IsSavegameWriterRunning();
+// Queues savegame data for writing into the given file. The data is taken
+// from the given buffer, which is left empty. If there is a screenshot, it
+// is appended to the data and registered in the rich media header; the
+// writer takes the ownership of the bitmap.
+void QueueSavegameWrite(int slot, const String &filename, std::vector<char> &data, Bitmap *screenshot);
+// Waits until all the pending saves are written; this has to be done
+// before reading or modifying savegame files on the main thread
+void WaitForSavegameWrites();
+// Adds the result of a save written on the main thread, so that it is
+// reported in order with the ones written in the background
+void PushWrittenSavegame(int slot, const String &filename, bool success);
+// Gets the result of the next finished save; returns false if there are none.
+// The saves which failed are written to the log.
+bool GetWrittenSavegame(int &slot, bool &success);
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_GAME__SAVEGAMEWRITER_H
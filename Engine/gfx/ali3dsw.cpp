@@ -16,13 +16,18 @@
 //
 //=============================================================================
 
+#include "debug/profiler.h"
 #include "gfx/ali3dexception.h"
 #include "gfx/ali3dsw.h"
+#include "gfx/blend_kernels.h"
 #include "gfx/gfxfilter_allegro.h"
 #include "gfx/gfxfilter_hqx.h"
 #include "gfx/gfx_util.h"
+#include "gfx/renderthreads.h"
 #include "main/main_allegro.h"
 #include "platform/base/agsplatformdriver.h"
+#include "util/geometry.h"
+#include "util/math.h"
 
 #if defined(PSP_VERSION)
 // PSP: Includes for sceKernelDelayThread.
@@ -47,6 +52,8 @@ extern "C" DDRAW_SURFACE *gfx_directx_primary_surface;
 extern int dxmedia_play_video (const char*, bool, int, int);
 #endif // WINDOWS_VERSION
 
+extern "C" unsigned long _blender_trans24(unsigned long x, unsigned long y, unsigned long n);
+
 namespace AGS
 {
 namespace Engine
@@ -55,6 +62,7 @@ namespace ALSW
 {
 
 namespace BitmapHelper = AGS::Common::BitmapHelper;
+namespace Math = AGS::Common::Math;
 
 bool ALSoftwareGfxModeList::GetMode(int index, DisplayMode &mode) const
 {
@@ -71,6 +79,9 @@ bool ALSoftwareGfxModeList::GetMode(int index, DisplayMode &mode) const
 unsigned long _trans_alpha_blender32(unsigned long x, unsigned long y, unsigned long n);
 RGB faded_out_palette[256];
 
+// If the frame changed in more places, they are joined into one region
+const size_t MaxDirtyRects = 16;
+
 
 ALSoftwareGraphicsDriver::ALSoftwareGraphicsDriver()
 {
@@ -84,6 +95,14 @@ ALSoftwareGraphicsDriver::ALSoftwareGraphicsDriver()
   dxGammaControl = NULL;
 #endif
   _allegroScreenWrapper = NULL;
+  virtualScreen = NULL;
+  _lastBitmapStamp = 0;
+  _useDirtyRects = false;
+  _lastFrameValid = false;
+  _presentFull = true;
+  _lastPresentX = 0;
+  _lastPresentY = 0;
+  _composeThreads = -1;
 }
 
 bool ALSoftwareGraphicsDriver::IsModeSupported(const DisplayMode &mode)
@@ -172,6 +191,8 @@ void ALSoftwareGraphicsDriver::SetGraphicsFilter(PALSWFilter filter)
 {
   _filter = filter;
   OnSetFilter();
+  if (_filter)
+    _filter->UseDirtyRects(_useDirtyRects);
 
   // If we already have a gfx mode set, then use the new filter to update virtual screen immediately
   CreateVirtualScreen();
@@ -186,14 +207,13 @@ bool ALSoftwareGraphicsDriver::SetDisplayMode(const DisplayMode &mode, volatile
 {
   ReleaseDisplayMode();
 
-  const int driver = GetAllegroGfxDriverID(mode.Windowed);
-
   set_color_depth(mode.ColorDepth);
 
   if (_initGfxCallback != NULL)
     _initGfxCallback(NULL);
 
-  if (!IsModeSupported(mode) || set_gfx_mode(driver, mode.Width, mode.Height, 0, 0) != 0)
+  BITMAP *display_bmp = InitDisplay(mode);
+  if (!display_bmp)
     return false;
 
   OnInit(loopTimer);
@@ -202,7 +222,7 @@ bool ALSoftwareGraphicsDriver::SetDisplayMode(const DisplayMode &mode, volatile
   // set_gfx_mode is an allegro function that creates screen bitmap;
   // following code assumes the screen is already created, therefore we should
   // ensure global bitmap wraps over existing allegro screen bitmap.
-  _allegroScreenWrapper = BitmapHelper::CreateRawBitmapWrapper(screen);
+  _allegroScreenWrapper = BitmapHelper::CreateRawBitmapWrapper(display_bmp);
   BitmapHelper::SetScreenBitmap( _allegroScreenWrapper );
   BitmapHelper::GetScreenBitmap()->Clear();
 
@@ -212,6 +232,14 @@ bool ALSoftwareGraphicsDriver::SetDisplayMode(const DisplayMode &mode, volatile
 
   // If we already have a gfx filter, then use it to update virtual screen immediately
   CreateVirtualScreen();
+  return true;
+}
+
+BITMAP *ALSoftwareGraphicsDriver::InitDisplay(const DisplayMode &mode)
+{
+  const int driver = GetAllegroGfxDriverID(mode.Windowed);
+  if (!IsModeSupported(mode) || set_gfx_mode(driver, mode.Width, mode.Height, 0, 0) != 0)
+    return NULL;
 
 #ifdef _WIN32
   if (!mode.Windowed)
@@ -227,8 +255,7 @@ bool ALSoftwareGraphicsDriver::SetDisplayMode(const DisplayMode &mode, volatile
     }
   }
 #endif
-
-  return true;
+  return screen;
 }
 
 void ALSoftwareGraphicsDriver::CreateVirtualScreen()
@@ -242,12 +269,14 @@ void ALSoftwareGraphicsDriver::CreateVirtualScreen()
   // (which may or not be the same as real screen)
   virtualScreen = _filter->InitVirtualScreen(real_screen, _srcRect.GetSize(), _dstRect);
   BitmapHelper::SetScreenBitmap( virtualScreen );
+  ForgetLastFrame();
 }
 
 void ALSoftwareGraphicsDriver::ReleaseDisplayMode()
 {
   OnModeReleased();
   drawlist.clear();
+  ForgetLastFrame();
 
 #ifdef _WIN32
   if (dxGammaControl != NULL) 
@@ -269,6 +298,7 @@ void ALSoftwareGraphicsDriver::ReleaseDisplayMode()
   // not change allegro screen pointer (at this moment it should point at the
   // original internally created allegro bitmap which will be destroyed by Allegro).
   BitmapHelper::SetScreenBitmap(NULL);
+  ReleaseDisplay();
 }
 
 bool ALSoftwareGraphicsDriver::SetNativeSize(const Size &src_size)
@@ -293,6 +323,8 @@ void ALSoftwareGraphicsDriver::ClearRectangle(int x1, int y1, int x2, int y2, RG
   if (colorToUse != NULL) 
     color = makecol_depth(_mode.ColorDepth, colorToUse->r, colorToUse->g, colorToUse->b);
   _filter->ClearRect(x1, y1, x2, y2, color);
+  // real screen may be the back buffer too
+  ForgetLastFrame();
 }
 
 ALSoftwareGraphicsDriver::~ALSoftwareGraphicsDriver()
@@ -349,7 +381,7 @@ Bitmap *ALSoftwareGraphicsDriver::ConvertBitmapToSupportedColourDepth(Bitmap *bi
 
 IDriverDependantBitmap* ALSoftwareGraphicsDriver::CreateDDBFromBitmap(Bitmap *bitmap, bool hasAlpha, bool opaque)
 {
-  ALSoftwareBitmap* newBitmap = new ALSoftwareBitmap(bitmap, opaque, hasAlpha);
+  ALSoftwareBitmap* newBitmap = new ALSoftwareBitmap(bitmap, opaque, hasAlpha, ++_lastBitmapStamp);
   return newBitmap;
 }
 
@@ -358,6 +390,10 @@ void ALSoftwareGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* bitma
   ALSoftwareBitmap* alSwBmp = (ALSoftwareBitmap*)bitmapToUpdate;
   alSwBmp->_bmp = bitmap;
   alSwBmp->_hasAlpha = hasAlpha;
+  alSwBmp->_stamp = ++_lastBitmapStamp;
+  // converted image is out of date now
+  delete alSwBmp->_convertedBmp;
+  alSwBmp->_convertedBmp = NULL;
 }
 
 void ALSoftwareGraphicsDriver::DestroyDDB(IDriverDependantBitmap* bitmap)
@@ -375,58 +411,399 @@ void ALSoftwareGraphicsDriver::ClearDrawList()
   drawlist.clear();
 }
 
-void ALSoftwareGraphicsDriver::RenderToBackBuffer()
+void ALSoftwareGraphicsDriver::RenderSprite(Bitmap *ds, ALSoftwareBitmap *bitmap, int drawAtX, int drawAtY)
 {
-  for (size_t i = 0; i < drawlist.size(); i++)
+  if ((bitmap->_opaque) && (bitmap->_bmp == virtualScreen))
+  { }
+  else if (bitmap->_opaque)
+  {
+    ds->Blit(bitmap->_bmp, 0, 0, drawAtX, drawAtY, bitmap->_bmp->GetWidth(), bitmap->_bmp->GetHeight());
+  }
+  else if (bitmap->_transparency >= 255)
+  {
+    // fully transparent... invisible, do nothing
+  }
+  else if (bitmap->_hasAlpha)
   {
-    if (drawlist[i].bitmap == NULL)
+    // here _transparency is used as alpha (between 1 and 254), but 0 means opaque!
+    const BlendKernels::BlendOp blend_op = bitmap->_transparency == 0 ?
+        BlendKernels::kBlendOp_Alpha32 : BlendKernels::kBlendOp_TransAlpha32;
+    if (!BlendKernels::BlendBlt(ds, bitmap->_bmp, drawAtX, drawAtY, blend_op, bitmap->_transparency))
     {
-      if (_nullSpriteCallback)
-        _nullSpriteCallback(drawlist[i].x, drawlist[i].y);
+      if (bitmap->_transparency == 0) // this means opaque
+        set_alpha_blender();
       else
-        throw Ali3DException("Unhandled attempt to draw null sprite");
+        // here _transparency is used as alpha (between 1 and 254)
+        set_blender_mode(NULL, NULL, _trans_alpha_blender32, 0, 0, 0, bitmap->_transparency);
+
+      ds->TransBlendBlt(bitmap->_bmp, drawAtX, drawAtY);
+    }
+  }
+  else
+  {
+    Bitmap *sprite = bitmap->_bmp;
+    if (GfxUtil::NeedsDepthConversion(ds, sprite))
+    {
+      Bitmap *converted = GetConvertedImage(bitmap);
+      if (converted)
+        sprite = converted;
+    }
+    // here _transparency is used as alpha (between 1 and 254), but 0 means opaque!
+    GfxUtil::DrawSpriteWithTransparency(ds, sprite, drawAtX, drawAtY,
+        bitmap->_transparency ? bitmap->_transparency : 255);
+  }
+}
 
+// Bands narrower than this are not worth a thread
+const int MinComposeBandHeight = 32;
+
+struct ComposeJob
+{
+  ALSoftwareGraphicsDriver *Driver;
+  const std::vector<Rect>  *Regions;
+  size_t                    First;
+  size_t                    Last;
+  std::vector<Bitmap*>      Surfaces;
+  std::vector<Rect>         Areas;
+};
+
+void ALSoftwareGraphicsDriver::ComposeBand(void *data, int band)
+{
+  ComposeJob *job = (ComposeJob*)data;
+  job->Driver->ComposeArea(job->Surfaces[band], job->Areas[band], *job->Regions, job->First, job->Last);
+}
+
+void ALSoftwareGraphicsDriver::ComposeArea(Bitmap *ds, const Rect &area, const std::vector<Rect> &regions,
+                                           size_t first, size_t last)
+{
+  for (size_t r = 0; r < regions.size(); r++)
+  {
+    const Rect clip = IntersectRects(regions[r], area);
+    if (clip.IsEmpty())
       continue;
+    ds->SetClip(RectWH(clip.Left - area.Left, clip.Top - area.Top, clip.GetWidth(), clip.GetHeight()));
+    for (size_t i = first; i < last; i++)
+    {
+      ALSoftwareBitmap* bitmap = drawlist[i].bitmap;
+      if (bitmap != NULL && AreRectsIntersecting(clip,
+            RectWH(drawlist[i].x, drawlist[i].y, bitmap->_bmp->GetWidth(), bitmap->_bmp->GetHeight())))
+        RenderSprite(ds, bitmap, drawlist[i].x - area.Left, drawlist[i].y - area.Top);
     }
+  }
+}
 
+bool ALSoftwareGraphicsDriver::CanComposeConcurrently(size_t first, size_t last)
+{
+  // sub-bitmaps of a video bitmap share the display's state, and drawing
+  // on them may need the display to be acquired
+  if (!virtualScreen->IsMemoryBitmap())
+    return false;
+  const int depth = virtualScreen->GetColorDepth();
+  for (size_t i = first; i < last; i++)
+  {
     ALSoftwareBitmap* bitmap = drawlist[i].bitmap;
-    int drawAtX = drawlist[i].x;
-    int drawAtY = drawlist[i].y;
-
-    if ((bitmap->_opaque) && (bitmap->_bmp == virtualScreen))
-    { }
-    else if (bitmap->_opaque)
+    if (bitmap == NULL)
+      continue;
+    Bitmap *sprite = bitmap->_bmp;
+    if (bitmap->_opaque)
     {
-      virtualScreen->Blit(bitmap->_bmp, 0, 0, drawAtX, drawAtY, bitmap->_bmp->GetWidth(), bitmap->_bmp->GetHeight());
+      // blitting between color depths uses Allegro's conversion state
+      if (sprite != virtualScreen && sprite->GetColorDepth() != depth)
+        return false;
     }
     else if (bitmap->_transparency >= 255)
     {
-      // fully transparent... invisible, do nothing
+      // invisible
     }
     else if (bitmap->_hasAlpha)
     {
-      if (bitmap->_transparency == 0) // this means opaque
-        set_alpha_blender();
-      else
-        // here _transparency is used as alpha (between 1 and 254)
-        set_blender_mode(NULL, NULL, _trans_alpha_blender32, 0, 0, 0, bitmap->_transparency);
+      // the fallback for these sets Allegro's global blender
+      const BlendKernels::BlendOp blend_op = bitmap->_transparency == 0 ?
+          BlendKernels::kBlendOp_Alpha32 : BlendKernels::kBlendOp_TransAlpha32;
+      if (!BlendKernels::CanBlendBlt(virtualScreen, sprite, blend_op))
+        return false;
+    }
+    else
+    {
+      // converted images are cached in the bitmap, so have them made here
+      if (GfxUtil::NeedsDepthConversion(virtualScreen, sprite))
+      {
+        sprite = GetConvertedImage(bitmap);
+        if (!sprite)
+          return false;
+      }
+      if (!GfxUtil::CanDrawSpriteConcurrently(virtualScreen, sprite,
+            bitmap->_transparency ? bitmap->_transparency : 255))
+        return false;
+    }
+  }
+  return true;
+}
+
+void ALSoftwareGraphicsDriver::ComposeSprites(const std::vector<Rect> &regions, size_t first, size_t last)
+{
+  const Rect screen_rc = RectWH(virtualScreen->GetSize());
+  int threads = RenderThreads::GetThreadCount() + 1;
+  if (_composeThreads >= 0)
+    threads = Math::Min(threads, _composeThreads);
+  const int band_count = Math::Min(threads, screen_rc.GetHeight() / MinComposeBandHeight);
+  if (band_count < 2 || first >= last || !CanComposeConcurrently(first, last))
+  {
+    ComposeArea(virtualScreen, screen_rc, regions, first, last);
+    return;
+  }
+
+  // Split back buffer into horizontal bands, each one drawn by its own
+  // thread on a sub-bitmap. Every band gets the sprites that overlap it in
+  // the draw list order, and the pixels are blended by the same functions
+  // as in the single-threaded drawing, so the result is exactly the same.
+  ComposeJob job;
+  job.Driver = this;
+  job.Regions = &regions;
+  job.First = first;
+  job.Last = last;
+  for (int band = 0; band < band_count; band++)
+  {
+    const int top = screen_rc.GetHeight() * band / band_count;
+    const int bottom = screen_rc.GetHeight() * (band + 1) / band_count - 1;
+    const Rect area(0, top, screen_rc.Right, bottom);
+    Bitmap *surface = BitmapHelper::CreateSubBitmap(virtualScreen, area);
+    if (!surface)
+      break;
+    job.Areas.push_back(area);
+    job.Surfaces.push_back(surface);
+  }
+  if (job.Surfaces.size() == (size_t)band_count)
+    RenderThreads::RunBands(ComposeBand, &job, band_count);
+  else
+    ComposeArea(virtualScreen, screen_rc, regions, first, last);
+  for (size_t i = 0; i < job.Surfaces.size(); i++)
+    delete job.Surfaces[i];
+}
+
+Bitmap *ALSoftwareGraphicsDriver::GetConvertedImage(ALSoftwareBitmap *bitmap)
+{
+  const int depth = virtualScreen->GetColorDepth();
+  if (bitmap->_convertedBmp && bitmap->_convertedStamp == bitmap->_stamp &&
+      bitmap->_convertedBmp->GetColorDepth() == depth)
+    return bitmap->_convertedBmp;
+
+  delete bitmap->_convertedBmp;
+  bitmap->_convertedBmp = GfxUtil::CreateDepthConvertedCopy(bitmap->_bmp, depth);
+  bitmap->_convertedStamp = bitmap->_stamp;
+  _renderStats.Conversions++;
+  return bitmap->_convertedBmp;
+}
+
+bool ALSoftwareGraphicsDriver::HasFullScreenBackground() const
+{
+  for (size_t i = 0; i < drawlist.size(); i++)
+  {
+    const ALSoftwareBitmap *bitmap = drawlist[i].bitmap;
+    if (bitmap == NULL)
+      continue;
+    return bitmap->_opaque && bitmap->_bmp != virtualScreen &&
+      drawlist[i].x <= 0 && drawlist[i].y <= 0 &&
+      drawlist[i].x + bitmap->_bmp->GetWidth() >= virtualScreen->GetWidth() &&
+      drawlist[i].y + bitmap->_bmp->GetHeight() >= virtualScreen->GetHeight();
+  }
+  return false;
+}
+
+void ALSoftwareGraphicsDriver::AddDirtyRect(std::vector<Rect> &rects, const Rect &rc)
+{
+  Rect dirty = IntersectRects(rc, RectWH(virtualScreen->GetSize()));
+  if (dirty.IsEmpty())
+    return;
+  // join with the overlapping regions, so that no pixel is drawn twice
+  for (size_t i = 0; i < rects.size();)
+  {
+    if (AreRectsIntersecting(dirty, rects[i]))
+    {
+      dirty = UnionRects(dirty, rects[i]);
+      rects[i] = rects.back();
+      rects.pop_back();
+      i = 0;
+    }
+    else
+    {
+      i++;
+    }
+  }
+  rects.push_back(dirty);
+}
+
+void ALSoftwareGraphicsDriver::LimitDirtyRects(std::vector<Rect> &rects)
+{
+  if (rects.size() <= MaxDirtyRects)
+    return;
+  Rect dirty = rects[0];
+  for (size_t i = 1; i < rects.size(); i++)
+    dirty = UnionRects(dirty, rects[i]);
+  rects.clear();
+  rects.push_back(dirty);
+}
+
+void ALSoftwareGraphicsDriver::FindDirtyRects()
+{
+  _dirtyRects.clear();
+  _frameSprites.clear();
+  for (size_t i = 0; i < drawlist.size(); i++)
+  {
+    const ALSoftwareBitmap *bitmap = drawlist[i].bitmap;
+    // skip entries that do not draw anything
+    if (bitmap == NULL || (bitmap->_opaque && bitmap->_bmp == virtualScreen) ||
+        (!bitmap->_opaque && bitmap->_transparency >= 255))
+      continue;
+    DrawnSprite sprite;
+    sprite.Stamp = bitmap->_stamp;
+    sprite.Bounds = RectWH(drawlist[i].x, drawlist[i].y, bitmap->_bmp->GetWidth(), bitmap->_bmp->GetHeight());
+    sprite.Transparency = bitmap->_opaque ? 0 : bitmap->_transparency;
+    _frameSprites.push_back(sprite);
+  }
+
+  if (!_lastFrameValid)
+  {
+    AddDirtyRect(_dirtyRects, RectWH(virtualScreen->GetSize()));
+    return;
+  }
 
-	  virtualScreen->TransBlendBlt(bitmap->_bmp, drawAtX, drawAtY);
+  // Match sprites of the two frames in their drawing order. Sprites which
+  // were added, removed or changed invalidate both their old and new place;
+  // the matched ones keep their order, so anywhere else the frame is the same.
+  const size_t last_count = _lastSprites.size();
+  const size_t cur_count = _frameSprites.size();
+  size_t last = 0, cur = 0;
+  while (last < last_count || cur < cur_count)
+  {
+    if (last < last_count && cur < cur_count && _lastSprites[last] == _frameSprites[cur])
+    {
+      last++;
+      cur++;
+    }
+    else if (last + 1 < last_count && cur < cur_count && _lastSprites[last + 1] == _frameSprites[cur])
+    {
+      AddDirtyRect(_dirtyRects, _lastSprites[last++].Bounds); // sprite removed
+    }
+    else if (cur + 1 < cur_count && last < last_count && _lastSprites[last] == _frameSprites[cur + 1])
+    {
+      AddDirtyRect(_dirtyRects, _frameSprites[cur++].Bounds); // sprite added
     }
     else
     {
-      // here _transparency is used as alpha (between 1 and 254), but 0 means opaque!
-      GfxUtil::DrawSpriteWithTransparency(virtualScreen, bitmap->_bmp, drawAtX, drawAtY,
-          bitmap->_transparency ? bitmap->_transparency : 255);
+      if (last < last_count)
+        AddDirtyRect(_dirtyRects, _lastSprites[last++].Bounds);
+      if (cur < cur_count)
+        AddDirtyRect(_dirtyRects, _frameSprites[cur++].Bounds);
     }
   }
 
-  if (((_tint_red > 0) || (_tint_green > 0) || (_tint_blue > 0))
-      && (_mode.ColorDepth > 8)) {
+  LimitDirtyRects(_dirtyRects);
+}
+
+void ALSoftwareGraphicsDriver::ForgetLastFrame()
+{
+  _lastFrameValid = false;
+  _lastSprites.clear();
+  _dirtyRects.clear();
+  _presentRects.clear();
+  _presentFull = true;
+}
+
+void ALSoftwareGraphicsDriver::UseDirtyRects(bool enabled)
+{
+  if (_useDirtyRects == enabled)
+    return;
+  _useDirtyRects = enabled;
+  ForgetLastFrame();
+  if (_filter)
+    _filter->UseDirtyRects(enabled);
+}
+
+void ALSoftwareGraphicsDriver::SetMemoryBackBuffer(Bitmap *backBuffer)
+{
+  virtualScreen = backBuffer;
+  ForgetLastFrame();
+}
+
+void ALSoftwareGraphicsDriver::RenderToBackBuffer()
+{
+  Profiler::Zone zone("RenderToBackBuffer");
+  const bool has_tint = ((_tint_red > 0) || (_tint_green > 0) || (_tint_blue > 0))
+      && (_mode.ColorDepth > 8);
+
+  // Only parts of the frame may be redrawn if all of it comes from the draw
+  // list; the tint is applied over the finished frame though, and would
+  // accumulate on the parts which were not redrawn.
+  if (_useDirtyRects && !has_tint && HasFullScreenBackground())
+  {
+    FindDirtyRects();
+
+    // null sprites must not draw anything in this mode, so their callbacks
+    // are only run once per frame, before drawing
+    for (size_t i = 0; i < drawlist.size(); i++)
+    {
+      if (drawlist[i].bitmap != NULL)
+        continue;
+      if (_nullSpriteCallback)
+        _nullSpriteCallback(drawlist[i].x, drawlist[i].y);
+      else
+        throw Ali3DException("Unhandled attempt to draw null sprite");
+    }
+
+    const Rect clip = virtualScreen->GetClip();
+    ComposeSprites(_dirtyRects, 0, drawlist.size());
+    virtualScreen->SetClip(clip);
+    int32_t pixels = 0;
+    for (size_t r = 0; r < _dirtyRects.size(); r++)
+    {
+      pixels += _dirtyRects[r].GetWidth() * _dirtyRects[r].GetHeight();
+      AddDirtyRect(_presentRects, _dirtyRects[r]);
+    }
+    LimitDirtyRects(_presentRects);
+
+    _lastSprites.swap(_frameSprites);
+    _lastFrameValid = true;
+    _renderStats.FramePixels = pixels;
+    _renderStats.FrameRects = _dirtyRects.size();
+  }
+  else
+  {
+    // null sprite callbacks may draw right onto the back buffer, so the
+    // sprites are composited in runs between them
+    _composeRegions.assign(1, virtualScreen->GetClip());
+    size_t first = 0;
+    for (size_t i = 0; i < drawlist.size(); i++)
+    {
+      if (drawlist[i].bitmap != NULL)
+        continue;
+      ComposeSprites(_composeRegions, first, i);
+      virtualScreen->SetClip(_composeRegions[0]);
+      if (_nullSpriteCallback)
+        _nullSpriteCallback(drawlist[i].x, drawlist[i].y);
+      else
+        throw Ali3DException("Unhandled attempt to draw null sprite");
+      _composeRegions[0] = virtualScreen->GetClip();
+      first = i + 1;
+    }
+    ComposeSprites(_composeRegions, first, drawlist.size());
+    virtualScreen->SetClip(_composeRegions[0]);
+
+    ForgetLastFrame();
+    _renderStats.FramePixels = virtualScreen->GetWidth() * virtualScreen->GetHeight();
+    _renderStats.FrameRects = 1;
+    _renderStats.FullFrames++;
+  }
+  _renderStats.Frames++;
+  _renderStats.TotalPixels += _renderStats.FramePixels;
+
+  if (has_tint) {
     // Common::gl_ScreenBmp tint
     // This slows down the game no end, only experimental ATM
     set_trans_blender(_tint_red, _tint_green, _tint_blue, 0);
-    virtualScreen->LitBlendBlt(virtualScreen, 0, 0, 128);
+    if (!BlendKernels::LitBlendBlt(virtualScreen, virtualScreen, 0, 0, _blender_trans24,
+          makecol_depth(virtualScreen->GetColorDepth(), _tint_red, _tint_green, _tint_blue), 128))
+      virtualScreen->LitBlendBlt(virtualScreen, 0, 0, 128);
 /*  This alternate method gives the correct (D3D-style) result, but is just too slow!
     if ((_spareTintingScreen != NULL) &&
         ((_spareTintingScreen->GetWidth() != virtualScreen->GetWidth()) || (_spareTintingScreen->GetHeight() != virtualScreen->GetHeight())))
@@ -452,10 +829,28 @@ void ALSoftwareGraphicsDriver::Render(GlobalFlipType flip)
   if (_autoVsync)
     this->Vsync();
 
+  Profiler::Zone zone("filter");
   if (flip == kFlip_None)
-    _filter->RenderScreen(virtualScreen, _global_x_offset, _global_y_offset);
+  {
+    bool presented = false;
+    if (!_presentFull && _global_x_offset == _lastPresentX && _global_y_offset == _lastPresentY)
+    {
+      presented = true;
+      for (size_t i = 0; i < _presentRects.size() && presented; i++)
+        presented = _filter->RenderScreenRegion(virtualScreen, _global_x_offset, _global_y_offset, _presentRects[i]);
+    }
+    if (!presented)
+      _filter->RenderScreen(virtualScreen, _global_x_offset, _global_y_offset);
+    _presentFull = false;
+  }
   else
+  {
     _filter->RenderScreenFlipped(virtualScreen, _global_x_offset, _global_y_offset, flip);
+    _presentFull = true;
+  }
+  _presentRects.clear();
+  _lastPresentX = _global_x_offset;
+  _lastPresentY = _global_y_offset;
 }
 
 void ALSoftwareGraphicsDriver::Render()
@@ -605,6 +1000,8 @@ void ALSoftwareGraphicsDriver::__fade_out_range(int speed, int from, int to, int
 
 void ALSoftwareGraphicsDriver::FadeOut(int speed, int targetColourRed, int targetColourGreen, int targetColourBlue) {
 
+  ForgetLastFrame();
+
   if (_mode.ColorDepth > 8) 
   {
     highcolor_fade_out(speed * 4, targetColourRed, targetColourGreen, targetColourBlue);
@@ -614,6 +1011,7 @@ void ALSoftwareGraphicsDriver::FadeOut(int speed, int targetColourRed, int targe
 }
 
 void ALSoftwareGraphicsDriver::FadeIn(int speed, PALLETE p, int targetColourRed, int targetColourGreen, int targetColourBlue) {
+  ForgetLastFrame();
   if (_mode.ColorDepth > 8) {
 
     highcolor_fade_in(virtualScreen, speed * 4, targetColourRed, targetColourGreen, targetColourBlue);
@@ -655,6 +1053,7 @@ void ALSoftwareGraphicsDriver::BoxOutEffect(bool blackingOut, int speed, int del
 
 bool ALSoftwareGraphicsDriver::PlayVideo(const char *filename, bool useAVISound, VideoSkipType skipType, bool stretchToFullScreen)
 {
+  ForgetLastFrame();
 #ifdef _WIN32
   int result = dxmedia_play_video(filename, useAVISound, skipType, stretchToFullScreen ? 1 : 0);
   return (result == 0);
@@ -738,6 +1137,122 @@ AllegroGfxFilter *ALSWGraphicsFactory::CreateFilter(const String &id)
     return NULL;
 }
 
+
+
+ALNullGraphicsDriver::ALNullGraphicsDriver()
+  : _displayBmp(NULL)
+  , _dumpInterval(0)
+  , _frameIndex(0)
+{
+}
+
+ALNullGraphicsDriver::~ALNullGraphicsDriver()
+{
+  // release display while the overridden methods are still available
+  UnInit();
+}
+
+bool ALNullGraphicsDriver::IsModeSupported(const DisplayMode &mode)
+{
+  if (mode.Width <= 0 || mode.Height <= 0 || mode.ColorDepth <= 0)
+  {
+    set_allegro_error("Invalid resolution parameters: %d x %d x %d", mode.Width, mode.Height, mode.ColorDepth);
+    return false;
+  }
+  return true;
+}
+
+BITMAP *ALNullGraphicsDriver::InitDisplay(const DisplayMode &mode)
+{
+  if (!IsModeSupported(mode))
+    return NULL;
+  _displayBmp = create_bitmap_ex(mode.ColorDepth, mode.Width, mode.Height);
+  if (!_displayBmp)
+    set_allegro_error("Unable to create %d x %d x %d display bitmap", mode.Width, mode.Height, mode.ColorDepth);
+  return _displayBmp;
+}
+
+void ALNullGraphicsDriver::ReleaseDisplay()
+{
+  if (_displayBmp)
+    destroy_bitmap(_displayBmp);
+  _displayBmp = NULL;
+}
+
+void ALNullGraphicsDriver::SetFrameDump(const String &dir, int interval)
+{
+  _dumpDir = dir;
+  _dumpInterval = interval;
+}
+
+void ALNullGraphicsDriver::Render(GlobalFlipType flip)
+{
+  ALSoftwareGraphicsDriver::Render(flip);
+
+  _frameIndex++;
+  if (_dumpInterval > 0 && _displayBmp && (_frameIndex % _dumpInterval) == 0)
+  {
+    PALETTE pal;
+    get_palette(pal);
+    String path = String::FromFormat("%s/frame%06d.bmp", _dumpDir.IsEmpty() ? "." : _dumpDir.GetCStr(), _frameIndex);
+    save_bitmap(path, _displayBmp, pal);
+  }
+}
+
+
+ALNullGraphicsFactory *ALNullGraphicsFactory::_factory = NULL;
+
+ALNullGraphicsFactory::~ALNullGraphicsFactory()
+{
+    _factory = NULL;
+}
+
+size_t ALNullGraphicsFactory::GetFilterCount() const
+{
+    return 2;
+}
+
+const GfxFilterInfo *ALNullGraphicsFactory::GetFilterInfo(size_t index) const
+{
+    switch (index)
+    {
+    case 0:
+        return &AllegroGfxFilter::FilterInfo;
+    case 1:
+        return &HqxGfxFilter::FilterInfo;
+    default:
+        return NULL;
+    }
+}
+
+String ALNullGraphicsFactory::GetDefaultFilterID() const
+{
+    return AllegroGfxFilter::FilterInfo.Id;
+}
+
+/* static */ ALNullGraphicsFactory *ALNullGraphicsFactory::GetFactory()
+{
+    if (!_factory)
+        _factory = new ALNullGraphicsFactory();
+    return _factory;
+}
+
+ALNullGraphicsDriver *ALNullGraphicsFactory::EnsureDriverCreated()
+{
+    if (!_driver)
+        _driver = new ALNullGraphicsDriver();
+    return _driver;
+}
+
+AllegroGfxFilter *ALNullGraphicsFactory::CreateFilter(const String &id)
+{
+    if (AllegroGfxFilter::FilterInfo.Id.CompareNoCase(id) == 0)
+        return new AllegroGfxFilter();
+    else if (HqxGfxFilter::FilterInfo.Id.CompareNoCase(id) == 0)
+        return new HqxGfxFilter();
+    return NULL;
+}
+
 } // namespace ALSW
 } // namespace Engine
 } // namespace AGS
@@ -69,8 +69,14 @@ public:
     bool _opaque;
     bool _hasAlpha;
     int _transparency;
-
-    ALSoftwareBitmap(Bitmap *bmp, bool opaque, bool hasAlpha)
+    // Identifies this bitmap and its contents; renewed on every update
+    uint32_t _stamp;
+    // Image converted to the back buffer's color depth, and the stamp of
+    // the contents it was made from; kept while they are up to date
+    Bitmap  *_convertedBmp;
+    uint32_t _convertedStamp;
+
+    ALSoftwareBitmap(Bitmap *bmp, bool opaque, bool hasAlpha, uint32_t stamp)
     {
         _bmp = bmp;
         _width = bmp->GetWidth();
@@ -82,6 +88,9 @@ public:
         _transparency = 0;
         _opaque = opaque;
         _hasAlpha = hasAlpha;
+        _stamp = stamp;
+        _convertedBmp = NULL;
+        _convertedStamp = 0;
     }
 
     int GetWidthToRender() { return (_stretchToWidth > 0) ? _stretchToWidth : _width; }
@@ -90,6 +99,8 @@ public:
     void Dispose()
     {
         // do we want to free the bitmap?
+        delete _convertedBmp;
+        _convertedBmp = NULL;
     }
 
     ~ALSoftwareBitmap()
@@ -162,15 +173,25 @@ public:
     virtual bool HasAcceleratedStretchAndFlip() { return false; }
     virtual bool UsesMemoryBackBuffer() { return true; }
     virtual Bitmap *GetMemoryBackBuffer() { return virtualScreen; }
-    virtual void SetMemoryBackBuffer(Bitmap *backBuffer) { virtualScreen = backBuffer; }
+    virtual void SetMemoryBackBuffer(Bitmap *backBuffer);
     virtual void SetScreenTint(int red, int green, int blue) { 
         _tint_red = red; _tint_green = green; _tint_blue = blue; }
+    virtual void UseDirtyRects(bool enabled);
+    virtual bool UsesDirtyRects() { return _useDirtyRects; }
+    virtual void SetComposeThreads(int thread_count) { _composeThreads = thread_count; }
     virtual ~ALSoftwareGraphicsDriver();
 
     typedef stdtr1compat::shared_ptr<AllegroGfxFilter> PALSWFilter;
 
     void SetGraphicsFilter(PALSWFilter filter);
 
+protected:
+    // Initializes the display for the given mode; returns Allegro bitmap
+    // representing the screen, or NULL on failure
+    virtual BITMAP *InitDisplay(const DisplayMode &mode);
+    // Releases the display resources created by InitDisplay
+    virtual void    ReleaseDisplay() { }
+
 private:
     PALSWFilter _filter;
 
@@ -186,6 +207,41 @@ private:
     std::vector<ALDrawListEntry> drawlist;
     GFX_MODE_LIST *_gfxModeList;
 
+    // Sprite as it was drawn on the back buffer, remembered to find out
+    // which parts of the screen have changed on the next frame
+    struct DrawnSprite
+    {
+        uint32_t Stamp;
+        Rect     Bounds;
+        int      Transparency;
+
+        bool operator==(const DrawnSprite &other) const
+        {
+            return Stamp == other.Stamp && Transparency == other.Transparency &&
+                Bounds.Left == other.Bounds.Left && Bounds.Top == other.Bounds.Top &&
+                Bounds.Right == other.Bounds.Right && Bounds.Bottom == other.Bounds.Bottom;
+        }
+    };
+
+    uint32_t _lastBitmapStamp;
+    bool _useDirtyRects;
+    // Tells that back buffer still has the last frame drawn from _lastSprites
+    bool _lastFrameValid;
+    std::vector<DrawnSprite> _lastSprites;
+    std::vector<DrawnSprite> _frameSprites;
+    // Back buffer regions redrawn for the current frame
+    std::vector<Rect> _dirtyRects;
+    // Back buffer regions changed since the last Render; there may be more
+    // than one frame drawn in between
+    std::vector<Rect> _presentRects;
+    // Tells that whole back buffer has to be presented on the next Render
+    bool _presentFull;
+    int _lastPresentX, _lastPresentY;
+    // Max number of threads to composite the draw list with
+    int _composeThreads;
+    // Back buffer regions to composite the current frame in
+    std::vector<Rect> _composeRegions;
+
 #ifdef _WIN32
     IDirectDrawGammaControl* dxGammaControl;
     // The gamma ramp is a lookup table for each possible R, G and B value
@@ -200,6 +256,35 @@ private:
     void CreateVirtualScreen();
     // Unset parameters and release resources related to the display mode
     void ReleaseDisplayMode();
+    // Draws single draw list entry on the given surface, which is either
+    // the back buffer or a part of it
+    void RenderSprite(Bitmap *ds, ALSoftwareBitmap *bitmap, int x, int y);
+    // Draws draw list entries in [first, last) range inside the regions of
+    // the back buffer; the work is split between render threads if possible.
+    // Leaves the back buffer's clipping rectangle changed.
+    void ComposeSprites(const std::vector<Rect> &regions, size_t first, size_t last);
+    // Draws the entries in [first, last) range on the surface representing
+    // the given area of the back buffer, clipped to the regions
+    void ComposeArea(Bitmap *ds, const Rect &area, const std::vector<Rect> &regions, size_t first, size_t last);
+    // Tells if the entries in [first, last) range may be drawn on separate
+    // parts of the back buffer at once; prepares depth-converted images
+    bool CanComposeConcurrently(size_t first, size_t last);
+    // Composites one band of the back buffer, called by render threads
+    static void ComposeBand(void *data, int band);
+    // Returns bitmap's image converted to the back buffer's color depth,
+    // converting it only if the image was changed since the last time
+    Bitmap *GetConvertedImage(ALSoftwareBitmap *bitmap);
+    // Tells if the draw list begins with opaque sprite covering whole back buffer,
+    // which means that any part of the frame may be redrawn from the list alone
+    bool HasFullScreenBackground() const;
+    // Compares draw list with the last frame and fills _dirtyRects
+    void FindDirtyRects();
+    // Adds back buffer region to the list, joining it with the ones it overlaps
+    void AddDirtyRect(std::vector<Rect> &rects, const Rect &rc);
+    // Joins all the regions into one if there are too many of them
+    static void LimitDirtyRects(std::vector<Rect> &rects);
+    // Drops remembered last frame, so that next one will be drawn in full
+    void ForgetLastFrame();
 
     void highcolor_fade_out(int speed, int targetColourRed, int targetColourGreen, int targetColourBlue);
     void highcolor_fade_in(Bitmap *bmp_orig, int speed, int targetColourRed, int targetColourGreen, int targetColourBlue);
@@ -209,6 +294,38 @@ private:
 };
 
 
+// Software renderer that draws into the memory instead of the real screen;
+// lets the engine run without display, e.g. for automated testing
+class ALNullGraphicsDriver : public ALSoftwareGraphicsDriver
+{
+public:
+    ALNullGraphicsDriver();
+    virtual ~ALNullGraphicsDriver();
+
+    virtual const char*GetDriverName() { return "Null renderer"; }
+    virtual const char*GetDriverID() { return "Null"; }
+    virtual bool IsModeSupported(const DisplayMode &mode);
+    virtual IGfxModeList *GetSupportedModeList(int color_depth) { return NULL; }
+    virtual void Render(GlobalFlipType flip);
+    virtual void Vsync() { }
+    virtual bool PlayVideo(const char *filename, bool useAVISound, VideoSkipType skipType, bool stretchToFullScreen) { return false; }
+
+    // Saves every Nth rendered frame as a bitmap file in the given directory;
+    // zero interval disables saving
+    void SetFrameDump(const String &dir, int interval);
+
+protected:
+    virtual BITMAP *InitDisplay(const DisplayMode &mode);
+    virtual void    ReleaseDisplay();
+
+private:
+    BITMAP *_displayBmp;
+    String  _dumpDir;
+    int     _dumpInterval;
+    int     _frameIndex;
+};
+
+
 class ALSWGraphicsFactory : public GfxDriverFactoryBase<ALSoftwareGraphicsDriver, AllegroGfxFilter>
 {
 public:
@@ -227,6 +344,25 @@ private:
     static ALSWGraphicsFactory *_factory;
 };
 
+
+class ALNullGraphicsFactory : public GfxDriverFactoryBase<ALNullGraphicsDriver, AllegroGfxFilter>
+{
+public:
+    virtual ~ALNullGraphicsFactory();
+
+    virtual size_t               GetFilterCount() const;
+    virtual const GfxFilterInfo *GetFilterInfo(size_t index) const;
+    virtual String               GetDefaultFilterID() const;
+
+    static  ALNullGraphicsFactory *GetFactory();
+
+private:
+    virtual ALNullGraphicsDriver *EnsureDriverCreated();
+    virtual AllegroGfxFilter     *CreateFilter(const String &id);
+
+    static ALNullGraphicsFactory *_factory;
+};
+
 } // namespace ALSW
 } // namespace Engine
 } // namespace AGS
@@ -0,0 +1,710 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// The blenders work on the pixel packed into an integer, doing red and blue
+// channels in one multiplication, and rely on the unsigned wraparound when
+// the destination is brighter than the source. SIMD kernels repeat the very
+// same operations on 32-bit lanes, which gives the identical low 24 bits of
+// the result (that's all the blenders keep), whatever the size of the
+// "unsigned long" is.
+//
+//=============================================================================
+
+#include <algorithm>
+#include "gfx/blend_kernels.h"
+#include "gfx/blender.h"
+#include "util/math.h"
+
+#if defined (__GNUC__) && (defined (__i386__) || defined (__x86_64__))
+#define AGS_BLEND_SSE2
+#define AGS_TARGET_SSE2 __attribute__((target("sse2")))
+#if (__GNUC__ >= 5) || defined (__clang__)
+#define AGS_BLEND_AVX2
+#define AGS_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined (_MSC_VER) && (defined (_M_IX86) || defined (_M_X64))
+#define AGS_BLEND_SSE2
+#define AGS_TARGET_SSE2
+#if (_MSC_VER >= 1700)
+#define AGS_BLEND_AVX2
+#define AGS_TARGET_AVX2
+#endif
+#endif
+
+#if defined (AGS_BLEND_SSE2)
+#include <emmintrin.h>
+#endif
+#if defined (AGS_BLEND_AVX2)
+#include <immintrin.h>
+#endif
+#if defined (_MSC_VER) && defined (AGS_BLEND_SSE2)
+#include <intrin.h>
+#endif
+
+extern "C" {
+    unsigned long _blender_alpha32(unsigned long x, unsigned long y, unsigned long n);
+    unsigned long _blender_trans24(unsigned long x, unsigned long y, unsigned long n);
+    unsigned long _blender_trans16(unsigned long x, unsigned long y, unsigned long n);
+    unsigned long _blender_trans15(unsigned long x, unsigned long y, unsigned long n);
+}
+unsigned long _myblender_alpha_trans24(unsigned long x, unsigned long y, unsigned long n);
+namespace AGS { namespace Engine { namespace ALSW {
+    unsigned long _trans_alpha_blender32(unsigned long x, unsigned long y, unsigned long n);
+} } }
+
+namespace AGS
+{
+namespace Engine
+{
+namespace BlendKernels
+{
+
+using namespace AGS::Common;
+
+const uint32_t MaskColor32 = MASK_COLOR_32;
+const uint16_t MaskColor16 = MASK_COLOR_16;
+const uint16_t MaskColor15 = MASK_COLOR_15;
+
+//-----------------------------------------------------------------------------
+// Scalar kernels: call blenders directly, sparing the generic Allegro loop
+//-----------------------------------------------------------------------------
+
+template <unsigned long (*Blender)(unsigned long, unsigned long, unsigned long)>
+void BlendRow32_Scalar(void *dst, const void *src, int count, uint32_t alpha)
+{
+    uint32_t *d = (uint32_t*)dst;
+    const uint32_t *s = (const uint32_t*)src;
+    for (int i = 0; i < count; ++i)
+    {
+        if (s[i] != MaskColor32)
+            d[i] = (uint32_t)Blender(s[i], d[i], alpha);
+    }
+}
+
+template <unsigned long (*Blender)(unsigned long, unsigned long, unsigned long), uint16_t Mask>
+void BlendRow16_Scalar(void *dst, const void *src, int count, uint32_t alpha)
+{
+    uint16_t *d = (uint16_t*)dst;
+    const uint16_t *s = (const uint16_t*)src;
+    for (int i = 0; i < count; ++i)
+    {
+        if (s[i] != Mask)
+            d[i] = (uint16_t)Blender(s[i], d[i], alpha);
+    }
+}
+
+void LitTrans32_Scalar(void *dst, const void *src, int count, uint32_t color, uint32_t light)
+{
+    uint32_t *d = (uint32_t*)dst;
+    const uint32_t *s = (const uint32_t*)src;
+    for (int i = 0; i < count; ++i)
+    {
+        if (s[i] != MaskColor32)
+            d[i] = (uint32_t)_blender_trans24(color, s[i], light);
+    }
+}
+
+const PfnBlendRow ScalarRowFuncs[kNumBlendOps] =
+{
+    BlendRow32_Scalar<_blender_alpha32>,
+    BlendRow32_Scalar<ALSW::_trans_alpha_blender32>,
+    BlendRow32_Scalar<_blender_trans24>,
+    BlendRow32_Scalar<_myblender_alpha_trans24>,
+    BlendRow32_Scalar<_argb2argb_blender>,
+    BlendRow32_Scalar<_argb2rgb_blender>,
+    BlendRow32_Scalar<_rgb2argb_blender>,
+    BlendRow32_Scalar<_opaque_alpha_blender>,
+    BlendRow16_Scalar<_blender_trans16, MaskColor16>,
+    BlendRow16_Scalar<_blender_trans15, MaskColor15>,
+};
+
+// How the blend factor of the 32-bit linear blenders is found
+enum FactorKind
+{
+    kFactor_Const,      // given alpha
+    kFactor_SrcAlpha,   // source alpha
+    kFactor_SrcAlphaMul,// source alpha multiplied by given alpha
+    kFactor_SrcAlphaMulInc // source alpha multiplied by given alpha + 1
+};
+
+#if defined (AGS_BLEND_SSE2)
+//-----------------------------------------------------------------------------
+// SSE2 kernels
+//-----------------------------------------------------------------------------
+
+// Low 32 bits of the lane products
+AGS_TARGET_SSE2 inline __m128i MulLo32_SSE2(__m128i a, __m128i b)
+{
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd  = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+// n = n ? n + 1 : 0
+AGS_TARGET_SSE2 inline __m128i IncNonZero_SSE2(__m128i n)
+{
+    return _mm_add_epi32(_mm_add_epi32(n, _mm_set1_epi32(1)), _mm_cmpeq_epi32(n, _mm_setzero_si128()));
+}
+
+// Blends x over y with factor n, where n is 0 to 256:
+// ((x - y) * n / 256 + y), done for red and blue, and for green separately
+AGS_TARGET_SSE2 inline __m128i Lerp32_SSE2(__m128i x, __m128i y, __m128i n)
+{
+    const __m128i rb_mask = _mm_set1_epi32(0xFF00FF);
+    const __m128i g_mask  = _mm_set1_epi32(0xFF00);
+    __m128i rb = _mm_sub_epi32(_mm_and_si128(x, rb_mask), _mm_and_si128(y, rb_mask));
+    rb = _mm_add_epi32(_mm_srli_epi32(MulLo32_SSE2(rb, n), 8), y);
+    __m128i yg = _mm_and_si128(y, g_mask);
+    __m128i g = _mm_sub_epi32(_mm_and_si128(x, g_mask), yg);
+    g = _mm_add_epi32(_mm_srli_epi32(MulLo32_SSE2(g, n), 8), yg);
+    return _mm_or_si128(_mm_and_si128(rb, rb_mask), _mm_and_si128(g, g_mask));
+}
+
+template <FactorKind Factor, bool KeepAlpha>
+AGS_TARGET_SSE2 void LerpRow32_SSE2(void *dst, const void *src, int count, uint32_t alpha)
+{
+    uint32_t *d = (uint32_t*)dst;
+    const uint32_t *s = (const uint32_t*)src;
+    const __m128i mask = _mm_set1_epi32(MaskColor32);
+    const __m128i alpha_mask = _mm_set1_epi32(0xFF000000);
+    const __m128i given = _mm_set1_epi32(Factor == kFactor_SrcAlphaMulInc ? (alpha & 0xFF) + 1 : alpha);
+    const __m128i const_n = IncNonZero_SSE2(given);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)(s + i));
+        __m128i y = _mm_loadu_si128((const __m128i*)(d + i));
+        __m128i n;
+        if (Factor == kFactor_Const)
+            n = const_n;
+        else if (Factor == kFactor_SrcAlpha)
+            n = IncNonZero_SSE2(_mm_srli_epi32(x, 24));
+        else
+            n = IncNonZero_SSE2(_mm_srli_epi32(MulLo32_SSE2(_mm_srli_epi32(x, 24), given), 8));
+        __m128i res = Lerp32_SSE2(x, y, n);
+        if (KeepAlpha)
+            res = _mm_or_si128(res, _mm_and_si128(y, alpha_mask));
+        __m128i skip = _mm_cmpeq_epi32(x, mask);
+        res = _mm_or_si128(_mm_and_si128(skip, y), _mm_andnot_si128(skip, res));
+        _mm_storeu_si128((__m128i*)(d + i), res);
+    }
+    if (i < count)
+    {
+        // the leftover pixels are done by the blender itself
+        if (Factor == kFactor_Const)
+            (KeepAlpha ? BlendRow32_Scalar<_myblender_alpha_trans24> : BlendRow32_Scalar<_blender_trans24>)(d + i, s + i, count - i, alpha);
+        else if (Factor == kFactor_SrcAlpha)
+            BlendRow32_Scalar<_blender_alpha32>(d + i, s + i, count - i, alpha);
+        else if (Factor == kFactor_SrcAlphaMul)
+            BlendRow32_Scalar<ALSW::_trans_alpha_blender32>(d + i, s + i, count - i, alpha);
+        else
+            BlendRow32_Scalar<_argb2rgb_blender>(d + i, s + i, count - i, alpha);
+    }
+}
+
+AGS_TARGET_SSE2 void Argb2RgbRow_SSE2(void *dst, const void *src, int count, uint32_t alpha)
+{
+    // zero alpha means "use only source alpha"
+    if (alpha > 0)
+        LerpRow32_SSE2<kFactor_SrcAlphaMulInc, false>(dst, src, count, alpha);
+    else
+        LerpRow32_SSE2<kFactor_SrcAlpha, false>(dst, src, count, alpha);
+}
+
+AGS_TARGET_SSE2 void OpaqueAlphaRow_SSE2(void *dst, const void *src, int count, uint32_t alpha)
+{
+    uint32_t *d = (uint32_t*)dst;
+    const uint32_t *s = (const uint32_t*)src;
+    const __m128i mask = _mm_set1_epi32(MaskColor32);
+    const __m128i alpha_mask = _mm_set1_epi32(0xFF000000);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)(s + i));
+        __m128i y = _mm_loadu_si128((const __m128i*)(d + i));
+        __m128i skip = _mm_cmpeq_epi32(x, mask);
+        __m128i res = _mm_or_si128(x, alpha_mask);
+        _mm_storeu_si128((__m128i*)(d + i), _mm_or_si128(_mm_and_si128(skip, y), _mm_andnot_si128(skip, res)));
+    }
+    BlendRow32_Scalar<_opaque_alpha_blender>(d + i, s + i, count - i, alpha);
+}
+
+// Allegro's 15/16-bit trans blenders unpack the pixel as "-G-R-B" into
+// 32 bits, so that all three channels are multiplied at once
+template <uint32_t UnpackMask>
+AGS_TARGET_SSE2 inline __m128i LerpUnpacked16_SSE2(__m128i x, __m128i y, __m128i n)
+{
+    const __m128i unpack_mask = _mm_set1_epi32(UnpackMask);
+    x = _mm_and_si128(_mm_or_si128(x, _mm_slli_epi32(x, 16)), unpack_mask);
+    y = _mm_and_si128(_mm_or_si128(y, _mm_slli_epi32(y, 16)), unpack_mask);
+    __m128i res = _mm_add_epi32(_mm_srli_epi32(MulLo32_SSE2(_mm_sub_epi32(x, y), n), 5), y);
+    res = _mm_and_si128(res, unpack_mask);
+    res = _mm_or_si128(res, _mm_srli_epi32(res, 16));
+    // sign-extend low 16 bits, so that the saturating pack keeps them as is
+    return _mm_srai_epi32(_mm_slli_epi32(res, 16), 16);
+}
+
+template <uint32_t UnpackMask, uint16_t Mask, unsigned long (*Blender)(unsigned long, unsigned long, unsigned long)>
+AGS_TARGET_SSE2 void TransRow16_SSE2(void *dst, const void *src, int count, uint32_t alpha)
+{
+    uint16_t *d = (uint16_t*)dst;
+    const uint16_t *s = (const uint16_t*)src;
+    const __m128i mask = _mm_set1_epi16((short)Mask);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i n = _mm_set1_epi32(alpha ? (alpha + 1) / 8 : 0);
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)(s + i));
+        __m128i y = _mm_loadu_si128((const __m128i*)(d + i));
+        __m128i lo = LerpUnpacked16_SSE2<UnpackMask>(_mm_unpacklo_epi16(x, zero), _mm_unpacklo_epi16(y, zero), n);
+        __m128i hi = LerpUnpacked16_SSE2<UnpackMask>(_mm_unpackhi_epi16(x, zero), _mm_unpackhi_epi16(y, zero), n);
+        __m128i res = _mm_packs_epi32(lo, hi);
+        __m128i skip = _mm_cmpeq_epi16(x, mask);
+        _mm_storeu_si128((__m128i*)(d + i), _mm_or_si128(_mm_and_si128(skip, y), _mm_andnot_si128(skip, res)));
+    }
+    BlendRow16_Scalar<Blender, Mask>(d + i, s + i, count - i, alpha);
+}
+
+AGS_TARGET_SSE2 void LitTrans32_SSE2(void *dst, const void *src, int count, uint32_t color, uint32_t light)
+{
+    uint32_t *d = (uint32_t*)dst;
+    const uint32_t *s = (const uint32_t*)src;
+    const __m128i mask = _mm_set1_epi32(MaskColor32);
+    const __m128i x = _mm_set1_epi32(color);
+    const __m128i n = IncNonZero_SSE2(_mm_set1_epi32(light));
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i y = _mm_loadu_si128((const __m128i*)(s + i));
+        __m128i old = _mm_loadu_si128((const __m128i*)(d + i));
+        __m128i res = Lerp32_SSE2(x, y, n);
+        __m128i skip = _mm_cmpeq_epi32(y, mask);
+        _mm_storeu_si128((__m128i*)(d + i), _mm_or_si128(_mm_and_si128(skip, old), _mm_andnot_si128(skip, res)));
+    }
+    LitTrans32_Scalar(d + i, s + i, count - i, color, light);
+}
+
+const PfnBlendRow SSE2RowFuncs[kNumBlendOps] =
+{
+    LerpRow32_SSE2<kFactor_SrcAlpha, false>,
+    LerpRow32_SSE2<kFactor_SrcAlphaMul, false>,
+    LerpRow32_SSE2<kFactor_Const, false>,
+    LerpRow32_SSE2<kFactor_Const, true>,
+    BlendRow32_Scalar<_argb2argb_blender>, // divides by the resulting alpha
+    Argb2RgbRow_SSE2,
+    BlendRow32_Scalar<_rgb2argb_blender>,
+    OpaqueAlphaRow_SSE2,
+    TransRow16_SSE2<0x7E0F81F, MaskColor16, _blender_trans16>,
+    TransRow16_SSE2<0x3E07C1F, MaskColor15, _blender_trans15>,
+};
+#endif // AGS_BLEND_SSE2
+
+#if defined (AGS_BLEND_AVX2)
+//-----------------------------------------------------------------------------
+// AVX2 kernels, same as SSE2 ones but eight pixels at a time
+//-----------------------------------------------------------------------------
+
+AGS_TARGET_AVX2 inline __m256i IncNonZero_AVX2(__m256i n)
+{
+    return _mm256_add_epi32(_mm256_add_epi32(n, _mm256_set1_epi32(1)), _mm256_cmpeq_epi32(n, _mm256_setzero_si256()));
+}
+
+AGS_TARGET_AVX2 inline __m256i Lerp32_AVX2(__m256i x, __m256i y, __m256i n)
+{
+    const __m256i rb_mask = _mm256_set1_epi32(0xFF00FF);
+    const __m256i g_mask  = _mm256_set1_epi32(0xFF00);
+    __m256i rb = _mm256_sub_epi32(_mm256_and_si256(x, rb_mask), _mm256_and_si256(y, rb_mask));
+    rb = _mm256_add_epi32(_mm256_srli_epi32(_mm256_mullo_epi32(rb, n), 8), y);
+    __m256i yg = _mm256_and_si256(y, g_mask);
+    __m256i g = _mm256_sub_epi32(_mm256_and_si256(x, g_mask), yg);
+    g = _mm256_add_epi32(_mm256_srli_epi32(_mm256_mullo_epi32(g, n), 8), yg);
+    return _mm256_or_si256(_mm256_and_si256(rb, rb_mask), _mm256_and_si256(g, g_mask));
+}
+
+template <FactorKind Factor, bool KeepAlpha>
+AGS_TARGET_AVX2 void LerpRow32_AVX2(void *dst, const void *src, int count, uint32_t alpha)
+{
+    uint32_t *d = (uint32_t*)dst;
+    const uint32_t *s = (const uint32_t*)src;
+    const __m256i mask = _mm256_set1_epi32(MaskColor32);
+    const __m256i alpha_mask = _mm256_set1_epi32(0xFF000000);
+    const __m256i given = _mm256_set1_epi32(Factor == kFactor_SrcAlphaMulInc ? (alpha & 0xFF) + 1 : alpha);
+    const __m256i const_n = IncNonZero_AVX2(given);
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(s + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(d + i));
+        __m256i n;
+        if (Factor == kFactor_Const)
+            n = const_n;
+        else if (Factor == kFactor_SrcAlpha)
+            n = IncNonZero_AVX2(_mm256_srli_epi32(x, 24));
+        else
+            n = IncNonZero_AVX2(_mm256_srli_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(x, 24), given), 8));
+        __m256i res = Lerp32_AVX2(x, y, n);
+        if (KeepAlpha)
+            res = _mm256_or_si256(res, _mm256_and_si256(y, alpha_mask));
+        _mm256_storeu_si256((__m256i*)(d + i), _mm256_blendv_epi8(res, y, _mm256_cmpeq_epi32(x, mask)));
+    }
+    // SSE2 version is always there when AVX2 is
+    LerpRow32_SSE2<Factor, KeepAlpha>(d + i, s + i, count - i, alpha);
+}
+
+AGS_TARGET_AVX2 void Argb2RgbRow_AVX2(void *dst, const void *src, int count, uint32_t alpha)
+{
+    if (alpha > 0)
+        LerpRow32_AVX2<kFactor_SrcAlphaMulInc, false>(dst, src, count, alpha);
+    else
+        LerpRow32_AVX2<kFactor_SrcAlpha, false>(dst, src, count, alpha);
+}
+
+AGS_TARGET_AVX2 void OpaqueAlphaRow_AVX2(void *dst, const void *src, int count, uint32_t alpha)
+{
+    uint32_t *d = (uint32_t*)dst;
+    const uint32_t *s = (const uint32_t*)src;
+    const __m256i mask = _mm256_set1_epi32(MaskColor32);
+    const __m256i alpha_mask = _mm256_set1_epi32(0xFF000000);
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(s + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(d + i));
+        __m256i res = _mm256_or_si256(x, alpha_mask);
+        _mm256_storeu_si256((__m256i*)(d + i), _mm256_blendv_epi8(res, y, _mm256_cmpeq_epi32(x, mask)));
+    }
+    OpaqueAlphaRow_SSE2(d + i, s + i, count - i, alpha);
+}
+
+template <uint32_t UnpackMask>
+AGS_TARGET_AVX2 inline __m256i LerpUnpacked16_AVX2(__m256i x, __m256i y, __m256i n)
+{
+    const __m256i unpack_mask = _mm256_set1_epi32(UnpackMask);
+    x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi32(x, 16)), unpack_mask);
+    y = _mm256_and_si256(_mm256_or_si256(y, _mm256_slli_epi32(y, 16)), unpack_mask);
+    __m256i res = _mm256_add_epi32(_mm256_srli_epi32(_mm256_mullo_epi32(_mm256_sub_epi32(x, y), n), 5), y);
+    res = _mm256_and_si256(res, unpack_mask);
+    return _mm256_and_si256(_mm256_or_si256(res, _mm256_srli_epi32(res, 16)), _mm256_set1_epi32(0xFFFF));
+}
+
+template <uint32_t UnpackMask, uint16_t Mask, unsigned long (*Blender)(unsigned long, unsigned long, unsigned long)>
+AGS_TARGET_AVX2 void TransRow16_AVX2(void *dst, const void *src, int count, uint32_t alpha)
+{
+    uint16_t *d = (uint16_t*)dst;
+    const uint16_t *s = (const uint16_t*)src;
+    const __m256i mask = _mm256_set1_epi16((short)Mask);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i n = _mm256_set1_epi32(alpha ? (alpha + 1) / 8 : 0);
+    int i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(s + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(d + i));
+        // unpack and pack work within 128-bit halves, so the order is kept
+        __m256i lo = LerpUnpacked16_AVX2<UnpackMask>(_mm256_unpacklo_epi16(x, zero), _mm256_unpacklo_epi16(y, zero), n);
+        __m256i hi = LerpUnpacked16_AVX2<UnpackMask>(_mm256_unpackhi_epi16(x, zero), _mm256_unpackhi_epi16(y, zero), n);
+        __m256i res = _mm256_packus_epi32(lo, hi);
+        _mm256_storeu_si256((__m256i*)(d + i), _mm256_blendv_epi8(res, y, _mm256_cmpeq_epi16(x, mask)));
+    }
+    TransRow16_SSE2<UnpackMask, Mask, Blender>(d + i, s + i, count - i, alpha);
+}
+
+AGS_TARGET_AVX2 void LitTrans32_AVX2(void *dst, const void *src, int count, uint32_t color, uint32_t light)
+{
+    uint32_t *d = (uint32_t*)dst;
+    const uint32_t *s = (const uint32_t*)src;
+    const __m256i mask = _mm256_set1_epi32(MaskColor32);
+    const __m256i x = _mm256_set1_epi32(color);
+    const __m256i n = IncNonZero_AVX2(_mm256_set1_epi32(light));
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i y = _mm256_loadu_si256((const __m256i*)(s + i));
+        __m256i old = _mm256_loadu_si256((const __m256i*)(d + i));
+        __m256i res = Lerp32_AVX2(x, y, n);
+        _mm256_storeu_si256((__m256i*)(d + i), _mm256_blendv_epi8(res, old, _mm256_cmpeq_epi32(y, mask)));
+    }
+    LitTrans32_SSE2(d + i, s + i, count - i, color, light);
+}
+
+const PfnBlendRow AVX2RowFuncs[kNumBlendOps] =
+{
+    LerpRow32_AVX2<kFactor_SrcAlpha, false>,
+    LerpRow32_AVX2<kFactor_SrcAlphaMul, false>,
+    LerpRow32_AVX2<kFactor_Const, false>,
+    LerpRow32_AVX2<kFactor_Const, true>,
+    BlendRow32_Scalar<_argb2argb_blender>,
+    Argb2RgbRow_AVX2,
+    BlendRow32_Scalar<_rgb2argb_blender>,
+    OpaqueAlphaRow_AVX2,
+    TransRow16_AVX2<0x7E0F81F, MaskColor16, _blender_trans16>,
+    TransRow16_AVX2<0x3E07C1F, MaskColor15, _blender_trans15>,
+};
+#endif // AGS_BLEND_AVX2
+
+//-----------------------------------------------------------------------------
+// Kernel selection
+//-----------------------------------------------------------------------------
+
+KernelSet ActiveSet = kKernels_Scalar;
+
+bool IsSetSupported(KernelSet set)
+{
+    switch (set)
+    {
+    case kKernels_Scalar:
+        return true;
+#if defined (AGS_BLEND_SSE2)
+    case kKernels_SSE2:
+#if defined (_MSC_VER)
+        {
+            int info[4];
+            __cpuid(info, 1);
+            return (info[3] & (1 << 26)) != 0;
+        }
+#else
+        return __builtin_cpu_supports("sse2") != 0;
+#endif
+#endif
+#if defined (AGS_BLEND_AVX2)
+    case kKernels_AVX2:
+#if defined (_MSC_VER)
+        {
+            int info[4];
+            __cpuid(info, 1);
+            // the OS has to save the AVX registers too
+            const bool os_avx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 &&
+                (_xgetbv(0) & 6) == 6;
+            if (!os_avx)
+                return false;
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+        }
+#else
+        return __builtin_cpu_supports("avx2") != 0;
+#endif
+#endif
+    default:
+        return false;
+    }
+}
+
+void Init()
+{
+    if (IsSetSupported(kKernels_AVX2))
+        ActiveSet = kKernels_AVX2;
+    else if (IsSetSupported(kKernels_SSE2))
+        ActiveSet = kKernels_SSE2;
+    else
+        ActiveSet = kKernels_Scalar;
+}
+
+bool SetActiveSet(KernelSet set)
+{
+    if (!IsSetSupported(set))
+        return false;
+    ActiveSet = set;
+    return true;
+}
+
+KernelSet GetActiveSet()
+{
+    return ActiveSet;
+}
+
+const char *GetSetName(KernelSet set)
+{
+    switch (set)
+    {
+    case kKernels_Scalar: return "scalar";
+    case kKernels_SSE2:   return "SSE2";
+    case kKernels_AVX2:   return "AVX2";
+    default:              return "unknown";
+    }
+}
+
+PfnBlendRow GetRowFunc(BlendOp op, KernelSet set)
+{
+    if (op < 0 || op >= kNumBlendOps)
+        return NULL;
+    switch (set)
+    {
+#if defined (AGS_BLEND_SSE2)
+    case kKernels_SSE2: return SSE2RowFuncs[op];
+#endif
+#if defined (AGS_BLEND_AVX2)
+    case kKernels_AVX2: return AVX2RowFuncs[op];
+#endif
+    default:            return ScalarRowFuncs[op];
+    }
+}
+
+PfnLitRow GetLitTrans32Func(KernelSet set)
+{
+    switch (set)
+    {
+#if defined (AGS_BLEND_SSE2)
+    case kKernels_SSE2: return LitTrans32_SSE2;
+#endif
+#if defined (AGS_BLEND_AVX2)
+    case kKernels_AVX2: return LitTrans32_AVX2;
+#endif
+    default:            return LitTrans32_Scalar;
+    }
+}
+
+int GetBlendOpDepth(BlendOp op)
+{
+    switch (op)
+    {
+    case kBlendOp_Trans16: return 16;
+    case kBlendOp_Trans15: return 15;
+    case kBlendOp_None:    return 0;
+    default:               return 32;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Drawing
+//-----------------------------------------------------------------------------
+
+// Tells if the pixels of this color depth are laid out the way the kernels
+// expect them to be
+bool IsSupportedFormat(int depth)
+{
+    if (depth == 32)
+        return _rgb_r_shift_32 == 16 && _rgb_g_shift_32 == 8 &&
+            _rgb_b_shift_32 == 0 && _rgb_a_shift_32 == 24;
+    return depth == 16 || depth == 15;
+}
+
+// Clips the sprite rectangle placed at x,y to the destination's clipping
+// rectangle; returns false if nothing is left to draw
+bool ClipSprite(Bitmap *ds, Bitmap *sprite, int &x, int &y, int &sx, int &sy, int &w, int &h)
+{
+    const Rect clip = ds->GetClip();
+    sx = x < clip.Left ? clip.Left - x : 0;
+    sy = y < clip.Top ? clip.Top - y : 0;
+    x += sx;
+    y += sy;
+    w = Math::Min(sprite->GetWidth() - sx, clip.Right + 1 - x);
+    h = Math::Min(sprite->GetHeight() - sy, clip.Bottom + 1 - y);
+    return w > 0 && h > 0;
+}
+
+bool CanBlend(Bitmap *ds, Bitmap *sprite, int depth)
+{
+    return ds->GetColorDepth() == depth && sprite->GetColorDepth() == depth &&
+        ds->IsMemoryBitmap() && sprite->IsMemoryBitmap() && IsSupportedFormat(depth);
+}
+
+bool CanBlendBlt(Bitmap *ds, Bitmap *sprite, BlendOp op)
+{
+    return op >= 0 && op < kNumBlendOps && CanBlend(ds, sprite, GetBlendOpDepth(op));
+}
+
+bool BlendBlt(Bitmap *ds, Bitmap *sprite, int x, int y, BlendOp op, int alpha)
+{
+    if (!CanBlendBlt(ds, sprite, op))
+        return false;
+    int sx, sy, w, h;
+    if (!ClipSprite(ds, sprite, x, y, sx, sy, w, h))
+        return true;
+
+    PfnBlendRow blend_row = GetRowFunc(op, ActiveSet);
+    const int bpp = ds->GetBPP();
+    for (int row = 0; row < h; ++row)
+    {
+        blend_row(ds->GetScanLineForWriting(y + row) + x * bpp,
+            sprite->GetScanLine(sy + row) + sx * bpp, w, alpha);
+    }
+    return true;
+}
+
+// Tinting blenders convert each pixel to HSV and back, but sprites mostly
+// consist of few colors, so remembering the recent results pays off
+template <typename TPixel>
+void LitRowCached(TPixel *dst, const TPixel *src, int count, TPixel mask,
+                  BLENDER_FUNC blender, uint32_t color, uint32_t light,
+                  TPixel *cache_key, TPixel *cache_value, size_t cache_size)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const TPixel c = src[i];
+        if (c == mask)
+            continue;
+        const size_t slot = (c ^ (c >> 7) ^ (c >> 15)) & (cache_size - 1);
+        if (cache_key[slot] != c)
+        {
+            cache_key[slot] = c;
+            cache_value[slot] = (TPixel)blender(color, c, light);
+        }
+        dst[i] = cache_value[slot];
+    }
+}
+
+bool LitBlendBlt(Bitmap *ds, Bitmap *sprite, int x, int y, BLENDER_FUNC blender, uint32_t color, int light)
+{
+    const int depth = sprite->GetColorDepth();
+    if (!CanBlend(ds, sprite, depth))
+        return false;
+    int sx, sy, w, h;
+    if (!ClipSprite(ds, sprite, x, y, sx, sy, w, h))
+        return true;
+
+    const int bpp = ds->GetBPP();
+    if (depth == 32 && blender == _blender_trans24)
+    {
+        PfnLitRow lit_row = GetLitTrans32Func(ActiveSet);
+        for (int row = 0; row < h; ++row)
+        {
+            lit_row(ds->GetScanLineForWriting(y + row) + x * bpp,
+                sprite->GetScanLine(sy + row) + sx * bpp, w, color, light);
+        }
+        return true;
+    }
+
+    // the mask color is never looked up, so it marks the free cache slots
+    const size_t cache_size = 256;
+    if (depth == 32)
+    {
+        uint32_t cache_key[cache_size], cache_value[cache_size];
+        std::fill(cache_key, cache_key + cache_size, MaskColor32);
+        for (int row = 0; row < h; ++row)
+        {
+            LitRowCached<uint32_t>((uint32_t*)(ds->GetScanLineForWriting(y + row) + x * bpp),
+                (const uint32_t*)(sprite->GetScanLine(sy + row) + sx * bpp), w, MaskColor32,
+                blender, color, light, cache_key, cache_value, cache_size);
+        }
+    }
+    else
+    {
+        const uint16_t mask = depth == 16 ? MaskColor16 : MaskColor15;
+        uint16_t cache_key[cache_size], cache_value[cache_size];
+        std::fill(cache_key, cache_key + cache_size, mask);
+        for (int row = 0; row < h; ++row)
+        {
+            LitRowCached<uint16_t>((uint16_t*)(ds->GetScanLineForWriting(y + row) + x * bpp),
+                (const uint16_t*)(sprite->GetScanLine(sy + row) + sx * bpp), w, mask,
+                blender, color, light, cache_key, cache_value, cache_size);
+        }
+    }
+    return true;
+}
+
+} // namespace BlendKernels
+} // namespace Engine
+} // namespace AGS
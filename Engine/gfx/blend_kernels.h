@@ -0,0 +1,101 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Row-wise implementations of the blenders used by the software renderer.
+//
+// Each blend operation gives exactly the same result as drawing with the
+// corresponding Allegro or AGS blender callback (see gfx/blender.h), only
+// it processes whole rows of pixels at once, using SIMD instructions where
+// the CPU supports them. The mask color of the source is skipped, the same
+// way as Allegro's draw_trans_sprite and draw_lit_sprite do.
+//
+//=============================================================================
+#ifndef __AGS_EE_GFX__BLENDKERNELS_H
+#define __AGS_EE_GFX__BLENDKERNELS_H
+
+#include "core/types.h"
+#include "gfx/bitmap.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+using Common::Bitmap;
+
+namespace BlendKernels
+{
+
+enum KernelSet
+{
+    kKernels_Scalar,
+    kKernels_SSE2,
+    kKernels_AVX2,
+    kNumKernelSets
+};
+
+enum BlendOp
+{
+    kBlendOp_None = -1,
+    kBlendOp_Alpha32,       // Allegro's _blender_alpha32, set by set_alpha_blender
+    kBlendOp_TransAlpha32,  // _trans_alpha_blender32
+    kBlendOp_Trans32,       // Allegro's _blender_trans24, set by set_trans_blender
+    kBlendOp_TransKeepAlpha32, // _myblender_alpha_trans24, set by set_my_trans_blender
+    kBlendOp_Argb2Argb,     // _argb2argb_blender
+    kBlendOp_Argb2Rgb,      // _argb2rgb_blender
+    kBlendOp_Rgb2Argb,      // _rgb2argb_blender
+    kBlendOp_OpaqueAlpha,   // _opaque_alpha_blender
+    kBlendOp_Trans16,       // Allegro's _blender_trans16
+    kBlendOp_Trans15,       // Allegro's _blender_trans15
+    kNumBlendOps
+};
+
+// Blends count source pixels over destination; alpha is the value that
+// the blender callback receives as its last argument
+typedef void (*PfnBlendRow)(void *dst, const void *src, int count, uint32_t alpha);
+// Blends a constant color with count source pixels and puts the result to
+// destination, like draw_lit_sprite does
+typedef void (*PfnLitRow)(void *dst, const void *src, int count, uint32_t color, uint32_t light);
+
+// Selects the fastest kernel set supported by the CPU
+void        Init();
+bool        IsSetSupported(KernelSet set);
+bool        SetActiveSet(KernelSet set);
+KernelSet   GetActiveSet();
+const char *GetSetName(KernelSet set);
+// Returns row function of the given set; operations that have no SIMD
+// version in that set get the scalar one
+PfnBlendRow GetRowFunc(BlendOp op, KernelSet set);
+// Returns row function for the lit blend with Allegro's _blender_trans24
+PfnLitRow   GetLitTrans32Func(KernelSet set);
+// Returns color depth which the operation works with
+int         GetBlendOpDepth(BlendOp op);
+
+// Tells if BlendBlt can draw the sprite over the destination bitmap
+bool        CanBlendBlt(Bitmap *ds, Bitmap *sprite, BlendOp op);
+// Draws sprite over the destination bitmap, as TransBlendBlt does with the
+// operation's blender set; returns false if these bitmaps can't be drawn
+// with the kernels, in which case nothing is drawn
+bool        BlendBlt(Bitmap *ds, Bitmap *sprite, int x, int y, BlendOp op, int alpha);
+// Draws sprite over the destination bitmap, as LitBlendBlt does with given
+// blender callback and the blender color set; returns false if it can't be
+// done with the kernels, in which case nothing is drawn
+bool        LitBlendBlt(Bitmap *ds, Bitmap *sprite, int x, int y, BLENDER_FUNC blender, uint32_t color, int light);
+
+} // namespace BlendKernels
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_GFX__BLENDKERNELS_H
@@ -13,6 +13,7 @@
 //=============================================================================
 
 #include "gfx/gfx_util.h"
+#include "gfx/blend_kernels.h"
 #include "gfx/blender.h"
 
 // CHECKME: is this hack still relevant?
@@ -52,6 +53,35 @@ static const BlendModeSetter BlendModeSets[kNumBlendModes] =
     // NOTE: add new modes here
 };
 
+struct BlendModeOps
+{
+    // Row kernels matching the blenders of BlendModeSetter
+    BlendKernels::BlendOp AllAlpha;
+    BlendKernels::BlendOp AlphaToOpaque;
+    BlendKernels::BlendOp OpaqueToAlpha;
+    BlendKernels::BlendOp OpaqueToAlphaNoTrans;
+    BlendKernels::BlendOp AllOpaque;
+};
+
+static const BlendModeOps BlendModeKernels[kNumBlendModes] =
+{
+    { BlendKernels::kBlendOp_None, BlendKernels::kBlendOp_None, BlendKernels::kBlendOp_None,
+      BlendKernels::kBlendOp_None, BlendKernels::kBlendOp_None }, // kBlendMode_NoAlpha
+    { BlendKernels::kBlendOp_Argb2Argb, BlendKernels::kBlendOp_Argb2Rgb, BlendKernels::kBlendOp_Rgb2Argb,
+      BlendKernels::kBlendOp_OpaqueAlpha, BlendKernels::kBlendOp_None }, // kBlendMode_Alpha
+};
+
+BlendKernels::BlendOp GetBlendOp(BlendMode blend_mode, bool dst_has_alpha, bool src_has_alpha, int blend_alpha)
+{
+    if (blend_mode < 0 || blend_mode >= kNumBlendModes)
+        return BlendKernels::kBlendOp_None;
+    const BlendModeOps &ops = BlendModeKernels[blend_mode];
+    if (dst_has_alpha)
+        return src_has_alpha ? ops.AllAlpha :
+            (blend_alpha == 0xFF ? ops.OpaqueToAlphaNoTrans : ops.OpaqueToAlpha);
+    return src_has_alpha ? ops.AlphaToOpaque : ops.AllOpaque;
+}
+
 bool SetBlender(BlendMode blend_mode, bool dst_has_alpha, bool src_has_alpha, int blend_alpha)
 {
     if (blend_mode < 0 || blend_mode > kNumBlendModes)
@@ -78,27 +108,47 @@ void DrawSpriteBlend(Bitmap *ds, const Point &ds_at, Bitmap *sprite,
     if (blend_alpha <= 0)
         return; // do not draw 100% transparent image
 
-    if (// support only 32-bit blending at the moment
-        ds->GetColorDepth() == 32 && sprite->GetColorDepth() == 32 &&
-        // set blenders if applicable and tell if succeeded
-        SetBlender(blend_mode, dst_has_alpha, src_has_alpha, blend_alpha))
+    // support only 32-bit blending at the moment
+    if (ds->GetColorDepth() == 32 && sprite->GetColorDepth() == 32)
     {
-        ds->TransBlendBlt(sprite, ds_at.X, ds_at.Y);
+        if (BlendKernels::BlendBlt(ds, sprite, ds_at.X, ds_at.Y,
+                GetBlendOp(blend_mode, dst_has_alpha, src_has_alpha, blend_alpha), blend_alpha))
+            return;
+        // set blenders if applicable and tell if succeeded
+        if (SetBlender(blend_mode, dst_has_alpha, src_has_alpha, blend_alpha))
+        {
+            ds->TransBlendBlt(sprite, ds_at.X, ds_at.Y);
+            return;
+        }
     }
-    else
+    GfxUtil::DrawSpriteWithTransparency(ds, sprite, ds_at.X, ds_at.Y, blend_alpha);
+}
+
+// Gets the kernel operation matching Allegro's trans blender
+BlendKernels::BlendOp GetTransBlendOp(int depth)
+{
+    switch (depth)
     {
-        GfxUtil::DrawSpriteWithTransparency(ds, sprite, ds_at.X, ds_at.Y, blend_alpha);
+    case 32: return BlendKernels::kBlendOp_Trans32;
+    case 16: return BlendKernels::kBlendOp_Trans16;
+    case 15: return BlendKernels::kBlendOp_Trans15;
+    default: return BlendKernels::kBlendOp_None;
     }
 }
 
-void DrawSpriteWithTransparency(Bitmap *ds, Bitmap *sprite, int x, int y, int alpha)
+// Draws sprite using Allegro's trans blender with the given alpha
+void DrawSpriteTransBlend(Bitmap *ds, Bitmap *sprite, int x, int y, int alpha)
 {
-    if (alpha <= 0)
+    const BlendKernels::BlendOp blend_op = GetTransBlendOp(ds->GetColorDepth());
+    if (!BlendKernels::BlendBlt(ds, sprite, x, y, blend_op, alpha))
     {
-        // fully transparent, don't draw it at all
-        return;
+        set_trans_blender(0, 0, 0, alpha);
+        ds->TransBlendBlt(sprite, x, y);
     }
+}
 
+bool NeedsDepthConversion(Bitmap *ds, Bitmap *sprite)
+{
     int surface_depth = ds->GetColorDepth();
     int sprite_depth  = sprite->GetColorDepth();
 
@@ -109,64 +159,86 @@ void DrawSpriteWithTransparency(Bitmap *ds, Bitmap *sprite, int x, int y, int al
 #endif
         )
     {
-        // If sprite is lower color depth than destination surface, e.g.
-        // 8-bit sprites drawn on 16/32-bit surfaces.
-        if (sprite_depth == 8 && surface_depth >= 24)
-        {
-            // 256-col sprite -> truecolor background
-            // this is automatically supported by allegro, no twiddling needed
-            ds->Blit(sprite, x, y, kBitmap_Transparency);
-            return;
-        }
+        // 256-col sprite -> truecolor background
+        // this is automatically supported by allegro, no twiddling needed
+        return !(sprite_depth == 8 && surface_depth >= 24);
+    }
+    return false;
+}
 
-        // 256-col sprite -> hi-color background, or
-        // 16-bit sprite -> 32-bit background
-        Bitmap hctemp;
-        hctemp.CreateCopy(sprite, surface_depth);
-        if (sprite_depth == 8)
+Bitmap *CreateDepthConvertedCopy(Bitmap *sprite, int depth)
+{
+    // 256-col sprite -> hi-color background, or
+    // 16-bit sprite -> 32-bit background
+    Bitmap *hctemp = BitmapHelper::CreateBitmapCopy(sprite, depth);
+    if (sprite->GetColorDepth() == 8)
+    {
+        // only do this for 256-col -> hi-color, cos the Blit call converts
+        // transparency for 16->32 bit
+        color_t mask_color = hctemp->GetMaskColor();
+        for (int scan_y = 0; scan_y < hctemp->GetHeight(); ++scan_y)
         {
-            // only do this for 256-col -> hi-color, cos the Blit call converts
-            // transparency for 16->32 bit
-            color_t mask_color = hctemp.GetMaskColor();
-            for (int scan_y = 0; scan_y < hctemp.GetHeight(); ++scan_y)
+            // we know this must be 1 bpp source and 2 bpp pixel destination
+            const uint8_t *src_scanline = sprite->GetScanLine(scan_y);
+            uint16_t      *dst_scanline = (uint16_t*)hctemp->GetScanLineForWriting(scan_y);
+            for (int scan_x = 0; scan_x < hctemp->GetWidth(); ++scan_x)
             {
-                // we know this must be 1 bpp source and 2 bpp pixel destination
-                const uint8_t *src_scanline = sprite->GetScanLine(scan_y);
-                uint16_t      *dst_scanline = (uint16_t*)hctemp.GetScanLineForWriting(scan_y);
-                for (int scan_x = 0; scan_x < hctemp.GetWidth(); ++scan_x)
+                if (src_scanline[scan_x] == 0)
                 {
-                    if (src_scanline[scan_x] == 0)
-                    {
-                        dst_scanline[scan_x] = mask_color;
-                    }
+                    dst_scanline[scan_x] = mask_color;
                 }
             }
         }
+    }
+    return hctemp;
+}
 
+void DrawSpriteWithTransparency(Bitmap *ds, Bitmap *sprite, int x, int y, int alpha)
+{
+    if (alpha <= 0)
+    {
+        // fully transparent, don't draw it at all
+        return;
+    }
+
+    if (NeedsDepthConversion(ds, sprite))
+    {
+        Bitmap *hctemp = CreateDepthConvertedCopy(sprite, ds->GetColorDepth());
+        if (!hctemp)
+            return;
         if (alpha < 0xFF) 
         {
-            set_trans_blender(0, 0, 0, alpha);
-            ds->TransBlendBlt(&hctemp, x, y);
+            DrawSpriteTransBlend(ds, hctemp, x, y, alpha);
         }
         else
         {
-            ds->Blit(&hctemp, x, y, kBitmap_Transparency);
+            ds->Blit(hctemp, x, y, kBitmap_Transparency);
         }
+        delete hctemp;
+        return;
+    }
+
+    if (alpha < 0xFF && ds->GetColorDepth() > 8 && sprite->GetColorDepth() > 8) 
+    {
+        DrawSpriteTransBlend(ds, sprite, x, y, alpha);
     }
     else
     {
-        if (alpha < 0xFF && surface_depth > 8 && sprite_depth > 8) 
-        {
-            set_trans_blender(0, 0, 0, alpha);
-            ds->TransBlendBlt(sprite, x, y);
-        }
-        else
-        {
-            ds->Blit(sprite, x, y, kBitmap_Transparency);
-        }
+        ds->Blit(sprite, x, y, kBitmap_Transparency);
     }
 }
 
+bool CanDrawSpriteConcurrently(Bitmap *ds, Bitmap *sprite, int alpha)
+{
+    if (alpha <= 0)
+        return true;
+    if (NeedsDepthConversion(ds, sprite))
+        return false;
+    if (alpha < 0xFF && ds->GetColorDepth() > 8 && sprite->GetColorDepth() > 8)
+        return BlendKernels::CanBlendBlt(ds, sprite, GetTransBlendOp(ds->GetColorDepth()));
+    return true;
+}
+
 } // namespace GfxUtil
 
 } // namespace Engine
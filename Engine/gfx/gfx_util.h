@@ -47,6 +47,17 @@ namespace GfxUtil
     // ignoring image's alpha channel, even if there's one;
     // does proper conversion depending on respected color depths.
     void DrawSpriteWithTransparency(Bitmap *ds, Bitmap *sprite, int x, int y, int alpha = 0xFF);
+    // Tells if DrawSpriteWithTransparency would draw the sprite without
+    // converting it and without setting Allegro's global blender, which
+    // makes it safe to draw on separate parts of the surface concurrently
+    bool CanDrawSpriteConcurrently(Bitmap *ds, Bitmap *sprite, int alpha);
+    // Tells if DrawSpriteWithTransparency has to make a copy of the sprite
+    // converted to the surface's color depth in order to draw it
+    bool NeedsDepthConversion(Bitmap *ds, Bitmap *sprite);
+    // Creates a copy of the sprite in the given color depth, suitable for
+    // drawing with DrawSpriteWithTransparency; callers which draw the same
+    // sprite repeatedly may keep the copy instead of converting every time
+    Bitmap *CreateDepthConvertedCopy(Bitmap *sprite, int depth);
 } // namespace GfxUtil
 
 } // namespace Engine
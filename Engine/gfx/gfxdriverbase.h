@@ -74,6 +74,11 @@ public:
     virtual void        SetCallbackOnInit(GFXDRV_CLIENTCALLBACKINITGFX callback) { _initGfxCallback = callback; }
     virtual void        SetCallbackForNullSprite(GFXDRV_CLIENTCALLBACKXY callback) { _nullSpriteCallback = callback; }
 
+    virtual void        UseDirtyRects(bool enabled) { }
+    virtual bool        UsesDirtyRects() { return false; }
+    virtual void        SetComposeThreads(int thread_count) { }
+    virtual const GfxRenderStats &GetRenderStats() { return _renderStats; }
+
 protected:
     // Called after graphics driver was initialized for use for the first time
     virtual void OnInit(volatile int *loopTimer);
@@ -104,6 +109,7 @@ protected:
     int                 _global_x_offset;
     int                 _global_y_offset;
     volatile int *      _loopTimer;
+    GfxRenderStats      _renderStats;
 
     // Callbacks
     GFXDRV_CLIENTCALLBACK _pollingCallback;
@@ -64,9 +64,18 @@ IGfxDriverFactory *GetGfxDriverFactory(const String id)
 #endif
     if (id.CompareNoCase("Software") == 0)
         return ALSW::ALSWGraphicsFactory::GetFactory();
+    if (id.CompareNoCase("Null") == 0)
+        return ALSW::ALNullGraphicsFactory::GetFactory();
     set_allegro_error("No graphics factory with such id: %s", id.GetCStr());
     return NULL;
 }
 
+void SetNullGfxFrameDump(const String &dir, int interval)
+{
+    ALSW::ALNullGraphicsDriver *driver =
+        (ALSW::ALNullGraphicsDriver*)ALSW::ALNullGraphicsFactory::GetFactory()->GetDriver();
+    driver->SetFrameDump(dir, interval);
+}
+
 } // namespace Engine
 } // namespace AGS
@@ -67,10 +67,13 @@ public:
     virtual PGfxFilter           SetFilter(const String &id, String &filter_error) = 0;
 };
 
-// Query the available graphics factory names
+// Query the available graphics factory names; this does not include
+// the "Null" factory, which may only be requested explicitly
 void GetGfxDriverFactoryNames(StringV &ids);
 // Acquire the graphics factory singleton object by its id
 IGfxDriverFactory *GetGfxDriverFactory(const String id);
+// Makes the "Null" driver save every Nth rendered frame to the given directory
+void SetNullGfxFrameDump(const String &dir, int interval);
 
 } // namespace Engine
 } // namespace AGS
@@ -95,6 +95,30 @@ void AllegroGfxFilter::RenderScreen(Bitmap *toRender, int x, int y) {
     lastBlitY = y;
 }
 
+bool AllegroGfxFilter::RenderScreenRegion(Bitmap *toRender, int x, int y, const Rect &region)
+{
+    if (toRender != realScreen)
+    {
+        // Stretching a part gives the same pixels as stretching whole bitmap
+        // only if every source pixel turns into equal block on screen
+        if ((_dstRect.GetWidth() % toRender->GetWidth()) != 0 ||
+            (_dstRect.GetHeight() % toRender->GetHeight()) != 0)
+            return false;
+        const int dst_x = _scaling.X.ScalePt(x + region.Left);
+        const int dst_y = _scaling.Y.ScalePt(y + region.Top);
+        const int width = _scaling.X.ScaleDistance(region.GetWidth());
+        const int height = _scaling.Y.ScaleDistance(region.GetHeight());
+        if (toRender->GetSize() == _dstRect.GetSize())
+            realScreen->Blit(toRender, region.Left, region.Top, dst_x, dst_y, width, height);
+        else
+            realScreen->StretchBlt(toRender, region, RectWH(dst_x, dst_y, width, height));
+    }
+    lastBlitFrom = toRender;
+    lastBlitX = _scaling.X.ScalePt(x);
+    lastBlitY = _scaling.Y.ScalePt(y);
+    return true;
+}
+
 void AllegroGfxFilter::RenderScreenFlipped(Bitmap *toRender, int x, int y, GlobalFlipType flipType) {
 
     if (toRender == virtualScreen)
@@ -43,6 +43,12 @@ public:
     virtual Bitmap *ShutdownAndReturnRealScreen();
     virtual void RenderScreen(Bitmap *toRender, int x, int y);
     virtual void RenderScreenFlipped(Bitmap *toRender, int x, int y, GlobalFlipType flipType);
+    // Renders only given region of the bitmap; returns false if the filter
+    // cannot do this, in which case the whole bitmap should be rendered
+    virtual bool RenderScreenRegion(Bitmap *toRender, int x, int y, const Rect &region);
+    // Tells that renderer only redraws the changed parts of the screen,
+    // so the filter may also save work on the unchanged ones
+    virtual void UseDirtyRects(bool enabled) { }
     virtual void ClearRect(int x1, int y1, int x2, int y2, int color);
     virtual void GetCopyOfScreenIntoBitmap(Bitmap *copyBitmap);
     virtual void GetCopyOfScreenIntoBitmap(Bitmap *copyBitmap, bool copy_with_yoffset);
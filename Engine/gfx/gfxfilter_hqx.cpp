@@ -12,9 +12,11 @@
 //
 //=============================================================================
 
+#include <string.h>
 #include "gfx/bitmap.h"
 #include "gfx/gfxfilter_hqx.h"
 #include "gfx/hq2x3x.h"
+#include "gfx/renderthreads.h"
 
 namespace AGS
 {
@@ -27,9 +29,17 @@ using namespace Common;
 
 const GfxFilterInfo HqxGfxFilter::FilterInfo = GfxFilterInfo("Hqx", "Hqx (High Quality)", 2, 3);
 
+// Height of the source band, in rows; the frame is split into bands to
+// scale them on the render threads and to skip the unchanged ones
+const int HqxBandHeight = 16;
+
 HqxGfxFilter::HqxGfxFilter()
     : _pfnHqx(NULL)
     , _hqxScalingBuffer(NULL)
+    , _bandSource(NULL)
+    , _bandCount(0)
+    , _skipUnchanged(false)
+    , _lastFrameValid(false)
 {
 }
 
@@ -61,10 +71,11 @@ Bitmap* HqxGfxFilter::InitVirtualScreen(Bitmap *screen, const Size src_size, con
     int min_scaling = Math::Min(dst_rect.GetWidth() / src_size.Width, dst_rect.GetHeight() / src_size.Height);
     min_scaling = Math::Clamp(2, 3, min_scaling);
     if (min_scaling == 2)
-        _pfnHqx = hq2x_32;
+        _pfnHqx = hq2x_32_rows;
     else
-        _pfnHqx = hq3x_32;
+        _pfnHqx = hq3x_32_rows;
     _hqxScalingBuffer = BitmapHelper::CreateBitmap(src_size.Width * min_scaling, src_size.Height * min_scaling);
+    _lastFrameValid = false;
 
     InitLUTs();
     return virtual_screen;
@@ -75,15 +86,86 @@ Bitmap *HqxGfxFilter::ShutdownAndReturnRealScreen()
     Bitmap *real_screen = AllegroGfxFilter::ShutdownAndReturnRealScreen();
     delete _hqxScalingBuffer;
     _hqxScalingBuffer = NULL;
+    _lastFrameValid = false;
+    _lastSource.clear();
     return real_screen;
 }
 
+void HqxGfxFilter::UseDirtyRects(bool enabled)
+{
+    _skipUnchanged = enabled;
+    _lastFrameValid = false;
+    if (!enabled)
+        _lastSource.clear();
+}
+
+void HqxGfxFilter::GetBandRows(int band, int &y_from, int &y_to) const
+{
+    y_from = band * HqxBandHeight;
+    y_to = Math::Min(y_from + HqxBandHeight, _bandSource->GetHeight());
+}
+
+void HqxGfxFilter::CompareBand(void *data, int band)
+{
+    HqxGfxFilter *filter = (HqxGfxFilter*)data;
+    int y_from, y_to;
+    filter->GetBandRows(band, y_from, y_to);
+    const size_t row_size = filter->_bandSource->GetWidth() * sizeof(uint32_t);
+    bool changed = false;
+    for (int y = y_from; y < y_to; ++y)
+    {
+        const unsigned char *src_row = filter->_bandSource->GetScanLine(y);
+        unsigned char *last_row = &filter->_lastSource[y * row_size];
+        if (memcmp(src_row, last_row, row_size) != 0)
+        {
+            memcpy(last_row, src_row, row_size);
+            changed = true;
+        }
+    }
+    filter->_bandChanged[band] = changed;
+}
+
+void HqxGfxFilter::ScaleBand(void *data, int band)
+{
+    HqxGfxFilter *filter = (HqxGfxFilter*)data;
+    if (filter->_skipUnchanged && filter->_lastFrameValid)
+    {
+        // hqx looks at the pixels around each one, so the band's result also
+        // depends on the edge rows of the neighbouring bands
+        const int last_band = filter->_bandCount - 1;
+        if (!filter->_bandChanged[band] &&
+            (band == 0 || !filter->_bandChanged[band - 1]) &&
+            (band == last_band || !filter->_bandChanged[band + 1]))
+            return;
+    }
+    int y_from, y_to;
+    filter->GetBandRows(band, y_from, y_to);
+    Bitmap *src = filter->_bandSource;
+    filter->_pfnHqx(src->GetDataForWriting(), filter->_hqxScalingBuffer->GetDataForWriting(),
+        src->GetWidth(), src->GetHeight(), filter->_hqxScalingBuffer->GetLineLength(), y_from, y_to);
+}
+
 Bitmap *HqxGfxFilter::PreRenderPass(Bitmap *toRender)
 {
+    _bandSource = toRender;
+    _bandCount = (toRender->GetHeight() + HqxBandHeight - 1) / HqxBandHeight;
+    if (_skipUnchanged)
+    {
+        const size_t src_size = toRender->GetWidth() * toRender->GetHeight() * sizeof(uint32_t);
+        if (_lastSource.size() != src_size)
+        {
+            _lastSource.resize(src_size);
+            _lastFrameValid = false;
+        }
+        _bandChanged.resize(_bandCount);
+        RenderThreads::RunBands(CompareBand, this, _bandCount);
+    }
+
     _hqxScalingBuffer->Acquire();
-    _pfnHqx(toRender->GetDataForWriting(), _hqxScalingBuffer->GetDataForWriting(),
-        toRender->GetWidth(), toRender->GetHeight(), _hqxScalingBuffer->GetLineLength());
+    RenderThreads::RunBands(ScaleBand, this, _bandCount);
     _hqxScalingBuffer->Release();
+    _lastFrameValid = _skipUnchanged;
+    _bandSource = NULL;
     return _hqxScalingBuffer;
 }
 
@@ -19,6 +19,7 @@
 #ifndef __AGS_EE_GFX__HQ2XGFXFILTER_H
 #define __AGS_EE_GFX__HQ2XGFXFILTER_H
 
+#include <vector>
 #include "gfx/gfxfilter_allegro.h"
 
 namespace AGS
@@ -39,16 +40,33 @@ public:
     virtual bool Initialize(const int color_depth, String &err_str);
     virtual Bitmap *InitVirtualScreen(Bitmap *screen, const Size src_size, const Rect dst_rect);
     virtual Bitmap *ShutdownAndReturnRealScreen();
+    // hqx result depends on the neighbouring pixels, so it is always applied to whole screen
+    virtual bool RenderScreenRegion(Bitmap *toRender, int x, int y, const Rect &region) { return false; }
+    // Skips scaling of the bands whose source rows did not change since the last frame
+    virtual void UseDirtyRects(bool enabled);
 
     static const GfxFilterInfo FilterInfo;
 
 protected:
     virtual Bitmap *PreRenderPass(Bitmap *toRender);
 
-    typedef void (*PfnHqx)(unsigned char *in, unsigned char *out, int src_w, int src_h, int bpl);
+    typedef void (*PfnHqxRows)(unsigned char *in, unsigned char *out, int src_w, int src_h, int bpl,
+                               int y_from, int y_to);
 
-    PfnHqx  _pfnHqx;
-    Bitmap *_hqxScalingBuffer;
+    // Band jobs for the render threads
+    static void CompareBand(void *data, int band);
+    static void ScaleBand(void *data, int band);
+    void GetBandRows(int band, int &y_from, int &y_to) const;
+
+    PfnHqxRows _pfnHqx;
+    Bitmap    *_hqxScalingBuffer;
+    Bitmap    *_bandSource;    // bitmap being scaled, only valid during PreRenderPass
+    int        _bandCount;
+    bool       _skipUnchanged;
+    // Tells that scaling buffer has the result of scaling _lastSource
+    bool       _lastFrameValid;
+    std::vector<unsigned char> _lastSource;
+    std::vector<char> _bandChanged;
 };
 
 } // namespace ALSW
@@ -52,6 +52,20 @@ enum VideoSkipType
   VideoSkipKeyOrMouse = 3
 };
 
+// Counters of the screen area redrawn by the renderer
+struct GfxRenderStats
+{
+  int32_t  FramePixels; // pixels redrawn for the last frame
+  int32_t  FrameRects;  // number of regions the last frame was redrawn in
+  int32_t  Frames;      // frames rendered in total
+  int32_t  FullFrames;  // frames that had to be redrawn entirely
+  int64_t  TotalPixels; // pixels redrawn in total
+  int32_t  Conversions; // sprite images converted to the screen color depth
+
+  GfxRenderStats()
+    : FramePixels(0), FrameRects(0), Frames(0), FullFrames(0), TotalPixels(0), Conversions(0) {}
+};
+
 typedef void (*GFXDRV_CLIENTCALLBACK)();
 typedef bool (*GFXDRV_CLIENTCALLBACKXY)(int x, int y);
 typedef void (*GFXDRV_CLIENTCALLBACKINITGFX)(void *data);
@@ -121,6 +135,19 @@ public:
   virtual bool RequiresFullRedrawEachFrame() = 0;
   virtual bool HasAcceleratedStretchAndFlip() = 0;
   virtual bool UsesMemoryBackBuffer() = 0;
+  // Enables or disables redrawing only the parts of the screen that have
+  // changed since the last frame. While enabled, the driver expects the whole
+  // scene, room background included, to be passed in the draw list each
+  // frame, and nothing drawn right onto the back buffer, null sprite
+  // callbacks included. Drivers that redraw everything anyway ignore this.
+  virtual void UseDirtyRects(bool enabled) = 0;
+  virtual bool UsesDirtyRects() = 0;
+  // Sets the number of threads the draw list may be composited with, the
+  // render helper threads included; 1 means no threading, and negative value
+  // means all of the helper threads. Drivers that do not composite on the
+  // CPU ignore this.
+  virtual void SetComposeThreads(int thread_count) = 0;
+  virtual const GfxRenderStats &GetRenderStats() = 0;
   virtual ~IGraphicsDriver() { }
 };
 
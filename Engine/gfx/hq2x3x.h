@@ -16,13 +16,19 @@
 #define __AC_HQ2X3X_H
 
 #if defined(ANDROID_VERSION) || defined(PSP_VERSION)
-void InitLUTs(){}
-void hq2x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL ){}
-void hq3x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL ){}
+inline void InitLUTs(){}
+inline void hq2x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL ){}
+inline void hq3x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL ){}
+inline void hq2x_32_rows( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL, int y_from, int y_to ){}
+inline void hq3x_32_rows( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL, int y_from, int y_to ){}
 #else
 void InitLUTs();
 void hq2x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL );
 void hq3x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL );
+// Scale only source rows [y_from, y_to) of the image; the rows may be
+// processed in parallel, because each call writes only its own output rows
+void hq2x_32_rows( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL, int y_from, int y_to );
+void hq3x_32_rows( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL, int y_from, int y_to );
 #endif
 
 #endif // __AC_HQ2X3X_H
\ No newline at end of file
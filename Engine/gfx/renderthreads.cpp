@@ -0,0 +1,160 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include "gfx/renderthreads.h"
+#include "platform/base/agsplatformdriver.h"
+#include "util/math.h"
+#include "util/mutex.h"
+#include "util/mutex_lock.h"
+#include "util/semaphore.h"
+#include "util/thread.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+namespace RenderThreads
+{
+
+namespace Math = AGS::Common::Math;
+
+namespace
+{
+
+Thread      Workers[MaxThreadCount];
+int         WorkerCount = 0;
+// Signalled once for every helper thread that should look for work
+Semaphore  *JobSignal = NULL;
+// Signalled by the helper thread which has finished the last band
+Semaphore  *DoneSignal = NULL;
+volatile bool QuitWorkers = false;
+
+// Following are protected by the mutex
+Mutex       JobMutex;
+PfnBandJob  JobFunc = NULL;
+void       *JobData = NULL;
+int         JobBands = 0;
+int         NextBand = 0;
+int         BandsDone = 0;
+
+// Processes bands of the current job until there are none left;
+// returns true if the caller has finished the last band of the job
+bool RunJobBands()
+{
+    bool finished_job = false;
+    MutexLock lock(JobMutex);
+    while (NextBand < JobBands)
+    {
+        const int band = NextBand++;
+        PfnBandJob job = JobFunc;
+        void *data = JobData;
+        lock.Release();
+        job(data, band);
+        lock.Acquire(JobMutex);
+        if (++BandsDone == JobBands)
+            finished_job = true;
+    }
+    return finished_job;
+}
+
+// Thread entry point
+void RunWorker()
+{
+    JobSignal->Wait();
+    if (QuitWorkers)
+    {
+        // pass the signal on, in case this thread gets called again
+        // before it is told to stop
+        JobSignal->Post();
+        return;
+    }
+    if (RunJobBands())
+        DoneSignal->Post();
+}
+
+} // namespace
+
+int Init(int thread_count)
+{
+    Shutdown();
+    if (thread_count < 0)
+        thread_count = platform->GetCPUCount() - 1;
+    thread_count = Math::Clamp(0, MaxThreadCount, thread_count);
+    if (thread_count == 0)
+        return 0;
+
+    JobSignal = new Semaphore();
+    DoneSignal = new Semaphore();
+    QuitWorkers = false;
+    for (; WorkerCount < thread_count; ++WorkerCount)
+    {
+        if (!Workers[WorkerCount].CreateAndStart(RunWorker, true))
+            break;
+    }
+    if (WorkerCount == 0)
+        Shutdown();
+    return WorkerCount;
+}
+
+void Shutdown()
+{
+    if (!JobSignal)
+        return;
+    QuitWorkers = true;
+    JobSignal->Post();
+    for (int i = 0; i < WorkerCount; ++i)
+        Workers[i].Stop();
+    WorkerCount = 0;
+    delete JobSignal;
+    delete DoneSignal;
+    JobSignal = NULL;
+    DoneSignal = NULL;
+}
+
+int GetThreadCount()
+{
+    return WorkerCount;
+}
+
+void RunBands(PfnBandJob job, void *data, int band_count)
+{
+    if (WorkerCount == 0 || band_count < 2)
+    {
+        for (int band = 0; band < band_count; ++band)
+            job(data, band);
+        return;
+    }
+
+    {
+        MutexLock lock(JobMutex);
+        JobFunc = job;
+        JobData = data;
+        JobBands = band_count;
+        NextBand = 0;
+        BandsDone = 0;
+    }
+    // calling thread takes a band too, so there's no use in waking up
+    // more helpers than the remaining bands
+    const int wake_count = Math::Min(WorkerCount, band_count - 1);
+    for (int i = 0; i < wake_count; ++i)
+        JobSignal->Post();
+    if (!RunJobBands())
+        DoneSignal->Wait();
+}
+
+} // namespace RenderThreads
+
+} // namespace Engine
+} // namespace AGS
@@ -0,0 +1,55 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Helper threads for the software rendering. A job is split into a number
+// of bands (normally, horizontal stripes of a bitmap), which are processed
+// in parallel by the helper threads and the thread that has started the job.
+// Band functions must only write to the memory which belongs to their band.
+//
+//=============================================================================
+#ifndef __AGS_EE_GFX__RENDERTHREADS_H
+#define __AGS_EE_GFX__RENDERTHREADS_H
+
+namespace AGS
+{
+namespace Engine
+{
+
+namespace RenderThreads
+{
+
+// Maximal number of helper threads
+const int MaxThreadCount = 7;
+
+// Processes single band of the job
+typedef void (*PfnBandJob)(void *data, int band);
+
+// Starts helper threads; negative count means one less than the number of
+// CPUs, and zero means no threads. Returns the number of started threads.
+int  Init(int thread_count);
+// Stops all helper threads
+void Shutdown();
+// Returns the number of running helper threads
+int  GetThreadCount();
+// Calls job function for each band in [0; band_count) range, returns when
+// all of them are done. Jobs are run one at a time, and only from the main
+// thread; without helper threads all bands are processed in order.
+void RunBands(PfnBandJob job, void *data, int band_count);
+
+} // namespace RenderThreads
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_GFX__RENDERTHREADS_H
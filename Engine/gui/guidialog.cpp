@@ -19,6 +19,7 @@
 #include "ac/game.h"
 #include "ac/gamesetup.h"
 #include "ac/gamesetupstruct.h"
+#include "game/savegame_writer.h"
 #include "gui/cscidialog.h"
 #include <cctype> //isdigit()
 #include "gfx/bitmap.h"
@@ -287,6 +288,7 @@ void preparesavegamelist(int ctrllist)
   char curdir[255];
   _getcwd(curdir, 255);
 
+  WaitForSavegameWrites();
   char searchPath[260];
   sprintf(searchPath, "%s""agssave.*%s", saveGameDirectory, saveGameSuffix.GetCStr());
 
@@ -21,7 +21,6 @@
 
 static int   LUT16to32[65536];
 static int   RGBtoYUV[65536];
-static int   YUV1, YUV2;
 const  int   Ymask = 0x00FF0000;
 const  int   Umask = 0x0000FF00;
 const  int   Vmask = 0x000000FF;
@@ -146,8 +145,8 @@ inline void Interp10(unsigned char * pc, int c1, int c2, int c3)
 
 inline bool Diff(unsigned int w1, unsigned int w2)
 {
-  YUV1 = RGBtoYUV[w1];
-  YUV2 = RGBtoYUV[w2];
+  const int YUV1 = RGBtoYUV[w1];
+  const int YUV2 = RGBtoYUV[w2];
   return ( ( abs((YUV1 & Ymask) - (YUV2 & Ymask)) > trY ) ||
            ( abs((YUV1 & Umask) - (YUV2 & Umask)) > trU ) ||
            ( abs((YUV1 & Vmask) - (YUV2 & Vmask)) > trV ) );
@@ -156,10 +155,11 @@ inline bool Diff(unsigned int w1, unsigned int w2)
 #define INPUT_IMAGE_PIXEL_SIZE uint32_t
 #define INPUT_IMAGE_PIXEL_SIZE_IN_BYTES sizeof(INPUT_IMAGE_PIXEL_SIZE)
 
-void hq2x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL )
+void hq2x_32_rows( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL, int y_from, int y_to )
 {
   int  i, j, k;
   int  prevline, nextline;
+  int  YUV1, YUV2;
   int  w[10];
   int  c[10];
 
@@ -174,7 +174,12 @@ void hq2x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int
   //   | w7 | w8 | w9 |
   //   +----+----+----+
 
-  for (j=0; j<Yres; j++)
+  // Skip to the first requested row; neighbour rows are still read
+  // from the whole image, so that the bands match full image result
+  pIn  += y_from * Xres * 4;
+  pOut += y_from * BpL * 2;
+
+  for (j=y_from; j<y_to; j++)
   {
     if (j>0)      prevline = -Xres*4; else prevline = 0;
     if (j<Yres-1) nextline =  Xres*4; else nextline = 0;
@@ -2890,6 +2895,11 @@ void hq2x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int
   }
 }
 
+void hq2x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL )
+{
+  hq2x_32_rows(pIn, pOut, Xres, Yres, BpL, 0, Yres);
+}
+
 void InitLUTs(void)
 {
   int i, j, k, r, g, b, Y, u, v;
@@ -2972,10 +2982,11 @@ void InitLUTs(void)
 
 
 
-void hq3x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL )
+void hq3x_32_rows( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL, int y_from, int y_to )
 {
   int  i, j, k;
   int  prevline, nextline;
+  int  YUV1, YUV2;
   int  w[10];
   int  c[10];
 
@@ -2990,7 +3001,12 @@ void hq3x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int
   //   | w7 | w8 | w9 |
   //   +----+----+----+
 
-  for (j=0; j<Yres; j++)
+  // Skip to the first requested row; neighbour rows are still read
+  // from the whole image, so that the bands match full image result
+  pIn  += y_from * Xres * 4;
+  pOut += y_from * BpL * 3;
+
+  for (j=y_from; j<y_to; j++)
   {
     if (j>0)      prevline = -Xres*4; else prevline = 0;
     if (j<Yres-1) nextline =  Xres*4; else nextline = 0;
@@ -6679,3 +6695,8 @@ void hq3x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int
     pOut+=BpL;
   }
 }
+
+void hq3x_32( unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int BpL )
+{
+  hq3x_32_rows(pIn, pOut, Xres, Yres, BpL, 0, Yres);
+}
@@ -28,6 +28,7 @@
 #include "main/config.h"
 #include "platform/base/agsplatformdriver.h"
 #include "platform/base/override_defines.h" //_getcwd()
+#include "script/cc_instance.h"
 #include "util/directory.h"
 #include "util/filestream.h"
 #include "util/ini_util.h"
@@ -388,7 +389,9 @@ void read_config(const ConfigTree &cfg)
 #if defined (WINDOWS_VERSION)
         usetup.Screen.DriverID = INIreadstring(cfg, "graphics", "driver");
 #else
-        usetup.Screen.DriverID = "Software";
+        usetup.Screen.DriverID = INIreadstring(cfg, "graphics", "driver");
+        if (usetup.Screen.DriverID.CompareNoCase("Null") != 0)
+            usetup.Screen.DriverID = "Software";
 #endif
         if (usetup.Screen.DriverID.CompareNoCase("DX5") == 0)
             usetup.Screen.DriverID = "Software";
@@ -423,6 +426,11 @@ void read_config(const ConfigTree &cfg)
         usetup.Screen.DisplayMode.RefreshRate = INIreadint(cfg, "graphics", "refresh");
         usetup.Screen.DisplayMode.VSync = INIreadint(cfg, "graphics", "vsync") > 0;
         usetup.RenderAtScreenRes = INIreadint(cfg, "graphics", "render_at_screenres") > 0;
+        usetup.dirty_rects = INIreadint(cfg, "graphics", "dirty_rects", usetup.dirty_rects ? 1 : 0) != 0;
+        usetup.render_threads = INIreadint(cfg, "graphics", "render_threads", usetup.render_threads);
+        usetup.compose_threads = INIreadint(cfg, "graphics", "compose_threads", usetup.compose_threads);
+        usetup.dump_frames = INIreadint(cfg, "graphics", "dump_frames", usetup.dump_frames);
+        usetup.dump_frames_dir = INIreadstring(cfg, "graphics", "dump_frames_dir", usetup.dump_frames_dir);
 
         usetup.enable_antialiasing = INIreadint(cfg, "misc", "antialias") > 0;
         if (!usetup.force_hicolor_mode)
@@ -441,6 +449,27 @@ void read_config(const ConfigTree &cfg)
         // the config file specifies cache size in KB, here we convert it to bytes
         spriteset.maxCacheSize = INIreadint (cfg, "misc", "cachemax", DEFAULTCACHESIZE / 1024) * 1024;
 #endif
+        // optional limits for the sprite kinds, within the total cache size
+        spriteset.setCategoryBudget(kSprCat_Room, INIreadint(cfg, "misc", "cachemax_room", 0) * 1024);
+        spriteset.setCategoryBudget(kSprCat_Character, INIreadint(cfg, "misc", "cachemax_character", 0) * 1024);
+        spriteset.setCategoryBudget(kSprCat_GUI, INIreadint(cfg, "misc", "cachemax_gui", 0) * 1024);
+
+        usetup.sprite_prefetch = INIreadint(cfg, "misc", "sprite_prefetch", usetup.sprite_prefetch ? 1 : 0) != 0;
+        usetup.text_cache_size = INIreadint(cfg, "misc", "textcachemax", usetup.text_cache_size);
+        usetup.room_preload = INIreadint(cfg, "misc", "room_preload", usetup.room_preload);
+        usetup.room_preload_size = INIreadint(cfg, "misc", "room_preload_max", usetup.room_preload_size);
+        usetup.save_in_background = INIreadint(cfg, "misc", "save_in_background", usetup.save_in_background ? 1 : 0) != 0;
+
+        String script_dispatch = INIreadstring(cfg, "misc", "script_dispatch");
+        if (script_dispatch.CompareNoCase("switch") == 0)
+        {
+            ccInstance::SetDispatchMode(kScDispatch_Switch);
+        }
+        else if (script_dispatch.CompareNoCase("threaded") == 0)
+        {
+            if (!ccInstance::SetDispatchMode(kScDispatch_Threaded))
+                Debug::Printf(kDbgMsg_Warn, "WARNING: threaded script dispatch is not supported by this build");
+        }
 
         String repfile = INIreadstring(cfg, "misc", "replay");
         if (repfile != NULL) {
@@ -449,6 +478,11 @@ void read_config(const ConfigTree &cfg)
         }
         else
             play.playback = 0;
+        // replay benchmark file from the command line overrides config
+        if (!usetup.replay_bench_file.IsEmpty()) {
+            snprintf(replayfile, MAX_PATH, "%s", usetup.replay_bench_file.GetCStr());
+            play.playback = 1;
+        }
 
         usetup.mouse_auto_lock = INIreadint(cfg, "mouse", "auto_lock") > 0;
 
@@ -33,8 +33,10 @@
 #include "ac/objectcache.h"
 #include "ac/path_helper.h"
 #include "ac/record.h"
+#include "ac/roompreload.h"
 #include "ac/roomstatus.h"
 #include "ac/speech.h"
+#include "ac/textruncache.h"
 #include "ac/translation.h"
 #include "ac/viewframe.h"
 #include "ac/dynobj/scriptobject.h"
@@ -45,6 +47,7 @@
 #include "font/agsfontrenderer.h"
 #include "font/fonts.h"
 #include "game/main_game_file.h"
+#include "game/savegame_writer.h"
 #include "main/config.h"
 #include "main/game_start.h"
 #include "main/engine.h"
@@ -53,9 +56,14 @@
 #include "main/main.h"
 #include "main/main_allegro.h"
 #include "media/audio/sound.h"
+#include "ac/sprite.h"
 #include "ac/spritecache.h"
+#include "ac/spriteprefetch.h"
 #include "util/filestream.h"
+#include "gfx/blend_kernels.h"
+#include "gfx/gfxdriverfactory.h"
 #include "gfx/graphicsdriver.h"
+#include "gfx/renderthreads.h"
 #include "core/assetmanager.h"
 #include "util/misc.h"
 #include "platform/util/pe.h"
@@ -233,6 +241,29 @@ void engine_force_window()
     }
 }
 
+void engine_force_headless()
+{
+    // Run without display and sound, override the config file
+    if (usetup.headless)
+    {
+        usetup.Screen.DriverID = "Null";
+        usetup.digicard = DIGI_NONE;
+        usetup.midicard = MIDI_NONE;
+    }
+    if (usetup.Screen.DriverID.CompareNoCase("Null") == 0)
+    {
+        // there's no device to fit the screen to, so take the game size as is,
+        // unless the config has explicit scaling
+        usetup.Screen.DisplayMode.Windowed = true;
+        usetup.Screen.DisplayMode.ScreenSize.SizeDef = kScreenDef_ByGameScaling;
+        if (usetup.Screen.WinGameFrame.ScaleDef != kFrame_IntScale)
+        {
+            usetup.Screen.WinGameFrame.ScaleDef = kFrame_IntScale;
+            usetup.Screen.WinGameFrame.ScaleFactor = 1;
+        }
+    }
+}
+
 void init_game_file_name_from_cmdline()
 {
     game_file_name.Empty();
@@ -961,6 +992,14 @@ int engine_init_sprites()
         return EXIT_NORMAL;
     }
 
+    if (usetup.sprite_prefetch)
+    {
+        if (spriteprefetch_start("acsprset.spr"))
+            Debug::Printf(kDbgMsg_Init, "Sprite prefetch thread started");
+        else
+            Debug::Printf(kDbgMsg_Init, "Failed to start sprite prefetch thread, sprites will be loaded on demand");
+    }
+
     return RETURN_CONTINUE;
 }
 
@@ -998,6 +1037,7 @@ void engine_init_game_settings()
     // may as well preload the character gfx
     if (playerchar->view >= 0)
         precache_view (playerchar->view);
+    init_sprite_categories();
 
     for (ee = 0; ee < MAX_INIT_SPR; ee++)
         objcache[ee].image = NULL;
@@ -1351,6 +1391,10 @@ bool engine_read_config(const String &exe_path, ConfigTree &cfg)
         INIwriteint(cfg, "misc", "log", 0);
     else if (enable_log_file)
         INIwriteint(cfg, "misc", "log", 1);
+    if (enable_profiler)
+        INIwriteint(cfg, "debug", "profiler", 1);
+    if (!profiler_trace_file.IsEmpty())
+        INIwritestring(cfg, "debug", "profiler_trace", profiler_trace_file);
 
     // Parse and set up game config
     read_config(cfg);
@@ -1392,6 +1436,8 @@ int initialize_engine(int argc,char*argv[])
 
     engine_force_window();
 
+    engine_force_headless();
+
     our_eip = -195;
 
     our_eip = -192;
@@ -1497,6 +1543,16 @@ int initialize_engine(int argc,char*argv[])
 
     engine_init_resolution_settings(game.size);
 
+    BlendKernels::Init();
+    Debug::Printf(kDbgMsg_Init, "Software blending kernels: %s", BlendKernels::GetSetName(BlendKernels::GetActiveSet()));
+    Debug::Printf(kDbgMsg_Init, "Render helper threads: %d", RenderThreads::Init(usetup.render_threads));
+    textcache_set_max_size(Math::Max(0, usetup.text_cache_size) * 1024);
+    if (usetup.room_preload > 0 &&
+        roompreload_start(usetup.room_preload, Math::Max(0, usetup.room_preload_size) * 1024))
+        Debug::Printf(kDbgMsg_Init, "Room preload thread started");
+    if (usetup.save_in_background && StartSavegameWriter())
+        Debug::Printf(kDbgMsg_Init, "Savegame writing thread started");
+
     // Attempt to initialize graphics mode
     if (!engine_try_set_gfxmode_any(usetup.Screen))
         return EXIT_NORMAL;
@@ -1535,6 +1591,9 @@ bool engine_try_set_gfxmode_any(const ScreenSetup &setup)
         return false;
 
     engine_post_gfxmode_setup(init_desktop);
+    gfxDriver->SetComposeThreads(usetup.compose_threads);
+    if (usetup.dump_frames > 0 && stricmp(gfxDriver->GetDriverID(), "Null") == 0)
+        SetNullGfxFrameDump(usetup.dump_frames_dir, usetup.dump_frames);
     return true;
 }
 
@@ -39,22 +39,31 @@
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
 #include "ac/roomstruct.h"
+#include "ac/dynobj/managedobjectpool.h"
 #include "debug/debugger.h"
 #include "debug/debug_log.h"
+#include "debug/profiler.h"
+#include "debug/out.h"
+#include "game/savegame_writer.h"
 #include "gui/guiinv.h"
 #include "gui/guimain.h"
 #include "gui/guitextbox.h"
 #include "main/mainheader.h"
 #include "main/engine.h"
 #include "main/game_run.h"
+#include "main/replay_bench.h"
 #include "main/update.h"
 #include "media/audio/soundclip.h"
 #include "plugin/agsplugin.h"
 #include "plugin/plugin_engine.h"
 #include "script/script.h"
 #include "ac/spritecache.h"
+#include "ac/spriteprefetch.h"
+#include "ac/textruncache.h"
+#include "gfx/graphicsdriver.h"
 
 using namespace AGS::Common;
+using namespace AGS::Engine;
 
 extern AnimatingGUIButton animbuts[MAX_ANIMATING_BUTTONS];
 extern int numAnimButs;
@@ -87,6 +96,7 @@ extern int offsetx, offsety;
 extern unsigned int loopcounter,lastcounter;
 extern volatile int timerloop;
 extern int cur_mode,cur_cursor;
+extern IGraphicsDriver *gfxDriver;
 
 // Checks if user interface should remain disabled for now
 int ShouldStayInWaitMode();
@@ -607,6 +617,18 @@ void game_loop_update_events()
     if (in_new_room>0)
         setevent(EV_FADEIN,0,0,0);
     in_new_room=0;
+    // tell the script about the finished saves; games made with the older
+    // script API don't know these events, so they only get the failures
+    // displayed to the player
+    int save_slot;
+    bool save_success;
+    while (GetWrittenSavegame(save_slot, save_success))
+    {
+        if (game.options[OPT_BASESCRIPTAPI] >= kScriptAPI_v341)
+            run_on_event(save_success ? GE_SAVE_GAME : GE_SAVE_FAILED, RuntimeScriptValue().SetInt32(save_slot));
+        else if (!save_success)
+            Display("ERROR: Unable to save the game to slot %d.", save_slot);
+    }
     update_events();
     if ((new_room_was > 0) && (in_new_room == 0)) {
         // if in a new room, and the room wasn't just changed again in update_events,
@@ -649,6 +671,16 @@ void game_loop_update_loop_counter()
     }
 }
 
+void game_loop_collect_garbage()
+{
+    // the game loop also runs inside blocking script calls, when the
+    // objects that are only referenced from the script registers and
+    // arguments have zero reference count, but are still in use
+    if (inside_script || curscript != NULL)
+        return;
+    pool.RunGarbageCollectionStep();
+}
+
 void game_loop_check_replay_record()
 {
     if (replay_start_this_time) {
@@ -657,12 +689,43 @@ void game_loop_check_replay_record()
     }
 }
 
+void log_engine_stats()
+{
+    const ManagedObjectPool::GCStats &gc = pool.GetGCStats();
+    Debug::Printf(kDbgGroup_ManObj, kDbgMsg_Debug, "Managed objects: %d alive, %d queued; last GC step: %d checked, %d disposed in %d us; total: %d disposed in %d ms",
+        gc.ObjectsAlive, gc.QueueLength, gc.LastSwept, gc.LastDisposed, (int)gc.LastTime, (int)gc.TotalDisposed, (int)(gc.TotalTime / 1000));
+    Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Debug, "Sprite cache: %d hits, %d prefetch hits, %d misses; size %d KB (limit %d KB; %d locked)",
+        spriteset.stats.Hits, spriteset.stats.PrefetchHits, spriteset.stats.Misses,
+        spriteset.cachesize / 1024, spriteset.maxCacheSize / 1024, spriteset.lockedSize / 1024);
+    const TextRunCacheStats &tc = textcache_get_stats();
+    if (tc.MaxSize > 0)
+        Debug::Printf(kDbgMsg_Debug, "Text cache: %d hits, %d misses; size %d KB (limit %d KB)",
+            tc.Hits, tc.Misses, (int)(tc.Size / 1024), (int)(tc.MaxSize / 1024));
+
+    static GfxRenderStats last_render_stats;
+    const GfxRenderStats &rs = gfxDriver->GetRenderStats();
+    if (gfxDriver->UsesDirtyRects() && rs.Frames > last_render_stats.Frames)
+    {
+        const int frames = rs.Frames - last_render_stats.Frames;
+        Debug::Printf(kDbgMsg_Debug, "Renderer: %d frames (%d redrawn in full), %d pixels redrawn per frame; last frame: %d pixels in %d regions",
+            frames, rs.FullFrames - last_render_stats.FullFrames, (int)((rs.TotalPixels - last_render_stats.TotalPixels) / frames),
+            rs.FramePixels, rs.FrameRects);
+    }
+    if (rs.Conversions > last_render_stats.Conversions)
+        Debug::Printf(kDbgMsg_Debug, "Renderer: %d sprites converted to screen color depth",
+            rs.Conversions - last_render_stats.Conversions);
+    last_render_stats = rs;
+}
+
 void game_loop_update_fps()
 {
     if (time(NULL) != t1) {
         t1 = time(NULL);
         fps = loopcounter - lastcounter;
         lastcounter = loopcounter;
+
+        if (show_engine_stats)
+            log_engine_stats();
     }
 }
 
@@ -670,6 +733,9 @@ void PollUntilNextFrame()
 {
     // make sure we poll, cos a low framerate (eg 5 fps) could stutter
     // mp3 music
+    // the replay benchmark runs frames back to back
+    if (ReplayBench::IsActive())
+        return;
     while (timerloop == 0 && play.fast_forward == 0) {
         update_polled_stuff_if_runtime();
         platform->YieldCPU();
@@ -680,7 +746,19 @@ void UpdateGameOnce(bool checkControls, IDriverDependantBitmap *extraBitmap, int
 
     int res;
 
-    update_mp3();
+    if (ReplayBench::IsActive() && !play.playback) {
+        ReplayBench::Finish();
+        quit("|Replay benchmark complete");
+    }
+    ReplayBench::BeginFrame();
+    Profiler::BeginFrame();
+
+    ReplayBench::SetPhase(ReplayBench::kPhase_Audio);
+    {
+        Profiler::Zone zone("audio");
+        update_mp3();
+    }
+    ReplayBench::SetPhase(ReplayBench::kPhase_Other);
 
     numEventsAtStartOfFunction = numevents;
 
@@ -704,6 +782,7 @@ void UpdateGameOnce(bool checkControls, IDriverDependantBitmap *extraBitmap, int
 
     our_eip = 1004;
 
+    ReplayBench::SetPhase(ReplayBench::kPhase_Script);
     game_loop_check_new_room();
 
     our_eip = 1005;
@@ -721,29 +800,39 @@ void UpdateGameOnce(bool checkControls, IDriverDependantBitmap *extraBitmap, int
 
     our_eip=2;
 
+    ReplayBench::SetPhase(ReplayBench::kPhase_Update);
     game_loop_do_update();
 
     game_loop_update_animated_buttons();
 
+    ReplayBench::SetPhase(ReplayBench::kPhase_Script);
     game_loop_do_late_update();
 
+    ReplayBench::SetPhase(ReplayBench::kPhase_Audio);
     update_polled_audio_and_crossfade();
 
+    ReplayBench::SetPhase(ReplayBench::kPhase_Draw);
     game_loop_do_render_and_check_mouse(extraBitmap, extraX, extraY);
 
     our_eip=6;
 
+    ReplayBench::SetPhase(ReplayBench::kPhase_Script);
     game_loop_update_events();
 
     our_eip=7;
 
     //    if (mgetbutton()>NONE) break;
+    ReplayBench::SetPhase(ReplayBench::kPhase_Audio);
     update_polled_stuff_if_runtime();
 
+    ReplayBench::SetPhase(ReplayBench::kPhase_Update);
     game_loop_update_background_animation();
 
     game_loop_update_loop_counter();
 
+    game_loop_collect_garbage();
+
+    ReplayBench::SetPhase(ReplayBench::kPhase_Other);
     game_loop_check_replay_record();
 
     // Immediately start the next frame if we are skipping a cutscene
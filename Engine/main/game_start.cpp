@@ -17,8 +17,10 @@
 //
 
 #include "ac/common.h"
+#include "ac/characterindex.h"
 #include "ac/characterinfo.h"
 #include "ac/game.h"
+#include "ac/gamesetup.h"
 #include "ac/gamesetupstruct.h"
 #include "ac/gamestate.h"
 #include "ac/global_game.h"
@@ -33,6 +35,7 @@
 #include "main/mainheader.h"
 #include "main/game_run.h"
 #include "main/game_start.h"
+#include "main/replay_bench.h"
 #include "script/script.h"
 
 using namespace AGS::Common;
@@ -40,6 +43,7 @@ using namespace AGS::Engine;
 
 extern int our_eip, displayed_room;
 extern volatile char want_exit, abort_engine;
+extern GameSetup usetup;
 extern GameSetupStruct game;
 extern GameState play;
 extern volatile int timerloop;
@@ -60,6 +64,12 @@ void start_game_check_replay()
     else if (play.playback) {
         start_playback();
     }
+
+    if (!usetup.replay_bench_file.IsEmpty()) {
+        if (!play.playback)
+            quit("!Replay benchmark: could not start playback of the replay file");
+        ReplayBench::Start();
+    }
 }
 
 void start_game_init_editor_debugging()
@@ -150,7 +160,10 @@ void initialize_start_and_play_game(int override_start_room, const char *loadSav
         srand (play.randseed);
         play.gamestep = 0;
         if (override_start_room)
+        {
             playerchar->room = override_start_room;
+            charindex_update(game.playercharacter);
+        }
 
         start_game_check_replay();
 
@@ -238,7 +238,7 @@ Size set_game_frame_after_screen_size(const Size &game_size, const Size screen_s
         frame_size = Size((game_size.Width * scale) >> kShift, (game_size.Height * scale) >> kShift);
         // If the scaled game size appear larger than the screen,
         // use "proportional stretch" method instead
-        if (frame_size.ExceedsByAny(screen_size))
+        if (!screen_size.IsNull() && frame_size.ExceedsByAny(screen_size))
             frame_size = ProportionalStretch(screen_size, game_size);
     }
     return frame_size;
@@ -295,8 +295,9 @@ bool try_init_compatible_mode(const DisplayMode &dm, const bool match_device_rat
     // Windowed mode
     if (dm.Windowed)
     {
-        // If windowed mode, make the resolution stay in the generally supported limits
-        if (Size(dm.Width, dm.Height).ExceedsByAny(device_size))
+        // If windowed mode, make the resolution stay in the generally supported limits;
+        // device size is unknown when running without display
+        if (!device_size.IsNull() && Size(dm.Width, dm.Height).ExceedsByAny(device_size))
         {
             dm_compat.Width = device_size.Width;
             dm_compat.Height = device_size.Height;
@@ -462,7 +463,11 @@ bool graphics_mode_init_any(const Size game_size, const ScreenSetup &setup, cons
 
     // Prepare the list of available gfx factories, having the one requested by user at first place
     StringV ids;
-    GetGfxDriverFactoryNames(ids);
+    // Null renderer is never used as a substitute for the requested one
+    if (setup.DriverID.CompareNoCase("Null") == 0)
+        ids.push_back(setup.DriverID);
+    else
+        GetGfxDriverFactoryNames(ids);
     StringV::iterator it = std::find(ids.begin(), ids.end(), setup.DriverID);
     if (it != ids.end())
         std::rotate(ids.begin(), it, ids.end());
@@ -38,6 +38,7 @@
 #include "core/assetmanager.h"
 #include "util/directory.h"
 #include "util/path.h"
+#include "test/benchmark.h"
 
 #ifdef _DEBUG
 #include "test/test_all.h"
@@ -89,6 +90,7 @@ bool justRunSetup = false;
 bool justRegisterGame = false;
 bool justUnRegisterGame = false;
 const char *loadSaveGameOnStartup = NULL;
+const char *runBenchmark = NULL;
 
 #if !defined(MAC_VERSION) && !defined(IOS_VERSION) && !defined(PSP_VERSION) && !defined(ANDROID_VERSION)
 int psp_video_framedrop = 1;
@@ -196,6 +198,16 @@ void main_print_help() {
            "  --log                        Enable program output to the log file\n"
            "  --no-log                     Disable program output to the log file,\n"
            "                                 overriding configuration file setting\n"
+           "  --headless                   Run without display and sound, using the\n"
+           "                                 null renderer\n"
+           "  --benchmark <name>           Run engine benchmark and exit; use \"list\"\n"
+           "                                 to see available benchmarks\n"
+           "  --replay-bench <file>        Play back recorded replay as fast as possible,\n"
+           "                                 print frame timings and exit\n"
+           "  --profile                    Enable frame profiler and show its overlay;\n"
+           "                                 Ctrl+Alt+P toggles the overlay\n"
+           "  --profile-trace <file>       Write frame profiler zones to the trace file\n"
+           "                                 for Chrome's trace viewer\n"
            "  --help                       Print this help message\n"
            "\n"
            "Gamefile options:\n"
@@ -316,6 +328,26 @@ int main_process_cmdline(int argc,char*argv[])
         {
             disable_log_file = true;
         }
+        else if (stricmp(argv[ee], "--headless") == 0)
+        {
+            usetup.headless = true;
+        }
+        else if (stricmp(argv[ee], "--benchmark") == 0 && (argc > ee + 1))
+        {
+            runBenchmark = argv[++ee];
+        }
+        else if (stricmp(argv[ee], "--replay-bench") == 0 && (argc > ee + 1))
+        {
+            usetup.replay_bench_file = argv[++ee];
+        }
+        else if (stricmp(argv[ee], "--profile") == 0)
+        {
+            enable_profiler = true;
+        }
+        else if (stricmp(argv[ee], "--profile-trace") == 0 && (argc > ee + 1))
+        {
+            profiler_trace_file = argv[++ee];
+        }
         else if (argv[ee][0]!='-') datafile_argv=ee;
     }
 
@@ -491,6 +523,13 @@ int main(int argc,char*argv[]) {
         return 0;
     }
 
+    if (runBenchmark)
+    {
+        if (!Bench_Run(runBenchmark))
+            Bench_PrintList();
+        return 0;
+    }
+
     init_debug();
     Debug::Printf(kDbgMsg_Init, get_engine_string());
 
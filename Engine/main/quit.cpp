@@ -20,6 +20,7 @@
 #include "ac/gamesetup.h"
 #include "ac/gamesetupstruct.h"
 #include "ac/record.h"
+#include "ac/roompreload.h"
 #include "ac/roomstatus.h"
 #include "ac/translation.h"
 #include "debug/agseditordebugger.h"
@@ -33,8 +34,11 @@
 #include "main/mainheader.h"
 #include "main/quit.h"
 #include "ac/spritecache.h"
+#include "ac/spriteprefetch.h"
+#include "game/savegame_writer.h"
 #include "gfx/graphicsdriver.h"
 #include "gfx/bitmap.h"
+#include "gfx/renderthreads.h"
 #include "core/assetmanager.h"
 #include "plugin/plugin_engine.h"
 
@@ -278,6 +282,11 @@ void quit(const char *quitmsg)
     our_eip = 9019;
 
     quit_shutdown_audio();
+
+    spriteprefetch_stop();
+    roompreload_stop();
+    StopSavegameWriter();
+    RenderThreads::Shutdown();
     
     our_eip = 9901;
 
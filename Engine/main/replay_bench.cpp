@@ -0,0 +1,147 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <algorithm>
+#include <vector>
+#include "main/replay_bench.h"
+#include "platform/base/agsplatformdriver.h"
+#include "util/clock.h"
+#include "util/string.h"
+
+using AGS::Common::String;
+
+namespace AGS
+{
+namespace Engine
+{
+
+namespace ReplayBench
+{
+
+static const char *PhaseNames[kNumPhases] =
+{
+    "script", "update", "draw", "render", "audio", "other"
+};
+
+// Per-frame timings in microseconds; the extra last slot holds whole frames
+typedef std::vector<int32_t> TimingList;
+static TimingList Timings[kNumPhases + 1];
+
+static bool     IsRunning = false;
+static bool     InFrame = false;
+static Phase    CurPhase = kPhase_Other;
+static int64_t  StartTime;
+static int64_t  FrameStart;
+static int64_t  PhaseStart;
+static int64_t  FramePhaseTime[kNumPhases];
+
+static void EndFrame(int64_t now)
+{
+    FramePhaseTime[CurPhase] += now - PhaseStart;
+    for (int i = 0; i < kNumPhases; ++i)
+        Timings[i].push_back((int32_t)FramePhaseTime[i]);
+    Timings[kNumPhases].push_back((int32_t)(now - FrameStart));
+    InFrame = false;
+}
+
+void Start()
+{
+    for (int i = 0; i <= kNumPhases; ++i)
+        Timings[i].clear();
+    IsRunning = true;
+    InFrame = false;
+    CurPhase = kPhase_Other;
+    StartTime = GetClockMicroseconds();
+}
+
+bool IsActive()
+{
+    return IsRunning;
+}
+
+void BeginFrame()
+{
+    if (!IsRunning)
+        return;
+    int64_t now = GetClockMicroseconds();
+    if (InFrame)
+        EndFrame(now);
+    for (int i = 0; i < kNumPhases; ++i)
+        FramePhaseTime[i] = 0;
+    FrameStart = now;
+    PhaseStart = now;
+    CurPhase = kPhase_Other;
+    InFrame = true;
+}
+
+Phase SetPhase(Phase phase)
+{
+    Phase prev = CurPhase;
+    if (!IsRunning || !InFrame)
+        return prev;
+    int64_t now = GetClockMicroseconds();
+    FramePhaseTime[CurPhase] += now - PhaseStart;
+    PhaseStart = now;
+    CurPhase = phase;
+    return prev;
+}
+
+// Appends summary of the timing list as a JSON object
+static void AppendStats(String &json, const char *name, TimingList &list)
+{
+    std::sort(list.begin(), list.end());
+    int64_t total = 0;
+    for (size_t i = 0; i < list.size(); ++i)
+        total += list[i];
+    const size_t count = list.size();
+    int32_t fastest = count > 0 ? list.front() : 0;
+    int32_t slowest = count > 0 ? list.back() : 0;
+    int32_t median = count > 0 ? list[count / 2] : 0;
+    int32_t p99 = count > 0 ? list[(count - 1) * 99 / 100] : 0;
+    json.Append(String::FromFormat(
+        "    \"%s\": { \"min_us\": %d, \"median_us\": %d, \"p99_us\": %d, \"max_us\": %d, \"total_ms\": %.3f }",
+        name, fastest, median, p99, slowest, total / 1000.0));
+}
+
+void Finish()
+{
+    if (!IsRunning)
+        return;
+    int64_t now = GetClockMicroseconds();
+    if (InFrame)
+        EndFrame(now);
+    IsRunning = false;
+
+    String json;
+    json.Append("{\n");
+    json.Append(String::FromFormat("  \"frames\": %u,\n", (unsigned)Timings[kNumPhases].size()));
+    json.Append(String::FromFormat("  \"elapsed_ms\": %.3f,\n", (now - StartTime) / 1000.0));
+    json.Append("  \"phases\": {\n");
+    AppendStats(json, "frame", Timings[kNumPhases]);
+    for (int i = 0; i < kNumPhases; ++i)
+    {
+        json.Append(",\n");
+        AppendStats(json, PhaseNames[i], Timings[i]);
+    }
+    json.Append("\n  }\n}");
+    platform->WriteStdOut("%s", json.GetCStr());
+
+    for (int i = 0; i <= kNumPhases; ++i)
+        TimingList().swap(Timings[i]);
+}
+
+} // namespace ReplayBench
+
+} // namespace Engine
+} // namespace AGS
@@ -0,0 +1,61 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Replay benchmark: plays a recorded game session back without waiting for
+// the frame timer and measures how long each part of the game loop takes.
+// When playback ends the collected timings are printed to the standard
+// output as a JSON object.
+//
+//=============================================================================
+#ifndef __AGS_EE_MAIN__REPLAYBENCH_H
+#define __AGS_EE_MAIN__REPLAYBENCH_H
+
+namespace AGS
+{
+namespace Engine
+{
+
+namespace ReplayBench
+{
+
+enum Phase
+{
+    kPhase_Script,  // running scripts and handling game events
+    kPhase_Update,  // updating characters, objects and animations
+    kPhase_Draw,    // preparing room and GUI sprites for the frame
+    kPhase_Render,  // presenting the frame with the graphics driver
+    kPhase_Audio,   // polling music and sound playback
+    kPhase_Other,   // everything else, including time between frames
+    kNumPhases
+};
+
+// Starts collecting frame timings
+void  Start();
+// Tells if the benchmark is running
+bool  IsActive();
+// Marks the beginning of the next game frame; the previous one is
+// completed automatically
+void  BeginFrame();
+// Switches timing to the given phase; returns the phase that was active
+// before, so that callers may restore it
+Phase SetPhase(Phase phase);
+// Stops collecting timings and prints the report
+void  Finish();
+
+} // namespace ReplayBench
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_MAIN__REPLAYBENCH_H
@@ -29,6 +29,7 @@
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
 #include "ac/roomstruct.h"
+#include "debug/profiler.h"
 #include "main/mainheader.h"
 #include "main/update.h"
 #include "ac/screenoverlay.h"
@@ -454,6 +455,7 @@ void update_sierra_speech()
 // update_stuff: moves and animates objects, executes repeat scripts, and
 // the like.
 void update_stuff() {
+  AGS::Engine::Profiler::Zone zone("update_stuff");
   
   our_eip = 20;
 
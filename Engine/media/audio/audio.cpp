@@ -27,6 +27,7 @@
 #include "media/audio/sound.h"
 #include "debug/debug_log.h"
 #include "debug/debugger.h"
+#include "debug/profiler.h"
 #include "ac/common.h"
 #include "ac/file.h"
 #include "ac/global_audio.h"
@@ -837,6 +838,7 @@ void update_polled_mp3() {
 // (this should only be called once per game loop)
 void update_polled_audio_and_crossfade ()
 {
+    AGS::Engine::Profiler::Zone zone("audio");
 	update_polled_stuff_if_runtime ();
 
 	AGS::Engine::MutexLock _lock(_audio_mutex);
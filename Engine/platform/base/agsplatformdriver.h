@@ -73,6 +73,8 @@ struct AGSPlatformDriver
     virtual const char *GetDiskWriteAccessTroubleshootingText();
     virtual const char *GetGraphicsTroubleshootingText() { return ""; }
     virtual unsigned long GetDiskFreeSpaceMB() = 0;
+    // Returns number of the logical processors available to the program
+    virtual int  GetCPUCount() { return 1; }
     virtual const char* GetNoMouseErrorString() = 0;
     // Tells whether build is capable of controlling mouse movement properly
     virtual bool IsMouseControlSupported(bool windowed) { return false; }
@@ -29,6 +29,7 @@
 
 #include <pwd.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 using AGS::Common::String;
 
@@ -49,6 +50,7 @@ struct AGSLinux : AGSPlatformDriver {
   virtual const char *GetUserGlobalConfigDirectory();
   virtual const char *GetAppOutputDirectory();
   virtual unsigned long GetDiskFreeSpaceMB();
+  virtual int  GetCPUCount();
   virtual const char* GetNoMouseErrorString();
   virtual bool IsMouseControlSupported(bool windowed);
   virtual const char* GetAllegroFailUserHint();
@@ -150,6 +152,11 @@ unsigned long AGSLinux::GetDiskFreeSpaceMB() {
   return 100;
 }
 
+int AGSLinux::GetCPUCount() {
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (int)count : 1;
+}
+
 const char* AGSLinux::GetNoMouseErrorString() {
   return "This game requires a mouse. You need to configure and setup your mouse to play this game.\n";
 }
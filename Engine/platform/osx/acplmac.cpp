@@ -27,6 +27,7 @@
 //#include <libcda.h>
 //#include <pwd.h>
 //#include <sys/stat.h>
+#include <unistd.h>
 #include "platform/base/agsplatformdriver.h"
 #include "util/directory.h"
 #include "ac/common.h"
@@ -61,6 +62,7 @@ struct AGSMac : AGSPlatformDriver {
   virtual void Delay(int millis) override;
   virtual void DisplayAlert(const char*, ...) override;
   virtual unsigned long GetDiskFreeSpaceMB() override;
+  virtual int  GetCPUCount() override;
   virtual const char* GetNoMouseErrorString() override;
   virtual eScriptSystemOSID GetSystemOSID() override;
   virtual int  InitializeCDPlayer() override;
@@ -114,6 +116,11 @@ unsigned long AGSMac::GetDiskFreeSpaceMB() {
   return 100;
 }
 
+int AGSMac::GetCPUCount() {
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (int)count : 1;
+}
+
 const char* AGSMac::GetNoMouseErrorString() {
   return "This game requires a mouse. You need to configure and setup your mouse to play this game.\n";
 }
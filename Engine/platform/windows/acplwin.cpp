@@ -108,6 +108,7 @@ struct AGSWin32 : AGSPlatformDriver {
   virtual const char *GetIllegalFileChars();
   virtual const char *GetGraphicsTroubleshootingText();
   virtual unsigned long GetDiskFreeSpaceMB();
+  virtual int  GetCPUCount();
   virtual const char* GetNoMouseErrorString();
   virtual bool IsMouseControlSupported(bool windowed);
   virtual const char* GetAllegroFailUserHint();
@@ -860,6 +861,12 @@ unsigned long AGSWin32::GetDiskFreeSpaceMB() {
   return returnMb;
 }
 
+int AGSWin32::GetCPUCount() {
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+}
+
 const char* AGSWin32::GetNoMouseErrorString() {
   return "No mouse was detected on your system, or your mouse is not configured to work with DirectInput. You must have a mouse to play this game.";
 }
@@ -19,6 +19,7 @@
 #include "ac/roomstruct.h"
 #include "ac/view.h"
 #include "ac/charactercache.h"
+#include "ac/characterindex.h"
 #include "ac/display.h"
 #include "ac/draw.h"
 #include "ac/dynamicsprite.h"
@@ -51,6 +52,7 @@
 #include "script/script.h"
 #include "script/script_runtime.h"
 #include "ac/spritecache.h"
+#include "ac/textruncache.h"
 #include "util/stream.h"
 #include "gfx/bitmap.h"
 #include "gfx/graphicsdriver.h"
@@ -363,6 +365,8 @@ AGSCharacter* IAGSEngine::GetCharacter (int32 charnum) {
     if (charnum >= game.numcharacters)
         quit("!AGSEngine::GetCharacter: invalid character request");
 
+    // the plugin may move the character to another room by itself
+    charindex_invalidate();
     return (AGSCharacter*)&game.chars[charnum];
 }
 AGSGameOptions* IAGSEngine::GetGameOptions () {
@@ -761,6 +765,7 @@ void IAGSEngine::BreakIntoDebugger()
 
 IAGSFontRenderer* IAGSEngine::ReplaceFontRenderer(int fontNumber, IAGSFontRenderer *newRenderer)
 {
+    textcache_clear();
     return font_replace_renderer(fontNumber, newRenderer);
 }
 
@@ -808,6 +813,14 @@ int pl_run_plugin_hooks (int event, long data) {
     return 0;
 }
 
+bool pl_any_want_hook(int event) {
+    for (int i = 0; i < numPlugins; i++) {
+        if (plugins[i].wantHook & event)
+            return true;
+    }
+    return false;
+}
+
 int pl_run_plugin_debug_hooks (const char *scriptfile, int linenum) {
     int i, retval = 0;
     for (i = 0; i < numPlugins; i++) {
@@ -25,6 +25,7 @@
 #include "script/cc_instance.h"
 #include "debug/debug_log.h"
 #include "debug/out.h"
+#include "debug/profiler.h"
 #include "script/cc_options.h"
 #include "script/executingscript.h"
 #include "script/script.h"
@@ -242,6 +243,9 @@ ccInstance::ccInstance()
     returnValue         = 0;
 
     code_fixups         = NULL;
+    code_ops            = NULL;
+    code_opindex        = NULL;
+    numcodeops          = 0;
 }
 
 ccInstance::~ccInstance()
@@ -283,6 +287,35 @@ void ccInstance::AbortAndDestroy()
     }
 
 int ccInstance::CallScriptFunction(const char *funcname, int32_t numargs, const RuntimeScriptValue *params)
+{
+    ccError = 0;
+    int32_t startat = FindScriptFunction(funcname, numargs);
+    if (startat < 0)
+        return startat;
+    return CallScriptFunctionAt(startat, numargs, params);
+}
+
+int32_t ccInstance::FindScriptFunction(const char *funcname, int32_t numargs)
+{
+    const ScriptExport *exp = FindExport(funcname);
+    if (!exp) {
+        cc_error("function '%s' not found", funcname);
+        return -2;
+    }
+    // scripts compiled with an older version do not have parameter count
+    if (exp->ArgCount >= 0 && exp->ArgCount != numargs) {
+        cc_error("wrong number of parameters to exported function '%s' (expected %d, supplied %d)", funcname, exp->ArgCount, numargs);
+        return -1;
+    }
+    int32_t etype = (instanceof->export_addr[exp->Index] >> 24L) & 0x000ff;
+    if (etype != EXPORT_FUNCTION) {
+        cc_error("symbol is not a function");
+        return -1;
+    }
+    return (instanceof->export_addr[exp->Index] & 0x00ffffff);
+}
+
+int ccInstance::CallScriptFunctionAt(int32_t startat, int32_t numargs, const RuntimeScriptValue *params)
 {
     ccError = 0;
     currentline = 0;
@@ -303,43 +336,6 @@ int ccInstance::CallScriptFunction(const char *funcname, int32_t numargs, const
         return -4;
     }
 
-    int32_t startat = -1;
-    int k;
-    char mangledName[200];
-    sprintf(mangledName, "%s$", funcname);
-
-    for (k = 0; k < instanceof->numexports; k++) {
-        char *thisExportName = instanceof->exports[k];
-        int match = 0;
-
-        // check for a mangled name match
-        if (strncmp(thisExportName, mangledName, strlen(mangledName)) == 0) {
-            // found, compare the number of parameters
-            char *numParams = thisExportName + strlen(mangledName);
-            if (atoi(numParams) != numargs) {
-                cc_error("wrong number of parameters to exported function '%s' (expected %d, supplied %d)", funcname, atoi(numParams), numargs);
-                return -1;
-            }
-            match = 1;
-        }
-        // check for an exact match (if the script was compiled with
-        // an older version)
-        if ((match == 1) || (strcmp(thisExportName, funcname) == 0)) {
-            int32_t etype = (instanceof->export_addr[k] >> 24L) & 0x000ff;
-            if (etype != EXPORT_FUNCTION) {
-                cc_error("symbol is not a function");
-                return -1;
-            }
-            startat = (instanceof->export_addr[k] & 0x00ffffff);
-            break;
-        }
-    }
-
-    if (startat < 0) {
-        cc_error("function '%s' not found", funcname);
-        return -2;
-    }
-
     //numargs++;                    // account for return address
     flags &= ~INSTF_ABORTED;
 
@@ -362,7 +358,11 @@ int ccInstance::CallScriptFunction(const char *funcname, int32_t numargs, const
     }
     runningInst = this;
 
-    int reterr = Run(startat);
+    int reterr;
+    {
+        AGS::Engine::Profiler::Zone zone("script");
+        reterr = Run(startat);
+    }
     ASSERT_STACK_SIZE(numargs);
     PopValuesFromStack(numargs);
     pc = 0;
@@ -395,25 +395,33 @@ int ccInstance::CallScriptFunction(const char *funcname, int32_t numargs, const
     return ccError;
 }
 
-bool ccInstance::DoRunScriptFuncCantBlock(NonBlockingScriptFunction* funcToRun, bool hasTheFunc) {
-    if (!hasTheFunc)
+bool ccInstance::DoRunScriptFuncCantBlock(NonBlockingScriptFunction* funcToRun, int32_t &func_addr) {
+    if (func_addr == kScFuncAddr_Missing)
         return(false);
 
-    no_blocking_functions++;
-    int result;
-
-    if (funcToRun->numParameters < 3)
-    {
-        result = CallScriptFunction((char*)funcToRun->functionName, funcToRun->numParameters, funcToRun->params);
-    }
-    else
+    if (funcToRun->numParameters >= 3)
         quit("DoRunScriptFuncCantBlock called with too many parameters");
 
-    if (result == -2) {
-        // the function doens't exist, so don't try and run it again
-        hasTheFunc = false;
+    if (func_addr == kScFuncAddr_Unresolved) {
+        ccError = 0;
+        int32_t addr = FindScriptFunction(funcToRun->functionName, funcToRun->numParameters);
+        if (addr == -2) {
+            // the function doens't exist, so don't try and run it again
+            func_addr = kScFuncAddr_Missing;
+            ccErrorString[0] = 0;
+            ccError = 0;
+            return(false);
+        }
+        else if (addr < 0) {
+            quit_with_script_error(funcToRun->functionName);
+        }
+        func_addr = addr;
     }
-    else if ((result != 0) && (result != 100)) {
+
+    no_blocking_functions++;
+    int result = CallScriptFunctionAt(func_addr, funcToRun->numParameters, funcToRun->params);
+
+    if ((result != 0) && (result != 100)) {
         quit_with_script_error(funcToRun->functionName);
     }
     else
@@ -424,7 +432,7 @@ bool ccInstance::DoRunScriptFuncCantBlock(NonBlockingScriptFunction* funcToRun,
     ccErrorString[0] = 0;
     ccError = 0;
     no_blocking_functions--;
-    return(hasTheFunc);
+    return(true);
 }
 
 char scfunctionname[MAX_FUNCTION_NAME_LEN+1];
@@ -481,8 +489,131 @@ int ccInstance::PrepareTextScript(const char**tsname) {
     line_number = callStackLineNumber[callStackSize];\
     currentline = line_number
 
-#define MAXNEST 50  // number of recursive function calls allowed
+// Threaded dispatch relies on the "labels as values" extension
+#if defined(__GNUC__) && !defined(AGS_NO_THREADED_DISPATCH)
+#define AGS_SCRIPT_THREADED_DISPATCH
+#endif
+
+#if defined(AGS_SCRIPT_THREADED_DISPATCH)
+ScriptDispatchMode ScDispatchMode = kScDispatch_Threaded;
+#else
+ScriptDispatchMode ScDispatchMode = kScDispatch_Switch;
+#endif
+
+bool ccInstance::SetDispatchMode(ScriptDispatchMode mode)
+{
+#if !defined(AGS_SCRIPT_THREADED_DISPATCH)
+    if (mode == kScDispatch_Threaded)
+        return false;
+#endif
+    ScDispatchMode = mode;
+    return true;
+}
+
+ScriptDispatchMode ccInstance::GetDispatchMode()
+{
+    return ScDispatchMode;
+}
+
 int ccInstance::Run(int32_t curpc)
+{
+    // Instruction dump is enabled for the whole function call, same as the
+    // debug run option was always checked only once, on function entry
+    if (ccGetOption(SCOPT_DEBUGRUN))
+        return RunImpl<false, true>(curpc);
+#if defined(AGS_SCRIPT_THREADED_DISPATCH)
+    if (ScDispatchMode == kScDispatch_Threaded)
+        return RunImpl<true, false>(curpc);
+#endif
+    return RunImpl<false, false>(curpc);
+}
+
+bool ccInstance::ResolveRuntimeArgs(const ScriptOperation &op, ScriptOperation &run_op)
+{
+    run_op = op;
+    for (int i = 0; i < run_op.ArgCount; ++i)
+    {
+        if (run_op.StackArgs & (1 << i))
+        {
+            run_op.Args[i] = GetStackPtrOffsetFw(run_op.Args[i].IValue);
+        }
+        else if (run_op.ImportArgs & (1 << i))
+        {
+            const ScriptImport *import = simp.getByIndex(run_op.Args[i].IValue);
+            if (!import)
+            {
+                cc_error("cannot resolve import, key = %d", run_op.Args[i].IValue);
+                return false;
+            }
+            run_op.Args[i] = import->Value;
+        }
+    }
+    return true;
+}
+
+// Instructions are decoded and their arguments resolved when the instance
+// is created; only the stack offsets, which depend on the current state of
+// the stack, and the imports, which may be replaced by plugins at any time,
+// have to be fixed up when the instruction is fetched
+#define SCMD_FETCH \
+    op = &codeInst->code_ops[codeInst->code_opindex[pc]]; \
+    if (op->StackArgs || op->ImportArgs) \
+    { \
+        if (!ResolveRuntimeArgs(*op, stackOp)) \
+            return -1; \
+        op = &stackOp; \
+    } \
+    preg1 = &registers[op->Args[0].IValue >= 0 && op->Args[0].IValue < CC_NUM_REGISTERS ? op->Args[0].IValue : 0]; \
+    preg2 = &registers[op->Args[1].IValue >= 0 && op->Args[1].IValue < CC_NUM_REGISTERS ? op->Args[1].IValue : 0]; \
+    if (INSTRUMENTED) \
+        DumpInstruction(*op)
+
+// In threaded mode every handler fetches the next instruction itself and
+// jumps straight to its handler; in switch mode handlers return to the loop
+#if defined(AGS_SCRIPT_THREADED_DISPATCH)
+#define SCMD_CASE(cmd) case cmd: scmd_label_##cmd
+#define SCMD_DEFAULT   default: scmd_label_default
+#define SCMD_DISPATCH \
+    if (THREADED) \
+        goto *scmd_labels[op->Instruction.Code]
+#define SCMD_DISPATCH_NEXT \
+    if (THREADED) \
+    { \
+        if (flags & INSTF_ABORTED) \
+            return 0; \
+        pc += op->ArgCount + 1; \
+        SCMD_FETCH; \
+        goto *scmd_labels[op->Instruction.Code]; \
+    }
+#define SCMD_DISPATCH_AT_PC \
+    if (THREADED) \
+    { \
+        SCMD_FETCH; \
+        goto *scmd_labels[op->Instruction.Code]; \
+    }
+#else
+#define SCMD_CASE(cmd) case cmd
+#define SCMD_DEFAULT   default
+#define SCMD_DISPATCH
+#define SCMD_DISPATCH_NEXT
+#define SCMD_DISPATCH_AT_PC
+#endif
+// Ends the handler, proceeding to the instruction that follows
+#define SCMD_NEXT      SCMD_DISPATCH_NEXT break
+// Ends the handler, proceeding to the instruction at current PC
+#define SCMD_GOTO_PC   SCMD_DISPATCH_AT_PC continue
+
+// Current operation, its arguments and registers, for the handlers
+#define codeOp (*op)
+#define arg1   (op->Args[0])
+#define arg2   (op->Args[1])
+#define arg3   (op->Args[2])
+#define reg1   (*preg1)
+#define reg2   (*preg2)
+
+#define MAXNEST 50  // number of recursive function calls allowed
+template <bool THREADED, bool INSTRUMENTED>
+int ccInstance::RunImpl(int32_t curpc)
 {
     pc = curpc;
     returnValue = -1;
@@ -503,128 +634,65 @@ int ccInstance::Run(int32_t curpc)
     funcstart[0] = pc;
     current_instance = this;
     ccInstance *codeInst = runningInst;
-    int write_debug_dump = ccGetOption(SCOPT_DEBUGRUN);
-	ScriptOperation codeOp;
+    // current operation, and registers referenced by its arguments
+    const ScriptOperation *op;
+    RuntimeScriptValue *preg1;
+    RuntimeScriptValue *preg2;
+    // a copy of operation, used when some of the arguments refer to stack
+    ScriptOperation stackOp;
+    const char *direct_ptr1;
+    const char *direct_ptr2;
 
     FunctionCallStack func_callstack;
 
-    while (1) {
-
-        /*
-		if (!codeInst->ReadOperation(codeOp, pc))
-        {
-            return -1;
-        }
-        */
-        /* ReadOperation */
-        //=====================================================================
-        codeOp.Instruction.Code			= codeInst->code[pc];
-        codeOp.Instruction.InstanceId	= (codeOp.Instruction.Code >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK;
-        codeOp.Instruction.Code		   &= INSTANCE_ID_REMOVEMASK; // now this is pure instruction code
-
-        if (codeOp.Instruction.Code < 0 || codeOp.Instruction.Code >= CC_NUM_SCCMDS)
-        {
-            cc_error("invalid instruction %d found in code stream", codeOp.Instruction.Code);
-            return -1;
-        }
+#if defined(AGS_SCRIPT_THREADED_DISPATCH)
+    // Handler labels, indexed by instruction code; operation codes are
+    // validated when the code is decoded, so the table is indexed without
+    // further checks
+    static void *const scmd_labels[CC_NUM_SCCMDS] =
+    {
+        &&scmd_label_default,
+        &&scmd_label_SCMD_ADD,          &&scmd_label_SCMD_SUB,          &&scmd_label_SCMD_REGTOREG,
+        &&scmd_label_SCMD_WRITELIT,     &&scmd_label_SCMD_RET,          &&scmd_label_SCMD_LITTOREG,
+        &&scmd_label_SCMD_MEMREAD,      &&scmd_label_SCMD_MEMWRITE,     &&scmd_label_SCMD_MULREG,
+        &&scmd_label_SCMD_DIVREG,       &&scmd_label_SCMD_ADDREG,       &&scmd_label_SCMD_SUBREG,
+        &&scmd_label_SCMD_BITAND,       &&scmd_label_SCMD_BITOR,        &&scmd_label_SCMD_ISEQUAL,
+        &&scmd_label_SCMD_NOTEQUAL,     &&scmd_label_SCMD_GREATER,      &&scmd_label_SCMD_LESSTHAN,
+        &&scmd_label_SCMD_GTE,          &&scmd_label_SCMD_LTE,          &&scmd_label_SCMD_AND,
+        &&scmd_label_SCMD_OR,           &&scmd_label_SCMD_CALL,         &&scmd_label_SCMD_MEMREADB,
+        &&scmd_label_SCMD_MEMREADW,     &&scmd_label_SCMD_MEMWRITEB,    &&scmd_label_SCMD_MEMWRITEW,
+        &&scmd_label_SCMD_JZ,           &&scmd_label_SCMD_PUSHREG,      &&scmd_label_SCMD_POPREG,
+        &&scmd_label_SCMD_JMP,          &&scmd_label_SCMD_MUL,          &&scmd_label_SCMD_CALLEXT,
+        &&scmd_label_SCMD_PUSHREAL,     &&scmd_label_SCMD_SUBREALSTACK, &&scmd_label_SCMD_LINENUM,
+        &&scmd_label_SCMD_CALLAS,       &&scmd_label_SCMD_THISBASE,     &&scmd_label_SCMD_NUMFUNCARGS,
+        &&scmd_label_SCMD_MODREG,       &&scmd_label_SCMD_XORREG,       &&scmd_label_SCMD_NOTREG,
+        &&scmd_label_SCMD_SHIFTLEFT,    &&scmd_label_SCMD_SHIFTRIGHT,   &&scmd_label_SCMD_CALLOBJ,
+        &&scmd_label_SCMD_CHECKBOUNDS,  &&scmd_label_SCMD_MEMWRITEPTR,  &&scmd_label_SCMD_MEMREADPTR,
+        &&scmd_label_SCMD_MEMZEROPTR,   &&scmd_label_SCMD_MEMINITPTR,   &&scmd_label_SCMD_LOADSPOFFS,
+        &&scmd_label_SCMD_CHECKNULL,    &&scmd_label_SCMD_FADD,         &&scmd_label_SCMD_FSUB,
+        &&scmd_label_SCMD_FMULREG,      &&scmd_label_SCMD_FDIVREG,      &&scmd_label_SCMD_FADDREG,
+        &&scmd_label_SCMD_FSUBREG,      &&scmd_label_SCMD_FGREATER,     &&scmd_label_SCMD_FLESSTHAN,
+        &&scmd_label_SCMD_FGTE,         &&scmd_label_SCMD_FLTE,         &&scmd_label_SCMD_ZEROMEMORY,
+        &&scmd_label_SCMD_CREATESTRING, &&scmd_label_SCMD_STRINGSEQUAL, &&scmd_label_SCMD_STRINGSNOTEQ,
+        &&scmd_label_SCMD_CHECKNULLREG, &&scmd_label_SCMD_LOOPCHECKOFF, &&scmd_label_SCMD_MEMZEROPTRND,
+        &&scmd_label_SCMD_JNZ,          &&scmd_label_SCMD_DYNAMICBOUNDS,&&scmd_label_SCMD_NEWARRAY,
+        &&scmd_label_SCMD_NEWUSEROBJECT
+    };
+#endif
 
-        codeOp.ArgCount = sccmd_info[codeOp.Instruction.Code].ArgCount;
-        if (pc + codeOp.ArgCount >= codeInst->codesize)
-        {
-            cc_error("unexpected end of code data (%d; %d)", pc + codeOp.ArgCount, codeInst->codesize);
-            return -1;
-        }
+    while (1) {
 
-        int pc_at = pc + 1;
-        for (int i = 0; i < codeOp.ArgCount; ++i, ++pc_at)
-        {
-            char fixup = codeInst->code_fixups[pc_at];
-            if (fixup > 0)
-            {
-                // could be relative pointer or import address
-                /*
-                if (!FixupArgument(code[pc], fixup, codeOp.Args[i]))
-                {
-                    return -1;
-                }
-                */
-                /* FixupArgument */
-                //=====================================================================
-                switch (fixup)
-                {
-                case FIXUP_GLOBALDATA:
-                    {
-                        ScriptVariable *gl_var = (ScriptVariable*)codeInst->code[pc_at];
-                        codeOp.Args[i].SetGlobalVar(&gl_var->RValue);
-                    }
-                    break;
-                case FIXUP_FUNCTION:
-                    // originally commented -- CHECKME: could this be used in very old versions of AGS?
-                    //      code[fixup] += (long)&code[0];
-                    // This is a program counter value, presumably will be used as SCMD_CALL argument
-                    codeOp.Args[i].SetInt32((int32_t)codeInst->code[pc_at]);
-                    break;
-                case FIXUP_STRING:
-                    codeOp.Args[i].SetStringLiteral(&codeInst->strings[0] + codeInst->code[pc_at]);
-                    break;
-                case FIXUP_IMPORT:
-                    {
-                        const ScriptImport *import = simp.getByIndex((int32_t)codeInst->code[pc_at]);
-                        if (import)
-                        {
-                            codeOp.Args[i] = import->Value;
-                        }
-                        else
-                        {
-                            cc_error("cannot resolve import, key = %ld", codeInst->code[pc_at]);
-                            return -1;
-                        }
-                    }
-                    break;
-                case FIXUP_STACK:
-                    codeOp.Args[i] = GetStackPtrOffsetFw((int32_t)codeInst->code[pc_at]);
-                    break;
-                default:
-                    cc_error("internal fixup type error: %d", fixup);
-                    return -1;
-                }
-                /* End FixupArgument */
-                //=====================================================================
-            }
-            else
-            {
-                // should be a numeric literal (int32 or float)
-                codeOp.Args[i].SetInt32( (int32_t)codeInst->code[pc_at] );
-            }
-        }
-        /* End ReadOperation */
-        //=====================================================================
-
-        // save the arguments for quick access
-        RuntimeScriptValue &arg1 = codeOp.Args[0];
-        RuntimeScriptValue &arg2 = codeOp.Args[1];
-        RuntimeScriptValue &arg3 = codeOp.Args[2];
-        RuntimeScriptValue &reg1 = 
-            registers[arg1.IValue >= 0 && arg1.IValue < CC_NUM_REGISTERS ? arg1.IValue : 0];
-        RuntimeScriptValue &reg2 = 
-            registers[arg2.IValue >= 0 && arg2.IValue < CC_NUM_REGISTERS ? arg2.IValue : 0];
-
-        const char *direct_ptr1;
-        const char *direct_ptr2;
-
-        if (write_debug_dump)
-        {
-            DumpInstruction(codeOp);
-        }
+        SCMD_FETCH;
+        SCMD_DISPATCH;
 
-        switch (codeOp.Instruction.Code) {
-      case SCMD_LINENUM:
+        switch (op->Instruction.Code) {
+      SCMD_CASE(SCMD_LINENUM):
           line_number = arg1.IValue;
           currentline = arg1.IValue;
           if (new_line_hook)
               new_line_hook(this, currentline);
-          break;
-      case SCMD_ADD:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_ADD):
           // If the the register is SREG_SP, we are allocating new variable on the stack
           if (arg1.IValue == SREG_SP)
           {
@@ -649,8 +717,8 @@ int ccInstance::Run(int32_t curpc)
           {
             reg1.IValue += arg2.IValue;
           }
-          break;
-      case SCMD_SUB:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_SUB):
           if (reg1.Type == kScValStackPtr)
           {
             // If this is SREG_SP, this is stack pop, which frees local variables;
@@ -676,11 +744,11 @@ int ccInstance::Run(int32_t curpc)
           {
             reg1.IValue -= arg2.IValue;
           }
-          break;
-      case SCMD_REGTOREG:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_REGTOREG):
           reg2 = reg1;
-          break;
-      case SCMD_WRITELIT:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_WRITELIT):
           // Take the data address from reg[MAR] and copy there arg1 bytes from arg2 address
           //
           // NOTE: since it reads directly from arg2 (which originally was
@@ -703,8 +771,8 @@ int ccInstance::Run(int32_t curpc)
               cc_error("unexpected data size for WRITELIT op: %d", arg1.IValue);
               break;
           }
-          break;
-      case SCMD_RET:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_RET):
           {
           if (loopIterationCheckDisabled > 0)
               loopIterationCheckDisabled--;
@@ -720,90 +788,90 @@ int ccInstance::Run(int32_t curpc)
           }
           current_instance = this;
           POP_CALL_STACK;
-          continue; // continue so that the PC doesn't get overwritten
+          SCMD_GOTO_PC; // jump so that the PC doesn't get overwritten
           }
-      case SCMD_LITTOREG:
+      SCMD_CASE(SCMD_LITTOREG):
           reg1 = arg2;
-          break;
-      case SCMD_MEMREAD:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_MEMREAD):
           // Take the data address from reg[MAR] and copy int32_t to reg[arg1]
           reg1 = registers[SREG_MAR].ReadValue();
-          break;
-      case SCMD_MEMWRITE:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_MEMWRITE):
           // Take the data address from reg[MAR] and copy there int32_t from reg[arg1]
           registers[SREG_MAR].WriteValue(reg1);
-          break;
-      case SCMD_LOADSPOFFS:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_LOADSPOFFS):
           registers[SREG_MAR] = GetStackPtrOffsetRw(arg1.IValue);
           if (ccError)
           {
               return -1;
           }
-          break;
+          SCMD_NEXT;
 
           // 64 bit: Force 32 bit math
-      case SCMD_MULREG:
+      SCMD_CASE(SCMD_MULREG):
           reg1.SetInt32(reg1.IValue * reg2.IValue);
-          break;
-      case SCMD_DIVREG:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_DIVREG):
           if (reg2.IValue == 0) {
               cc_error("!Integer divide by zero");
               return -1;
           } 
           reg1.SetInt32(reg1.IValue / reg2.IValue);
-          break;
-      case SCMD_ADDREG:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_ADDREG):
           // This may be pointer arithmetics, in which case IValue stores offset from base pointer
           reg1.IValue += reg2.IValue;
-          break;
-      case SCMD_SUBREG:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_SUBREG):
           // This may be pointer arithmetics, in which case IValue stores offset from base pointer
           reg1.IValue -= reg2.IValue;
-          break;
-      case SCMD_BITAND:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_BITAND):
           reg1.SetInt32(reg1.IValue & reg2.IValue);
-          break;
-      case SCMD_BITOR:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_BITOR):
           reg1.SetInt32(reg1.IValue | reg2.IValue);
-          break;
-      case SCMD_ISEQUAL:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_ISEQUAL):
           reg1.SetInt32AsBool(reg1 == reg2);
-          break;
-      case SCMD_NOTEQUAL:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_NOTEQUAL):
           reg1.SetInt32AsBool(reg1 != reg2);
-          break;
-      case SCMD_GREATER:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_GREATER):
           reg1.SetInt32AsBool(reg1.IValue > reg2.IValue);
-          break;
-      case SCMD_LESSTHAN:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_LESSTHAN):
           reg1.SetInt32AsBool(reg1.IValue < reg2.IValue);
-          break;
-      case SCMD_GTE:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_GTE):
           reg1.SetInt32AsBool(reg1.IValue >= reg2.IValue);
-          break;
-      case SCMD_LTE:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_LTE):
           reg1.SetInt32AsBool(reg1.IValue <= reg2.IValue);
-          break;
-      case SCMD_AND:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_AND):
           reg1.SetInt32AsBool(reg1.IValue && reg2.IValue);
-          break;
-      case SCMD_OR:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_OR):
           reg1.SetInt32AsBool(reg1.IValue || reg2.IValue);
-          break;
-      case SCMD_XORREG:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_XORREG):
           reg1.SetInt32(reg1.IValue ^ reg2.IValue);
-          break;
-      case SCMD_MODREG:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_MODREG):
           if (reg2.IValue == 0) {
               cc_error("!Integer divide by zero");
               return -1;
           } 
           reg1.SetInt32(reg1.IValue % reg2.IValue);
-          break;
-      case SCMD_NOTREG:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_NOTREG):
           reg1 = !(reg1);
-          break;
-      case SCMD_CALL:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_CALL):
           // CallScriptFunction another function within same script, just save PC
           // and continue from there
           if (curnest >= MAXNEST - 1) {
@@ -835,32 +903,32 @@ int ccInstance::Run(int32_t curpc)
           curnest++;
           thisbase[curnest] = 0;
           funcstart[curnest] = pc;
-          continue; // continue so that the PC doesn't get overwritten
-      case SCMD_MEMREADB:
+          SCMD_GOTO_PC; // jump so that the PC doesn't get overwritten
+      SCMD_CASE(SCMD_MEMREADB):
           // Take the data address from reg[MAR] and copy byte to reg[arg1]
           reg1.SetUInt8(registers[SREG_MAR].ReadByte());
-          break;
-      case SCMD_MEMREADW:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_MEMREADW):
           // Take the data address from reg[MAR] and copy int16_t to reg[arg1]
           reg1.SetInt16(registers[SREG_MAR].ReadInt16());
-          break;
-      case SCMD_MEMWRITEB:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_MEMWRITEB):
           // Take the data address from reg[MAR] and copy there byte from reg[arg1]
           registers[SREG_MAR].WriteByte(reg1.IValue);
-          break;
-      case SCMD_MEMWRITEW:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_MEMWRITEW):
           // Take the data address from reg[MAR] and copy there int16_t from reg[arg1]
           registers[SREG_MAR].WriteInt16(reg1.IValue);
-          break;
-      case SCMD_JZ:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_JZ):
           if (registers[SREG_AX].IsNull())
               pc += arg1.IValue;
-          break;
-      case SCMD_JNZ:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_JNZ):
           if (!registers[SREG_AX].IsNull())
               pc += arg1.IValue;
-          break;
-      case SCMD_PUSHREG:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_PUSHREG):
           // Script code analysis shows that statistically there's a moderate
           // chance (10-30% depending on game) that a PUSHREG instruction will be
           // immediately followed by POPREG.
@@ -871,7 +939,7 @@ int ccInstance::Run(int32_t curpc)
           {
               registers[codeInst->code[pc + 3]] = reg1;
               pc += 2;
-              break;
+              SCMD_NEXT;
           }
           // Push reg[arg1] value to the stack
           ASSERT_STACK_SPACE_AVAILABLE(1);
@@ -880,12 +948,12 @@ int ccInstance::Run(int32_t curpc)
           {
               return -1;
           }
-          break;
-      case SCMD_POPREG:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_POPREG):
           ASSERT_STACK_SIZE(1);
           reg1 = PopValueFromStack();
-          break;
-      case SCMD_JMP:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_JMP):
           pc += arg1.IValue;
 
           if ((arg1.IValue < 0) && (maxWhileLoops > 0) && (loopIterationCheckDisabled == 0)) {
@@ -900,18 +968,18 @@ int ccInstance::Run(int32_t curpc)
                   return -1;
               }
           }
-          break;
-      case SCMD_MUL:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_MUL):
           reg1.IValue *= arg2.IValue;
-          break;
-      case SCMD_CHECKBOUNDS:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_CHECKBOUNDS):
           if ((reg1.IValue < 0) ||
               (reg1.IValue >= arg2.IValue)) {
                   cc_error("!Array index out of bounds (index: %d, bounds: 0..%d)", reg1.IValue, arg2.IValue - 1);
                   return -1;
           }
-          break;
-      case SCMD_DYNAMICBOUNDS:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_DYNAMICBOUNDS):
           {
               // TODO: test reg[MAR] type here;
               // That might be dynamic object, but also a non-managed dynamic array, "allocated"
@@ -924,12 +992,12 @@ int ccInstance::Run(int32_t curpc)
                       cc_error("!Array index out of bounds (index: %d, bounds: 0..%d)", reg1.IValue / elementSize, upperBound - 1);
                       return -1;
               }
-              break;
+              SCMD_NEXT;
           }
 
           // 64 bit: Handles are always 32 bit values. They are not C pointer.
 
-      case SCMD_MEMREADPTR: {
+      SCMD_CASE(SCMD_MEMREADPTR): {
           ccError = 0;
 
           int32_t handle = registers[SREG_MAR].ReadInt32();
@@ -948,8 +1016,8 @@ int ccInstance::Run(int32_t curpc)
           // if error occurred, cc_error will have been set
           if (ccError)
               return -1;
-          break; }
-      case SCMD_MEMWRITEPTR: {
+          SCMD_NEXT; }
+      SCMD_CASE(SCMD_MEMWRITEPTR): {
 
           int32_t handle = registers[SREG_MAR].ReadInt32();
           char *address = NULL;
@@ -983,9 +1051,9 @@ int ccInstance::Run(int32_t curpc)
               ccAddObjectReference(newHandle);
               registers[SREG_MAR].WriteInt32(newHandle);
           }
-          break;
+          SCMD_NEXT;
                              }
-      case SCMD_MEMINITPTR: { 
+      SCMD_CASE(SCMD_MEMINITPTR): { 
           char *address = NULL;
 
           if (reg1.Type == kScValStaticArray && reg1.StcArr->GetDynamicManager())
@@ -1014,15 +1082,15 @@ int ccInstance::Run(int32_t curpc)
 
           ccAddObjectReference(newHandle);
           registers[SREG_MAR].WriteInt32(newHandle);
-          break;
+          SCMD_NEXT;
                             }
-      case SCMD_MEMZEROPTR: {
+      SCMD_CASE(SCMD_MEMZEROPTR): {
           int32_t handle = registers[SREG_MAR].ReadInt32();
           ccReleaseObjectReference(handle);
           registers[SREG_MAR].WriteInt32(0);
-          break;
+          SCMD_NEXT;
                             }
-      case SCMD_MEMZEROPTRND: {
+      SCMD_CASE(SCMD_MEMZEROPTRND): {
           int32_t handle = registers[SREG_MAR].ReadInt32();
 
           // don't do the Dispose check for the object being returned -- this is
@@ -1034,24 +1102,24 @@ int ccInstance::Run(int32_t curpc)
           ccReleaseObjectReference(handle);
           pool.disableDisposeForObject = NULL;
           registers[SREG_MAR].WriteInt32(0);
-          break;
+          SCMD_NEXT;
                               }
-      case SCMD_CHECKNULL:
+      SCMD_CASE(SCMD_CHECKNULL):
           if (registers[SREG_MAR].IsNull()) {
               cc_error("!Null pointer referenced");
               return -1;
           }
-          break;
-      case SCMD_CHECKNULLREG:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_CHECKNULLREG):
           if (reg1.IsNull()) {
               cc_error("!Null string referenced");
               return -1;
           }
-          break;
-      case SCMD_NUMFUNCARGS:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_NUMFUNCARGS):
           num_args_to_func = arg1.IValue;
-          break;
-      case SCMD_CALLAS:{
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_CALLAS):{
           PUSH_CALL_STACK;
 
           // CallScriptFunction to a function in another script
@@ -1111,9 +1179,9 @@ int ccInstance::Run(int32_t curpc)
           was_just_callas = func_callstack.Count;
           num_args_to_func = -1;
           POP_CALL_STACK;
-          break;
+          SCMD_NEXT;
                        }
-      case SCMD_CALLEXT: {
+      SCMD_CASE(SCMD_CALLEXT): {
           // CallScriptFunction to a real 'C' code function
           was_just_callas = -1;
           if (num_args_to_func < 0)
@@ -1190,12 +1258,12 @@ int ccInstance::Run(int32_t curpc)
           current_instance = this;
           next_call_needs_object = 0;
           num_args_to_func = -1;
-          break;
+          SCMD_NEXT;
                          }
-      case SCMD_PUSHREAL:
+      SCMD_CASE(SCMD_PUSHREAL):
           PushToFuncCallStack(func_callstack, reg1);
-          break;
-      case SCMD_SUBREALSTACK:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_SUBREALSTACK):
           PopFromFuncCallStack(func_callstack, arg1.IValue);
           if (was_just_callas >= 0)
           {
@@ -1203,8 +1271,8 @@ int ccInstance::Run(int32_t curpc)
               PopValuesFromStack(arg1.IValue);
               was_just_callas = -1;
           }
-          break;
-      case SCMD_CALLOBJ:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_CALLOBJ):
           // set the OP register
           if (reg1.IsNull()) {
               cc_error("!Null pointer referenced");
@@ -1238,17 +1306,17 @@ int ccInstance::Run(int32_t curpc)
               return -1;
           }
           next_call_needs_object = 1;
-          break;
-      case SCMD_SHIFTLEFT:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_SHIFTLEFT):
           reg1.SetInt32(reg1.IValue << reg2.IValue);
-          break;
-      case SCMD_SHIFTRIGHT:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_SHIFTRIGHT):
           reg1.SetInt32(reg1.IValue >> reg2.IValue);
-          break;
-      case SCMD_THISBASE:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_THISBASE):
           thisbase[curnest] = arg1.IValue;
-          break;
-      case SCMD_NEWARRAY:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_NEWARRAY):
           {
               int numElements = reg1.IValue;
               if ((numElements < 1) || (numElements > 1000000))
@@ -1258,9 +1326,9 @@ int ccInstance::Run(int32_t curpc)
               }
               int32_t handle = globalDynamicArray.Create(numElements, arg2.IValue, arg3.GetAsBool());
               reg1.SetDynamicObject((void*)ccGetObjectAddressFromHandle(handle), &globalDynamicArray);
-              break;
+              SCMD_NEXT;
           }
-      case SCMD_NEWUSEROBJECT:
+      SCMD_CASE(SCMD_NEWUSEROBJECT):
           {
               const int32_t size = arg2.IValue;
               if (size < 0)
@@ -1270,43 +1338,43 @@ int ccInstance::Run(int32_t curpc)
               }
               ScriptUserObject *suo = ScriptUserObject::CreateManaged(size);
               reg1.SetDynamicObject(suo, suo);
-              break;
+              SCMD_NEXT;
           }
-      case SCMD_FADD:
+      SCMD_CASE(SCMD_FADD):
           reg1.SetFloat(reg1.FValue + arg2.IValue); // arg2 was used as int here originally
-          break;
-      case SCMD_FSUB:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_FSUB):
           reg1.SetFloat(reg1.FValue - arg2.IValue); // arg2 was used as int here originally
-          break;
-      case SCMD_FMULREG:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_FMULREG):
           reg1.SetFloat(reg1.FValue * reg2.FValue);
-          break;
-      case SCMD_FDIVREG:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_FDIVREG):
           if (reg2.FValue == 0.0) {
               cc_error("!Floating point divide by zero");
               return -1;
           } 
           reg1.SetFloat(reg1.FValue / reg2.FValue);
-          break;
-      case SCMD_FADDREG:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_FADDREG):
           reg1.SetFloat(reg1.FValue + reg2.FValue);
-          break;
-      case SCMD_FSUBREG:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_FSUBREG):
           reg1.SetFloat(reg1.FValue - reg2.FValue);
-          break;
-      case SCMD_FGREATER:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_FGREATER):
           reg1.SetFloatAsBool(reg1.FValue > reg2.FValue);
-          break;
-      case SCMD_FLESSTHAN:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_FLESSTHAN):
           reg1.SetFloatAsBool(reg1.FValue < reg2.FValue);
-          break;
-      case SCMD_FGTE:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_FGTE):
           reg1.SetFloatAsBool(reg1.FValue >= reg2.FValue);
-          break;
-      case SCMD_FLTE:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_FLTE):
           reg1.SetFloatAsBool(reg1.FValue <= reg2.FValue);
-          break;
-      case SCMD_ZEROMEMORY:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_ZEROMEMORY):
           // Check if we are zeroing at stack tail
           if (registers[SREG_MAR] == registers[SREG_SP]) {
               // creating a local variable -- check the stack to ensure no mem overrun
@@ -1330,8 +1398,8 @@ int ccInstance::Run(int32_t curpc)
 				registers[SREG_MAR].Type);
             return -1;
           }
-          break;
-      case SCMD_CREATESTRING:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_CREATESTRING):
           if (stringClassImpl == NULL) {
               cc_error("No string class implementation set, but opcode was used");
               return -1;
@@ -1340,8 +1408,8 @@ int ccInstance::Run(int32_t curpc)
           reg1.SetDynamicObject(
               (void*)stringClassImpl->CreateString(direct_ptr1),
               &myScriptStringImpl);
-          break;
-      case SCMD_STRINGSEQUAL:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_STRINGSEQUAL):
           if ((reg1.IsNull()) || (reg2.IsNull())) {
               cc_error("!Null pointer referenced");
               return -1;
@@ -1350,8 +1418,8 @@ int ccInstance::Run(int32_t curpc)
           direct_ptr2 = (const char*)reg2.GetDirectPtr();
           reg1.SetInt32AsBool(strcmp(direct_ptr1, direct_ptr2) == 0);
           
-          break;
-      case SCMD_STRINGSNOTEQ:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_STRINGSNOTEQ):
           if ((reg1.IsNull()) || (reg2.IsNull())) {
               cc_error("!Null pointer referenced");
               return -1;
@@ -1359,13 +1427,16 @@ int ccInstance::Run(int32_t curpc)
           direct_ptr1 = (const char*)reg1.GetDirectPtr();
           direct_ptr2 = (const char*)reg2.GetDirectPtr();
           reg1.SetInt32AsBool(strcmp(direct_ptr1, direct_ptr2) != 0 );
-          break;
-      case SCMD_LOOPCHECKOFF:
+          SCMD_NEXT;
+      SCMD_CASE(SCMD_LOOPCHECKOFF):
           if (loopIterationCheckDisabled == 0)
               loopIterationCheckDisabled++;
-          break;
-      default:
-          cc_error("instruction %d is not implemented", codeOp.Instruction.Code);
+          SCMD_NEXT;
+      SCMD_DEFAULT:
+          if (codeInst->code_opindex[pc] == 0)
+              cc_error("invalid instruction %d found in code stream", (int32_t)(codeInst->code[pc] & INSTANCE_ID_REMOVEMASK));
+          else
+              cc_error("instruction %d is not implemented", codeOp.Instruction.Code);
           return -1;
         }
 
@@ -1376,6 +1447,13 @@ int ccInstance::Run(int32_t curpc)
     }
 }
 
+#undef codeOp
+#undef arg1
+#undef arg2
+#undef arg3
+#undef reg1
+#undef reg2
+
 int ccInstance::RunScriptFunctionIfExists(const char*tsname, int numParam, const RuntimeScriptValue *params) {
     int oldRestoreCount = gameHasBeenRestored;
     // First, save the current ccError state
@@ -1532,19 +1610,14 @@ void ccInstance::GetScriptPosition(ScriptPosition &script_pos)
 // get a pointer to a variable or function exported by the script
 RuntimeScriptValue ccInstance::GetSymbolAddress(const char *symname)
 {
-    int k;
-    char altName[200];
-    sprintf(altName, "%s$", symname);
-    RuntimeScriptValue rval_null;
-
-    for (k = 0; k < instanceof->numexports; k++) {
-        if (strcmp(instanceof->exports[k], symname) == 0)
-            return exports[k];
-        // mangled function name
-        if (strncmp(instanceof->exports[k], altName, strlen(altName)) == 0)
-            return exports[k];
-    }
-    return rval_null;
+    const ScriptExport *exp = FindExport(symname);
+    return exp ? exports[exp->Index] : RuntimeScriptValue();
+}
+
+const ScriptExport *ccInstance::FindExport(const char *symname) const
+{
+    ScExportMap::const_iterator it = exportindex->find(symname);
+    return it != exportindex->end() ? &it->second : NULL;
 }
 
 void ccInstance::DumpInstruction(const ScriptOperation &op)
@@ -1601,6 +1674,7 @@ bool ccInstance::_Create(PScript scri, ccInstance * joined)
     if (joined != NULL) {
         // share memory space with an existing instance (ie. this is a thread/fork)
         globalvars = joined->globalvars;
+        exportindex = joined->exportindex;
         globaldatasize = joined->globaldatasize;
         globaldata = joined->globaldata;
         code = joined->code;
@@ -1659,6 +1733,9 @@ bool ccInstance::_Create(PScript scri, ccInstance * joined)
     {
         resolved_imports = joined->resolved_imports;
         code_fixups = joined->code_fixups;
+        code_ops = joined->code_ops;
+        code_opindex = joined->code_opindex;
+        numcodeops = joined->numcodeops;
     }
     else
     {
@@ -1674,6 +1751,14 @@ bool ccInstance::_Create(PScript scri, ccInstance * joined)
         {
             return false;
         }
+        if (!CreateRuntimeCodeOps())
+        {
+            return false;
+        }
+        if (!CreateExportIndex(scri))
+        {
+            return false;
+        }
     }
 
     exports = new RuntimeScriptValue[scri->numexports];
@@ -1745,6 +1830,7 @@ void ccInstance::Free()
         nullfree(code);
     }
     globalvars.reset();
+    exportindex.reset();
     globaldata = NULL;
     code = NULL;
     strings = NULL;
@@ -1760,9 +1846,14 @@ void ccInstance::Free()
     {
         delete [] resolved_imports;
         delete [] code_fixups;
+        delete [] code_ops;
+        delete [] code_opindex;
     }
     resolved_imports = NULL;
     code_fixups = NULL;
+    code_ops = NULL;
+    code_opindex = NULL;
+    numcodeops = 0;
 }
 
 bool ccInstance::ResolveScriptImports(PScript scri)
@@ -1954,6 +2045,136 @@ bool ccInstance::CreateRuntimeCodeFixups(PScript scri)
     return true;
 }
 
+bool ccInstance::CreateRuntimeCodeOps()
+{
+    // First pass: count instructions, so that we know how many operations
+    // to allocate; operation 0 is reserved for invalid code positions, it
+    // has a NULL instruction code, that is reported as error when executed
+    numcodeops = 1;
+    for (int32_t at_pc = 0; at_pc < codesize; )
+    {
+        int32_t cmd = (int32_t)(code[at_pc] & INSTANCE_ID_REMOVEMASK);
+        if (cmd < 0 || cmd >= CC_NUM_SCCMDS || at_pc + sccmd_info[cmd].ArgCount >= codesize)
+        {
+            at_pc++;
+            continue;
+        }
+        numcodeops++;
+        at_pc += sccmd_info[cmd].ArgCount + 1;
+    }
+
+    code_ops = new ScriptOperation[numcodeops];
+    code_opindex = new int32_t[codesize > 0 ? codesize : 1];
+    memset(code_opindex, 0, (codesize > 0 ? codesize : 1) * sizeof(int32_t));
+
+    // Second pass: decode instructions and resolve their arguments;
+    // if the code is broken the error will be reported only if the
+    // interpreter actually gets there, same as it used to
+    int32_t op_index = 1;
+    for (int32_t at_pc = 0; at_pc < codesize; )
+    {
+        ScriptOperation &op = code_ops[op_index];
+        op.Instruction.Code         = code[at_pc];
+        op.Instruction.InstanceId   = (op.Instruction.Code >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK;
+        op.Instruction.Code        &= INSTANCE_ID_REMOVEMASK; // now this is pure instruction code
+        if (op.Instruction.Code < 0 || op.Instruction.Code >= CC_NUM_SCCMDS ||
+            at_pc + sccmd_info[op.Instruction.Code].ArgCount >= codesize)
+        {
+            op = ScriptOperation();
+            at_pc++;
+            continue;
+        }
+
+        op.ArgCount = sccmd_info[op.Instruction.Code].ArgCount;
+        code_opindex[at_pc] = op_index;
+        int32_t arg_pc = at_pc + 1;
+        for (int i = 0; i < op.ArgCount; ++i, ++arg_pc)
+        {
+            char fixup = code_fixups[arg_pc];
+            if (fixup > 0)
+            {
+                // could be relative pointer or import address
+                switch (fixup)
+                {
+                case FIXUP_GLOBALDATA:
+                    {
+                        ScriptVariable *gl_var = (ScriptVariable*)code[arg_pc];
+                        op.Args[i].SetGlobalVar(&gl_var->RValue);
+                    }
+                    break;
+                case FIXUP_FUNCTION:
+                    // originally commented -- CHECKME: could this be used in very old versions of AGS?
+                    //      code[fixup] += (long)&code[0];
+                    // This is a program counter value, presumably will be used as SCMD_CALL argument
+                    op.Args[i].SetInt32((int32_t)code[arg_pc]);
+                    break;
+                case FIXUP_STRING:
+                    op.Args[i].SetStringLiteral(&strings[0] + code[arg_pc]);
+                    break;
+                case FIXUP_IMPORT:
+                    {
+                        // the import is looked up when the operation is
+                        // executed, only make sure that it exists
+                        const ScriptImport *import = simp.getByIndex((int32_t)code[arg_pc]);
+                        if (import)
+                        {
+                            op.Args[i].SetInt32((int32_t)code[arg_pc]);
+                            op.ImportArgs |= (1 << i);
+                        }
+                        else
+                        {
+                            cc_error("cannot resolve import, key = %ld", code[arg_pc]);
+                            return false;
+                        }
+                    }
+                    break;
+                case FIXUP_STACK:
+                    // stack address depends on the stack contents at the time
+                    // of execution, so only remember the offset for now
+                    op.Args[i].SetInt32((int32_t)code[arg_pc]);
+                    op.StackArgs |= (1 << i);
+                    break;
+                default:
+                    cc_error("internal fixup type error: %d", fixup);
+                    return false;
+                }
+            }
+            else
+            {
+                // should be a numeric literal (int32 or float)
+                op.Args[i].SetInt32( (int32_t)code[arg_pc] );
+            }
+        }
+        op_index++;
+        at_pc = arg_pc;
+    }
+    return true;
+}
+
+bool ccInstance::CreateExportIndex(PScript scri)
+{
+    exportindex.reset(new ScExportMap());
+    for (int i = 0; i < scri->numexports; ++i)
+    {
+        ScriptExport exp;
+        exp.Index = i;
+        // the symbol is always available by its full name
+        const char *name = scri->exports[i];
+        exportindex->insert(std::make_pair(Common::String(name), exp));
+        // functions are also registered by the name without "$N" suffix,
+        // which tells the number of parameters
+        const char *mangle = strchr(name, '$');
+        if (mangle)
+        {
+            exp.ArgCount = atoi(mangle + 1);
+            // NOTE: insert does not replace existing entry, so the first
+            // export of the same name is found, as before
+            exportindex->insert(std::make_pair(Common::String(name, mangle - name), exp));
+        }
+    }
+    return true;
+}
+
 /*
 bool ccInstance::ReadOperation(ScriptOperation &op, int32_t at_pc)
 {
@@ -26,7 +26,7 @@
 #include "script/script_common.h"
 #include "script/cc_script.h"  // ccScript
 #include "script/nonblockingscriptfunction.h"
-#include "util/string.h"
+#include "util/string_types.h"
 
 using namespace AGS;
 
@@ -48,6 +48,17 @@ using namespace AGS;
 struct ccInstance;
 struct ScriptImport;
 
+// Method used by the interpreter to dispatch instructions
+enum ScriptDispatchMode
+{
+    // switch over instruction code
+    kScDispatch_Switch,
+    // every handler jumps straight to the handler of the next instruction,
+    // taken from the table (computed goto); only supported when the engine
+    // is built with GCC-compatible compiler
+    kScDispatch_Threaded
+};
+
 struct ScriptInstruction
 {
     ScriptInstruction()
@@ -65,11 +76,19 @@ struct ScriptOperation
 	ScriptOperation()
 	{
 		ArgCount = 0;
+		StackArgs = 0;
+		ImportArgs = 0;
 	}
 
 	ScriptInstruction   Instruction;
 	RuntimeScriptValue	Args[MAX_SCMD_ARGS];
 	int				    ArgCount;
+	// Bit mask of arguments that keep stack offset and have to be
+	// resolved at the time operation is executed
+	int                 StackArgs;
+	// Bit mask of arguments that keep import index; imports may be
+	// registered again later, so they are resolved at the time too
+	int                 ImportArgs;
 };
 
 struct ScriptVariable
@@ -84,6 +103,20 @@ struct ScriptVariable
     RuntimeScriptValue  RValue;
 };
 
+// Script export entry, registered under the symbol name without the
+// function's parameter count suffix
+struct ScriptExport
+{
+    ScriptExport()
+        : Index(-1)
+        , ArgCount(-1)
+    {
+    }
+
+    int32_t Index;      // index in the script's export table
+    int32_t ArgCount;   // number of function parameters, or -1 if not specified
+};
+
 struct FunctionCallStack;
 
 struct ScriptPosition
@@ -110,9 +143,12 @@ public:
     // TODO: change to std:: if moved to C++11
     typedef stdtr1compat::unordered_map<int32_t, ScriptVariable> ScVarMap;
     typedef stdtr1compat::shared_ptr<ScVarMap>                   PScVarMap;
+    typedef stdtr1compat::unordered_map<Common::String, ScriptExport> ScExportMap;
+    typedef stdtr1compat::shared_ptr<ScExportMap>                PScExportMap;
 public:
     int32_t flags;
     PScVarMap globalvars;
+    PScExportMap exportindex; // export lookup table, shared with forked instances
     char *globaldata;
     int32_t globaldatasize;
     intptr_t *code;
@@ -146,12 +182,21 @@ public:
     int  numimports;
 
     char *code_fixups;
+    // pre-decoded operations, and the index of operation for each code position;
+    // positions which do not start a valid instruction refer to operation 0
+    ScriptOperation *code_ops;
+    int32_t *code_opindex;
+    int32_t numcodeops;
 
     // returns the currently executing instance, or NULL if none
     static ccInstance *GetCurrentInstance(void);
     // create a runnable instance of the supplied script
     static ccInstance *CreateFromScript(PScript script);
     static ccInstance *CreateEx(PScript scri, ccInstance * joined);
+    // set the instruction dispatch method for all instances;
+    // returns false if the method is not supported by this build
+    static bool SetDispatchMode(ScriptDispatchMode mode);
+    static ScriptDispatchMode GetDispatchMode();
 
     ccInstance();
     ~ccInstance();
@@ -165,7 +210,13 @@ public:
     
     // call an exported function in the script (2nd arg is number of params)
     int     CallScriptFunction(const char *funcname, int32_t num_params, const RuntimeScriptValue *params);
-    bool    DoRunScriptFuncCantBlock(NonBlockingScriptFunction* funcToRun, bool hasTheFunc);
+    // call function at the code address previously found by FindScriptFunction
+    int     CallScriptFunctionAt(int32_t startat, int32_t num_params, const RuntimeScriptValue *params);
+    // find an exported function, checking the number of parameters; returns function's
+    // code address, or -2 if no such function, or -1 if it cannot be called this way
+    int32_t FindScriptFunction(const char *funcname, int32_t num_params);
+    // run the function in non-blocking mode; func_addr caches function's lookup result
+    bool    DoRunScriptFuncCantBlock(NonBlockingScriptFunction* funcToRun, int32_t &func_addr);
     int     PrepareTextScript(const char **tsname);
     int     Run(int32_t curpc);
     int     RunScriptFunctionIfExists(const char *tsname, int numParam, const RuntimeScriptValue *params);
@@ -182,6 +233,13 @@ public:
 
 protected:
     bool    _Create(PScript scri, ccInstance * joined);
+    // interpreter loop, specialized for the dispatch method and whether
+    // every instruction is dumped to the debug log
+    template <bool THREADED, bool INSTRUMENTED>
+    int     RunImpl(int32_t curpc);
+    // makes a copy of operation with the stack and import arguments
+    // resolved for the current state of the script
+    bool    ResolveRuntimeArgs(const ScriptOperation &op, ScriptOperation &run_op);
     // free the memory associated with the instance
     void    Free();
 
@@ -190,6 +248,11 @@ protected:
     bool    AddGlobalVar(const ScriptVariable &glvar);
     ScriptVariable *FindGlobalVar(int32_t var_addr);
     bool    CreateRuntimeCodeFixups(PScript scri);
+    // Decodes instructions and resolves their arguments beforehand,
+    // so that interpreter would not have to do this at every step
+    bool    CreateRuntimeCodeOps();
+    bool    CreateExportIndex(PScript scri);
+    const ScriptExport *FindExport(const char *symname) const;
 	//bool    ReadOperation(ScriptOperation &op, int32_t at_pc);
 
     // Runtime fixups
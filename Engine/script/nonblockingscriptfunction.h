@@ -23,6 +23,13 @@
 
 #include <vector>
 
+// Special values of the cached function address
+enum ScriptFuncAddrState
+{
+    kScFuncAddr_Unresolved  = -1, // not looked up yet
+    kScFuncAddr_Missing     = -2  // script does not have this function
+};
+
 struct NonBlockingScriptFunction
 {
     const char* functionName;
@@ -30,9 +37,11 @@ struct NonBlockingScriptFunction
     //void* param1;
     //void* param2;
     RuntimeScriptValue params[2];
-    bool roomHasFunction;
-    bool globalScriptHasFunction;
-    std::vector<bool> moduleHasFunction;
+    // Function's code address in each script; must be reset to
+    // kScFuncAddr_Unresolved whenever corresponding script is reloaded
+    int32_t roomFuncAddr;
+    int32_t globalScriptFuncAddr;
+    std::vector<int32_t> moduleFuncAddr;
     bool atLeastOneImplementationExists;
 
     NonBlockingScriptFunction(const char*funcName, int numParams)
@@ -40,8 +49,8 @@ struct NonBlockingScriptFunction
         this->functionName = funcName;
         this->numParameters = numParams;
         atLeastOneImplementationExists = false;
-        roomHasFunction = true;
-        globalScriptHasFunction = true;
+        roomFuncAddr = kScFuncAddr_Unresolved;
+        globalScriptFuncAddr = kScFuncAddr_Unresolved;
     }
 };
 
@@ -17,6 +17,7 @@
 #include "ac/common.h"
 #include "ac/roomstruct.h"
 #include "ac/character.h"
+#include "ac/characterindex.h"
 #include "ac/dialog.h"
 #include "ac/event.h"
 #include "ac/game.h"
@@ -124,18 +125,18 @@ void run_function_on_non_blocking_thread(NonBlockingScriptFunction* funcToRun) {
     // run modules
     // modules need a forkedinst for this to work
     for (int kk = 0; kk < numScriptModules; kk++) {
-        funcToRun->moduleHasFunction[kk] = moduleInstFork[kk]->DoRunScriptFuncCantBlock(funcToRun, funcToRun->moduleHasFunction[kk]);
+        moduleInstFork[kk]->DoRunScriptFuncCantBlock(funcToRun, funcToRun->moduleFuncAddr[kk]);
 
         if (room_changes_was != play.room_changes)
             return;
     }
 
-    funcToRun->globalScriptHasFunction = gameinstFork->DoRunScriptFuncCantBlock(funcToRun, funcToRun->globalScriptHasFunction);
+    gameinstFork->DoRunScriptFuncCantBlock(funcToRun, funcToRun->globalScriptFuncAddr);
 
     if (room_changes_was != play.room_changes)
         return;
 
-    funcToRun->roomHasFunction = roominstFork->DoRunScriptFuncCantBlock(funcToRun, funcToRun->roomHasFunction);
+    roominstFork->DoRunScriptFuncCantBlock(funcToRun, funcToRun->roomFuncAddr);
 }
 
 //-----------------------------------------------------------
@@ -603,6 +604,7 @@ int run_interaction_commandlist (InteractionCommandList *nicl, int *timesrun, in
           if (!is_valid_character(IPARAM1))
               quit("!Move NPC to different room: invalid character specified");
           game.chars[IPARAM1].room = IPARAM2;
+          charindex_update(IPARAM1);
           break;
       case 27: // Set character view
           SetCharacterView (IPARAM1, IPARAM2);
@@ -0,0 +1,291 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Software renderer benchmarks. These work on memory bitmaps, so that
+// they may be run without setting up the graphics mode.
+//
+//=============================================================================
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "gfx/ali3dsw.h"
+#include "gfx/bitmap.h"
+#include "gfx/hq2x3x.h"
+#include "gfx/renderthreads.h"
+#include "platform/base/agsplatformdriver.h"
+#include "test/benchmark.h"
+#include "util/clock.h"
+#include "util/math.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+namespace
+{
+
+const int HqxBenchWidth = 640;
+const int HqxBenchHeight = 400;
+const int HqxBenchBandHeight = 16;
+const int HqxBenchFrameCount = 30;
+const int HqxBenchRepeatCount = 3;
+
+typedef void (*PfnHqxRows)(unsigned char *in, unsigned char *out, int src_w, int src_h, int bpl,
+                           int y_from, int y_to);
+
+struct HqxBenchJob
+{
+    PfnHqxRows     Func;
+    unsigned char *In;
+    unsigned char *Out;
+    int            Bpl;
+};
+
+void HqxBenchBand(void *data, int band)
+{
+    HqxBenchJob *job = (HqxBenchJob*)data;
+    const int y_from = band * HqxBenchBandHeight;
+    const int y_to = y_from + HqxBenchBandHeight < HqxBenchHeight ? y_from + HqxBenchBandHeight : HqxBenchHeight;
+    job->Func(job->In, job->Out, HqxBenchWidth, HqxBenchHeight, job->Bpl, y_from, y_to);
+}
+
+// Makes an image with flat areas, gradients and sharp edges, resembling
+// a low resolution game frame, so that all the hqx patterns get used
+void MakeHqxBenchImage(std::vector<uint32_t> &image)
+{
+    image.resize(HqxBenchWidth * HqxBenchHeight);
+    srand(1);
+    for (int y = 0; y < HqxBenchHeight; ++y)
+    {
+        for (int x = 0; x < HqxBenchWidth; ++x)
+        {
+            uint32_t col;
+            if ((x / 40 + y / 25) % 3 == 0)
+                col = 0x203040;
+            else if ((x / 40 + y / 25) % 3 == 1)
+                col = ((x * 255 / HqxBenchWidth) << 16) | ((y * 255 / HqxBenchHeight) << 8);
+            else
+                col = (rand() % 4) * 0x3F3F3F;
+            image[y * HqxBenchWidth + x] = col;
+        }
+    }
+}
+
+// Scales the image for a number of frames; returns the best time of
+// a single frame in microseconds
+int64_t RunHqxBench(HqxBenchJob &job)
+{
+    const int band_count = (HqxBenchHeight + HqxBenchBandHeight - 1) / HqxBenchBandHeight;
+    int64_t best_time = 0;
+    for (int r = 0; r < HqxBenchRepeatCount; ++r)
+    {
+        int64_t start = GetClockMicroseconds();
+        for (int f = 0; f < HqxBenchFrameCount; ++f)
+            RenderThreads::RunBands(HqxBenchBand, &job, band_count);
+        int64_t time = (GetClockMicroseconds() - start) / HqxBenchFrameCount;
+        if (r == 0 || time < best_time)
+            best_time = time;
+    }
+    return best_time;
+}
+
+const int ComposeBenchWidth = 640;
+const int ComposeBenchHeight = 400;
+const int ComposeBenchSpriteCount = 60;
+const int ComposeBenchFrameCount = 30;
+const int ComposeBenchRepeatCount = 3;
+
+struct ComposeBenchScene
+{
+    std::vector<Bitmap*>                  Images;
+    std::vector<IDriverDependantBitmap*>  Sprites;
+    std::vector<int>                      X;
+    std::vector<int>                      Y;
+};
+
+// Makes a sprite with a transparent border and a shaded body; alpha
+// sprites get the alpha falling off towards the edges
+Bitmap *MakeComposeBenchSprite(int width, int height, bool has_alpha)
+{
+    Bitmap *bmp = BitmapHelper::CreateBitmap(width, height, 32);
+    for (int y = 0; y < height; ++y)
+    {
+        uint32_t *line = (uint32_t*)bmp->GetScanLineForWriting(y);
+        for (int x = 0; x < width; ++x)
+        {
+            const int edge = Math::Min(Math::Min(x, width - 1 - x), Math::Min(y, height - 1 - y));
+            const uint32_t rgb = ((x * 4) & 0xFF) << 16 | ((y * 3) & 0xFF) << 8 | 0x40;
+            if (edge < 2)
+                line[x] = has_alpha ? 0 : bmp->GetMaskColor();
+            else if (has_alpha)
+                line[x] = (uint32_t)Math::Min(255, edge * 24) << 24 | rgb;
+            else
+                line[x] = rgb;
+        }
+    }
+    return bmp;
+}
+
+// Builds a frame resembling a room with characters and objects: an opaque
+// background, then alpha-blended, translucent and plain masked sprites
+void MakeComposeBenchScene(IGraphicsDriver *driver, ComposeBenchScene &scene)
+{
+    srand(1);
+    Bitmap *bg = BitmapHelper::CreateBitmap(ComposeBenchWidth, ComposeBenchHeight, 32);
+    for (int y = 0; y < ComposeBenchHeight; ++y)
+    {
+        uint32_t *line = (uint32_t*)bg->GetScanLineForWriting(y);
+        for (int x = 0; x < ComposeBenchWidth; ++x)
+            line[x] = ((x * 255 / ComposeBenchWidth) << 16) | ((y * 255 / ComposeBenchHeight) << 8) | (rand() % 32);
+    }
+    scene.Images.push_back(bg);
+    scene.Sprites.push_back(driver->CreateDDBFromBitmap(bg, false, true));
+    scene.X.push_back(0);
+    scene.Y.push_back(0);
+
+    for (int i = 0; i < ComposeBenchSpriteCount; ++i)
+    {
+        const int kind = i % 3;
+        Bitmap *bmp = MakeComposeBenchSprite(32 + rand() % 64, 48 + rand() % 96, kind == 0);
+        IDriverDependantBitmap *ddb = driver->CreateDDBFromBitmap(bmp, kind == 0, false);
+        if (kind == 1)
+            ddb->SetTransparency(64 + rand() % 128);
+        scene.Images.push_back(bmp);
+        scene.Sprites.push_back(ddb);
+        scene.X.push_back(rand() % ComposeBenchWidth - 32);
+        scene.Y.push_back(rand() % ComposeBenchHeight - 48);
+    }
+}
+
+// Renders the scene for a number of frames; returns the best time of
+// a single frame in microseconds
+int64_t RunComposeBench(IGraphicsDriver *driver, const ComposeBenchScene &scene)
+{
+    int64_t best_time = 0;
+    for (int r = 0; r < ComposeBenchRepeatCount; ++r)
+    {
+        int64_t start = GetClockMicroseconds();
+        for (int f = 0; f < ComposeBenchFrameCount; ++f)
+        {
+            for (size_t i = 0; i < scene.Sprites.size(); ++i)
+                driver->DrawSprite(scene.X[i], scene.Y[i], scene.Sprites[i]);
+            driver->RenderToBackBuffer();
+        }
+        int64_t time = (GetClockMicroseconds() - start) / ComposeBenchFrameCount;
+        if (r == 0 || time < best_time)
+            best_time = time;
+    }
+    return best_time;
+}
+
+} // namespace
+
+
+void Bench_HqxFilter()
+{
+    std::vector<uint32_t> image;
+    MakeHqxBenchImage(image);
+    InitLUTs();
+
+    const int scales[] = { 2, 3 };
+    const PfnHqxRows funcs[] = { hq2x_32_rows, hq3x_32_rows };
+    const int was_threads = RenderThreads::GetThreadCount();
+
+    platform->WriteStdOut("Hqx filter benchmark, %dx%d source, best of %d runs of %d frames:",
+        HqxBenchWidth, HqxBenchHeight, HqxBenchRepeatCount, HqxBenchFrameCount);
+    platform->WriteStdOut("%-8s %16s %16s %10s", "scale", "1 thread, Mpx/s", "N threads, Mpx/s", "speedup");
+    for (size_t s = 0; s < sizeof(scales) / sizeof(int); ++s)
+    {
+        const int scale = scales[s];
+        const int bpl = HqxBenchWidth * scale * sizeof(uint32_t);
+        const size_t out_size = bpl * HqxBenchHeight * scale;
+        std::vector<unsigned char> out_single(out_size);
+        std::vector<unsigned char> out_threaded(out_size);
+        HqxBenchJob job;
+        job.Func = funcs[s];
+        job.In = (unsigned char*)&image.front();
+        job.Bpl = bpl;
+
+        RenderThreads::Shutdown();
+        job.Out = &out_single.front();
+        const int64_t time_single = RunHqxBench(job);
+        const int threads = RenderThreads::Init(-1) + 1;
+        job.Out = &out_threaded.front();
+        const int64_t time_threaded = RunHqxBench(job);
+
+        // output megapixels per second equal output pixels per microsecond
+        const double out_pixels = (double)HqxBenchWidth * scale * HqxBenchHeight * scale;
+        const double mpx_single = time_single > 0 ? out_pixels / time_single : 0.0;
+        const double mpx_threaded = time_threaded > 0 ? out_pixels / time_threaded : 0.0;
+        platform->WriteStdOut("hq%dx     %16.1f %13.1f (%d) %9.2fx%s", scale,
+            mpx_single, mpx_threaded, threads,
+            mpx_single > 0.0 ? mpx_threaded / mpx_single : 0.0,
+            memcmp(&out_single.front(), &out_threaded.front(), out_size) != 0 ? "  RESULT MISMATCH" : "");
+    }
+
+    RenderThreads::Shutdown();
+    if (was_threads > 0)
+        RenderThreads::Init(was_threads);
+}
+
+void Bench_SpriteCompose()
+{
+    // memory bitmaps and blenders need Allegro, but not the display
+    if (system_driver == NULL && install_allegro(SYSTEM_NONE, &errno, atexit) != 0)
+    {
+        platform->WriteStdOut("Failed to initialize Allegro");
+        return;
+    }
+    set_color_depth(32);
+
+    ALSW::ALSoftwareGraphicsDriver driver;
+    ComposeBenchScene scene;
+    MakeComposeBenchScene(&driver, scene);
+    Bitmap *out_single = BitmapHelper::CreateBitmap(ComposeBenchWidth, ComposeBenchHeight, 32);
+    Bitmap *out_threaded = BitmapHelper::CreateBitmap(ComposeBenchWidth, ComposeBenchHeight, 32);
+    const int was_threads = RenderThreads::GetThreadCount();
+
+    platform->WriteStdOut("Sprite compositing benchmark, %dx%d frame of %d sprites, best of %d runs of %d frames:",
+        ComposeBenchWidth, ComposeBenchHeight, (int)scene.Sprites.size(), ComposeBenchRepeatCount, ComposeBenchFrameCount);
+    platform->WriteStdOut("%16s %16s %10s", "1 thread, fps", "N threads, fps", "speedup");
+
+    RenderThreads::Shutdown();
+    driver.SetComposeThreads(1);
+    driver.SetMemoryBackBuffer(out_single);
+    const int64_t time_single = RunComposeBench(&driver, scene);
+    const int threads = RenderThreads::Init(-1) + 1;
+    driver.SetComposeThreads(-1);
+    driver.SetMemoryBackBuffer(out_threaded);
+    const int64_t time_threaded = RunComposeBench(&driver, scene);
+
+    bool same = true;
+    for (int y = 0; y < ComposeBenchHeight && same; ++y)
+        same = memcmp(out_single->GetScanLine(y), out_threaded->GetScanLine(y), ComposeBenchWidth * sizeof(uint32_t)) == 0;
+    const double fps_single = time_single > 0 ? 1000000.0 / time_single : 0.0;
+    const double fps_threaded = time_threaded > 0 ? 1000000.0 / time_threaded : 0.0;
+    platform->WriteStdOut("%16.1f %12.1f (%d) %9.2fx%s", fps_single, fps_threaded, threads,
+        fps_single > 0.0 ? fps_threaded / fps_single : 0.0, same ? "" : "  RESULT MISMATCH");
+
+    driver.SetMemoryBackBuffer(NULL);
+    for (size_t i = 0; i < scene.Sprites.size(); ++i)
+        driver.DestroyDDB(scene.Sprites[i]);
+    for (size_t i = 0; i < scene.Images.size(); ++i)
+        delete scene.Images[i];
+    delete out_single;
+    delete out_threaded;
+    RenderThreads::Shutdown();
+    if (was_threads > 0)
+        RenderThreads::Init(was_threads);
+}
@@ -0,0 +1,259 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Script interpreter benchmark. Engine does not link the script compiler,
+// so the test scripts are assembled here from the byte-code, following
+// what the compiler generates for the simple loops.
+//
+//=============================================================================
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "platform/base/agsplatformdriver.h"
+#include "script/cc_error.h"
+#include "script/cc_instance.h"
+#include "script/script_common.h"
+#include "script/script_runtime.h"
+#include "test/benchmark.h"
+#include "util/clock.h"
+
+using namespace AGS::Engine;
+
+namespace
+{
+
+const int32_t BenchLoopCount = 2000000;
+const int     BenchRepeatCount = 5;
+
+RuntimeScriptValue Sc_BenchNop(const RuntimeScriptValue *params, int32_t param_count)
+{
+    return RuntimeScriptValue().SetInt32(0);
+}
+
+// Simple byte-code assembler
+class BenchScriptWriter
+{
+public:
+    void Cmd(int32_t cmd) { _code.push_back(cmd); }
+    void Cmd(int32_t cmd, intptr_t arg1) { Cmd(cmd); _code.push_back(arg1); }
+    void Cmd(int32_t cmd, intptr_t arg1, intptr_t arg2) { Cmd(cmd, arg1); _code.push_back(arg2); }
+    // Marks the last written argument for fixup
+    void Fixup(char type)
+    {
+        _fixups.push_back((int32_t)_code.size() - 1);
+        _fixupTypes.push_back(type);
+    }
+    int32_t Pos() const { return (int32_t)_code.size(); }
+    // Writes a jump instruction, and returns position of its argument
+    int32_t Jump(int32_t cmd) { Cmd(cmd, 0); return Pos() - 1; }
+    // Sets jump argument, making it lead to the current position
+    void    Land(int32_t jump_arg_pos) { _code[jump_arg_pos] = Pos() - (jump_arg_pos + 1); }
+    // Writes a backward jump to the given position
+    void    JumpBack(int32_t cmd, int32_t to_pos) { Cmd(cmd, to_pos - (Pos() + 2)); }
+
+    void BeginFunction(const char *name)
+    {
+        _exports.push_back(name);
+        _exportAddr.push_back((EXPORT_FUNCTION << 24) | Pos());
+    }
+
+    ccScript *CreateScript(const std::vector<const char*> &imports, int32_t globaldata_size)
+    {
+        ccScript *scri = new ccScript();
+        scri->globaldatasize = globaldata_size;
+        scri->globaldata = (char*)calloc(globaldata_size, 1);
+        scri->codesize = (int32_t)_code.size();
+        scri->code = (intptr_t*)malloc(_code.size() * sizeof(intptr_t));
+        memcpy(scri->code, &_code.front(), _code.size() * sizeof(intptr_t));
+        scri->stringssize = 1;
+        scri->strings = (char*)calloc(1, 1);
+        scri->numfixups = (int)_fixups.size();
+        scri->fixups = (int32_t*)malloc(_fixups.size() * sizeof(int32_t));
+        scri->fixuptypes = (char*)malloc(_fixups.size());
+        for (size_t i = 0; i < _fixups.size(); ++i)
+        {
+            scri->fixups[i] = _fixups[i];
+            scri->fixuptypes[i] = _fixupTypes[i];
+        }
+        scri->numimports = (int)imports.size();
+        scri->imports = (char**)malloc(imports.size() * sizeof(char*));
+        for (size_t i = 0; i < imports.size(); ++i)
+            scri->imports[i] = strdup(imports[i]);
+        scri->numexports = (int)_exports.size();
+        scri->exports = (char**)malloc(_exports.size() * sizeof(char*));
+        scri->export_addr = (int32_t*)malloc(_exports.size() * sizeof(int32_t));
+        for (size_t i = 0; i < _exports.size(); ++i)
+        {
+            scri->exports[i] = strdup(_exports[i]);
+            scri->export_addr[i] = _exportAddr[i];
+        }
+        return scri;
+    }
+
+private:
+    std::vector<intptr_t>     _code;
+    std::vector<int32_t>      _fixups;
+    std::vector<char>         _fixupTypes;
+    std::vector<const char*>  _exports;
+    std::vector<int32_t>      _exportAddr;
+};
+
+// Writes a loop header "for (cx = 0; cx < count; cx++)"; returns loop start
+// position and the position of exit jump argument
+void WriteLoopBegin(BenchScriptWriter &w, int32_t &loop_pos, int32_t &exit_pos)
+{
+    w.Cmd(SCMD_LOOPCHECKOFF);
+    w.Cmd(SCMD_LITTOREG, SREG_CX, 0);
+    w.Cmd(SCMD_LITTOREG, SREG_DX, 0);
+    loop_pos = w.Pos();
+    w.Cmd(SCMD_LINENUM, 1);
+    w.Cmd(SCMD_REGTOREG, SREG_CX, SREG_AX);
+    w.Cmd(SCMD_LITTOREG, SREG_BX, BenchLoopCount);
+    w.Cmd(SCMD_LESSTHAN, SREG_AX, SREG_BX);
+    exit_pos = w.Jump(SCMD_JZ);
+}
+
+void WriteLoopEnd(BenchScriptWriter &w, int32_t loop_pos, int32_t exit_pos)
+{
+    w.Cmd(SCMD_ADD, SREG_CX, 1);
+    w.JumpBack(SCMD_JMP, loop_pos);
+    w.Land(exit_pos);
+    w.Cmd(SCMD_REGTOREG, SREG_DX, SREG_AX);
+    w.Cmd(SCMD_RET);
+}
+
+ccScript *CreateBenchScript()
+{
+    BenchScriptWriter w;
+    int32_t loop_pos, exit_pos;
+
+    // Local function: dx += 1
+    int32_t local_func = w.Pos();
+    w.Cmd(SCMD_LITTOREG, SREG_AX, 1);
+    w.Cmd(SCMD_ADDREG, SREG_DX, SREG_AX);
+    w.Cmd(SCMD_RET);
+
+    // Integer arithmetics: dx += (cx * 3) ^ cx
+    w.BeginFunction("bench_arith$0");
+    WriteLoopBegin(w, loop_pos, exit_pos);
+    w.Cmd(SCMD_REGTOREG, SREG_CX, SREG_AX);
+    w.Cmd(SCMD_MUL, SREG_AX, 3);
+    w.Cmd(SCMD_XORREG, SREG_AX, SREG_CX);
+    w.Cmd(SCMD_ADDREG, SREG_DX, SREG_AX);
+    WriteLoopEnd(w, loop_pos, exit_pos);
+
+    // Global variable access: gvar = 0; loop { gvar += cx; dx = gvar }
+    w.BeginFunction("bench_memory$0");
+    w.Cmd(SCMD_LITTOREG, SREG_MAR, 0);
+    w.Fixup(FIXUP_GLOBALDATA);
+    w.Cmd(SCMD_LITTOREG, SREG_AX, 0);
+    w.Cmd(SCMD_MEMWRITE, SREG_AX);
+    WriteLoopBegin(w, loop_pos, exit_pos);
+    w.Cmd(SCMD_LITTOREG, SREG_MAR, 0);
+    w.Fixup(FIXUP_GLOBALDATA);
+    w.Cmd(SCMD_MEMREAD, SREG_AX);
+    w.Cmd(SCMD_ADDREG, SREG_AX, SREG_CX);
+    w.Cmd(SCMD_MEMWRITE, SREG_AX);
+    w.Cmd(SCMD_REGTOREG, SREG_AX, SREG_DX);
+    WriteLoopEnd(w, loop_pos, exit_pos);
+
+    // Local function call, with argument passed through the stack
+    w.BeginFunction("bench_call$0");
+    WriteLoopBegin(w, loop_pos, exit_pos);
+    w.Cmd(SCMD_PUSHREG, SREG_CX);
+    w.Cmd(SCMD_LITTOREG, SREG_AX, local_func);
+    w.Fixup(FIXUP_FUNCTION);
+    w.Cmd(SCMD_CALL, SREG_AX);
+    w.Cmd(SCMD_POPREG, SREG_CX);
+    WriteLoopEnd(w, loop_pos, exit_pos);
+
+    // Call to the engine API function
+    w.BeginFunction("bench_extcall$0");
+    WriteLoopBegin(w, loop_pos, exit_pos);
+    w.Cmd(SCMD_LITTOREG, SREG_AX, 0);
+    w.Fixup(FIXUP_IMPORT);
+    w.Cmd(SCMD_CALLEXT, SREG_AX);
+    w.Cmd(SCMD_ADD, SREG_DX, 1);
+    WriteLoopEnd(w, loop_pos, exit_pos);
+
+    std::vector<const char*> imports;
+    imports.push_back("BenchNop");
+    return w.CreateScript(imports, sizeof(int32_t));
+}
+
+} // namespace
+
+
+void Bench_ScriptDispatch()
+{
+    const char *bench_funcs[] = { "bench_arith", "bench_memory", "bench_call", "bench_extcall" };
+    const size_t bench_count = sizeof(bench_funcs) / sizeof(const char*);
+    const ScriptDispatchMode modes[] = { kScDispatch_Switch, kScDispatch_Threaded };
+    const char *mode_names[] = { "switch", "threaded" };
+    const size_t mode_count = sizeof(modes) / sizeof(ScriptDispatchMode);
+
+    ccAddExternalStaticFunction("BenchNop", Sc_BenchNop);
+    PScript script(CreateBenchScript());
+    ccInstance *inst = ccInstance::CreateFromScript(script);
+    if (!inst)
+    {
+        platform->WriteStdOut("Failed to create script instance: %s", ccErrorString);
+        ccRemoveExternalSymbol("BenchNop");
+        return;
+    }
+
+    const ScriptDispatchMode was_mode = ccInstance::GetDispatchMode();
+    int64_t best_time[bench_count][2] = {{0}};
+    int     result[bench_count][2] = {{0}};
+    for (size_t m = 0; m < mode_count; ++m)
+    {
+        if (!ccInstance::SetDispatchMode(modes[m]))
+        {
+            platform->WriteStdOut("Dispatch mode '%s' is not supported by this build", mode_names[m]);
+            continue;
+        }
+        for (size_t b = 0; b < bench_count; ++b)
+        {
+            for (int r = 0; r < BenchRepeatCount; ++r)
+            {
+                int64_t start = GetClockMicroseconds();
+                if (inst->CallScriptFunction(bench_funcs[b], 0, NULL) != 0)
+                {
+                    platform->WriteStdOut("Error running %s: %s", bench_funcs[b], ccErrorString);
+                    break;
+                }
+                int64_t time = GetClockMicroseconds() - start;
+                if (r == 0 || time < best_time[b][m])
+                    best_time[b][m] = time;
+                result[b][m] = inst->returnValue;
+            }
+        }
+    }
+    ccInstance::SetDispatchMode(was_mode);
+
+    platform->WriteStdOut("Script dispatch benchmark, %d iterations, best of %d runs:", BenchLoopCount, BenchRepeatCount);
+    platform->WriteStdOut("%-16s %12s %12s %10s", "test", "switch, ms", "threaded, ms", "speedup");
+    for (size_t b = 0; b < bench_count; ++b)
+    {
+        platform->WriteStdOut("%-16s %12.2f %12.2f %9.2fx%s", bench_funcs[b],
+            best_time[b][0] / 1000.0, best_time[b][1] / 1000.0,
+            best_time[b][1] > 0 ? (double)best_time[b][0] / best_time[b][1] : 0.0,
+            result[b][0] != result[b][1] && best_time[b][1] > 0 ? "  RESULT MISMATCH" : "");
+    }
+
+    delete inst;
+    script.reset();
+    ccRemoveExternalSymbol("BenchNop");
+}
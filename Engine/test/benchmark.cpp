@@ -0,0 +1,54 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include "core/types.h"
+#include "platform/base/agsplatformdriver.h"
+#include "test/benchmark.h"
+#include "util/string_utils.h"
+
+struct BenchmarkInfo
+{
+    const char *Name;
+    const char *Description;
+    void      (*Run)();
+};
+
+static const BenchmarkInfo Benchmarks[] =
+{
+    { "script",  "script interpreter: switch vs threaded dispatch", Bench_ScriptDispatch },
+    { "hqx",     "hqx scaling filter: single vs multiple threads", Bench_HqxFilter },
+    { "compose", "software sprite compositing: single vs multiple threads", Bench_SpriteCompose }
+};
+
+static const size_t BenchmarkCount = sizeof(Benchmarks) / sizeof(BenchmarkInfo);
+
+bool Bench_Run(const char *name)
+{
+    for (size_t i = 0; i < BenchmarkCount; ++i)
+    {
+        if (stricmp(Benchmarks[i].Name, name) == 0)
+        {
+            Benchmarks[i].Run();
+            return true;
+        }
+    }
+    return false;
+}
+
+void Bench_PrintList()
+{
+    platform->WriteStdOut("Available benchmarks:");
+    for (size_t i = 0; i < BenchmarkCount; ++i)
+        platform->WriteStdOut("  %-16s %s", Benchmarks[i].Name, Benchmarks[i].Description);
+}
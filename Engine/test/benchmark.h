@@ -0,0 +1,35 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Engine microbenchmarks, run from the command line with --benchmark <name>;
+// results are printed to the standard output.
+//
+//=============================================================================
+
+#ifndef __AGS_EE_TEST__BENCHMARK_H
+#define __AGS_EE_TEST__BENCHMARK_H
+
+// Runs benchmark of the given name; returns false if there's no such benchmark
+bool Bench_Run(const char *name);
+// Prints the list of available benchmarks
+void Bench_PrintList();
+
+// Script interpreter: compares instruction dispatch methods
+void Bench_ScriptDispatch();
+// Hqx scaling filter: single thread vs render threads, at 2x and 3x
+void Bench_HqxFilter();
+// Software renderer: sprite compositing on one thread vs render threads
+void Bench_SpriteCompose();
+
+#endif // __AGS_EE_TEST__BENCHMARK_H
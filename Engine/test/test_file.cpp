@@ -16,12 +16,94 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <vector>
 #include "util/alignedstream.h"
 #include "util/filestream.h"
+#include "util/lzw.h"
+#include "util/memorystream.h"
 #include "debug/assert.h"
 
 using namespace AGS::Common;
 
+// Compresses data through the files and decodes it back in pieces of
+// various size, which must not change the result
+static void Test_Lzw()
+{
+    std::vector<unsigned char> data(50000);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        // mix repeated runs with noise, so that both matches and literals are used
+        data[i] = (i / 64) % 3 == 0 ? (unsigned char)(seed >> 16) : (unsigned char)(i % 13);
+    }
+
+    Stream *out = File::OpenFile("lzw_in.tmp", AGS::Common::kFile_CreateAlways, AGS::Common::kFile_Write);
+    out->Write(&data.front(), data.size());
+    delete out;
+    Stream *lzw_in = File::OpenFile("lzw_in.tmp", AGS::Common::kFile_Open, AGS::Common::kFile_Read);
+    out = File::OpenFile("lzw_out.tmp", AGS::Common::kFile_CreateAlways, AGS::Common::kFile_Write);
+    lzwcompress(lzw_in, out);
+    delete lzw_in;
+    delete out;
+    Stream *in = File::OpenFile("lzw_out.tmp", AGS::Common::kFile_Open, AGS::Common::kFile_Read);
+    std::vector<unsigned char> packed((size_t)in->GetLength());
+    in->Read(&packed.front(), packed.size());
+    delete in;
+    File::DeleteFile("lzw_in.tmp");
+    File::DeleteFile("lzw_out.tmp");
+
+    std::vector<unsigned char> unpacked(data.size() + 1);
+    LzwDecoder decoder(&packed.front(), packed.size());
+    size_t done = 0;
+    for (size_t piece = 1; done < data.size(); piece = piece * 3 % 1000 + 1)
+    {
+        const size_t want = piece < data.size() - done ? piece : data.size() - done;
+        const size_t got = decoder.Expand(&unpacked[done], want);
+        done += got;
+        if (got < want)
+            break;
+    }
+    assert(done == data.size());
+    assert(memcmp(&unpacked.front(), &data.front(), data.size()) == 0);
+    // the data is over
+    assert(decoder.Expand(&unpacked[done], 1) == 0);
+}
+
+// Writes into the memory buffer, patches values written before, as the
+// savegame header is patched, and reads everything back
+static void Test_MemoryStream()
+{
+    std::vector<char> buffer;
+    MemoryStream out(buffer);
+    out.WriteInt32(1);
+    out.WriteInt32(2);
+    out.WriteInt32(3);
+    out.Write("memory", 7);
+    assert(buffer.size() == 19);
+    out.Seek(4, kSeekBegin);
+    out.WriteInt32(20);
+    out.Seek(4, kSeekCurrent);
+    out.WriteByte('M');
+    assert(out.GetPosition() == 13);
+    assert(buffer.size() == 19);
+    out.Seek(0, kSeekEnd);
+    out.WriteInt16(7);
+    assert(buffer.size() == 21);
+    assert(out.Seek(-30, kSeekCurrent) == 21);
+
+    MemoryStream in(buffer);
+    char str[7];
+    assert(in.ReadInt32() == 1);
+    assert(in.ReadInt32() == 20);
+    assert(in.ReadInt32() == 3);
+    assert(in.Read(str, 7) == 7);
+    assert(strcmp(str, "Memory") == 0);
+    assert(in.ReadInt16() == 7);
+    assert(in.EOS());
+    assert(in.ReadByte() == -1);
+}
+
 struct TTrickyAlignedData
 {
     char    a;
@@ -203,6 +285,9 @@ void Test_File()
     assert(ptr32_array_in[3] == 0xBEEFFEED);
 
     assert(!File::TestReadFile("test.tmp"));
+
+    Test_Lzw();
+    Test_MemoryStream();
 }
 
 #endif // _DEBUG
@@ -14,10 +14,203 @@
 
 #ifdef _DEBUG
 
+#include <errno.h>
+#include <stdlib.h>
+#include <vector>
+#include "gfx/ali3dsw.h"
+#include "gfx/bitmap.h"
+#include "gfx/blend_kernels.h"
+#include "gfx/blender.h"
 #include "gfx/gfx_def.h"
 #include "debug/assert.h"
 
+using AGS::Common::Bitmap;
+using AGS::Engine::GfxRenderStats;
+using AGS::Engine::IDriverDependantBitmap;
+using AGS::Engine::IGraphicsDriver;
+namespace BitmapHelper = AGS::Common::BitmapHelper;
 namespace GfxDef = AGS::Common::GfxDef;
+namespace BlendKernels = AGS::Engine::BlendKernels;
+
+extern "C" {
+    unsigned long _blender_alpha32(unsigned long x, unsigned long y, unsigned long n);
+    unsigned long _blender_trans24(unsigned long x, unsigned long y, unsigned long n);
+    unsigned long _blender_trans16(unsigned long x, unsigned long y, unsigned long n);
+    unsigned long _blender_trans15(unsigned long x, unsigned long y, unsigned long n);
+}
+unsigned long _myblender_alpha_trans24(unsigned long x, unsigned long y, unsigned long n);
+namespace AGS { namespace Engine { namespace ALSW {
+    unsigned long _trans_alpha_blender32(unsigned long x, unsigned long y, unsigned long n);
+} } }
+
+struct BlendKernelRef
+{
+    BlendKernels::BlendOp Op;
+    BLENDER_FUNC          Blender;
+};
+
+// Pseudo-random pixels, with the mask color and the edge alpha values
+// appearing more often than they would by chance
+static uint32_t Test_MakePixel(uint32_t &seed, int depth)
+{
+    seed = seed * 1103515245 + 12345;
+    uint32_t c = (seed >> 8) ^ (seed << 13);
+    switch (seed % 11)
+    {
+    case 0: return depth == 32 ? MASK_COLOR_32 : depth == 16 ? MASK_COLOR_16 : MASK_COLOR_15;
+    case 1: c &= 0x00FFFFFF; break;
+    case 2: c |= 0xFF000000; break;
+    }
+    return depth == 32 ? c : depth == 16 ? (c & 0xFFFF) : (c & 0x7FFF);
+}
+
+// Tests that the blending kernels give exactly the same result as the
+// blender callbacks they replace
+static void Test_BlendKernels()
+{
+    const BlendKernelRef refs[] =
+    {
+        { BlendKernels::kBlendOp_Alpha32, _blender_alpha32 },
+        { BlendKernels::kBlendOp_TransAlpha32, AGS::Engine::ALSW::_trans_alpha_blender32 },
+        { BlendKernels::kBlendOp_Trans32, _blender_trans24 },
+        { BlendKernels::kBlendOp_TransKeepAlpha32, _myblender_alpha_trans24 },
+        { BlendKernels::kBlendOp_Argb2Argb, _argb2argb_blender },
+        { BlendKernels::kBlendOp_Argb2Rgb, _argb2rgb_blender },
+        { BlendKernels::kBlendOp_Rgb2Argb, _rgb2argb_blender },
+        { BlendKernels::kBlendOp_OpaqueAlpha, _opaque_alpha_blender },
+        { BlendKernels::kBlendOp_Trans16, _blender_trans16 },
+        { BlendKernels::kBlendOp_Trans15, _blender_trans15 },
+    };
+    const size_t ref_count = sizeof(refs) / sizeof(BlendKernelRef);
+    const uint32_t alphas[] = { 0, 1, 2, 7, 8, 64, 127, 128, 200, 254, 255 };
+    const size_t alpha_count = sizeof(alphas) / sizeof(uint32_t);
+    // not a multiple of the SIMD width, to also test the leftover pixels
+    const int pixel_count = 133;
+
+    std::vector<uint32_t> src(pixel_count), dst(pixel_count), expect(pixel_count), result(pixel_count);
+    std::vector<uint16_t> src16(pixel_count), dst16(pixel_count), result16(pixel_count);
+    for (int set = 0; set < BlendKernels::kNumKernelSets; ++set)
+    {
+        if (!BlendKernels::IsSetSupported((BlendKernels::KernelSet)set))
+            continue;
+        uint32_t seed = 1;
+        for (size_t r = 0; r < ref_count; ++r)
+        {
+            const int depth = BlendKernels::GetBlendOpDepth(refs[r].Op);
+            const uint32_t mask = depth == 32 ? MASK_COLOR_32 : depth == 16 ? MASK_COLOR_16 : MASK_COLOR_15;
+            BlendKernels::PfnBlendRow blend_row =
+                BlendKernels::GetRowFunc(refs[r].Op, (BlendKernels::KernelSet)set);
+            for (size_t a = 0; a < alpha_count; ++a)
+            {
+                for (int i = 0; i < pixel_count; ++i)
+                {
+                    src[i] = Test_MakePixel(seed, depth);
+                    dst[i] = Test_MakePixel(seed, depth);
+                    expect[i] = src[i] == mask ? dst[i] : (uint32_t)refs[r].Blender(src[i], dst[i], alphas[a]);
+                    if (depth == 32)
+                        continue;
+                    // upper 16 bits of the blender result are not stored
+                    expect[i] &= 0xFFFF;
+                    src16[i] = (uint16_t)src[i];
+                    dst16[i] = (uint16_t)dst[i];
+                }
+                if (depth == 32)
+                {
+                    result = dst;
+                    blend_row(&result.front(), &src.front(), pixel_count, alphas[a]);
+                }
+                else
+                {
+                    result16 = dst16;
+                    blend_row(&result16.front(), &src16.front(), pixel_count, alphas[a]);
+                    result.assign(result16.begin(), result16.end());
+                }
+                for (int i = 0; i < pixel_count; ++i)
+                    assert(result[i] == expect[i]);
+            }
+        }
+
+        // lit blending of the constant color with the source pixels
+        BlendKernels::PfnLitRow lit_row = BlendKernels::GetLitTrans32Func((BlendKernels::KernelSet)set);
+        for (size_t a = 0; a < alpha_count; ++a)
+        {
+            const uint32_t color = Test_MakePixel(seed, 32);
+            for (int i = 0; i < pixel_count; ++i)
+            {
+                src[i] = Test_MakePixel(seed, 32);
+                dst[i] = Test_MakePixel(seed, 32);
+                expect[i] = src[i] == MASK_COLOR_32 ? dst[i] : (uint32_t)_blender_trans24(color, src[i], alphas[a]);
+            }
+            result = dst;
+            lit_row(&result.front(), &src.front(), pixel_count, color, alphas[a]);
+            for (int i = 0; i < pixel_count; ++i)
+                assert(result[i] == expect[i]);
+        }
+    }
+}
+
+static void Test_RenderFrame(IGraphicsDriver &driver, IDriverDependantBitmap *bg,
+                             IDriverDependantBitmap *sprite, int x, int y)
+{
+    driver.DrawSprite(0, 0, bg);
+    driver.DrawSprite(x, y, sprite);
+    driver.RenderToBackBuffer();
+}
+
+// Tests that the software renderer only redraws the parts of the frame
+// which have changed: a sprite that stays in place and is not updated,
+// like an idle character, must not make anything dirty
+static void Test_DirtyRects()
+{
+    // memory bitmaps need Allegro, but not the display
+    const bool init_allegro = system_driver == NULL;
+    if (init_allegro && install_allegro(SYSTEM_NONE, &errno, atexit) != 0)
+        return;
+
+    AGS::Engine::ALSW::ALSoftwareGraphicsDriver driver;
+    Bitmap *screen = BitmapHelper::CreateBitmap(320, 200, 32);
+    Bitmap *bg = BitmapHelper::CreateBitmap(320, 200, 32);
+    // different color depth, so that the sprite has to be converted too
+    Bitmap *image = BitmapHelper::CreateBitmap(20, 50, 16);
+    bg->Clear();
+    image->Clear();
+    driver.SetMemoryBackBuffer(screen);
+    driver.UseDirtyRects(true);
+    IDriverDependantBitmap *bg_ddb = driver.CreateDDBFromBitmap(bg, false, true);
+    IDriverDependantBitmap *sprite = driver.CreateDDBFromBitmap(image, false, false);
+    const GfxRenderStats &stats = driver.GetRenderStats();
+
+    // first frame is drawn in full
+    Test_RenderFrame(driver, bg_ddb, sprite, 100, 100);
+    assert(stats.FrameRects == 1);
+    assert(stats.FramePixels == 320 * 200);
+    const int32_t conversions = stats.Conversions;
+    // idle sprite
+    Test_RenderFrame(driver, bg_ddb, sprite, 100, 100);
+    assert(stats.FrameRects == 0);
+    assert(stats.FramePixels == 0);
+    assert(stats.Conversions == conversions);
+    // sprite updated in place
+    driver.UpdateDDBFromBitmap(sprite, image, false);
+    Test_RenderFrame(driver, bg_ddb, sprite, 100, 100);
+    assert(stats.FrameRects == 1);
+    assert(stats.FramePixels == 20 * 50);
+    assert(stats.Conversions == conversions + 1);
+    // sprite moved, both old and new places are redrawn
+    Test_RenderFrame(driver, bg_ddb, sprite, 150, 100);
+    assert(stats.FrameRects == 2);
+    assert(stats.FramePixels == 2 * 20 * 50);
+    assert(stats.Conversions == conversions + 1);
+
+    driver.SetMemoryBackBuffer(NULL);
+    driver.DestroyDDB(sprite);
+    driver.DestroyDDB(bg_ddb);
+    delete image;
+    delete bg;
+    delete screen;
+    if (init_allegro)
+        allegro_exit();
+}
 
 void Test_Gfx()
 {
@@ -34,6 +227,9 @@ void Test_Gfx()
         trans100_back[i] = GfxDef::LegacyTrans255ToTrans100(trans255[i]);
         assert(trans100[i] == trans100_back[i]);
     }
+
+    Test_BlendKernels();
+    Test_DirtyRects();
 }
 
 #endif // _DEBUG
@@ -15,6 +15,7 @@
 #ifdef _DEBUG
 
 #include "debug/assert.h"
+#include "util/geometry.h"
 #include "util/scaling.h"
 
 using namespace AGS::Common;
@@ -33,8 +34,30 @@ void Test_Scaling(int src, int dst)
     assert(x == src);
 }
 
+void Test_RectOps()
+{
+    Rect r1(0, 0, 9, 9);
+    Rect r2(5, 5, 14, 14);
+    Rect r3(10, 0, 19, 9);
+    assert(AreRectsIntersecting(r1, r2));
+    assert(!AreRectsIntersecting(r1, r3));
+    assert(AreRectsIntersecting(r2, r3));
+
+    Rect r = IntersectRects(r1, r2);
+    assert(r.Left == 5 && r.Top == 5 && r.Right == 9 && r.Bottom == 9);
+    r = IntersectRects(r1, r3);
+    assert(r.IsEmpty());
+
+    r = UnionRects(r1, r3);
+    assert(r.Left == 0 && r.Top == 0 && r.Right == 19 && r.Bottom == 9);
+    r = UnionRects(r1, r2);
+    assert(r.Left == 0 && r.Top == 0 && r.Right == 14 && r.Bottom == 14);
+}
+
 void Test_Math()
 {
+    Test_RectOps();
+
     {
         Test_Scaling(100, 100);
 
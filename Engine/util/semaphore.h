@@ -0,0 +1,68 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Counting semaphore, used to make threads wait for work without polling
+//
+//=============================================================================
+
+#ifndef __AGS_EE_UTIL__SEMAPHORE_H
+#define __AGS_EE_UTIL__SEMAPHORE_H
+
+namespace AGS
+{
+namespace Engine
+{
+
+
+class BaseSemaphore
+{
+public:
+  BaseSemaphore()
+  {
+  };
+
+  virtual ~BaseSemaphore()
+  {
+  };
+
+  // Blocks until the counter is above zero, then decrements it
+  virtual void Wait() = 0;
+  // Increments the counter, releasing one waiting thread
+  virtual void Post() = 0;
+};
+
+
+} // namespace Engine
+} // namespace AGS
+
+
+#if defined(WINDOWS_VERSION)
+#include "semaphore_windows.h"
+
+#elif defined(PSP_VERSION)
+#include "semaphore_psp.h"
+
+#elif defined(WII_VERSION)
+#include "semaphore_wii.h"
+
+#elif defined(LINUX_VERSION) \
+   || defined(MAC_VERSION) \
+   || defined(IOS_VERSION) \
+   || defined(ANDROID_VERSION)
+#include "semaphore_pthread.h"
+
+#endif
+
+
+#endif // __AGS_EE_UTIL__SEMAPHORE_H
@@ -0,0 +1,62 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#ifndef __AGS_EE_UTIL__PSP_SEMAPHORE_H
+#define __AGS_EE_UTIL__PSP_SEMAPHORE_H
+
+#include <pspsdk.h>
+#include <pspkernel.h>
+#include <pspthreadman.h>
+
+namespace AGS
+{
+namespace Engine
+{
+
+
+class PSPSemaphore : public BaseSemaphore
+{
+public:
+  PSPSemaphore()
+  {
+    _sem = sceKernelCreateSema("", 0, 0, 0x7FFFFFFF, 0);
+  }
+
+  ~PSPSemaphore()
+  {
+    sceKernelDeleteSema(_sem);
+  }
+
+  inline void Wait()
+  {
+    sceKernelWaitSema(_sem, 1, 0);
+  }
+
+  inline void Post()
+  {
+    sceKernelSignalSema(_sem, 1);
+  }
+
+private:
+  SceUID _sem;
+};
+
+
+typedef PSPSemaphore Semaphore;
+
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_UTIL__PSP_SEMAPHORE_H
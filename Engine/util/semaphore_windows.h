@@ -0,0 +1,75 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#ifndef __AGS_EE_UTIL__SEMAPHORE_WINDOWS_H
+#define __AGS_EE_UTIL__SEMAPHORE_WINDOWS_H
+
+// FIXME: This is a horrible hack to avoid conflicts between Allegro and Windows
+#define BITMAP WINDOWS_BITMAP
+#include <windows.h>
+#undef BITMAP
+
+#include <crtdbg.h>
+#include <limits.h>
+
+
+namespace AGS
+{
+namespace Engine
+{
+
+
+class WindowsSemaphore : public BaseSemaphore
+{
+public:
+  WindowsSemaphore()
+  {
+    _sem = CreateSemaphore(NULL, 0, LONG_MAX, NULL);
+
+    _ASSERT(_sem != NULL);
+  }
+
+  ~WindowsSemaphore()
+  {
+    _ASSERT(_sem != NULL);
+
+    CloseHandle(_sem);
+  }
+
+  inline void Wait()
+  {
+    _ASSERT(_sem != NULL);
+
+    WaitForSingleObject(_sem, INFINITE);
+  }
+
+  inline void Post()
+  {
+    _ASSERT(_sem != NULL);
+
+    ReleaseSemaphore(_sem, 1, NULL);
+  }
+
+private:
+  HANDLE _sem;
+};
+
+
+typedef WindowsSemaphore Semaphore;
+
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_UTIL__SEMAPHORE_WINDOWS_H